@@ -84,6 +84,29 @@ typedef struct audio_statistics
    float close_to_blocking;
 } audio_statistics_t;
 
+/* Live measurements of the audio output path. Buffer
+ * sizes are in bytes of driver output, costs in
+ * microseconds per write, averaged. */
+typedef struct audio_telemetry
+{
+   double ratio;           /* resampling ratio of the last write */
+   float dsp_usec;
+   float stretch_usec;
+   float resample_usec;
+   float mix_usec;
+   float buffer_ms;        /* driver buffer, when full */
+   float latency_ms;       /* estimated, at the last write */
+   float target_ms;        /* what rate control aims for */
+   float jitter_ms;        /* of the fill, as adaptive rate control sees it */
+   unsigned buffer_size;   /* 0 if the driver doesn't report it */
+   unsigned fill;
+   unsigned fill_min;      /* over the last second of output */
+   unsigned fill_max;
+   unsigned underruns;     /* times the driver buffer ran dry */
+   unsigned overruns;      /* non-blocking writes that didn't fit */
+   unsigned output_rate;
+} audio_telemetry_t;
+
 RETRO_END_DECLS
 
 #endif
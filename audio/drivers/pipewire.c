@@ -0,0 +1,434 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <spa/param/audio/format-utils.h>
+#include <pipewire/pipewire.h>
+
+#include <boolean.h>
+#include <retro_miscellaneous.h>
+#include <queues/fifo_queue.h>
+
+#include "../../retroarch.h"
+#include "../../verbosity.h"
+
+/* Bounds for the graph quantum we ask for, in frames. */
+#define PIPEWIRE_QUANTUM_MIN  32
+#define PIPEWIRE_QUANTUM_MAX  8192
+
+/* Room the FIFO keeps in callback mode for whatever a
+ * single core callback produces beyond the quantum. */
+#define PIPEWIRE_PULL_SLACK   4096
+
+/* Times a graph cycle runs the core callback to fill one
+ * quantum before giving up and padding with silence. */
+#define PIPEWIRE_PULL_TRIES   4
+
+/* Seconds to wait on the daemon before giving up. */
+#define PIPEWIRE_TIMEOUT      2
+
+typedef struct pipewire_audio
+{
+   struct pw_thread_loop *loop;
+   struct pw_stream *stream;
+   struct pw_stream_events events;
+   fifo_buffer_t *buffer;
+   size_t buffer_size;
+   unsigned frame_size;
+   unsigned rate;
+   unsigned quantum;       /* frames per graph cycle, as last seen */
+   bool nonblock;
+   bool is_paused;
+   bool error;
+   /* Callback mode: the graph cycle runs the core's audio
+    * callback itself, rather than waiting on write(). */
+   bool pull;
+   bool in_process;
+} pipewire_t;
+
+static void pipewire_free(void *data)
+{
+   pipewire_t *pw = (pipewire_t*)data;
+
+   if (!pw)
+      return;
+
+   if (pw->loop)
+      pw_thread_loop_stop(pw->loop);
+
+   if (pw->stream)
+      pw_stream_destroy(pw->stream);
+
+   if (pw->loop)
+      pw_thread_loop_destroy(pw->loop);
+
+   if (pw->buffer)
+      fifo_free(pw->buffer);
+
+   free(pw);
+   pw_deinit();
+}
+
+static void pipewire_state_cb(void *data, enum pw_stream_state old,
+      enum pw_stream_state state, const char *error)
+{
+   pipewire_t *pw = (pipewire_t*)data;
+
+   (void)old;
+
+   if (state == PW_STREAM_STATE_ERROR)
+   {
+      RARCH_ERR("[PipeWire]: Stream error: %s.\n", error ? error : "unknown");
+      pw->error = true;
+   }
+
+   pw_thread_loop_signal(pw->loop, false);
+}
+
+/* Runs on the thread loop with its lock held, once per
+ * graph cycle. */
+static void pipewire_process_cb(void *data)
+{
+   size_t size, avail;
+   unsigned quantum;
+   uint8_t *dst;
+   struct spa_buffer *buf;
+   pipewire_t        *pw = (pipewire_t*)data;
+   struct pw_buffer   *b = pw_stream_dequeue_buffer(pw->stream);
+
+   if (!b)
+      return;
+
+   buf  = b->buffer;
+   dst  = (uint8_t*)buf->datas[0].data;
+   size = buf->datas[0].maxsize;
+#if PW_CHECK_VERSION(0, 3, 49)
+   if (b->requested)
+      size = MIN(size, b->requested * pw->frame_size);
+#endif
+   size -= size % pw->frame_size;
+
+   if (!dst)
+      size = 0;
+
+   quantum = (unsigned)(size / pw->frame_size);
+   if (quantum && quantum != pw->quantum)
+   {
+      RARCH_LOG("[PipeWire]: Quantum is %u frames (%.1f ms).\n",
+            quantum, quantum * 1000.0f / pw->rate);
+      pw->quantum = quantum;
+   }
+
+   if (pw->pull)
+   {
+      unsigned i;
+
+      /* write() lands back here and must not wait on us. */
+      pw->in_process = true;
+      for (i = 0; i < PIPEWIRE_PULL_TRIES
+            && FIFO_READ_AVAIL(pw->buffer) < size; i++)
+         audio_driver_callback();
+      pw->in_process = false;
+   }
+
+   avail = MIN(FIFO_READ_AVAIL(pw->buffer), size);
+   if (avail)
+      fifo_read(pw->buffer, dst, avail);
+   /* Underrun, play silence. */
+   if (size > avail)
+      memset(dst + avail, 0, size - avail);
+
+   if (dst)
+   {
+      buf->datas[0].chunk->offset = 0;
+      buf->datas[0].chunk->stride = pw->frame_size;
+      buf->datas[0].chunk->size   = (uint32_t)size;
+   }
+
+   pw_stream_queue_buffer(pw->stream, b);
+   pw_thread_loop_signal(pw->loop, false);
+}
+
+/* Largest power of two not above @frames, within the
+ * bounds the graph is likely to accept. */
+static unsigned pipewire_quantum(unsigned frames)
+{
+   unsigned quantum = PIPEWIRE_QUANTUM_MIN;
+
+   while (quantum * 2 <= frames && quantum * 2 <= PIPEWIRE_QUANTUM_MAX)
+      quantum *= 2;
+
+   return quantum;
+}
+
+static void *pipewire_init(const char *device, unsigned rate,
+      unsigned latency,
+      unsigned block_frames,
+      unsigned *new_rate)
+{
+   uint8_t                     pod[1024];
+   struct spa_audio_info_raw   info;
+   struct spa_pod_builder      b;
+   const struct spa_pod *params[1];
+   struct pw_properties   *props = NULL;
+   unsigned               frames = rate * latency / 1000;
+   unsigned              quantum;
+   pipewire_t                *pw = (pipewire_t*)calloc(1, sizeof(*pw));
+
+   if (!pw)
+      return NULL;
+
+   pw_init(NULL, NULL);
+
+   pw->rate       = rate;
+   pw->frame_size = 2 * sizeof(float);
+   pw->pull       = audio_driver_has_callback();
+   pw->is_paused  = pw->pull;
+
+   /* Two graph cycles per latency: one playing, one being
+    * filled. In callback mode the quantum is the latency. */
+   quantum        = pipewire_quantum(pw->pull ? frames : frames / 2);
+   if (frames < 2 * quantum)
+      frames      = 2 * quantum;
+   if (pw->pull)
+      frames     += PIPEWIRE_PULL_SLACK;
+
+   pw->buffer_size = frames * pw->frame_size;
+   pw->buffer      = fifo_new(pw->buffer_size + 1);
+   if (!pw->buffer)
+      goto error;
+
+   pw->loop = pw_thread_loop_new("RetroArch audio", NULL);
+   if (!pw->loop)
+      goto error;
+
+   props = pw_properties_new(
+         PW_KEY_MEDIA_TYPE,     "Audio",
+         PW_KEY_MEDIA_CATEGORY, "Playback",
+         PW_KEY_MEDIA_ROLE,     "Game",
+         PW_KEY_NODE_NAME,      "RetroArch",
+         NULL);
+   if (!props)
+      goto error;
+
+   /* Ask the graph for our quantum and rate, so neither
+    * the period nor resampling adds to the latency. */
+   pw_properties_setf(props, PW_KEY_NODE_LATENCY, "%u/%u", quantum, rate);
+#ifdef PW_KEY_NODE_RATE
+   /* Not in the oldest 0.3 releases configure accepts. */
+   pw_properties_setf(props, PW_KEY_NODE_RATE, "1/%u", rate);
+#endif
+   if (device)
+#ifdef PW_KEY_TARGET_OBJECT
+      pw_properties_set(props, PW_KEY_TARGET_OBJECT, device);
+#else
+      pw_properties_set(props, PW_KEY_NODE_TARGET, device);
+#endif
+
+   pw->events.version       = PW_VERSION_STREAM_EVENTS;
+   pw->events.state_changed = pipewire_state_cb;
+   pw->events.process       = pipewire_process_cb;
+
+   pw_thread_loop_lock(pw->loop);
+   if (pw_thread_loop_start(pw->loop) < 0)
+      goto unlock_error;
+
+   /* Takes ownership of props. */
+   pw->stream = pw_stream_new_simple(pw_thread_loop_get_loop(pw->loop),
+         "RetroArch", props, &pw->events, pw);
+   props      = NULL;
+   if (!pw->stream)
+      goto unlock_error;
+
+   memset(&info, 0, sizeof(info));
+   info.format      = SPA_AUDIO_FORMAT_F32;
+   info.channels    = 2;
+   info.rate        = rate;
+   info.position[0] = SPA_AUDIO_CHANNEL_FL;
+   info.position[1] = SPA_AUDIO_CHANNEL_FR;
+
+   spa_pod_builder_init(&b, pod, sizeof(pod));
+   params[0] = spa_format_audio_raw_build(&b, SPA_PARAM_EnumFormat, &info);
+
+   if (pw_stream_connect(pw->stream, PW_DIRECTION_OUTPUT, PW_ID_ANY,
+            (enum pw_stream_flags)(PW_STREAM_FLAG_AUTOCONNECT
+            | PW_STREAM_FLAG_MAP_BUFFERS
+            | (pw->is_paused ? PW_STREAM_FLAG_INACTIVE : 0)),
+            params, 1) < 0)
+      goto unlock_error;
+
+   while (     !pw->error
+         && pw_stream_get_state(pw->stream, NULL) < PW_STREAM_STATE_PAUSED)
+      if (pw_thread_loop_timed_wait(pw->loop, PIPEWIRE_TIMEOUT) != 0)
+         break;
+
+   if (pw_stream_get_state(pw->stream, NULL) < PW_STREAM_STATE_PAUSED)
+      goto unlock_error;
+
+   pw_thread_loop_unlock(pw->loop);
+
+   RARCH_LOG("[PipeWire]: Requested %u frames quantum, %u bytes buffer%s.\n",
+         quantum, (unsigned)pw->buffer_size,
+         pw->pull ? ", callback mode" : "");
+
+   return pw;
+
+unlock_error:
+   pw_thread_loop_unlock(pw->loop);
+error:
+   if (props)
+      pw_properties_free(props);
+   RARCH_ERR("[PipeWire]: Failed to initialize.\n");
+   pipewire_free(pw);
+   return NULL;
+}
+
+static bool pipewire_start(void *data, bool is_shutdown);
+static ssize_t pipewire_write(void *data, const void *buf_, size_t size)
+{
+   pipewire_t        *pw = (pipewire_t*)data;
+   const uint8_t    *buf = (const uint8_t*)buf_;
+   size_t        written = 0;
+
+   /* Workaround buggy menu code.
+    * If a write happens while we're paused, we might never progress. */
+   if (pw->is_paused && !pw->pull)
+      if (!pipewire_start(pw, false))
+         return -1;
+
+   pw_thread_loop_lock(pw->loop);
+   while (size && !pw->error)
+   {
+      size_t writable = MIN(size, FIFO_WRITE_AVAIL(pw->buffer));
+
+      if (writable)
+      {
+         fifo_write(pw->buffer, buf, writable);
+         buf     += writable;
+         size    -= writable;
+         written += writable;
+      }
+      else if (pw->nonblock || pw->in_process)
+         break;
+      else if (pw_thread_loop_timed_wait(pw->loop, PIPEWIRE_TIMEOUT) != 0)
+      {
+         /* Nothing is consuming, e.g. no sink to link to. */
+         RARCH_WARN("[PipeWire]: Timed out waiting for the graph.\n");
+         break;
+      }
+   }
+   pw_thread_loop_unlock(pw->loop);
+
+   if (pw->error)
+      return -1;
+   return written;
+}
+
+static bool pipewire_stop(void *data)
+{
+   pipewire_t *pw = (pipewire_t*)data;
+   if (pw->is_paused)
+      return true;
+
+   RARCH_LOG("[PipeWire]: Pausing.\n");
+
+   if (pw->pull)
+      audio_driver_disable_callback();
+
+   pw_thread_loop_lock(pw->loop);
+   pw_stream_set_active(pw->stream, false);
+   pw_thread_loop_unlock(pw->loop);
+   pw->is_paused = true;
+   return !pw->error;
+}
+
+static bool pipewire_alive(void *data)
+{
+   pipewire_t *pw = (pipewire_t*)data;
+
+   if (!pw)
+      return false;
+   return !pw->is_paused;
+}
+
+static bool pipewire_start(void *data, bool is_shutdown)
+{
+   pipewire_t *pw = (pipewire_t*)data;
+   if (!pw->is_paused)
+      return true;
+
+   RARCH_LOG("[PipeWire]: Unpausing.\n");
+
+   if (pw->pull)
+      audio_driver_enable_callback();
+
+   pw_thread_loop_lock(pw->loop);
+   pw_stream_set_active(pw->stream, true);
+   pw_thread_loop_unlock(pw->loop);
+   pw->is_paused = false;
+   return !pw->error;
+}
+
+static void pipewire_set_nonblock_state(void *data, bool state)
+{
+   pipewire_t *pw = (pipewire_t*)data;
+   if (pw)
+      pw->nonblock = state;
+}
+
+static bool pipewire_use_float(void *data)
+{
+   (void)data;
+   return true;
+}
+
+static size_t pipewire_write_avail(void *data)
+{
+   size_t length;
+   pipewire_t *pw = (pipewire_t*)data;
+
+   pw_thread_loop_lock(pw->loop);
+   length = FIFO_WRITE_AVAIL(pw->buffer);
+   pw_thread_loop_unlock(pw->loop);
+   return length;
+}
+
+static size_t pipewire_buffer_size(void *data)
+{
+   pipewire_t *pw = (pipewire_t*)data;
+   return pw->buffer_size;
+}
+
+audio_driver_t audio_pipewire = {
+   pipewire_init,
+   pipewire_write,
+   pipewire_stop,
+   pipewire_start,
+   pipewire_alive,
+   pipewire_set_nonblock_state,
+   pipewire_free,
+   pipewire_use_float,
+   "pipewire",
+   NULL,
+   NULL,
+   pipewire_write_avail,
+   pipewire_buffer_size,
+   NULL, /* write_begin */
+   NULL, /* write_end */
+   true  /* pulls_callback, see pipewire_process_cb() */
+};
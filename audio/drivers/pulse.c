@@ -31,6 +31,7 @@ typedef struct
    pa_threaded_mainloop *mainloop;
    pa_context *context;
    pa_stream *stream;
+   void *write_buf; /* from pa_stream_begin_write() */
    size_t buffer_size;
    bool nonblock;
    bool success;
@@ -352,6 +353,56 @@ static size_t pulse_buffer_size(void *data)
    return pa->buffer_size;
 }
 
+static void *pulse_write_begin(void *data, size_t size)
+{
+   pa_t    *pa = (pa_t*)data;
+   void   *buf = NULL;
+   size_t  len = size;
+
+   if (pa->is_paused)
+      if (!pulse_start(pa, false))
+         return NULL;
+
+   pa_threaded_mainloop_lock(pa->mainloop);
+
+   /* More than the buffer holds never becomes writable. */
+   if (size <= pa->buffer_size)
+   {
+      while (pa_stream_writable_size(pa->stream) < size && !pa->nonblock)
+         pa_threaded_mainloop_wait(pa->mainloop);
+
+      if (     pa_stream_writable_size(pa->stream) >= size
+            && pa_stream_begin_write(pa->stream, &buf, &len) == 0
+            && len < size)
+      {
+         pa_stream_cancel_write(pa->stream);
+         buf = NULL;
+      }
+   }
+
+   pa_threaded_mainloop_unlock(pa->mainloop);
+
+   pa->write_buf = buf;
+   return buf;
+}
+
+static ssize_t pulse_write_end(void *data, size_t size)
+{
+   int ret = 0;
+   pa_t *pa = (pa_t*)data;
+
+   pa_threaded_mainloop_lock(pa->mainloop);
+   if (size)
+      ret = pa_stream_write(pa->stream, pa->write_buf, size,
+            NULL, 0, PA_SEEK_RELATIVE);
+   else
+      pa_stream_cancel_write(pa->stream);
+   pa_threaded_mainloop_unlock(pa->mainloop);
+
+   pa->write_buf = NULL;
+   return ret < 0 ? -1 : (ssize_t)size;
+}
+
 audio_driver_t audio_pulse = {
    pulse_init,
    pulse_write,
@@ -366,4 +417,6 @@ audio_driver_t audio_pulse = {
    NULL,
    pulse_write_avail,
    pulse_buffer_size,
+   pulse_write_begin,
+   pulse_write_end,
 };
@@ -290,6 +290,14 @@ bool command_write_ram(command_t *cmd, const char *arg);
 #endif
 bool command_read_memory(command_t *cmd, const char *arg);
 bool command_write_memory(command_t *cmd, const char *arg);
+bool command_timeline_start(command_t *cmd, const char *arg);
+bool command_timeline_stop(command_t *cmd, const char *arg);
+bool command_timeline_dump(command_t *cmd, const char *arg);
+bool command_get_audio_stats(command_t *cmd, const char *arg);
+bool command_reset_audio_stats(command_t *cmd, const char *arg);
+#ifdef HAVE_REWIND
+bool command_rewind_seek(command_t *cmd, const char *arg);
+#endif
 
 struct cmd_action_map
 {
@@ -314,6 +322,14 @@ static const struct cmd_action_map action_map[] = {
 #endif
    { "READ_CORE_MEMORY", command_read_memory,      "<address> <number of bytes>" },
    { "WRITE_CORE_MEMORY",command_write_memory,     "<address> <byte1> <byte2> ..." },
+   { "TIMELINE_START",   command_timeline_start,   "No argument" },
+   { "TIMELINE_STOP",    command_timeline_stop,    "No argument" },
+   { "TIMELINE_DUMP",    command_timeline_dump,    "<output path>" },
+   { "GET_AUDIO_STATS",  command_get_audio_stats,  "No argument" },
+   { "RESET_AUDIO_STATS",command_reset_audio_stats,"No argument" },
+#ifdef HAVE_REWIND
+   { "REWIND_SEEK",      command_rewind_seek,      "<frames>" },
+#endif
 };
 
 static const struct cmd_map map[] = {
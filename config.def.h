@@ -819,6 +819,14 @@ static const float message_bgcolor_opacity = 1.0f;
 /* Screenshots post-shaded GPU output if available. */
 #define DEFAULT_GPU_SCREENSHOT true
 
+/* Hash software frames and hand identical ones to the
+ * video driver as dupes, skipping upload and filtering. */
+#define DEFAULT_VIDEO_FRAME_DUPE_DETECT false
+
+/* Tell video drivers which rows of a software frame
+ * changed, so they only upload those. */
+#define DEFAULT_VIDEO_FRAME_PARTIAL_UPLOAD false
+
 /* Watch shader files for changes and auto-apply as necessary. */
 #define DEFAULT_VIDEO_SHADER_WATCH_FILES false
 
@@ -968,6 +976,10 @@ static const bool audio_enable_menu_bgm    = false;
 /* Will sync audio. (recommended) */
 #define DEFAULT_AUDIO_SYNC true
 
+/* Run the audio processing chain (DSP, resampler,
+ * mixer) on its own thread. */
+#define DEFAULT_AUDIO_PROCESSING_THREAD false
+
 /* Audio rate control. */
 #if !defined(RARCH_CONSOLE)
 #define DEFAULT_RATE_CONTROL true
@@ -979,6 +991,14 @@ static const bool audio_enable_menu_bgm    = false;
  * is allowed to adjust input rate. */
 #define DEFAULT_RATE_CONTROL_DELTA  0.005
 
+/* Steer the audio buffer to a latency target with
+ * a PI controller rather than to half the buffer. */
+#define DEFAULT_RATE_CONTROL_ADAPTIVE false
+
+/* Latency the adaptive rate control aims for, in ms.
+ * 0 aims for half the audio buffer. */
+#define DEFAULT_AUDIO_LATENCY_TARGET 0
+
 /* Maximum timing skew. Defines how much adjust_system_rates
  * is allowed to adjust input rate. */
 #define DEFAULT_MAX_TIMING_SKEW  0.05
@@ -1001,6 +1021,10 @@ static const bool audio_enable_menu_bgm    = false;
  * is enabled */
 #define DEFAULT_AUDIO_FASTFORWARD_MUTE false
 
+/* Keep the audio pitch during fast forward
+ * and slow motion */
+#define DEFAULT_AUDIO_TIMESTRETCH false
+
 /* MISC */
 
 /* Enables displaying the current frames per second. */
@@ -1041,6 +1065,22 @@ static const bool audio_enable_menu_bgm    = false;
 /* How many frames to rewind at a time. */
 #define DEFAULT_REWIND_GRANULARITY 1
 
+/* Store a full state every N rewind entries (0 = off), so
+ * seeking far back only decompresses up to N deltas. */
+#define DEFAULT_REWIND_KEYFRAME_INTERVAL 0
+
+/* Minimum amount of rewind history, in seconds. When the buffer
+ * can't hold this much, states are captured less often (0 = off). */
+#define DEFAULT_REWIND_MIN_HISTORY 0
+
+/* Compress rewind states on a worker thread, so that only
+ * serialization is paid for on the main thread. */
+#define DEFAULT_REWIND_THREADED false
+
+/* Deflate rewind deltas (fast level) before they go into
+ * the rewind buffer. */
+#define DEFAULT_REWIND_COMPRESSION false
+
 /* Pause gameplay when gameplay loses focus. */
 #ifdef EMSCRIPTEN
 #define DEFAULT_PAUSE_NONACTIVE false
@@ -1149,6 +1189,10 @@ static const bool savestate_thumbnail_enable = false;
 /* When using the Run Ahead feature, use a secondary instance of the core. */
 #define DEFAULT_RUN_AHEAD_SECONDARY_INSTANCE true
 
+/* Run the secondary instance on a worker thread, in parallel with
+ * the main instance, for as long as input doesn't change. */
+#define DEFAULT_RUN_AHEAD_SECONDARY_THREADED false
+
 /* Hide warning messages when using the Run Ahead feature. */
 #define DEFAULT_RUN_AHEAD_HIDE_WARNINGS false
 
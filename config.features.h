@@ -206,6 +206,12 @@
 #define SUPPORTS_PULSE false
 #endif
 
+#ifdef HAVE_PIPEWIRE
+#define SUPPORTS_PIPEWIRE true
+#else
+#define SUPPORTS_PIPEWIRE false
+#endif
+
 #ifdef HAVE_DSOUND
 #define SUPPORTS_DSOUND true
 #else
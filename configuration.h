@@ -140,6 +140,7 @@ typedef struct settings
       unsigned audio_output_sample_rate;
       unsigned audio_block_frames;
       unsigned audio_latency;
+      unsigned audio_latency_target;
 
       unsigned fps_update_interval;
       unsigned memory_update_interval;
@@ -178,6 +179,8 @@ typedef struct settings
       unsigned libretro_log_level;
       unsigned rewind_granularity;
       unsigned rewind_buffer_size_step;
+      unsigned rewind_keyframe_interval;
+      unsigned rewind_min_history;
       unsigned autosave_interval;
       unsigned savestate_max_keep;
       unsigned network_cmd_port;
@@ -508,6 +511,8 @@ typedef struct settings
       bool video_post_filter_record;
       bool video_gpu_record;
       bool video_gpu_screenshot;
+      bool video_frame_dupe_detect;
+      bool video_frame_partial_upload;
       bool video_allow_rotate;
       bool video_shared_context;
       bool video_force_srgb_disable;
@@ -534,10 +539,13 @@ typedef struct settings
       bool audio_enable_menu_notice;
       bool audio_enable_menu_bgm;
       bool audio_sync;
+      bool audio_processing_thread;
       bool audio_rate_control;
+      bool audio_rate_control_adaptive;
       bool audio_wasapi_exclusive_mode;
       bool audio_wasapi_float_format;
       bool audio_fastforward_mute;
+      bool audio_timestretch;
 
       /* Input */
       bool input_remap_binds_enable;
@@ -771,11 +779,14 @@ typedef struct settings
       bool history_list_enable;
       bool playlist_entry_rename;
       bool rewind_enable;
+      bool rewind_threaded;
+      bool rewind_compression;
       bool vrr_runloop_enable;
       bool apply_cheats_after_toggle;
       bool apply_cheats_after_load;
       bool run_ahead_enabled;
       bool run_ahead_secondary_instance;
+      bool run_ahead_secondary_threaded;
       bool run_ahead_hide_warnings;
       bool pause_nonactive;
       bool block_sram_overwrite;
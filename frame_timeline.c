@@ -0,0 +1,318 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2021 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libretro.h>
+#include <features/features_cpu.h>
+#include <streams/file_stream.h>
+
+#include "frame_timeline.h"
+
+/* Must be a power of two. About 30 seconds
+ * at 60 fps with ten events per frame. */
+#define FRAME_TIMELINE_EVENTS (1 << 15)
+
+typedef struct frame_timeline_event
+{
+   retro_time_t start;
+   uint32_t duration;
+   uint32_t frame;
+   unsigned phase;
+} frame_timeline_event_t;
+
+/* Durations are also binned into log-linear histograms so
+ * percentiles cover the whole recording, not just what's
+ * left in the ring: exact below 64 us, then 32 bins per
+ * power of two (about 3% error). */
+#define FRAME_TIMELINE_HIST_LINEAR 64
+#define FRAME_TIMELINE_HIST_SUB    32
+#define FRAME_TIMELINE_HIST_BINS   (FRAME_TIMELINE_HIST_LINEAR + 26 * FRAME_TIMELINE_HIST_SUB)
+
+typedef struct frame_timeline_hist
+{
+   uint64_t total;
+   uint32_t count;
+   uint32_t max;
+   uint32_t bins[FRAME_TIMELINE_HIST_BINS];
+} frame_timeline_hist_t;
+
+/* The ring has a single writer, the main thread, which also
+ * does the exporting (command interface), so it needs no
+ * locking; 'head' only ever grows and wraps by masking. */
+typedef struct frame_timeline
+{
+   frame_timeline_event_t *events;
+   frame_timeline_hist_t *hists;
+   retro_time_t starts[FRAME_TIMELINE_LAST];
+   uint32_t head;
+   uint32_t frame;
+   bool active;
+} frame_timeline_t;
+
+static frame_timeline_t frame_timeline_st;
+
+static const char *frame_timeline_names[FRAME_TIMELINE_LAST] = {
+   "frame",
+   "input_poll",
+   "core_run",
+   "runahead_save",
+   "runahead_load",
+   "rewind",
+   "video_frame",
+   "audio_flush",
+   "sleep",
+};
+
+static unsigned frame_timeline_hist_bin(uint32_t value)
+{
+   unsigned shift = 0;
+
+   if (value < FRAME_TIMELINE_HIST_LINEAR)
+      return value;
+
+   while ((value >> shift) >= 2 * FRAME_TIMELINE_HIST_SUB)
+      shift++;
+
+   return FRAME_TIMELINE_HIST_LINEAR + (shift - 1) * FRAME_TIMELINE_HIST_SUB
+      + (value >> shift) - FRAME_TIMELINE_HIST_SUB;
+}
+
+/* Midpoint of the range a bin covers. */
+static uint32_t frame_timeline_hist_value(unsigned bin)
+{
+   unsigned shift;
+   uint32_t low;
+
+   if (bin < FRAME_TIMELINE_HIST_LINEAR)
+      return bin;
+
+   bin  -= FRAME_TIMELINE_HIST_LINEAR;
+   shift = bin / FRAME_TIMELINE_HIST_SUB + 1;
+   low   = (uint32_t)(bin % FRAME_TIMELINE_HIST_SUB
+         + FRAME_TIMELINE_HIST_SUB) << shift;
+
+   return low + ((1 << shift) >> 1);
+}
+
+static uint32_t frame_timeline_hist_percentile(
+      const frame_timeline_hist_t *hist, unsigned percent)
+{
+   unsigned i;
+   uint64_t seen   = 0;
+   uint64_t target = ((uint64_t)hist->count * percent + 99) / 100;
+
+   for (i = 0; i < FRAME_TIMELINE_HIST_BINS; i++)
+   {
+      seen += hist->bins[i];
+      if (seen >= target)
+      {
+         uint32_t value = frame_timeline_hist_value(i);
+         return value < hist->max ? value : hist->max;
+      }
+   }
+
+   return hist->max;
+}
+
+static void frame_timeline_push(frame_timeline_t *tl,
+      unsigned phase, retro_time_t start, retro_time_t end)
+{
+   frame_timeline_event_t *ev = &tl->events[
+      tl->head & (FRAME_TIMELINE_EVENTS - 1)];
+   frame_timeline_hist_t *hist = &tl->hists[phase];
+
+   ev->start    = start;
+   ev->duration = (uint32_t)(end - start);
+   ev->frame    = tl->frame;
+   ev->phase    = phase;
+   tl->head++;
+
+   hist->total += ev->duration;
+   hist->count++;
+   if (ev->duration > hist->max)
+      hist->max  = ev->duration;
+   hist->bins[frame_timeline_hist_bin(ev->duration)]++;
+}
+
+bool frame_timeline_start(void)
+{
+   unsigned i;
+   frame_timeline_t *tl = &frame_timeline_st;
+
+   if (!tl->events)
+   {
+      tl->events = (frame_timeline_event_t*)malloc(
+            FRAME_TIMELINE_EVENTS * sizeof(*tl->events));
+      if (!tl->events)
+         return false;
+   }
+
+   if (!tl->hists)
+   {
+      tl->hists = (frame_timeline_hist_t*)malloc(
+            FRAME_TIMELINE_LAST * sizeof(*tl->hists));
+      if (!tl->hists)
+         return false;
+   }
+
+   memset(tl->hists, 0, FRAME_TIMELINE_LAST * sizeof(*tl->hists));
+
+   for (i = 0; i < FRAME_TIMELINE_LAST; i++)
+      tl->starts[i] = 0;
+   tl->head   = 0;
+   tl->frame  = 0;
+   tl->active = true;
+   return true;
+}
+
+void frame_timeline_stop(void)
+{
+   frame_timeline_st.active = false;
+}
+
+void frame_timeline_free(void)
+{
+   frame_timeline_t *tl = &frame_timeline_st;
+
+   if (tl->events)
+      free(tl->events);
+   if (tl->hists)
+      free(tl->hists);
+   tl->events = NULL;
+   tl->hists  = NULL;
+   tl->head   = 0;
+   tl->active = false;
+}
+
+bool frame_timeline_is_active(void)
+{
+   return frame_timeline_st.active;
+}
+
+void frame_timeline_new_frame(void)
+{
+   frame_timeline_t *tl = &frame_timeline_st;
+   retro_time_t now;
+
+   if (!tl->active)
+      return;
+
+   now = cpu_features_get_time_usec();
+   if (tl->starts[FRAME_TIMELINE_FRAME])
+   {
+      frame_timeline_push(tl, FRAME_TIMELINE_FRAME,
+            tl->starts[FRAME_TIMELINE_FRAME], now);
+      tl->frame++;
+   }
+   tl->starts[FRAME_TIMELINE_FRAME] = now;
+}
+
+void frame_timeline_begin(enum frame_timeline_phase phase)
+{
+   frame_timeline_t *tl = &frame_timeline_st;
+
+   if (tl->active)
+      tl->starts[phase] = cpu_features_get_time_usec();
+}
+
+void frame_timeline_end(enum frame_timeline_phase phase)
+{
+   frame_timeline_t *tl = &frame_timeline_st;
+
+   /* Ignores phases that began before recording started. */
+   if (!tl->active || !tl->starts[phase])
+      return;
+
+   frame_timeline_push(tl, phase, tl->starts[phase],
+         cpu_features_get_time_usec());
+   tl->starts[phase] = 0;
+}
+
+const char *frame_timeline_phase_name(enum frame_timeline_phase phase)
+{
+   if (phase >= FRAME_TIMELINE_LAST)
+      return NULL;
+   return frame_timeline_names[phase];
+}
+
+bool frame_timeline_get_stats(enum frame_timeline_phase phase,
+      frame_timeline_stats_t *stats)
+{
+   const frame_timeline_hist_t *hist = NULL;
+   frame_timeline_t *tl              = &frame_timeline_st;
+
+   if (!tl->hists || phase >= FRAME_TIMELINE_LAST)
+      return false;
+
+   hist         = &tl->hists[phase];
+   stats->count = hist->count;
+   stats->total = hist->total;
+   stats->max   = hist->max;
+
+   if (!hist->count)
+   {
+      stats->p50 = stats->p95 = stats->p99 = 0;
+      return true;
+   }
+
+   stats->p50   = frame_timeline_hist_percentile(hist, 50);
+   stats->p95   = frame_timeline_hist_percentile(hist, 95);
+   stats->p99   = frame_timeline_hist_percentile(hist, 99);
+   return true;
+}
+
+int frame_timeline_write(const char *path)
+{
+   uint32_t i, first;
+   frame_timeline_t *tl = &frame_timeline_st;
+   RFILE *file          = NULL;
+
+   if (!tl->events)
+      return -1;
+
+   if (!(file = filestream_open(path,
+               RETRO_VFS_FILE_ACCESS_WRITE,
+               RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return -1;
+
+   first = tl->head > FRAME_TIMELINE_EVENTS
+      ? tl->head - FRAME_TIMELINE_EVENTS : 0;
+
+   filestream_printf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+   for (i = first; i != tl->head; i++)
+   {
+      const frame_timeline_event_t *ev = &tl->events[
+         i & (FRAME_TIMELINE_EVENTS - 1)];
+
+      /* Complete ('X') events; timestamps are in microseconds. */
+      filestream_printf(file,
+            "%s{\"name\":\"%s\",\"cat\":\"runloop\",\"ph\":\"X\","
+            "\"ts\":%lld,\"dur\":%u,\"pid\":1,\"tid\":1,"
+            "\"args\":{\"frame\":%u}}\n",
+            i == first ? "" : ",",
+            frame_timeline_names[ev->phase],
+            (long long)ev->start, (unsigned)ev->duration,
+            (unsigned)ev->frame);
+   }
+
+   filestream_printf(file, "]}\n");
+   filestream_close(file);
+
+   return (int)(tl->head - first);
+}
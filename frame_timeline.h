@@ -0,0 +1,110 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2021 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FRAME_TIMELINE_H
+#define __FRAME_TIMELINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* Phases of a runloop iteration the timeline records.
+ * They nest; e.g. video and audio submission happen
+ * from within the core's run. */
+enum frame_timeline_phase
+{
+   FRAME_TIMELINE_FRAME = 0,
+   FRAME_TIMELINE_INPUT_POLL,
+   FRAME_TIMELINE_CORE_RUN,
+   FRAME_TIMELINE_RUNAHEAD_SAVE,
+   FRAME_TIMELINE_RUNAHEAD_LOAD,
+   FRAME_TIMELINE_REWIND,
+   FRAME_TIMELINE_VIDEO_FRAME,
+   FRAME_TIMELINE_AUDIO_FLUSH,
+   FRAME_TIMELINE_SLEEP,
+   FRAME_TIMELINE_LAST
+};
+
+/* Durations are in microseconds; percentiles are
+ * approximate (within about 3%). */
+typedef struct frame_timeline_stats
+{
+   uint64_t total;
+   uint32_t count;
+   uint32_t max;
+   uint32_t p50;
+   uint32_t p95;
+   uint32_t p99;
+} frame_timeline_stats_t;
+
+/**
+ * frame_timeline_start:
+ *
+ * Starts recording, dropping whatever was recorded before.
+ *
+ * Returns: false if the event ring could not be allocated.
+ **/
+bool frame_timeline_start(void);
+
+void frame_timeline_stop(void);
+
+void frame_timeline_free(void);
+
+bool frame_timeline_is_active(void);
+
+/* Closes the previous frame and opens the next one;
+ * called once at the top of every runloop iteration. */
+void frame_timeline_new_frame(void);
+
+/* Phases must be begun and ended on the main thread. These
+ * return right away when the timeline isn't recording. */
+void frame_timeline_begin(enum frame_timeline_phase phase);
+
+void frame_timeline_end(enum frame_timeline_phase phase);
+
+const char *frame_timeline_phase_name(enum frame_timeline_phase phase);
+
+/**
+ * frame_timeline_get_stats:
+ * @phase                : phase to summarize.
+ * @stats                : filled with the phase's statistics.
+ *
+ * Summarizes every event of @phase recorded since the
+ * last frame_timeline_start(), including those that have
+ * since been overwritten in the event ring.
+ *
+ * Returns: false if nothing was ever recorded.
+ **/
+bool frame_timeline_get_stats(enum frame_timeline_phase phase,
+      frame_timeline_stats_t *stats);
+
+/**
+ * frame_timeline_write:
+ * @path                 : file to write.
+ *
+ * Writes the recorded events as Chrome trace event JSON
+ * (chrome://tracing, Perfetto), oldest first.
+ *
+ * Returns: number of events written, or -1 on error.
+ **/
+int frame_timeline_write(const char *path);
+
+RETRO_END_DECLS
+
+#endif
@@ -47,6 +47,10 @@ struct gl_core_streamed_texture
    GLuint tex;
    unsigned width;
    unsigned height;
+   /* Rows [dirty_begin, dirty_end) changed since this
+    * texture was last uploaded to. */
+   unsigned dirty_begin;
+   unsigned dirty_end;
 };
 
 typedef struct gl_core
@@ -281,6 +281,11 @@ struct vk_per_frame
 
    VkCommandPool cmd_pool; /* ptr alignment */
    VkCommandBuffer cmd;    /* ptr alignment */
+
+   /* Rows [dirty_begin, dirty_end) changed since the
+    * texture was last uploaded to. */
+   unsigned dirty_begin;
+   unsigned dirty_end;
 };
 
 struct vk_draw_quad
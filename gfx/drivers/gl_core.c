@@ -1748,10 +1748,37 @@ error:
    return false;
 }
 
+static void gl_core_mark_dirty_rows(gl_core_t *gl,
+      unsigned y, unsigned height)
+{
+   unsigned i;
+
+   /* Every texture in the ring has to catch up on the rows
+    * that changed since it was last uploaded to. */
+   for (i = 0; i < GL_CORE_NUM_TEXTURES; i++)
+   {
+      struct gl_core_streamed_texture *streamed = &gl->textures[i];
+
+      if (!height)
+      {
+         streamed->dirty_begin = 0;
+         streamed->dirty_end   = UINT_MAX;
+         continue;
+      }
+
+      if (y < streamed->dirty_begin)
+         streamed->dirty_begin = y;
+      if (y + height > streamed->dirty_end)
+         streamed->dirty_end   = y + height;
+   }
+}
+
 static void gl_core_update_cpu_texture(gl_core_t *gl,
                                        struct gl_core_streamed_texture *streamed,
                                        const void *frame, unsigned width, unsigned height, unsigned pitch)
 {
+   unsigned y, rows;
+
    if (width != streamed->width || height != streamed->height)
    {
       if (streamed->tex != 0)
@@ -1768,24 +1795,37 @@ static void gl_core_update_cpu_texture(gl_core_t *gl,
          glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_BLUE);
          glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
       }
+
+      streamed->dirty_begin = 0;
+      streamed->dirty_end   = UINT_MAX;
    }
    else
       glBindTexture(GL_TEXTURE_2D, streamed->tex);
 
+   y    = streamed->dirty_begin;
+   rows = MIN(streamed->dirty_end, height);
+   streamed->dirty_begin = UINT_MAX;
+   streamed->dirty_end   = 0;
+
+   if (y >= rows)
+      return;
+   rows  -= y;
+   frame  = (const uint8_t*)frame + y * pitch;
+
    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
    if (gl->video_info.rgb32)
    {
       glPixelStorei(GL_UNPACK_ROW_LENGTH, pitch >> 2);
       glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0,
-                      width, height, GL_RGBA, GL_UNSIGNED_BYTE, frame);
+      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y,
+                      width, rows, GL_RGBA, GL_UNSIGNED_BYTE, frame);
    }
    else
    {
       glPixelStorei(GL_UNPACK_ROW_LENGTH, pitch >> 1);
       glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
-      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0,
-                      width, height, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, frame);
+      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y,
+                      width, rows, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, frame);
    }
 }
 
@@ -1872,7 +1912,12 @@ static bool gl_core_frame(void *data, const void *frame,
    glBindVertexArray(gl->vao);
 
    if (frame)
+   {
+      if (!gl->hw_render_enable)
+         gl_core_mark_dirty_rows(gl,
+               video_info->frame_dirty_y, video_info->frame_dirty_height);
       gl->textures_index = (gl->textures_index + 1) & (GL_CORE_NUM_TEXTURES - 1);
+   }
 
    streamed = &gl->textures[gl->textures_index];
    if (frame)
@@ -2035,6 +2080,7 @@ static uint32_t gl_core_get_flags(void *data)
    BIT32_SET(flags, GFX_CTX_FLAGS_BLACK_FRAME_INSERTION);
    BIT32_SET(flags, GFX_CTX_FLAGS_MENU_FRAME_FILTERING);
    BIT32_SET(flags, GFX_CTX_FLAGS_SCREENSHOTS_SUPPORTED);
+   BIT32_SET(flags, GFX_CTX_FLAGS_PARTIAL_UPLOAD);
 
    return flags;
 }
@@ -649,6 +649,31 @@ static void vulkan_deinit_descriptor_pool(vk_t *vk)
             &vk->swapchain[i].descriptor_manager);
 }
 
+static void vulkan_mark_dirty_rows(vk_t *vk,
+      unsigned y, unsigned height)
+{
+   unsigned i;
+
+   /* Every swapchain texture has to catch up on the rows
+    * that changed since it was last written to. */
+   for (i = 0; i < vk->num_swapchain_images; i++)
+   {
+      struct vk_per_frame *chain = &vk->swapchain[i];
+
+      if (!height)
+      {
+         chain->dirty_begin = 0;
+         chain->dirty_end   = UINT_MAX;
+         continue;
+      }
+
+      if (y < chain->dirty_begin)
+         chain->dirty_begin = y;
+      if (y + height > chain->dirty_end)
+         chain->dirty_end   = y + height;
+   }
+}
+
 static void vulkan_init_textures(vk_t *vk)
 {
    unsigned i;
@@ -672,6 +697,9 @@ static void vulkan_init_textures(vk_t *vk)
             vk->swapchain[i].texture_optimal = vulkan_create_texture(vk, NULL,
                   vk->tex_w, vk->tex_h, vk->tex_fmt,
                   NULL, NULL, VULKAN_TEXTURE_DYNAMIC);
+
+         vk->swapchain[i].dirty_begin = 0;
+         vk->swapchain[i].dirty_end   = UINT_MAX;
       }
    }
 
@@ -1819,11 +1847,14 @@ static bool vulkan_frame(void *data, const void *frame,
    /* Upload texture */
    if (frame && !vk->hw.enable)
    {
-      unsigned y;
+      unsigned y, rows;
       uint8_t *dst        = NULL;
       const uint8_t *src  = (const uint8_t*)frame;
       unsigned bpp        = vk->video.rgb32 ? 4 : 2;
 
+      vulkan_mark_dirty_rows(vk,
+            video_info->frame_dirty_y, video_info->frame_dirty_height);
+
       if (     chain->texture.width  != frame_width
             || chain->texture.height != frame_height)
       {
@@ -1844,16 +1875,28 @@ static bool vulkan_frame(void *data, const void *frame,
                   frame_width, frame_height,
                   chain->texture_optimal.format,
                   NULL, NULL, VULKAN_TEXTURE_DYNAMIC);
+
+         chain->dirty_begin = 0;
+         chain->dirty_end   = UINT_MAX;
       }
 
-      if (frame != chain->texture.mapped)
+      /* Only the rows that changed since this texture was
+       * last written to need copying. */
+      y    = chain->dirty_begin;
+      rows = MIN(chain->dirty_end, frame_height);
+      chain->dirty_begin = UINT_MAX;
+      chain->dirty_end   = 0;
+
+      if (frame != chain->texture.mapped && y < rows)
       {
-         dst = (uint8_t*)chain->texture.mapped;
+         rows -= y;
+         dst   = (uint8_t*)chain->texture.mapped + y * chain->texture.stride;
+         src  += y * pitch;
          if (     (chain->texture.stride == pitch )
                && pitch == frame_width * bpp)
-            memcpy(dst, src, frame_width * frame_height * bpp);
+            memcpy(dst, src, frame_width * rows * bpp);
          else
-            for (y = 0; y < frame_height; y++,
+            for (; rows; rows--,
                   dst += chain->texture.stride, src += pitch)
                memcpy(dst, src, frame_width * bpp);
       }
@@ -2381,6 +2424,9 @@ static bool vulkan_get_current_sw_framebuffer(void *data,
                chain->texture_optimal.format,
                NULL, NULL, VULKAN_TEXTURE_DYNAMIC);
       }
+
+      chain->dirty_begin = 0;
+      chain->dirty_end   = UINT_MAX;
    }
 
    framebuffer->data         = chain->texture.mapped;
@@ -2585,6 +2631,7 @@ static uint32_t vulkan_get_flags(void *data)
    BIT32_SET(flags, GFX_CTX_FLAGS_BLACK_FRAME_INSERTION);
    BIT32_SET(flags, GFX_CTX_FLAGS_MENU_FRAME_FILTERING);
    BIT32_SET(flags, GFX_CTX_FLAGS_SCREENSHOTS_SUPPORTED);
+   BIT32_SET(flags, GFX_CTX_FLAGS_PARTIAL_UPLOAD);
 
    return flags;
 }
@@ -60,47 +60,260 @@ struct rarch_softfilter
    unsigned threads;
 
 #ifdef HAVE_THREADS
-   struct filter_thread_data *thread_data;
+   struct softfilter_pool *pool;
 #endif
 };
 
 #ifdef HAVE_THREADS
 #include <rthreads/rthreads.h>
 
-struct filter_thread_data
+/* Packets per thread the filter is asked to cut a frame
+ * into. Threads take them off a shared counter, so one that
+ * runs ahead (cheap rows, a big core) takes over the rest
+ * instead of idling on the slowest slice. */
+#define SOFTFILTER_TILES_PER_THREAD 8
+
+/* Rows below which a tile isn't worth taking. */
+#define SOFTFILTER_TILE_MIN_ROWS    4
+
+/* Times the barriers poll before going to sleep. A frame's
+ * packets are done within microseconds of each other, the
+ * next frame is milliseconds away. */
+#define SOFTFILTER_SPIN_COUNT       2048
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SOFTFILTER_LOAD(pool, ptr)        __atomic_load_n((ptr), __ATOMIC_SEQ_CST)
+#define SOFTFILTER_STORE(pool, ptr, val)  __atomic_store_n((ptr), (val), __ATOMIC_SEQ_CST)
+#define SOFTFILTER_ADD(pool, ptr, val)    __atomic_add_fetch((ptr), (val), __ATOMIC_SEQ_CST)
+#else
+#define SOFTFILTER_LOAD(pool, ptr)        softfilter_atomic_add((pool), (ptr), 0)
+#define SOFTFILTER_STORE(pool, ptr, val)  softfilter_atomic_store((pool), (ptr), (val))
+#define SOFTFILTER_ADD(pool, ptr, val)    softfilter_atomic_add((pool), (ptr), (val))
+#endif
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define SOFTFILTER_RELAX() __builtin_ia32_pause()
+#elif defined(__GNUC__) && (defined(__aarch64__) || defined(__arm__))
+#define SOFTFILTER_RELAX() __asm__ __volatile__("yield")
+#else
+#define SOFTFILTER_RELAX()
+#endif
+
+/* Persistent workers shared by all packets of a filter. The
+ * thread calling rarch_softfilter_process() works along. */
+struct softfilter_pool
 {
-   sthread_t *thread;
-   const struct softfilter_work_packet *packet;
-   scond_t *cond;
-   slock_t *lock;
+   struct softfilter_work_packet *packets;
    void *userdata;
+   sthread_t **threads;
+   slock_t *lock;
+#if !defined(__GNUC__) && !defined(__clang__)
+   slock_t *atomic_lock;
+#endif
+   scond_t *cond_work;
+   scond_t *cond_done;
+   unsigned num_threads;
+   unsigned num_packets;
+   /* Shared between threads, see SOFTFILTER_LOAD(). */
+   unsigned next;       /* packet to take next */
+   unsigned pending;    /* packets not done yet */
+   unsigned generation; /* bumped for every frame */
+   unsigned parked;     /* threads asleep on a condition */
    bool die;
-   bool done;
 };
 
-static void filter_thread_loop(void *data)
+#if !defined(__GNUC__) && !defined(__clang__)
+static unsigned softfilter_atomic_add(struct softfilter_pool *pool,
+      unsigned *ptr, unsigned val)
+{
+   unsigned ret;
+   slock_lock(pool->atomic_lock);
+   ret = *ptr += val;
+   slock_unlock(pool->atomic_lock);
+   return ret;
+}
+
+static void softfilter_atomic_store(struct softfilter_pool *pool,
+      unsigned *ptr, unsigned val)
+{
+   slock_lock(pool->atomic_lock);
+   *ptr = val;
+   slock_unlock(pool->atomic_lock);
+}
+#endif
+
+/* Wakes whoever went to sleep on @cond, after a change
+ * to what they wait for. */
+static void softfilter_pool_wake(struct softfilter_pool *pool,
+      scond_t *cond)
+{
+   if (!SOFTFILTER_LOAD(pool, &pool->parked))
+      return;
+
+   slock_lock(pool->lock);
+   scond_broadcast(cond);
+   slock_unlock(pool->lock);
+}
+
+/* Takes packets until there are none left. */
+static void softfilter_pool_run(struct softfilter_pool *pool)
+{
+   for (;;)
+   {
+      unsigned i = SOFTFILTER_ADD(pool, &pool->next, 1) - 1;
+
+      if (i >= pool->num_packets)
+         break;
+
+      if (pool->packets[i].work)
+         pool->packets[i].work(pool->userdata,
+               pool->packets[i].thread_data);
+
+      if (!SOFTFILTER_ADD(pool, &pool->pending, (unsigned)-1))
+         softfilter_pool_wake(pool, pool->cond_done);
+   }
+}
+
+static void softfilter_pool_loop(void *data)
 {
-   struct filter_thread_data *thr = (struct filter_thread_data*)data;
+   struct softfilter_pool *pool = (struct softfilter_pool*)data;
+   unsigned seen                = 0;
 
    for (;;)
    {
-      bool die;
-      slock_lock(thr->lock);
-      while (thr->done && !thr->die)
-         scond_wait(thr->cond, thr->lock);
-      die = thr->die;
-      slock_unlock(thr->lock);
-
-      if (die)
+      unsigned spin       = SOFTFILTER_SPIN_COUNT;
+      unsigned generation = SOFTFILTER_LOAD(pool, &pool->generation);
+
+      while (generation == seen && spin--)
+      {
+         SOFTFILTER_RELAX();
+         generation       = SOFTFILTER_LOAD(pool, &pool->generation);
+      }
+
+      if (generation == seen)
+      {
+         /* Nothing came up, park until the next frame. */
+         slock_lock(pool->lock);
+         SOFTFILTER_ADD(pool, &pool->parked, 1);
+         while (     !pool->die
+               && (generation = SOFTFILTER_LOAD(pool, &pool->generation))
+               == seen)
+            scond_wait(pool->cond_work, pool->lock);
+         SOFTFILTER_ADD(pool, &pool->parked, (unsigned)-1);
+         slock_unlock(pool->lock);
+      }
+
+      if (pool->die)
          break;
 
-      if (thr->packet && thr->packet->work)
-         thr->packet->work(thr->userdata, thr->packet->thread_data);
+      seen = generation;
+      softfilter_pool_run(pool);
+   }
+}
+
+static void softfilter_pool_free(struct softfilter_pool *pool)
+{
+   unsigned i;
+
+   if (!pool)
+      return;
+
+   if (pool->threads)
+   {
+      slock_lock(pool->lock);
+      pool->die = true;
+      scond_broadcast(pool->cond_work);
+      slock_unlock(pool->lock);
+
+      for (i = 0; i < pool->num_threads; i++)
+         if (pool->threads[i])
+            sthread_join(pool->threads[i]);
+      free(pool->threads);
+   }
+
+   if (pool->cond_work)
+      scond_free(pool->cond_work);
+   if (pool->cond_done)
+      scond_free(pool->cond_done);
+   if (pool->lock)
+      slock_free(pool->lock);
+#if !defined(__GNUC__) && !defined(__clang__)
+   if (pool->atomic_lock)
+      slock_free(pool->atomic_lock);
+#endif
+   free(pool);
+}
+
+static struct softfilter_pool *softfilter_pool_new(
+      struct softfilter_work_packet *packets, unsigned num_packets,
+      void *userdata, unsigned num_threads)
+{
+   unsigned i;
+   struct softfilter_pool *pool = (struct softfilter_pool*)
+      calloc(1, sizeof(*pool));
+
+   if (!pool)
+      return NULL;
+
+   pool->packets     = packets;
+   pool->num_packets = num_packets;
+   pool->userdata    = userdata;
+   /* Nothing to take until the first frame. */
+   pool->next        = num_packets;
 
-      slock_lock(thr->lock);
-      thr->done = true;
-      scond_signal(thr->cond);
-      slock_unlock(thr->lock);
+   if (!(pool->lock      = slock_new()))
+      goto error;
+#if !defined(__GNUC__) && !defined(__clang__)
+   if (!(pool->atomic_lock = slock_new()))
+      goto error;
+#endif
+   if (!(pool->cond_work = scond_new()))
+      goto error;
+   if (!(pool->cond_done = scond_new()))
+      goto error;
+
+   pool->threads     = (sthread_t**)calloc(num_threads, sizeof(*pool->threads));
+   if (!pool->threads)
+      goto error;
+
+   for (i = 0; i < num_threads; i++)
+   {
+      if (!(pool->threads[i] = sthread_create(softfilter_pool_loop, pool)))
+         goto error;
+      pool->num_threads++;
+   }
+
+   return pool;
+
+error:
+   softfilter_pool_free(pool);
+   return NULL;
+}
+
+/* Runs one frame's packets on the pool and the calling
+ * thread, and returns once all of them are done. */
+static void softfilter_pool_process(struct softfilter_pool *pool)
+{
+   unsigned spin = SOFTFILTER_SPIN_COUNT;
+
+   SOFTFILTER_STORE(pool, &pool->pending, pool->num_packets);
+   SOFTFILTER_STORE(pool, &pool->next, 0);
+   SOFTFILTER_ADD(pool, &pool->generation, 1);
+   softfilter_pool_wake(pool, pool->cond_work);
+
+   softfilter_pool_run(pool);
+
+   while (SOFTFILTER_LOAD(pool, &pool->pending) && spin--)
+      SOFTFILTER_RELAX();
+
+   if (SOFTFILTER_LOAD(pool, &pool->pending))
+   {
+      slock_lock(pool->lock);
+      SOFTFILTER_ADD(pool, &pool->parked, 1);
+      while (SOFTFILTER_LOAD(pool, &pool->pending))
+         scond_wait(pool->cond_done, pool->lock);
+      SOFTFILTER_ADD(pool, &pool->parked, (unsigned)-1);
+      slock_unlock(pool->lock);
    }
 }
 #endif
@@ -135,12 +348,10 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
       softfilter_simd_mask_t cpu_features,
       unsigned threads)
 {
-   unsigned input_fmts, input_fmt, output_fmts, i = 0;
+   unsigned input_fmts, input_fmt, output_fmts, workers;
    struct config_file_userdata userdata;
    char key[64], name[64];
 
-   (void)i;
-
    key[0] = name[0] = '\0';
 
    snprintf(key, sizeof(key), "filter");
@@ -208,11 +419,28 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
    filt->max_width = max_width;
    filt->max_height = max_height;
 
+   if (threads == RARCH_SOFTFILTER_THREADS_AUTO)
+      threads = cpu_features_get_core_amount();
+   if (!threads)
+      threads = 1;
+   workers = threads;
+
+#ifdef HAVE_THREADS
+   /* Let filters that can split a frame cut it into
+    * several packets per thread. */
+   if (workers > 1)
+   {
+      unsigned max_tiles = max_height / SOFTFILTER_TILE_MIN_ROWS;
+
+      threads = workers * SOFTFILTER_TILES_PER_THREAD;
+      if (threads > max_tiles)
+         threads = MAX(max_tiles, workers);
+   }
+#endif
+
    filt->impl_data = filt->impl->create(
          &softfilter_config, input_fmt, input_fmt, max_width, max_height,
-         threads != RARCH_SOFTFILTER_THREADS_AUTO ? threads :
-         cpu_features_get_core_amount(), cpu_features,
-         &userdata);
+         threads, cpu_features, &userdata);
    if (!filt->impl_data)
    {
       RARCH_ERR("Failed to create softfilter state.\n");
@@ -227,7 +455,6 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
    }
 
    filt->threads = threads;
-   RARCH_LOG("Using %u threads for softfilter.\n", threads);
 
    filt->packets = (struct softfilter_work_packet*)
       calloc(threads, sizeof(*filt->packets));
@@ -238,31 +465,23 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
    }
 
 #ifdef HAVE_THREADS
-   if (filt->threads > 1)
+   if (workers > threads)
+      workers = threads;
+
+   if (workers > 1)
    {
-      filt->thread_data = (struct filter_thread_data*)
-         calloc(threads, sizeof(*filt->thread_data));
-      if (!filt->thread_data)
+      /* The thread calling process() is one of the workers. */
+      filt->pool = softfilter_pool_new(filt->packets, threads,
+            filt->impl_data, workers - 1);
+      if (!filt->pool)
          return false;
-
-      for (i = 0; i < threads; i++)
-      {
-         filt->thread_data[i].userdata = filt->impl_data;
-         filt->thread_data[i].done     = true;
-
-         filt->thread_data[i].lock     = slock_new();
-         if (!filt->thread_data[i].lock)
-            return false;
-         filt->thread_data[i].cond     = scond_new();
-         if (!filt->thread_data[i].cond)
-            return false;
-         filt->thread_data[i].thread   = sthread_create(
-               filter_thread_loop, &filt->thread_data[i]);
-         if (!filt->thread_data[i].thread)
-            return false;
-      }
    }
+   else
 #endif
+      workers = 1;
+
+   RARCH_LOG("Using %u threads for softfilter, %u packets per frame.\n",
+         workers, threads);
 
    return true;
 }
@@ -485,6 +704,10 @@ void rarch_softfilter_free(rarch_softfilter_t *filt)
    if (!filt)
       return;
 
+#ifdef HAVE_THREADS
+   softfilter_pool_free(filt->pool);
+#endif
+
    free(filt->packets);
    if (filt->impl && filt->impl_data)
       filt->impl->destroy(filt->impl_data);
@@ -498,26 +721,6 @@ void rarch_softfilter_free(rarch_softfilter_t *filt)
    free(filt->plugs);
 #endif
 
-#ifdef HAVE_THREADS
-   if (filt->threads > 1)
-   {
-      for (i = 0; i < filt->threads; i++)
-      {
-         if (!&filt->thread_data[i])
-            continue;
-         if (!filt->thread_data[i].thread)
-            continue;
-         slock_lock(filt->thread_data[i].lock);
-         filt->thread_data[i].die = true;
-         scond_signal(filt->thread_data[i].cond);
-         slock_unlock(filt->thread_data[i].lock);
-         sthread_join(filt->thread_data[i].thread);
-         slock_free(filt->thread_data[i].lock);
-         scond_free(filt->thread_data[i].cond);
-      }
-      free(filt->thread_data);
-   }
-#endif
 
    if (filt->conf)
       config_file_free(filt->conf);
@@ -562,32 +765,9 @@ void rarch_softfilter_process(rarch_softfilter_t *filt,
             output, output_stride, input, width, height, input_stride);
 
 #ifdef HAVE_THREADS
-   if (filt->threads > 1)
+   if (filt->pool)
    {
-      /* Fire off workers */
-      for (i = 0; i < filt->threads; i++)
-      {
-#if 0
-         RARCH_LOG("Firing off filter thread %u ...\n", i);
-#endif
-         filt->thread_data[i].packet = &filt->packets[i];
-         slock_lock(filt->thread_data[i].lock);
-         filt->thread_data[i].done = false;
-         scond_signal(filt->thread_data[i].cond);
-         slock_unlock(filt->thread_data[i].lock);
-      }
-
-      /* Wait for workers */
-      for (i = 0; i < filt->threads; i++)
-      {
-#if 0
-         RARCH_LOG("Waiting for filter thread %u ...\n", i);
-#endif
-         slock_lock(filt->thread_data[i].lock);
-         while (!filt->thread_data[i].done)
-            scond_wait(filt->thread_data[i].cond, filt->thread_data[i].lock);
-         slock_unlock(filt->thread_data[i].lock);
-      }
+      softfilter_pool_process(filt->pool);
       return;
    }
 #endif
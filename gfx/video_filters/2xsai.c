@@ -18,6 +18,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "softfilter_simd.h"
+
 #ifdef RARCH_INTERNAL
 #define softfilter_get_implementation twoxsai_get_implementation
 #define softfilter_thread_data twoxsai_softfilter_thread_data
@@ -44,6 +46,14 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   softfilter_simd_mask_t simd;
+   /* Scalar or vector renderers, see twoxsai_generic_packets() */
+   void (*rgb565)(unsigned width, unsigned height,
+         int first, int last, uint16_t *src,
+         unsigned src_stride, uint16_t *dst, unsigned dst_stride);
+   void (*xrgb8888)(unsigned width, unsigned height,
+         int first, int last, uint32_t *src,
+         unsigned src_stride, uint32_t *dst, unsigned dst_stride);
 };
 
 static unsigned twoxsai_generic_input_fmts(void)
@@ -69,7 +79,6 @@ static void *twoxsai_generic_create(const struct softfilter_config *config,
 {
    struct filter_data *filt = (struct filter_data*)calloc(1, sizeof(*filt));
 
-   (void)simd;
    (void)config;
    (void)userdata;
    if (!filt)
@@ -78,6 +87,7 @@ static void *twoxsai_generic_create(const struct softfilter_config *config,
       calloc(threads, sizeof(struct softfilter_thread_data));
    filt->threads = 1;
    filt->in_fmt  = in_fmt;
+   filt->simd    = simd;
    if (!filt->workers)
    {
       free(filt);
@@ -288,8 +298,149 @@ static void twoxsai_generic_rgb565(unsigned width, unsigned height,
    }
 }
 
+#define twoxsai_vector_result(V, A, B, C, D) \
+         V##_sub(V##_and(V##_eq(A, C), V##_eq(A, D)), \
+               V##_and(V##_eq(B, C), V##_eq(B, D)))
+
+/* twoxsai_function() for V##_lanes pixels at once: every case
+ * is worked out and the outcome selected per lane. */
+#define twoxsai_vector_function(V, hi, lo, hi2, lo2) \
+         { \
+         const V##_t colorI = V##_load(in - nextline - 1); \
+         const V##_t colorE = V##_load(in - nextline + 0); \
+         const V##_t colorF = V##_load(in - nextline + 1); \
+         const V##_t colorJ = V##_load(in - nextline + 2); \
+         const V##_t colorG = V##_load(in - 1); \
+         const V##_t colorA = V##_load(in + 0); \
+         const V##_t colorB = V##_load(in + 1); \
+         const V##_t colorK = V##_load(in + 2); \
+         const V##_t colorH = V##_load(in + nextline - 1); \
+         const V##_t colorC = V##_load(in + nextline + 0); \
+         const V##_t colorD = V##_load(in + nextline + 1); \
+         const V##_t colorL = V##_load(in + nextline + 2); \
+         const V##_t colorM = V##_load(in + nextline + nextline - 1); \
+         const V##_t colorN = V##_load(in + nextline + nextline + 0); \
+         const V##_t colorO = V##_load(in + nextline + nextline + 1); \
+         const V##_t eqAD   = V##_eq(colorA, colorD); \
+         const V##_t eqBC   = V##_eq(colorB, colorC); \
+         /* The four branches of twoxsai_function(); the last \
+          * one is whatever is left. */ \
+         const V##_t case1  = V##_andnot(eqAD, eqBC); \
+         const V##_t case2  = V##_andnot(eqBC, eqAD); \
+         const V##_t case3  = V##_and(eqAD, eqBC); \
+         const V##_t either = V##_or(eqAD, eqBC); \
+         const V##_t iAB    = softfilter_interpolate(V, colorA, colorB, hi, lo); \
+         const V##_t iAC    = softfilter_interpolate(V, colorA, colorC, hi, lo); \
+         const V##_t iABCD  = softfilter_interpolate2(V, colorA, colorB, colorC, colorD, hi2, lo2); \
+         /* A == C && A == F && B != E && B == J */ \
+         const V##_t keepA  = V##_and(V##_and(V##_eq(colorA, colorC), V##_eq(colorA, colorF)), \
+               V##_andnot(V##_eq(colorB, colorJ), V##_eq(colorB, colorE))); \
+         /* B == E && B == D && A != F && A == I */ \
+         const V##_t keepB  = V##_and(V##_and(V##_eq(colorB, colorE), V##_eq(colorB, colorD)), \
+               V##_andnot(V##_eq(colorA, colorI), V##_eq(colorA, colorF))); \
+         /* A == B && A == H && G != C && C == M */ \
+         const V##_t keepA1 = V##_and(V##_and(V##_eq(colorA, colorB), V##_eq(colorA, colorH)), \
+               V##_andnot(V##_eq(colorC, colorM), V##_eq(colorG, colorC))); \
+         /* C == G && C == D && A != H && A == I */ \
+         const V##_t keepC1 = V##_and(V##_and(V##_eq(colorC, colorG), V##_eq(colorC, colorD)), \
+               V##_andnot(V##_eq(colorA, colorI), V##_eq(colorA, colorH))); \
+         const V##_t r      = V##_add( \
+               V##_add(twoxsai_vector_result(V, colorA, colorB, colorG, colorE), \
+                  twoxsai_vector_result(V, colorB, colorA, colorK, colorF)), \
+               V##_add(twoxsai_vector_result(V, colorB, colorA, colorH, colorN), \
+                  twoxsai_vector_result(V, colorA, colorB, colorL, colorO))); \
+         const V##_t prodA  = V##_or(V##_and(case1, V##_or(keepA, \
+                     V##_and(V##_eq(colorA, colorE), V##_eq(colorB, colorL)))), \
+               V##_andnot(keepA, either)); \
+         const V##_t prodB  = V##_or(V##_and(case2, V##_or(keepB, \
+                     V##_and(V##_eq(colorB, colorF), V##_eq(colorA, colorH)))), \
+               V##_andnot(V##_andnot(keepB, keepA), either)); \
+         const V##_t prod1A = V##_or(V##_and(case1, V##_or(keepA1, \
+                     V##_and(V##_eq(colorA, colorG), V##_eq(colorC, colorO)))), \
+               V##_andnot(keepA1, either)); \
+         const V##_t prod1C = V##_or(V##_and(case2, V##_or(keepC1, \
+                     V##_and(V##_eq(colorC, colorH), V##_eq(colorA, colorF)))), \
+               V##_andnot(V##_andnot(keepC1, keepA1), either)); \
+         /* With A == B in the third case, r is 0 and iABCD is A */ \
+         const V##_t prod2A = V##_or(case1, V##_and(case3, V##_gtz(r))); \
+         const V##_t prod2B = V##_or(case2, V##_and(case3, V##_ltz(r))); \
+         V##_store2x(out, colorA, \
+               V##_sel(prodA, colorA, V##_sel(prodB, colorB, iAB))); \
+         V##_store2x(out + dst_stride, \
+               V##_sel(prod1A, colorA, V##_sel(prod1C, colorC, iAC)), \
+               V##_sel(prod2A, colorA, V##_sel(prod2B, colorB, iABCD))); \
+         in  += V##_lanes; \
+         out += V##_lanes * 2; \
+         }
+
+/* Body of a vector renderer, with the scalar code for the
+ * pixels left over at the end of each line. */
+#define twoxsai_vector_generic(V, typename_t, interpolate_cb, interpolate2_cb, hi_, lo_, hi2_, lo2_) \
+   unsigned finish; \
+   unsigned nextline = (last) ? 0 : src_stride; \
+   const V##_t hi    = V##_set1(hi_); \
+   const V##_t lo    = V##_set1(lo_); \
+   const V##_t hi2   = V##_set1(hi2_); \
+   const V##_t lo2   = V##_set1(lo2_); \
+   for (; height; height--) \
+   { \
+      typename_t *in  = (typename_t*)src; \
+      typename_t *out = (typename_t*)dst; \
+      for (finish = width; finish >= V##_lanes; finish -= V##_lanes) \
+         twoxsai_vector_function(V, hi, lo, hi2, lo2); \
+      for (; finish; finish -= 1) \
+      { \
+         twoxsai_declare_variables(typename_t, in, nextline); \
+         twoxsai_function(twoxsai_result, interpolate_cb, interpolate2_cb); \
+      } \
+      src += src_stride; \
+      dst += 2 * dst_stride; \
+   }
+
+#define twoxsai_vector_generic_xrgb8888(V) \
+   twoxsai_vector_generic(V, uint32_t, twoxsai_interpolate_xrgb8888, \
+         twoxsai_interpolate2_xrgb8888, \
+         0xFEFEFEFE, 0x01010101, 0xFCFCFCFC, 0x03030303)
+
+#define twoxsai_vector_generic_rgb565(V) \
+   twoxsai_vector_generic(V, uint16_t, twoxsai_interpolate_rgb565, \
+         twoxsai_interpolate2_rgb565, 0xF7DE, 0x0821, 0xE79C, 0x1863)
+
+#if defined(SOFTFILTER_SSE2)
+static void twoxsai_sse2_xrgb8888(unsigned width, unsigned height,
+      int first, int last, uint32_t *src,
+      unsigned src_stride, uint32_t *dst, unsigned dst_stride)
+{
+   twoxsai_vector_generic_xrgb8888(softfilter_sse2_u32);
+}
+
+static void twoxsai_sse2_rgb565(unsigned width, unsigned height,
+      int first, int last, uint16_t *src,
+      unsigned src_stride, uint16_t *dst, unsigned dst_stride)
+{
+   twoxsai_vector_generic_rgb565(softfilter_sse2_u16);
+}
+#endif
+
+#if defined(SOFTFILTER_AVX2)
+static SOFTFILTER_AVX2_TARGET void twoxsai_avx2_xrgb8888(unsigned width,
+      unsigned height, int first, int last, uint32_t *src,
+      unsigned src_stride, uint32_t *dst, unsigned dst_stride)
+{
+   twoxsai_vector_generic_xrgb8888(softfilter_avx2_u32);
+}
+
+static SOFTFILTER_AVX2_TARGET void twoxsai_avx2_rgb565(unsigned width,
+      unsigned height, int first, int last, uint16_t *src,
+      unsigned src_stride, uint16_t *dst, unsigned dst_stride)
+{
+   twoxsai_vector_generic_rgb565(softfilter_avx2_u16);
+}
+#endif
+
 static void twoxsai_work_cb_rgb565(void *data, void *thread_data)
 {
+   struct filter_data *filt = (struct filter_data*)data;
    struct softfilter_thread_data *thr =
       (struct softfilter_thread_data*)thread_data;
    uint16_t *input = (uint16_t*)thr->in_data;
@@ -297,7 +448,7 @@ static void twoxsai_work_cb_rgb565(void *data, void *thread_data)
    unsigned width = thr->width;
    unsigned height = thr->height;
 
-   twoxsai_generic_rgb565(width, height,
+   filt->rgb565(width, height,
          thr->first, thr->last, input,
          (unsigned)(thr->in_pitch / SOFTFILTER_BPP_RGB565),
          output,
@@ -306,6 +457,7 @@ static void twoxsai_work_cb_rgb565(void *data, void *thread_data)
 
 static void twoxsai_work_cb_xrgb8888(void *data, void *thread_data)
 {
+   struct filter_data *filt = (struct filter_data*)data;
    struct softfilter_thread_data *thr =
       (struct softfilter_thread_data*)thread_data;
    uint32_t *input = (uint32_t*)thr->in_data;
@@ -313,7 +465,7 @@ static void twoxsai_work_cb_xrgb8888(void *data, void *thread_data)
    unsigned width = thr->width;
    unsigned height = thr->height;
 
-   twoxsai_generic_xrgb8888(width, height,
+   filt->xrgb8888(width, height,
          thr->first, thr->last, input,
          (unsigned)(thr->in_pitch / SOFTFILTER_BPP_XRGB8888),
          output,
@@ -329,6 +481,23 @@ static void twoxsai_generic_packets(void *data,
    unsigned i;
    struct filter_data *filt = (struct filter_data*)data;
 
+   filt->rgb565   = twoxsai_generic_rgb565;
+   filt->xrgb8888 = twoxsai_generic_xrgb8888;
+#if defined(SOFTFILTER_SSE2)
+   if (filt->simd & SOFTFILTER_SIMD_SSE2)
+   {
+      filt->rgb565   = twoxsai_sse2_rgb565;
+      filt->xrgb8888 = twoxsai_sse2_xrgb8888;
+   }
+#endif
+#if defined(SOFTFILTER_AVX2)
+   if (filt->simd & SOFTFILTER_SIMD_AVX2)
+   {
+      filt->rgb565   = twoxsai_avx2_rgb565;
+      filt->xrgb8888 = twoxsai_avx2_xrgb8888;
+   }
+#endif
+
    for (i = 0; i < filt->threads; i++)
    {
       struct softfilter_thread_data *thr =
@@ -0,0 +1,347 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2018 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Times the softfilter plugs with each SIMD path this CPU
+ * supports and checks the vector output against the scalar one.
+ *
+ * Usage: softfilter_bench [-w width] [-h height] [-f frames] filter.so... */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <dlfcn.h>
+
+#include "../softfilter.h"
+
+struct bench_simd
+{
+   const char *ident;
+   softfilter_simd_mask_t mask;
+};
+
+static int bench_get_float(void *userdata, const char *key,
+      float *value, float default_value)
+{
+   *value = default_value;
+   return 0;
+}
+
+static int bench_get_int(void *userdata, const char *key,
+      int *value, int default_value)
+{
+   *value = default_value;
+   return 0;
+}
+
+static int bench_get_hex(void *userdata, const char *key,
+      unsigned *value, unsigned default_value)
+{
+   *value = default_value;
+   return 0;
+}
+
+static int bench_get_float_array(void *userdata, const char *key,
+      float **values, unsigned *out_num_values,
+      const float *default_values, unsigned num_default_values)
+{
+   *values         = (float*)malloc(num_default_values * sizeof(float));
+   *out_num_values = num_default_values;
+   if (*values)
+      memcpy(*values, default_values, num_default_values * sizeof(float));
+   return 0;
+}
+
+static int bench_get_int_array(void *userdata, const char *key,
+      int **values, unsigned *out_num_values,
+      const int *default_values, unsigned num_default_values)
+{
+   *values         = (int*)malloc(num_default_values * sizeof(int));
+   *out_num_values = num_default_values;
+   if (*values)
+      memcpy(*values, default_values, num_default_values * sizeof(int));
+   return 0;
+}
+
+static int bench_get_string(void *userdata, const char *key,
+      char **output, const char *default_output)
+{
+   *output = strdup(default_output);
+   return 0;
+}
+
+static const struct softfilter_config bench_config = {
+   bench_get_float,
+   bench_get_int,
+   bench_get_hex,
+   bench_get_float_array,
+   bench_get_int_array,
+   bench_get_string,
+   free,
+};
+
+static double bench_time_ms(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+/* Game-like input: mostly runs of a few colours, so the
+ * edge-detecting filters take all of their branches. */
+static void bench_fill(void *data, unsigned fmt,
+      unsigned width, unsigned height)
+{
+   static const uint32_t palette[] = {
+      0x000000, 0xFFFFFF, 0xF83800, 0x3CBCFC,
+      0x00A800, 0xFCA044, 0x7C7C7C, 0x6844FC,
+   };
+   uint32_t seed = 0x12345678;
+   unsigned i;
+   uint32_t color = 0;
+
+   for (i = 0; i < width * height; i++)
+   {
+      seed ^= seed << 13;
+      seed ^= seed >> 17;
+      seed ^= seed << 5;
+
+      /* New colour for a quarter of the pixels, and now
+       * and then one off the palette */
+      if ((seed & 3) == 0)
+         color = (seed & 0x700) ? palette[(seed >> 4) & 7] : (seed >> 8);
+
+      if (fmt == SOFTFILTER_FMT_RGB565)
+         ((uint16_t*)data)[i] = (uint16_t)(
+                 ((color >> 8) & 0xF800)
+               | ((color >> 5) & 0x07E0)
+               | ((color >> 3) & 0x001F));
+      else
+         ((uint32_t*)data)[i] = color & 0xFFFFFF;
+   }
+}
+
+static unsigned bench_bpp(unsigned fmt)
+{
+   return (fmt == SOFTFILTER_FMT_RGB565)
+      ? SOFTFILTER_BPP_RGB565 : SOFTFILTER_BPP_XRGB8888;
+}
+
+/* Runs one filter in one format with one SIMD mask.
+ * Returns the average time per frame in ms, or -1. */
+static double bench_run(softfilter_get_implementation_t get_impl,
+      softfilter_simd_mask_t mask, unsigned in_fmt, unsigned out_fmt,
+      const void *input, unsigned width, unsigned height,
+      unsigned frames, void *output, size_t output_size)
+{
+   struct softfilter_work_packet packets[16];
+   unsigned out_width, out_height, threads, i, j;
+   size_t out_stride;
+   double start;
+   const struct softfilter_implementation *impl = get_impl(mask);
+   void *filt = NULL;
+
+   if (!impl)
+      return -1.0;
+
+   filt = impl->create(&bench_config, in_fmt, out_fmt,
+         width, height, 1, mask, NULL);
+   if (!filt)
+      return -1.0;
+
+   impl->query_output_size(filt, &out_width, &out_height, width, height);
+   out_stride = out_width * bench_bpp(out_fmt);
+   threads    = impl->query_num_threads(filt);
+
+   if (threads > 16 || out_stride * out_height > output_size)
+   {
+      impl->destroy(filt);
+      return -1.0;
+   }
+
+   /* One untimed frame to warm up caches and tables */
+   start = 0.0;
+   for (i = 0; i <= frames; i++)
+   {
+      if (i == 1)
+         start = bench_time_ms();
+
+      impl->get_work_packets(filt, packets, output, out_stride,
+            input, width, height, width * bench_bpp(in_fmt));
+      for (j = 0; j < threads; j++)
+         packets[j].work(filt, packets[j].thread_data);
+   }
+
+   start = (bench_time_ms() - start) / frames;
+   impl->destroy(filt);
+   return start;
+}
+
+static void bench_simd_list(struct bench_simd *list, unsigned *count)
+{
+   *count = 0;
+   list[(*count)++].ident = "scalar";
+   list[*count - 1].mask  = 0;
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("sse2"))
+   {
+      list[(*count)++].ident = "sse2";
+      list[*count - 1].mask  = SOFTFILTER_SIMD_SSE | SOFTFILTER_SIMD_SSE2;
+      if (__builtin_cpu_supports("avx2"))
+      {
+         list[(*count)++].ident = "avx2";
+         list[*count - 1].mask  = SOFTFILTER_SIMD_SSE | SOFTFILTER_SIMD_SSE2
+            | SOFTFILTER_SIMD_AVX | SOFTFILTER_SIMD_AVX2;
+      }
+   }
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+   list[(*count)++].ident = "neon";
+   list[*count - 1].mask  = SOFTFILTER_SIMD_NEON;
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+   struct bench_simd simd[4];
+   unsigned simd_count;
+   unsigned width   = 256;
+   unsigned height  = 224;
+   unsigned frames  = 200;
+   int failures     = 0;
+   int i;
+
+   bench_simd_list(simd, &simd_count);
+
+   for (i = 1; i < argc && argv[i][0] == '-'; i += 2)
+   {
+      if (i + 1 >= argc)
+         break;
+      if (!strcmp(argv[i], "-w"))
+         width  = (unsigned)strtoul(argv[i + 1], NULL, 0);
+      else if (!strcmp(argv[i], "-h"))
+         height = (unsigned)strtoul(argv[i + 1], NULL, 0);
+      else if (!strcmp(argv[i], "-f"))
+         frames = (unsigned)strtoul(argv[i + 1], NULL, 0);
+   }
+
+   if (i >= argc || !width || !height || !frames)
+   {
+      fprintf(stderr, "Usage: %s [-w width] [-h height] [-f frames] filter.so...\n",
+            argv[0]);
+      return 1;
+   }
+
+   for (; i < argc; i++)
+   {
+      unsigned fmts[2] = { SOFTFILTER_FMT_RGB565, SOFTFILTER_FMT_XRGB8888 };
+      const struct softfilter_implementation *impl = NULL;
+      softfilter_get_implementation_t get_impl     = NULL;
+      void *lib = dlopen(argv[i], RTLD_NOW | RTLD_LOCAL);
+      unsigned f;
+
+      if (!lib)
+      {
+         fprintf(stderr, "%s\n", dlerror());
+         failures++;
+         continue;
+      }
+
+      get_impl = (softfilter_get_implementation_t)
+         dlsym(lib, "softfilter_get_implementation");
+      if (!get_impl || !(impl = get_impl(0))
+            || impl->api_version != SOFTFILTER_API_VERSION)
+      {
+         fprintf(stderr, "%s: not a softfilter plug\n", argv[i]);
+         dlclose(lib);
+         failures++;
+         continue;
+      }
+
+      for (f = 0; f < 2; f++)
+      {
+         unsigned in_fmt = fmts[f];
+         unsigned out_fmt, outputs;
+         /* No filter scales past 8x in either direction */
+         size_t output_size = (size_t)width * height * 64 * 4;
+         void *input        = NULL;
+         void *reference    = NULL;
+         void *output       = NULL;
+         double scalar_ms   = 0.0;
+         unsigned s;
+
+         if (!(impl->query_input_formats() & in_fmt))
+            continue;
+
+         outputs = impl->query_output_formats(in_fmt);
+         out_fmt = (outputs & in_fmt) ? in_fmt : (outputs & -outputs);
+
+         input     = malloc(width * height * bench_bpp(in_fmt));
+         reference = calloc(1, output_size);
+         output    = calloc(1, output_size);
+         if (!input || !reference || !output)
+         {
+            free(input);
+            free(reference);
+            free(output);
+            failures++;
+            continue;
+         }
+
+         bench_fill(input, in_fmt, width, height);
+
+         for (s = 0; s < simd_count; s++)
+         {
+            void *dst = s ? output : reference;
+            double ms = bench_run(get_impl, simd[s].mask,
+                  in_fmt, out_fmt, input, width, height,
+                  frames, dst, output_size);
+            int match = !s || !memcmp(reference, output, output_size);
+
+            if (ms < 0.0)
+            {
+               printf("%-24s %-8s %-6s failed to run\n", impl->short_ident,
+                     in_fmt == SOFTFILTER_FMT_RGB565 ? "rgb565" : "xrgb8888",
+                     simd[s].ident);
+               failures++;
+               continue;
+            }
+
+            if (!s)
+               scalar_ms = ms;
+
+            printf("%-24s %-8s %-6s %8.3f ms/frame %6.2fx%s\n",
+                  impl->short_ident,
+                  in_fmt == SOFTFILTER_FMT_RGB565 ? "rgb565" : "xrgb8888",
+                  simd[s].ident, ms, scalar_ms / ms,
+                  match ? "" : "  MISMATCH");
+
+            if (!match)
+               failures++;
+         }
+
+         free(input);
+         free(reference);
+         free(output);
+      }
+
+      dlclose(lib);
+   }
+
+   return failures ? 1 : 0;
+}
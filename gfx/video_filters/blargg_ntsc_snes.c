@@ -15,6 +15,7 @@
  */
 
 #include "softfilter.h"
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -25,6 +26,8 @@
 #include "snes_ntsc/snes_ntsc.h"
 #include "snes_ntsc/snes_ntsc.c"
 
+#include "softfilter_simd.h"
+
 #ifdef RARCH_INTERNAL
 #define softfilter_get_implementation blargg_ntsc_snes_get_implementation
 #define softfilter_thread_data blargg_ntsc_snes_softfilter_thread_data
@@ -42,8 +45,14 @@ struct softfilter_thread_data
    unsigned height;
    int first;
    int last;
+   int burst;
 };
 
+typedef void (*blargg_ntsc_snes_blit_t)(snes_ntsc_t const* ntsc,
+      SNES_NTSC_IN_T const* input, long in_row_width, int burst_phase,
+      int in_width, int in_height, void* rgb_out, long out_pitch,
+      int first, int last);
+
 struct filter_data
 {
    unsigned threads;
@@ -52,6 +61,9 @@ struct filter_data
    struct snes_ntsc_t *ntsc;
    int burst;
    int burst_toggle;
+   softfilter_simd_mask_t simd;
+   /* Low-res blitter, see blargg_ntsc_snes_generic_packets() */
+   blargg_ntsc_snes_blit_t blit;
 };
 
 static unsigned blargg_ntsc_snes_generic_input_fmts(void)
@@ -155,13 +167,13 @@ static void *blargg_ntsc_snes_generic_create(const struct softfilter_config *con
       unsigned threads, softfilter_simd_mask_t simd, void *userdata)
 {
    struct filter_data *filt = (struct filter_data*)calloc(1, sizeof(*filt));
-   (void)simd;
    if (!filt)
       return NULL;
    filt->workers = (struct softfilter_thread_data*)
       calloc(threads, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
+   filt->simd    = simd;
    if (!filt->workers)
    {
       free(filt);
@@ -195,27 +207,190 @@ static void blargg_ntsc_snes_generic_destroy(void *data)
    free(filt);
 }
 
+/* Vector version of retroarch_snes_ntsc_blit(). Each output
+ * pixel sums six kernel entries, and neighbouring pixels read
+ * neighbouring entries, so whole lanes of pixels can be summed,
+ * clamped and packed at once. Only the low 32 bits of an entry
+ * reach the output, so the lanes are as wide as
+ * snes_ntsc_rgb_t and the table is read as it is. */
+#if ULONG_MAX > 0xFFFFFFFFUL
+#if defined(SOFTFILTER_SSE2)
+#define BLARGG_NTSC_SNES_SSE2 blargg_ntsc_snes_vector_blit(softfilter_sse2_u64, \
+      blargg_ntsc_snes_vector_chunk2)
+#endif
+#if defined(SOFTFILTER_AVX2)
+#define BLARGG_NTSC_SNES_AVX2 blargg_ntsc_snes_vector_blit(softfilter_avx2_u64, \
+      blargg_ntsc_snes_vector_chunk4)
+#endif
+#else
+#if defined(SOFTFILTER_SSE2)
+#define BLARGG_NTSC_SNES_SSE2 blargg_ntsc_snes_vector_blit(softfilter_sse2_u32, \
+      blargg_ntsc_snes_vector_chunk4)
+#endif
+/* No eight-wide chunk, so AVX2 CPUs keep the SSE2 blit here */
+#endif
+
+/* SNES_NTSC_CLAMP_() and SNES_NTSC_RGB_OUT_() for 16 bits */
+#define blargg_ntsc_snes_vector_rgb(V, rgb, t0, t1, t2, t3, t4, t5) \
+   { \
+      V##_t raw_   = V##_add(V##_add(V##_add(t0, t1), V##_add(t2, t3)), \
+            V##_add(t4, t5)); \
+      V##_t sub_   = V##_and(V##_srl(raw_, 8), clamp_mask); \
+      V##_t clamp_ = V##_sub(clamp_add, sub_); \
+      raw_         = V##_or(raw_, clamp_); \
+      clamp_       = V##_sub(clamp_, sub_); \
+      raw_         = V##_and(raw_, clamp_); \
+      rgb          = V##_or(V##_or( \
+               V##_and(V##_srl(raw_, 12), mask_r), \
+               V##_and(V##_srl(raw_,  7), mask_g)), \
+            V##_and(V##_srl(raw_, 3), mask_b)); \
+   }
+
+/* One chunk, 3 input pixels to 7 output pixels, two at a time.
+ * k0-k2 are the current kernels, kx1 and kx2 the ones before
+ * k1 and k2, n0-n2 the kernels of the new input pixels. The
+ * eighth lane reads valid entries and is thrown away. */
+#define blargg_ntsc_snes_vector_chunk2(V) \
+   { \
+      V##_t rgb; \
+      blargg_ntsc_snes_vector_rgb(V, rgb, \
+            V##_load(n0 + 0),  V##_load(k1 + 19), V##_load(k2 + 31), \
+            V##_load(k0 + 7),  V##_load(kx1 + 26), V##_load(kx2 + 38)); \
+      line_out[0] = V##_lo16(rgb, 0); \
+      line_out[1] = V##_lo16(rgb, 1); \
+      blargg_ntsc_snes_vector_rgb(V, rgb, \
+            V##_load(n0 + 2),  V##_load(n1 + 14), V##_load(k2 + 33), \
+            V##_load(k0 + 9),  V##_load(k1 + 21), V##_load(kx2 + 40)); \
+      line_out[2] = V##_lo16(rgb, 0); \
+      line_out[3] = V##_lo16(rgb, 1); \
+      blargg_ntsc_snes_vector_rgb(V, rgb, \
+            V##_load(n0 + 4),  V##_load(n1 + 16), V##_load(n2 + 28), \
+            V##_load(k0 + 11), V##_load(k1 + 23), V##_load(k2 + 35)); \
+      line_out[4] = V##_lo16(rgb, 0); \
+      line_out[5] = V##_lo16(rgb, 1); \
+      blargg_ntsc_snes_vector_rgb(V, rgb, \
+            V##_load(n0 + 6),  V##_load(n1 + 18), V##_load(n2 + 30), \
+            V##_load(k0 + 13), V##_load(k1 + 25), V##_load(k2 + 37)); \
+      line_out[6] = V##_lo16(rgb, 0); \
+   }
+
+/* Same, four at a time. Pixels 2 and 3 take two of their
+ * kernels from the new input pixel, hence the split loads. */
+#define blargg_ntsc_snes_vector_chunk4(V) \
+   { \
+      V##_t rgb; \
+      blargg_ntsc_snes_vector_rgb(V, rgb, \
+            V##_load(n0 + 0), V##_load2(k1 + 19, n1 + 14), V##_load(k2 + 31), \
+            V##_load(k0 + 7), V##_load2(kx1 + 26, k1 + 21), V##_load(kx2 + 38)); \
+      line_out[0] = V##_lo16(rgb, 0); \
+      line_out[1] = V##_lo16(rgb, 1); \
+      line_out[2] = V##_lo16(rgb, 2); \
+      line_out[3] = V##_lo16(rgb, 3); \
+      blargg_ntsc_snes_vector_rgb(V, rgb, \
+            V##_load(n0 + 4),  V##_load(n1 + 16), V##_load(n2 + 28), \
+            V##_load(k0 + 11), V##_load(k1 + 23), V##_load(k2 + 35)); \
+      line_out[4] = V##_lo16(rgb, 0); \
+      line_out[5] = V##_lo16(rgb, 1); \
+      line_out[6] = V##_lo16(rgb, 2); \
+   }
+
+#define blargg_ntsc_snes_vector_step(chunk_cb, V, color0, color1, color2) \
+   { \
+      unsigned const pixel0_ = (color0); \
+      unsigned const pixel1_ = (color1); \
+      unsigned const pixel2_ = (color2); \
+      snes_ntsc_rgb_t const* n0 = SNES_NTSC_IN_FORMAT( ktable, pixel0_ ); \
+      snes_ntsc_rgb_t const* n1 = SNES_NTSC_IN_FORMAT( ktable, pixel1_ ); \
+      snes_ntsc_rgb_t const* n2 = SNES_NTSC_IN_FORMAT( ktable, pixel2_ ); \
+      chunk_cb(V); \
+      kx1 = k1; \
+      kx2 = k2; \
+      k0  = n0; \
+      k1  = n1; \
+      k2  = n2; \
+   }
+
+#define blargg_ntsc_snes_vector_blit(V, chunk_cb) \
+   int chunk_count            = (in_width - 1) / snes_ntsc_in_chunk; \
+   const V##_t clamp_mask     = V##_set1(snes_ntsc_clamp_mask); \
+   const V##_t clamp_add      = V##_set1(snes_ntsc_clamp_add); \
+   const V##_t mask_r         = V##_set1(0xF800); \
+   const V##_t mask_g         = V##_set1(0x07E0); \
+   const V##_t mask_b         = V##_set1(0x001F); \
+   (void)first; \
+   (void)last; \
+   for (; in_height; --in_height) \
+   { \
+      SNES_NTSC_IN_T const* line_in = input; \
+      snes_ntsc_out_t* line_out     = (snes_ntsc_out_t*)rgb_out; \
+      char const* ktable            = (char const*)ntsc->table + \
+         burst_phase * (snes_ntsc_burst_size * sizeof(snes_ntsc_rgb_t)); \
+      unsigned const black_         = snes_ntsc_black; \
+      unsigned const pixel_         = SNES_NTSC_ADJ_IN(*line_in); \
+      snes_ntsc_rgb_t const* k0     = SNES_NTSC_IN_FORMAT( ktable, black_ ); \
+      snes_ntsc_rgb_t const* k1     = k0; \
+      snes_ntsc_rgb_t const* k2     = SNES_NTSC_IN_FORMAT( ktable, pixel_ ); \
+      snes_ntsc_rgb_t const* kx1    = k0; \
+      snes_ntsc_rgb_t const* kx2    = k0; \
+      int n; \
+      ++line_in; \
+      for (n = chunk_count; n; --n) \
+      { \
+         blargg_ntsc_snes_vector_step(chunk_cb, V, \
+               SNES_NTSC_ADJ_IN(line_in[0]), \
+               SNES_NTSC_ADJ_IN(line_in[1]), \
+               SNES_NTSC_ADJ_IN(line_in[2])); \
+         line_in  += 3; \
+         line_out += 7; \
+      } \
+      /* finish final pixels */ \
+      blargg_ntsc_snes_vector_step(chunk_cb, V, \
+            snes_ntsc_black, snes_ntsc_black, snes_ntsc_black); \
+      burst_phase = (burst_phase + 1) % snes_ntsc_burst_count; \
+      input      += in_row_width; \
+      rgb_out     = (char*)rgb_out + out_pitch; \
+   }
+
+#if defined(BLARGG_NTSC_SNES_SSE2)
+static void blargg_ntsc_snes_blit_sse2(snes_ntsc_t const* ntsc,
+      SNES_NTSC_IN_T const* input, long in_row_width, int burst_phase,
+      int in_width, int in_height, void* rgb_out, long out_pitch,
+      int first, int last)
+{
+   BLARGG_NTSC_SNES_SSE2;
+}
+#endif
+
+#if defined(BLARGG_NTSC_SNES_AVX2)
+static SOFTFILTER_AVX2_TARGET void blargg_ntsc_snes_blit_avx2(
+      snes_ntsc_t const* ntsc,
+      SNES_NTSC_IN_T const* input, long in_row_width, int burst_phase,
+      int in_width, int in_height, void* rgb_out, long out_pitch,
+      int first, int last)
+{
+   BLARGG_NTSC_SNES_AVX2;
+}
+#endif
+
 static void blargg_ntsc_snes_render_rgb565(void *data, int width, int height,
-      int first, int last,
+      int first, int last, int burst,
       uint16_t *input, int pitch, uint16_t *output, int outpitch)
 {
    struct filter_data *filt = (struct filter_data*)data;
    if(width <= 256 || !hires_blit)
-      retroarch_snes_ntsc_blit(filt->ntsc, input, pitch, filt->burst,
+      filt->blit(filt->ntsc, input, pitch, burst,
             width, height, output, outpitch * 2, first, last);
    else
-      retroarch_snes_ntsc_blit_hires(filt->ntsc, input, pitch, filt->burst,
+      retroarch_snes_ntsc_blit_hires(filt->ntsc, input, pitch, burst,
             width, height, output, outpitch * 2, first, last);
-
-   filt->burst ^= filt->burst_toggle;
 }
 
 static void blargg_ntsc_snes_rgb565(void *data, unsigned width, unsigned height,
-      int first, int last, uint16_t *src,
+      int first, int last, int burst, uint16_t *src,
       unsigned src_stride, uint16_t *dst, unsigned dst_stride)
 {
    blargg_ntsc_snes_render_rgb565(data, width, height,
-         first, last,
+         first, last, burst,
          src, src_stride,
          dst, dst_stride);
 
@@ -231,7 +406,7 @@ static void blargg_ntsc_snes_work_cb_rgb565(void *data, void *thread_data)
    unsigned height = thr->height;
 
    blargg_ntsc_snes_rgb565(data, width, height,
-         thr->first, thr->last, input,
+         thr->first, thr->last, thr->burst, input,
          (unsigned)(thr->in_pitch / SOFTFILTER_BPP_RGB565),
          output,
          (unsigned)(thr->out_pitch / SOFTFILTER_BPP_RGB565));
@@ -244,6 +419,17 @@ static void blargg_ntsc_snes_generic_packets(void *data,
 {
    struct filter_data *filt = (struct filter_data*)data;
    unsigned i;
+
+   filt->blit = retroarch_snes_ntsc_blit;
+#if defined(BLARGG_NTSC_SNES_SSE2)
+   if (filt->simd & SOFTFILTER_SIMD_SSE2)
+      filt->blit = blargg_ntsc_snes_blit_sse2;
+#endif
+#if defined(BLARGG_NTSC_SNES_AVX2)
+   if (filt->simd & SOFTFILTER_SIMD_AVX2)
+      filt->blit = blargg_ntsc_snes_blit_avx2;
+#endif
+
    for (i = 0; i < filt->threads; i++)
    {
       struct softfilter_thread_data *thr =
@@ -263,10 +449,16 @@ static void blargg_ntsc_snes_generic_packets(void *data,
       thr->first = y_start;
       thr->last = y_end == height;
 
+      /* The burst phase steps once per row, so a slice
+       * starts where the rows above it left off. */
+      thr->burst = (filt->burst + y_start) % snes_ntsc_burst_count;
+
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
          packets[i].work = blargg_ntsc_snes_work_cb_rgb565;
       packets[i].thread_data = thr;
    }
+
+   filt->burst ^= filt->burst_toggle;
 }
 
 static const struct softfilter_implementation blargg_ntsc_snes_generic = {
@@ -20,6 +20,8 @@
 
 #include <retro_endianness.h>
 
+#include "softfilter_simd.h"
+
 #ifdef RARCH_INTERNAL
 #define softfilter_get_implementation epx_get_implementation
 #define softfilter_thread_data epx_softfilter_thread_data
@@ -41,11 +43,21 @@ struct softfilter_thread_data
    int last;
 };
 
+/* Renders as many pixels of a line's interior as fit whole
+ * vectors and returns how many that was. 'up' and 'down' point
+ * at the same column in the lines above and below. */
+typedef unsigned (*epx_interior_t)(const uint16_t *src,
+      const uint16_t *up, const uint16_t *down,
+      uint16_t *out0, uint16_t *out1, unsigned count);
+
 struct filter_data
 {
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   softfilter_simd_mask_t simd;
+   /* NULL for the scalar path, see epx_generic_packets() */
+   epx_interior_t interior;
 };
 
 static unsigned epx_generic_input_fmts(void)
@@ -70,7 +82,6 @@ static void *epx_generic_create(const struct softfilter_config *config,
       unsigned threads, softfilter_simd_mask_t simd, void *userdata)
 {
    struct filter_data *filt = (struct filter_data*)calloc(1, sizeof(*filt));
-   (void)simd;
    (void)config;
    (void)userdata;
    if (!filt)
@@ -79,6 +90,7 @@ static void *epx_generic_create(const struct softfilter_config *config,
       calloc(threads, sizeof(struct softfilter_thread_data));
    filt->threads = 1;
    filt->in_fmt  = in_fmt;
+   filt->simd    = simd;
    if (!filt->workers)
    {
       free(filt);
@@ -106,9 +118,49 @@ static void epx_generic_destroy(void *data)
    free(filt);
 }
 
+/* The interior loop below for V##_lanes pixels at once. Output
+ * pixels come out in the same order for either endianness. */
+#define epx_vector_interior(V) \
+   unsigned done; \
+   for (done = 0; done + V##_lanes <= count; done += V##_lanes) \
+   { \
+      const V##_t colorA = V##_load(src + done - 1); \
+      const V##_t colorX = V##_load(src + done); \
+      const V##_t colorC = V##_load(src + done + 1); \
+      const V##_t colorB = V##_load(down + done); \
+      const V##_t colorD = V##_load(up + done); \
+      const V##_t flat   = V##_or(V##_eq(colorA, colorC), V##_eq(colorB, colorD)); \
+      V##_store2x(out0 + 2 * done, \
+            V##_sel(V##_andnot(V##_eq(colorD, colorA), flat), colorD, colorX), \
+            V##_sel(V##_andnot(V##_eq(colorC, colorD), flat), colorC, colorX)); \
+      V##_store2x(out1 + 2 * done, \
+            V##_sel(V##_andnot(V##_eq(colorA, colorB), flat), colorA, colorX), \
+            V##_sel(V##_andnot(V##_eq(colorB, colorC), flat), colorB, colorX)); \
+   } \
+   return done
+
+#if defined(SOFTFILTER_SSE2)
+static unsigned epx_sse2_interior(const uint16_t *src,
+      const uint16_t *up, const uint16_t *down,
+      uint16_t *out0, uint16_t *out1, unsigned count)
+{
+   epx_vector_interior(softfilter_sse2_u16);
+}
+#endif
+
+#if defined(SOFTFILTER_AVX2)
+static SOFTFILTER_AVX2_TARGET unsigned epx_avx2_interior(const uint16_t *src,
+      const uint16_t *up, const uint16_t *down,
+      uint16_t *out0, uint16_t *out1, unsigned count)
+{
+   epx_vector_interior(softfilter_avx2_u16);
+}
+#endif
+
 static void epx_generic_rgb565 (unsigned width, unsigned height,
       int first, int lsat, uint16_t *src,
-      unsigned src_stride, uint16_t *dst, unsigned dst_stride)
+      unsigned src_stride, uint16_t *dst, unsigned dst_stride,
+      epx_interior_t interior)
 {
    uint16_t colorX, colorA, colorB, colorC, colorD;
    uint16_t *sP, *uP, *lP;
@@ -146,7 +198,24 @@ static void epx_generic_rgb565 (unsigned width, unsigned height,
       dP1++;
       dP2++;
 
-      for (w = width - 2; w; w--)
+      w = width - 2;
+
+      if (interior && w > 0)
+      {
+         unsigned done = interior(sP, uP, lP,
+               (uint16_t*)dP1, (uint16_t*)dP2, w);
+
+         sP     += done;
+         uP     += done;
+         lP     += done;
+         dP1    += done;
+         dP2    += done;
+         w      -= done;
+         colorX  = *(sP - 1);
+         colorC  = *sP;
+      }
+
+      for (; w; w--)
       {
          colorA = colorX;
          colorX = colorC;
@@ -198,6 +267,7 @@ static void epx_generic_rgb565 (unsigned width, unsigned height,
 
 static void epx_work_cb_rgb565(void *data, void *thread_data)
 {
+   struct filter_data *filt = (struct filter_data*)data;
    struct softfilter_thread_data *thr =
       (struct softfilter_thread_data*)thread_data;
    uint16_t *input = (uint16_t*)thr->in_data;
@@ -209,7 +279,8 @@ static void epx_work_cb_rgb565(void *data, void *thread_data)
          thr->first, thr->last, input,
          (unsigned)(thr->in_pitch / SOFTFILTER_BPP_RGB565),
          output,
-         (unsigned)(thr->out_pitch / SOFTFILTER_BPP_RGB565));
+         (unsigned)(thr->out_pitch / SOFTFILTER_BPP_RGB565),
+         filt->interior);
 }
 
 static void epx_generic_packets(void *data,
@@ -220,6 +291,16 @@ static void epx_generic_packets(void *data,
    unsigned i;
    struct filter_data *filt = (struct filter_data*)data;
 
+   filt->interior = NULL;
+#if defined(SOFTFILTER_SSE2)
+   if (filt->simd & SOFTFILTER_SIMD_SSE2)
+      filt->interior = epx_sse2_interior;
+#endif
+#if defined(SOFTFILTER_AVX2)
+   if (filt->simd & SOFTFILTER_SIMD_AVX2)
+      filt->interior = epx_avx2_interior;
+#endif
+
    for (i = 0; i < filt->threads; i++)
    {
       struct softfilter_thread_data *thr =
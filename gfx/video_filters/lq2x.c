@@ -17,6 +17,8 @@
 #include "softfilter.h"
 #include <stdlib.h>
 
+#include "softfilter_simd.h"
+
 #ifdef RARCH_INTERNAL
 #define softfilter_get_implementation lq2x_get_implementation
 #define softfilter_thread_data lq2x_softfilter_thread_data
@@ -43,6 +45,14 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   softfilter_simd_mask_t simd;
+   /* Scalar or vector renderers, see lq2x_generic_packets() */
+   void (*rgb565)(unsigned width, unsigned height,
+         int first, int last, uint16_t *src,
+         unsigned src_stride, uint16_t *dst, unsigned dst_stride);
+   void (*xrgb8888)(unsigned width, unsigned height,
+         int first, int last, uint32_t *src,
+         unsigned src_stride, uint32_t *dst, unsigned dst_stride);
 };
 
 static unsigned lq2x_generic_input_fmts(void)
@@ -67,7 +77,6 @@ static void *lq2x_generic_create(const struct softfilter_config *config,
       unsigned threads, softfilter_simd_mask_t simd, void *userdata)
 {
    struct filter_data *filt = (struct filter_data*)calloc(1, sizeof(*filt));
-   (void)simd;
    (void)config;
    (void)userdata;
    if (!filt)
@@ -76,6 +85,7 @@ static void *lq2x_generic_create(const struct softfilter_config *config,
       calloc(threads, sizeof(struct softfilter_thread_data));
    filt->threads = 1;
    filt->in_fmt  = in_fmt;
+   filt->simd    = simd;
    if (!filt->workers)
    {
       free(filt);
@@ -103,6 +113,32 @@ static void lq2x_generic_destroy(void *data)
    free(filt);
 }
 
+#define lq2x_interpolate_rgb565(C, A) (((C) + (A) - (((C) ^ (A)) & 0x0821)) >> 1)
+
+#define lq2x_interpolate_xrgb8888(C, A) (((C) + (A) - (((C) ^ (A)) & 0x0421)) >> 1)
+
+#define lq2x_function(typename_t, interpolate_cb) \
+         typename_t A = *(src - prevline); \
+         typename_t B = (x > 0) ? *(src - 1) : *src; \
+         typename_t C = *src; \
+         typename_t D = (x < width - 1) ? *(src + 1) : *src; \
+         typename_t E = *(src++ + nextline); \
+         typename_t c = C; \
+         if (A != E && B != D) \
+         { \
+            *out0++ = (A == B ? interpolate_cb(C, A) : c); \
+            *out0++ = (A == D ? interpolate_cb(C, A) : c); \
+            *out1++ = (E == B ? interpolate_cb(C, E) : c); \
+            *out1++ = (E == D ? interpolate_cb(C, E) : c); \
+         } \
+         else \
+         { \
+            *out0++ = c; \
+            *out0++ = c; \
+            *out1++ = c; \
+            *out1++ = c; \
+         }
+
 static void lq2x_generic_rgb565(unsigned width, unsigned height,
       int first, int last, uint16_t *src,
       unsigned src_stride, uint16_t *dst, unsigned dst_stride)
@@ -118,27 +154,7 @@ static void lq2x_generic_rgb565(unsigned width, unsigned height,
 
       for (x = 0; x < width; x++)
       {
-         uint16_t A = *(src - prevline);
-         uint16_t B = (x > 0) ? *(src - 1) : *src;
-         uint16_t C = *src;
-         uint16_t D = (x < width - 1) ? *(src + 1) : *src;
-         uint16_t E = *(src++ + nextline);
-         uint16_t c = C;
-
-         if (A != E && B != D)
-         {
-            *out0++ = (A == B ? ((C + A - ((C ^ A) & 0x0821)) >> 1) : c);
-            *out0++ = (A == D ? ((C + A - ((C ^ A) & 0x0821)) >> 1) : c);
-            *out1++ = (E == B ? ((C + E - ((C ^ E) & 0x0821)) >> 1) : c);
-            *out1++ = (E == D ? ((C + E - ((C ^ E) & 0x0821)) >> 1) : c);
-         }
-         else
-         {
-            *out0++ = c;
-            *out0++ = c;
-            *out1++ = c;
-            *out1++ = c;
-         }
+         lq2x_function(uint16_t, lq2x_interpolate_rgb565);
       }
 
       src  += src_stride - width;
@@ -162,27 +178,7 @@ static void lq2x_generic_xrgb8888(unsigned width, unsigned height,
 
       for (x = 0; x < width; x++)
       {
-         uint32_t A = *(src - prevline);
-         uint32_t B = (x > 0) ? *(src - 1) : *src;
-         uint32_t C = *src;
-         uint32_t D = (x < width - 1) ? *(src + 1) : *src;
-         uint32_t E = *(src++ + nextline);
-         uint32_t c = C;
-
-         if (A != E && B != D)
-         {
-            *out0++ = (A == B ? (C + A - ((C ^ A) & 0x0421)) >> 1 : c);
-            *out0++ = (A == D ? (C + A - ((C ^ A) & 0x0421)) >> 1 : c);
-            *out1++ = (E == B ? (C + E - ((C ^ E) & 0x0421)) >> 1 : c);
-            *out1++ = (E == D ? (C + E - ((C ^ E) & 0x0421)) >> 1 : c);
-         }
-         else
-         {
-            *out0++ = c;
-            *out0++ = c;
-            *out1++ = c;
-            *out1++ = c;
-         }
+         lq2x_function(uint32_t, lq2x_interpolate_xrgb8888);
       }
 
       src += src_stride - width;
@@ -191,8 +187,105 @@ static void lq2x_generic_xrgb8888(unsigned width, unsigned height,
    }
 }
 
+/* (C + A - ((C ^ A) & 0x0821)) >> 1 without the 17-bit sum */
+#define lq2x_vector_interpolate_rgb565(V, C, A, mask) \
+   V##_add(V##_and(C, A), V##_srl1(V##_and(V##_xor(C, A), mask)))
+
+/* The scalar code wraps at 32 bits as well */
+#define lq2x_vector_interpolate_xrgb8888(V, C, A, mask) \
+   V##_srl1(V##_sub(V##_add(C, A), V##_and(V##_xor(C, A), mask)))
+
+/* lq2x_function() for V##_lanes pixels away from the left
+ * and right edges. */
+#define lq2x_vector_function(V, interpolate_cb, mask) \
+         { \
+         const V##_t A       = V##_load(src - prevline); \
+         const V##_t B       = V##_load(src - 1); \
+         const V##_t C       = V##_load(src); \
+         const V##_t D       = V##_load(src + 1); \
+         const V##_t E       = V##_load(src + nextline); \
+         const V##_t flat    = V##_or(V##_eq(A, E), V##_eq(B, D)); \
+         const V##_t blendA  = interpolate_cb(V, C, A, mask); \
+         const V##_t blendE  = interpolate_cb(V, C, E, mask); \
+         V##_store2x(out0, \
+               V##_sel(V##_andnot(V##_eq(A, B), flat), blendA, C), \
+               V##_sel(V##_andnot(V##_eq(A, D), flat), blendA, C)); \
+         V##_store2x(out1, \
+               V##_sel(V##_andnot(V##_eq(E, B), flat), blendE, C), \
+               V##_sel(V##_andnot(V##_eq(E, D), flat), blendE, C)); \
+         src  += V##_lanes; \
+         out0 += V##_lanes * 2; \
+         out1 += V##_lanes * 2; \
+         }
+
+/* Body of a vector renderer. The first and last pixels of
+ * each line, and whatever is left over, take the scalar path. */
+#define lq2x_vector_generic(V, typename_t, interpolate_cb, vector_interpolate_cb, mask_) \
+   unsigned x, y; \
+   typename_t *out0 = (typename_t*)dst; \
+   typename_t *out1 = (typename_t*)(dst + dst_stride); \
+   const V##_t mask = V##_set1(mask_); \
+   for (y = 0; y < height; y++) \
+   { \
+      int prevline = (y == 0 ? 0 : src_stride); \
+      int nextline = (y == height - 1 || last) ? 0 : src_stride; \
+      for (x = 0; x < width; x++) \
+      { \
+         if (x > 0) \
+            for (; x + V##_lanes < width; x += V##_lanes) \
+               lq2x_vector_function(V, vector_interpolate_cb, mask); \
+         { \
+            lq2x_function(typename_t, interpolate_cb); \
+         } \
+      } \
+      src  += src_stride - width; \
+      out0 += dst_stride + dst_stride - (width << 1); \
+      out1 += dst_stride + dst_stride - (width << 1); \
+   }
+
+#define lq2x_vector_generic_rgb565(V) \
+   lq2x_vector_generic(V, uint16_t, lq2x_interpolate_rgb565, \
+         lq2x_vector_interpolate_rgb565, 0xF7DE)
+
+#define lq2x_vector_generic_xrgb8888(V) \
+   lq2x_vector_generic(V, uint32_t, lq2x_interpolate_xrgb8888, \
+         lq2x_vector_interpolate_xrgb8888, 0x0421)
+
+#if defined(SOFTFILTER_SSE2)
+static void lq2x_sse2_rgb565(unsigned width, unsigned height,
+      int first, int last, uint16_t *src,
+      unsigned src_stride, uint16_t *dst, unsigned dst_stride)
+{
+   lq2x_vector_generic_rgb565(softfilter_sse2_u16);
+}
+
+static void lq2x_sse2_xrgb8888(unsigned width, unsigned height,
+      int first, int last, uint32_t *src,
+      unsigned src_stride, uint32_t *dst, unsigned dst_stride)
+{
+   lq2x_vector_generic_xrgb8888(softfilter_sse2_u32);
+}
+#endif
+
+#if defined(SOFTFILTER_AVX2)
+static SOFTFILTER_AVX2_TARGET void lq2x_avx2_rgb565(unsigned width,
+      unsigned height, int first, int last, uint16_t *src,
+      unsigned src_stride, uint16_t *dst, unsigned dst_stride)
+{
+   lq2x_vector_generic_rgb565(softfilter_avx2_u16);
+}
+
+static SOFTFILTER_AVX2_TARGET void lq2x_avx2_xrgb8888(unsigned width,
+      unsigned height, int first, int last, uint32_t *src,
+      unsigned src_stride, uint32_t *dst, unsigned dst_stride)
+{
+   lq2x_vector_generic_xrgb8888(softfilter_avx2_u32);
+}
+#endif
+
 static void lq2x_work_cb_rgb565(void *data, void *thread_data)
 {
+   struct filter_data *filt = (struct filter_data*)data;
    struct softfilter_thread_data *thr =
       (struct softfilter_thread_data*)thread_data;
    uint16_t *input = (uint16_t*)thr->in_data;
@@ -200,7 +293,7 @@ static void lq2x_work_cb_rgb565(void *data, void *thread_data)
    unsigned width = thr->width;
    unsigned height = thr->height;
 
-   lq2x_generic_rgb565(width, height,
+   filt->rgb565(width, height,
          thr->first, thr->last, input,
          (unsigned)(thr->in_pitch / SOFTFILTER_BPP_RGB565),
          output,
@@ -209,6 +302,7 @@ static void lq2x_work_cb_rgb565(void *data, void *thread_data)
 
 static void lq2x_work_cb_xrgb8888(void *data, void *thread_data)
 {
+   struct filter_data *filt = (struct filter_data*)data;
    struct softfilter_thread_data *thr =
       (struct softfilter_thread_data*)thread_data;
    uint32_t *input = (uint32_t*)thr->in_data;
@@ -216,9 +310,7 @@ static void lq2x_work_cb_xrgb8888(void *data, void *thread_data)
    unsigned width = thr->width;
    unsigned height = thr->height;
 
-   (void)data;
-
-   lq2x_generic_xrgb8888(width, height,
+   filt->xrgb8888(width, height,
          thr->first, thr->last, input,
          (unsigned)(thr->in_pitch / SOFTFILTER_BPP_XRGB8888),
          output,
@@ -233,6 +325,24 @@ static void lq2x_generic_packets(void *data,
 {
    struct filter_data *filt = (struct filter_data*)data;
    unsigned i;
+
+   filt->rgb565   = lq2x_generic_rgb565;
+   filt->xrgb8888 = lq2x_generic_xrgb8888;
+#if defined(SOFTFILTER_SSE2)
+   if (filt->simd & SOFTFILTER_SIMD_SSE2)
+   {
+      filt->rgb565   = lq2x_sse2_rgb565;
+      filt->xrgb8888 = lq2x_sse2_xrgb8888;
+   }
+#endif
+#if defined(SOFTFILTER_AVX2)
+   if (filt->simd & SOFTFILTER_SIMD_AVX2)
+   {
+      filt->rgb565   = lq2x_avx2_rgb565;
+      filt->xrgb8888 = lq2x_avx2_xrgb8888;
+   }
+#endif
+
    for (i = 0; i < filt->threads; i++)
    {
       struct softfilter_thread_data *thr =
@@ -20,6 +20,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #ifdef RARCH_INTERNAL
 #define softfilter_get_implementation normal2x_get_implementation
 #define softfilter_thread_data normal2x_softfilter_thread_data
@@ -44,6 +48,7 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   softfilter_simd_mask_t simd;
 };
 
 static unsigned normal2x_generic_input_fmts(void)
@@ -68,7 +73,6 @@ static void *normal2x_generic_create(const struct softfilter_config *config,
       unsigned threads, softfilter_simd_mask_t simd, void *userdata)
 {
    struct filter_data *filt = (struct filter_data*)calloc(1, sizeof(*filt));
-   (void)simd;
    (void)config;
    (void)userdata;
 
@@ -80,6 +84,7 @@ static void *normal2x_generic_create(const struct softfilter_config *config,
    filt->workers = (struct softfilter_thread_data*)calloc(1, sizeof(struct softfilter_thread_data));
    filt->threads = 1;
    filt->in_fmt  = in_fmt;
+   filt->simd    = simd;
    if (!filt->workers) {
       free(filt);
       return NULL;
@@ -177,6 +182,88 @@ static void normal2x_work_cb_rgb565(void *data, void *thread_data)
    }
 }
 
+#if defined(__SSE2__)
+static void normal2x_work_cb_xrgb8888_sse2(void *data, void *thread_data)
+{
+   struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
+   const uint32_t *input              = (const uint32_t*)thr->in_data;
+   uint32_t *output                   = (uint32_t*)thr->out_data;
+   uint32_t in_stride                 = (uint32_t)(thr->in_pitch >> 2);
+   uint32_t out_stride                = (uint32_t)(thr->out_pitch >> 2);
+   uint32_t x, y;
+
+   for (y = 0; y < thr->height; ++y)
+   {
+      uint32_t *out_row1 = output;
+      uint32_t *out_row2 = output + out_stride;
+
+      for (x = 0; x + 4 <= thr->width; x += 4)
+      {
+         __m128i color = _mm_loadu_si128((const __m128i*)(input + x));
+         __m128i lo    = _mm_unpacklo_epi32(color, color);
+         __m128i hi    = _mm_unpackhi_epi32(color, color);
+
+         _mm_storeu_si128((__m128i*)(out_row1 + (x << 1)),     lo);
+         _mm_storeu_si128((__m128i*)(out_row1 + (x << 1) + 4), hi);
+         _mm_storeu_si128((__m128i*)(out_row2 + (x << 1)),     lo);
+         _mm_storeu_si128((__m128i*)(out_row2 + (x << 1) + 4), hi);
+      }
+
+      for (; x < thr->width; ++x)
+      {
+         uint32_t color            = input[x];
+         out_row1[(x << 1)]        = color;
+         out_row1[(x << 1) + 1]    = color;
+         out_row2[(x << 1)]        = color;
+         out_row2[(x << 1) + 1]    = color;
+      }
+
+      input  += in_stride;
+      output += out_stride << 1;
+   }
+}
+
+static void normal2x_work_cb_rgb565_sse2(void *data, void *thread_data)
+{
+   struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
+   const uint16_t *input              = (const uint16_t*)thr->in_data;
+   uint16_t *output                   = (uint16_t*)thr->out_data;
+   uint32_t in_stride                 = (uint32_t)(thr->in_pitch >> 1);
+   uint32_t out_stride                = (uint32_t)(thr->out_pitch >> 1);
+   uint32_t x, y;
+
+   for (y = 0; y < thr->height; ++y)
+   {
+      uint16_t *out_row1 = output;
+      uint16_t *out_row2 = output + out_stride;
+
+      for (x = 0; x + 8 <= thr->width; x += 8)
+      {
+         __m128i color = _mm_loadu_si128((const __m128i*)(input + x));
+         __m128i lo    = _mm_unpacklo_epi16(color, color);
+         __m128i hi    = _mm_unpackhi_epi16(color, color);
+
+         _mm_storeu_si128((__m128i*)(out_row1 + (x << 1)),     lo);
+         _mm_storeu_si128((__m128i*)(out_row1 + (x << 1) + 8), hi);
+         _mm_storeu_si128((__m128i*)(out_row2 + (x << 1)),     lo);
+         _mm_storeu_si128((__m128i*)(out_row2 + (x << 1) + 8), hi);
+      }
+
+      for (; x < thr->width; ++x)
+      {
+         uint16_t color            = input[x];
+         out_row1[(x << 1)]        = color;
+         out_row1[(x << 1) + 1]    = color;
+         out_row2[(x << 1)]        = color;
+         out_row2[(x << 1) + 1]    = color;
+      }
+
+      input  += in_stride;
+      output += out_stride << 1;
+   }
+}
+#endif
+
 static void normal2x_generic_packets(void *data,
       struct softfilter_work_packet *packets,
       void *output, size_t output_stride,
@@ -199,8 +286,16 @@ static void normal2x_generic_packets(void *data,
 
    if (filt->in_fmt == SOFTFILTER_FMT_XRGB8888) {
       packets[0].work = normal2x_work_cb_xrgb8888;
+#if defined(__SSE2__)
+      if (filt->simd & SOFTFILTER_SIMD_SSE2)
+         packets[0].work = normal2x_work_cb_xrgb8888_sse2;
+#endif
    } else if (filt->in_fmt == SOFTFILTER_FMT_RGB565) {
       packets[0].work = normal2x_work_cb_rgb565;
+#if defined(__SSE2__)
+      if (filt->simd & SOFTFILTER_SIMD_SSE2)
+         packets[0].work = normal2x_work_cb_rgb565_sse2;
+#endif
    }
    packets[0].thread_data = thr;
 }
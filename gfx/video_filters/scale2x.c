@@ -20,6 +20,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <retro_inline.h>
+
+#include "softfilter_simd.h"
+
 #ifdef RARCH_INTERNAL
 #define softfilter_get_implementation scale2x_get_implementation
 #define softfilter_thread_data scale2x_softfilter_thread_data
@@ -44,6 +48,7 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   softfilter_simd_mask_t simd;
 };
 
 static unsigned scale2x_generic_input_fmts(void)
@@ -68,7 +73,6 @@ static void *scale2x_generic_create(const struct softfilter_config *config,
       unsigned threads, softfilter_simd_mask_t simd, void *userdata)
 {
    struct filter_data *filt = (struct filter_data*)calloc(1, sizeof(*filt));
-   (void)simd;
    (void)config;
    (void)userdata;
 
@@ -80,6 +84,7 @@ static void *scale2x_generic_create(const struct softfilter_config *config,
    filt->workers = (struct softfilter_thread_data*)calloc(1, sizeof(struct softfilter_thread_data));
    filt->threads = 1;
    filt->in_fmt  = in_fmt;
+   filt->simd    = simd;
    if (!filt->workers) {
       free(filt);
       return NULL;
@@ -201,6 +206,286 @@ static void scale2x_work_cb_rgb565(void *data, void *thread_data)
    }
 }
 
+#if defined(__SSE2__) || defined(SOFTFILTER_AVX2)
+/* One source pixel as the scalar path does it, for the
+ * columns the vector loops don't cover. */
+static INLINE void scale2x_pixel_xrgb8888(const uint32_t *input,
+      uint32_t x, uint32_t width, uint32_t line_prev, uint32_t line_next,
+      uint32_t *output0, uint32_t *output1)
+{
+   uint32_t A = *(input + x - line_prev);
+   uint32_t B = (x > 0) ? *(input + x - 1) : *(input + x);
+   uint32_t C = *(input + x);
+   uint32_t D = (x < width - 1) ? *(input + x + 1) : *(input + x);
+   uint32_t E = *(input + x + line_next);
+
+   if (A != E && B != D)
+   {
+      output0[(x << 1)]     = (A == B ? A : C);
+      output0[(x << 1) + 1] = (A == D ? A : C);
+      output1[(x << 1)]     = (E == B ? E : C);
+      output1[(x << 1) + 1] = (E == D ? E : C);
+   }
+   else
+   {
+      output0[(x << 1)]     = C;
+      output0[(x << 1) + 1] = C;
+      output1[(x << 1)]     = C;
+      output1[(x << 1) + 1] = C;
+   }
+}
+
+static INLINE void scale2x_pixel_rgb565(const uint16_t *input,
+      uint32_t x, uint32_t width, uint32_t line_prev, uint32_t line_next,
+      uint16_t *output0, uint16_t *output1)
+{
+   uint16_t A = *(input + x - line_prev);
+   uint16_t B = (x > 0) ? *(input + x - 1) : *(input + x);
+   uint16_t C = *(input + x);
+   uint16_t D = (x < width - 1) ? *(input + x + 1) : *(input + x);
+   uint16_t E = *(input + x + line_next);
+
+   if (A != E && B != D)
+   {
+      output0[(x << 1)]     = (A == B ? A : C);
+      output0[(x << 1) + 1] = (A == D ? A : C);
+      output1[(x << 1)]     = (E == B ? E : C);
+      output1[(x << 1) + 1] = (E == D ? E : C);
+   }
+   else
+   {
+      output0[(x << 1)]     = C;
+      output0[(x << 1) + 1] = C;
+      output1[(x << 1)]     = C;
+      output1[(x << 1) + 1] = C;
+   }
+}
+#endif
+
+#if defined(__SSE2__)
+static void scale2x_work_cb_xrgb8888_sse2(void *data, void *thread_data)
+{
+   struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
+   uint32_t in_stride                 = (uint32_t)(thr->in_pitch >> 2);
+   uint32_t out_stride                = (uint32_t)(thr->out_pitch >> 2);
+   const uint32_t *input              = (const uint32_t*)thr->in_data;
+   uint32_t *output                   = (uint32_t*)thr->out_data;
+   uint32_t x, y;
+
+   for (y = 0; y < thr->height; y++)
+   {
+      /* Determine offsets of previous/next source lines */
+      uint32_t line_prev = (y == 0)               ? 0 : in_stride;
+      uint32_t line_next = (y == thr->height - 1) ? 0 : in_stride;
+      uint32_t *output0  = output;
+      uint32_t *output1  = output + out_stride;
+
+      scale2x_pixel_xrgb8888(input, 0, thr->width,
+            line_prev, line_next, output0, output1);
+
+      /* Columns with both horizontal neighbours in the line */
+      for (x = 1; x + 4 < thr->width; x += 4)
+      {
+         __m128i A     = _mm_loadu_si128((const __m128i*)(input + x - line_prev));
+         __m128i B     = _mm_loadu_si128((const __m128i*)(input + x - 1));
+         __m128i C     = _mm_loadu_si128((const __m128i*)(input + x));
+         __m128i D     = _mm_loadu_si128((const __m128i*)(input + x + 1));
+         __m128i E     = _mm_loadu_si128((const __m128i*)(input + x + line_next));
+         /* A != E && B != D */
+         __m128i edge  = _mm_andnot_si128(_mm_or_si128(
+                  _mm_cmpeq_epi32(A, E), _mm_cmpeq_epi32(B, D)), _mm_set1_epi32(-1));
+         __m128i m00   = _mm_and_si128(edge, _mm_cmpeq_epi32(A, B));
+         __m128i m01   = _mm_and_si128(edge, _mm_cmpeq_epi32(A, D));
+         __m128i m10   = _mm_and_si128(edge, _mm_cmpeq_epi32(E, B));
+         __m128i m11   = _mm_and_si128(edge, _mm_cmpeq_epi32(E, D));
+         __m128i out00 = _mm_or_si128(_mm_and_si128(m00, A), _mm_andnot_si128(m00, C));
+         __m128i out01 = _mm_or_si128(_mm_and_si128(m01, A), _mm_andnot_si128(m01, C));
+         __m128i out10 = _mm_or_si128(_mm_and_si128(m10, E), _mm_andnot_si128(m10, C));
+         __m128i out11 = _mm_or_si128(_mm_and_si128(m11, E), _mm_andnot_si128(m11, C));
+
+         _mm_storeu_si128((__m128i*)(output0 + (x << 1)),
+               _mm_unpacklo_epi32(out00, out01));
+         _mm_storeu_si128((__m128i*)(output0 + (x << 1) + 4),
+               _mm_unpackhi_epi32(out00, out01));
+         _mm_storeu_si128((__m128i*)(output1 + (x << 1)),
+               _mm_unpacklo_epi32(out10, out11));
+         _mm_storeu_si128((__m128i*)(output1 + (x << 1) + 4),
+               _mm_unpackhi_epi32(out10, out11));
+      }
+
+      for (; x < thr->width; x++)
+         scale2x_pixel_xrgb8888(input, x, thr->width,
+               line_prev, line_next, output0, output1);
+
+      input  += in_stride;
+      output += out_stride << 1;
+   }
+}
+
+static void scale2x_work_cb_rgb565_sse2(void *data, void *thread_data)
+{
+   struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
+   uint32_t in_stride                 = (uint32_t)(thr->in_pitch >> 1);
+   uint32_t out_stride                = (uint32_t)(thr->out_pitch >> 1);
+   const uint16_t *input              = (const uint16_t*)thr->in_data;
+   uint16_t *output                   = (uint16_t*)thr->out_data;
+   uint32_t x, y;
+
+   for (y = 0; y < thr->height; y++)
+   {
+      /* Determine offsets of previous/next source lines */
+      uint32_t line_prev = (y == 0)               ? 0 : in_stride;
+      uint32_t line_next = (y == thr->height - 1) ? 0 : in_stride;
+      uint16_t *output0  = output;
+      uint16_t *output1  = output + out_stride;
+
+      scale2x_pixel_rgb565(input, 0, thr->width,
+            line_prev, line_next, output0, output1);
+
+      /* Columns with both horizontal neighbours in the line */
+      for (x = 1; x + 8 < thr->width; x += 8)
+      {
+         __m128i A     = _mm_loadu_si128((const __m128i*)(input + x - line_prev));
+         __m128i B     = _mm_loadu_si128((const __m128i*)(input + x - 1));
+         __m128i C     = _mm_loadu_si128((const __m128i*)(input + x));
+         __m128i D     = _mm_loadu_si128((const __m128i*)(input + x + 1));
+         __m128i E     = _mm_loadu_si128((const __m128i*)(input + x + line_next));
+         /* A != E && B != D */
+         __m128i edge  = _mm_andnot_si128(_mm_or_si128(
+                  _mm_cmpeq_epi16(A, E), _mm_cmpeq_epi16(B, D)), _mm_set1_epi32(-1));
+         __m128i m00   = _mm_and_si128(edge, _mm_cmpeq_epi16(A, B));
+         __m128i m01   = _mm_and_si128(edge, _mm_cmpeq_epi16(A, D));
+         __m128i m10   = _mm_and_si128(edge, _mm_cmpeq_epi16(E, B));
+         __m128i m11   = _mm_and_si128(edge, _mm_cmpeq_epi16(E, D));
+         __m128i out00 = _mm_or_si128(_mm_and_si128(m00, A), _mm_andnot_si128(m00, C));
+         __m128i out01 = _mm_or_si128(_mm_and_si128(m01, A), _mm_andnot_si128(m01, C));
+         __m128i out10 = _mm_or_si128(_mm_and_si128(m10, E), _mm_andnot_si128(m10, C));
+         __m128i out11 = _mm_or_si128(_mm_and_si128(m11, E), _mm_andnot_si128(m11, C));
+
+         _mm_storeu_si128((__m128i*)(output0 + (x << 1)),
+               _mm_unpacklo_epi16(out00, out01));
+         _mm_storeu_si128((__m128i*)(output0 + (x << 1) + 8),
+               _mm_unpackhi_epi16(out00, out01));
+         _mm_storeu_si128((__m128i*)(output1 + (x << 1)),
+               _mm_unpacklo_epi16(out10, out11));
+         _mm_storeu_si128((__m128i*)(output1 + (x << 1) + 8),
+               _mm_unpackhi_epi16(out10, out11));
+      }
+
+      for (; x < thr->width; x++)
+         scale2x_pixel_rgb565(input, x, thr->width,
+               line_prev, line_next, output0, output1);
+
+      input  += in_stride;
+      output += out_stride << 1;
+   }
+}
+#endif
+
+#if defined(SOFTFILTER_AVX2)
+static SOFTFILTER_AVX2_TARGET void scale2x_work_cb_xrgb8888_avx2(void *data, void *thread_data)
+{
+   struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
+   uint32_t in_stride                 = (uint32_t)(thr->in_pitch >> 2);
+   uint32_t out_stride                = (uint32_t)(thr->out_pitch >> 2);
+   const uint32_t *input              = (const uint32_t*)thr->in_data;
+   uint32_t *output                   = (uint32_t*)thr->out_data;
+   uint32_t x, y;
+
+   for (y = 0; y < thr->height; y++)
+   {
+      /* Determine offsets of previous/next source lines */
+      uint32_t line_prev = (y == 0)               ? 0 : in_stride;
+      uint32_t line_next = (y == thr->height - 1) ? 0 : in_stride;
+      uint32_t *output0  = output;
+      uint32_t *output1  = output + out_stride;
+
+      scale2x_pixel_xrgb8888(input, 0, thr->width,
+            line_prev, line_next, output0, output1);
+
+      /* Columns with both horizontal neighbours in the line */
+      for (x = 1; x + 8 < thr->width; x += 8)
+      {
+         __m256i A     = _mm256_loadu_si256((const __m256i*)(input + x - line_prev));
+         __m256i B     = _mm256_loadu_si256((const __m256i*)(input + x - 1));
+         __m256i C     = _mm256_loadu_si256((const __m256i*)(input + x));
+         __m256i D     = _mm256_loadu_si256((const __m256i*)(input + x + 1));
+         __m256i E     = _mm256_loadu_si256((const __m256i*)(input + x + line_next));
+         /* A != E && B != D */
+         __m256i edge  = _mm256_andnot_si256(_mm256_or_si256(
+                  _mm256_cmpeq_epi32(A, E), _mm256_cmpeq_epi32(B, D)), _mm256_set1_epi32(-1));
+         __m256i m00   = _mm256_and_si256(edge, _mm256_cmpeq_epi32(A, B));
+         __m256i m01   = _mm256_and_si256(edge, _mm256_cmpeq_epi32(A, D));
+         __m256i m10   = _mm256_and_si256(edge, _mm256_cmpeq_epi32(E, B));
+         __m256i m11   = _mm256_and_si256(edge, _mm256_cmpeq_epi32(E, D));
+
+         softfilter_avx2_u32_store2x(output0 + (x << 1),
+               _mm256_blendv_epi8(C, A, m00), _mm256_blendv_epi8(C, A, m01));
+         softfilter_avx2_u32_store2x(output1 + (x << 1),
+               _mm256_blendv_epi8(C, E, m10), _mm256_blendv_epi8(C, E, m11));
+      }
+
+      for (; x < thr->width; x++)
+         scale2x_pixel_xrgb8888(input, x, thr->width,
+               line_prev, line_next, output0, output1);
+
+      input  += in_stride;
+      output += out_stride << 1;
+   }
+}
+
+static SOFTFILTER_AVX2_TARGET void scale2x_work_cb_rgb565_avx2(void *data, void *thread_data)
+{
+   struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
+   uint32_t in_stride                 = (uint32_t)(thr->in_pitch >> 1);
+   uint32_t out_stride                = (uint32_t)(thr->out_pitch >> 1);
+   const uint16_t *input              = (const uint16_t*)thr->in_data;
+   uint16_t *output                   = (uint16_t*)thr->out_data;
+   uint32_t x, y;
+
+   for (y = 0; y < thr->height; y++)
+   {
+      /* Determine offsets of previous/next source lines */
+      uint32_t line_prev = (y == 0)               ? 0 : in_stride;
+      uint32_t line_next = (y == thr->height - 1) ? 0 : in_stride;
+      uint16_t *output0  = output;
+      uint16_t *output1  = output + out_stride;
+
+      scale2x_pixel_rgb565(input, 0, thr->width,
+            line_prev, line_next, output0, output1);
+
+      /* Columns with both horizontal neighbours in the line */
+      for (x = 1; x + 16 < thr->width; x += 16)
+      {
+         __m256i A     = _mm256_loadu_si256((const __m256i*)(input + x - line_prev));
+         __m256i B     = _mm256_loadu_si256((const __m256i*)(input + x - 1));
+         __m256i C     = _mm256_loadu_si256((const __m256i*)(input + x));
+         __m256i D     = _mm256_loadu_si256((const __m256i*)(input + x + 1));
+         __m256i E     = _mm256_loadu_si256((const __m256i*)(input + x + line_next));
+         /* A != E && B != D */
+         __m256i edge  = _mm256_andnot_si256(_mm256_or_si256(
+                  _mm256_cmpeq_epi16(A, E), _mm256_cmpeq_epi16(B, D)), _mm256_set1_epi32(-1));
+         __m256i m00   = _mm256_and_si256(edge, _mm256_cmpeq_epi16(A, B));
+         __m256i m01   = _mm256_and_si256(edge, _mm256_cmpeq_epi16(A, D));
+         __m256i m10   = _mm256_and_si256(edge, _mm256_cmpeq_epi16(E, B));
+         __m256i m11   = _mm256_and_si256(edge, _mm256_cmpeq_epi16(E, D));
+
+         softfilter_avx2_u16_store2x(output0 + (x << 1),
+               _mm256_blendv_epi8(C, A, m00), _mm256_blendv_epi8(C, A, m01));
+         softfilter_avx2_u16_store2x(output1 + (x << 1),
+               _mm256_blendv_epi8(C, E, m10), _mm256_blendv_epi8(C, E, m11));
+      }
+
+      for (; x < thr->width; x++)
+         scale2x_pixel_rgb565(input, x, thr->width,
+               line_prev, line_next, output0, output1);
+
+      input  += in_stride;
+      output += out_stride << 1;
+   }
+}
+#endif
+
 static void scale2x_generic_packets(void *data,
       struct softfilter_work_packet *packets,
       void *output, size_t output_stride,
@@ -223,8 +508,24 @@ static void scale2x_generic_packets(void *data,
 
    if (filt->in_fmt == SOFTFILTER_FMT_XRGB8888) {
       packets[0].work = scale2x_work_cb_xrgb8888;
+#if defined(__SSE2__)
+      if (filt->simd & SOFTFILTER_SIMD_SSE2)
+         packets[0].work = scale2x_work_cb_xrgb8888_sse2;
+#endif
+#if defined(SOFTFILTER_AVX2)
+      if (filt->simd & SOFTFILTER_SIMD_AVX2)
+         packets[0].work = scale2x_work_cb_xrgb8888_avx2;
+#endif
    } else if (filt->in_fmt == SOFTFILTER_FMT_RGB565) {
       packets[0].work = scale2x_work_cb_rgb565;
+#if defined(__SSE2__)
+      if (filt->simd & SOFTFILTER_SIMD_SSE2)
+         packets[0].work = scale2x_work_cb_rgb565_sse2;
+#endif
+#if defined(SOFTFILTER_AVX2)
+      if (filt->simd & SOFTFILTER_SIMD_AVX2)
+         packets[0].work = scale2x_work_cb_rgb565_avx2;
+#endif
    }
    packets[0].thread_data = thr;
 }
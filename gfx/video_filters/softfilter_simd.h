@@ -0,0 +1,349 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2018 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SOFTFILTER_SIMD_H__
+#define SOFTFILTER_SIMD_H__
+
+/* Lane-wise pixel operations for the softfilters' vector paths.
+ *
+ * Every instruction set provides the same operations for 16-bit
+ * (RGB565) and 32-bit (XRGB8888) pixels, named
+ * softfilter_<isa>_<u16|u32>_<op>, so a filter can write its
+ * per-pixel logic once as a macro taking that prefix and
+ * instantiate it for each of them. Comparisons return all-ones
+ * lanes for true, which also count as -1 when added up. The
+ * u64 sets only carry the arithmetic the NTSC filter needs.
+ *
+ * SSE2 follows the target flags. AVX2 is compiled in regardless
+ * with per-function target attributes and picked at runtime
+ * through SOFTFILTER_SIMD_AVX2, so generic x86 builds still get
+ * it on capable CPUs. */
+
+#include <stdint.h>
+
+#include <retro_inline.h>
+
+#if defined(__SSE2__)
+#define SOFTFILTER_SSE2
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__) || defined(_M_IX86) || defined(_M_X64)) && (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5) || (defined(_MSC_VER) && _MSC_VER >= 1910))
+#define SOFTFILTER_AVX2
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SOFTFILTER_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SOFTFILTER_TARGET(isa)
+#endif
+
+#if defined(SOFTFILTER_AVX2)
+#include <immintrin.h>
+#elif defined(SOFTFILTER_SSE2)
+#include <emmintrin.h>
+#endif
+
+/* Per-channel average of two pixels, truncating. 'hi' masks
+ * off the lowest bit of every channel, 'lo' keeps only those. */
+#define softfilter_interpolate(V, a, b, hi, lo) \
+   V##_add(V##_add(V##_srl1(V##_and(a, hi)), V##_srl1(V##_and(b, hi))), \
+         V##_and(V##_and(a, b), lo))
+
+/* Same for four pixels; 'hi' and 'lo' split at the second bit. */
+#define softfilter_interpolate2(V, a, b, c, d, hi, lo) \
+   V##_add(V##_add( \
+            V##_add(V##_srl2(V##_and(a, hi)), V##_srl2(V##_and(b, hi))), \
+            V##_add(V##_srl2(V##_and(c, hi)), V##_srl2(V##_and(d, hi)))), \
+         V##_and(V##_srl2(V##_add( \
+                  V##_add(V##_and(a, lo), V##_and(b, lo)), \
+                  V##_add(V##_and(c, lo), V##_and(d, lo)))), lo))
+
+#if defined(SOFTFILTER_SSE2)
+#define softfilter_sse2_u16_lanes 8
+#define softfilter_sse2_u32_lanes 4
+
+typedef __m128i softfilter_sse2_u16_t;
+typedef __m128i softfilter_sse2_u32_t;
+
+static INLINE __m128i softfilter_sse2_load(const void *p)
+{
+   return _mm_loadu_si128((const __m128i*)p);
+}
+
+static INLINE __m128i softfilter_sse2_and(__m128i a, __m128i b)
+{
+   return _mm_and_si128(a, b);
+}
+
+static INLINE __m128i softfilter_sse2_or(__m128i a, __m128i b)
+{
+   return _mm_or_si128(a, b);
+}
+
+static INLINE __m128i softfilter_sse2_xor(__m128i a, __m128i b)
+{
+   return _mm_xor_si128(a, b);
+}
+
+/* a & ~b */
+static INLINE __m128i softfilter_sse2_andnot(__m128i a, __m128i b)
+{
+   return _mm_andnot_si128(b, a);
+}
+
+/* m ? a : b */
+static INLINE __m128i softfilter_sse2_sel(__m128i m, __m128i a, __m128i b)
+{
+   return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b));
+}
+
+#define softfilter_sse2_u16_load   softfilter_sse2_load
+#define softfilter_sse2_u16_and    softfilter_sse2_and
+#define softfilter_sse2_u16_or     softfilter_sse2_or
+#define softfilter_sse2_u16_xor    softfilter_sse2_xor
+#define softfilter_sse2_u16_andnot softfilter_sse2_andnot
+#define softfilter_sse2_u16_sel    softfilter_sse2_sel
+#define softfilter_sse2_u32_load   softfilter_sse2_load
+#define softfilter_sse2_u32_and    softfilter_sse2_and
+#define softfilter_sse2_u32_or     softfilter_sse2_or
+#define softfilter_sse2_u32_xor    softfilter_sse2_xor
+#define softfilter_sse2_u32_andnot softfilter_sse2_andnot
+#define softfilter_sse2_u32_sel    softfilter_sse2_sel
+
+#define softfilter_sse2_u16_set1(x) _mm_set1_epi16((short)(x))
+#define softfilter_sse2_u16_eq      _mm_cmpeq_epi16
+#define softfilter_sse2_u16_add     _mm_add_epi16
+#define softfilter_sse2_u16_sub     _mm_sub_epi16
+#define softfilter_sse2_u16_srl1(a) _mm_srli_epi16(a, 1)
+#define softfilter_sse2_u16_srl2(a) _mm_srli_epi16(a, 2)
+#define softfilter_sse2_u16_gtz(a)  _mm_cmpgt_epi16(a, _mm_setzero_si128())
+#define softfilter_sse2_u16_ltz(a)  _mm_cmplt_epi16(a, _mm_setzero_si128())
+
+#define softfilter_sse2_u32_set1(x) _mm_set1_epi32((int)(x))
+#define softfilter_sse2_u32_eq      _mm_cmpeq_epi32
+#define softfilter_sse2_u32_add     _mm_add_epi32
+#define softfilter_sse2_u32_sub     _mm_sub_epi32
+#define softfilter_sse2_u32_srl1(a) _mm_srli_epi32(a, 1)
+#define softfilter_sse2_u32_srl2(a) _mm_srli_epi32(a, 2)
+#define softfilter_sse2_u32_gtz(a)  _mm_cmpgt_epi32(a, _mm_setzero_si128())
+#define softfilter_sse2_u32_ltz(a)  _mm_cmplt_epi32(a, _mm_setzero_si128())
+#define softfilter_sse2_u32_srl(a, n) _mm_srli_epi32(a, n)
+/* Low 16 bits of lane i */
+#define softfilter_sse2_u32_lo16(a, i) ((uint16_t)_mm_extract_epi16(a, (i) * 2))
+/* Lanes 0-1 from lo, 2-3 from hi */
+#define softfilter_sse2_u32_load2(lo, hi) \
+   _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)(lo)), \
+         _mm_loadl_epi64((const __m128i*)(hi)))
+
+#define softfilter_sse2_u64_lanes 2
+typedef __m128i softfilter_sse2_u64_t;
+#define softfilter_sse2_u64_load      softfilter_sse2_load
+#define softfilter_sse2_u64_and       softfilter_sse2_and
+#define softfilter_sse2_u64_or        softfilter_sse2_or
+#define softfilter_sse2_u64_set1(x)   _mm_set1_epi64x((long long)(x))
+#define softfilter_sse2_u64_add       _mm_add_epi64
+#define softfilter_sse2_u64_sub       _mm_sub_epi64
+#define softfilter_sse2_u64_srl(a, n) _mm_srli_epi64(a, n)
+#define softfilter_sse2_u64_lo16(a, i) ((uint16_t)_mm_extract_epi16(a, (i) * 4))
+
+/* Stores a0 b0 a1 b1 ... */
+static INLINE void softfilter_sse2_u16_store2x(void *p,
+      __m128i a, __m128i b)
+{
+   _mm_storeu_si128((__m128i*)p,     _mm_unpacklo_epi16(a, b));
+   _mm_storeu_si128((__m128i*)p + 1, _mm_unpackhi_epi16(a, b));
+}
+
+static INLINE void softfilter_sse2_u32_store2x(void *p,
+      __m128i a, __m128i b)
+{
+   _mm_storeu_si128((__m128i*)p,     _mm_unpacklo_epi32(a, b));
+   _mm_storeu_si128((__m128i*)p + 1, _mm_unpackhi_epi32(a, b));
+}
+#endif
+
+#if defined(SOFTFILTER_AVX2)
+#define SOFTFILTER_AVX2_TARGET SOFTFILTER_TARGET("avx2")
+
+#define softfilter_avx2_u16_lanes 16
+#define softfilter_avx2_u32_lanes 8
+
+typedef __m256i softfilter_avx2_u16_t;
+typedef __m256i softfilter_avx2_u32_t;
+
+static INLINE SOFTFILTER_AVX2_TARGET __m256i softfilter_avx2_load(const void *p)
+{
+   return _mm256_loadu_si256((const __m256i*)p);
+}
+
+static INLINE SOFTFILTER_AVX2_TARGET __m256i softfilter_avx2_and(__m256i a, __m256i b)
+{
+   return _mm256_and_si256(a, b);
+}
+
+static INLINE SOFTFILTER_AVX2_TARGET __m256i softfilter_avx2_or(__m256i a, __m256i b)
+{
+   return _mm256_or_si256(a, b);
+}
+
+static INLINE SOFTFILTER_AVX2_TARGET __m256i softfilter_avx2_xor(__m256i a, __m256i b)
+{
+   return _mm256_xor_si256(a, b);
+}
+
+/* a & ~b */
+static INLINE SOFTFILTER_AVX2_TARGET __m256i softfilter_avx2_andnot(__m256i a, __m256i b)
+{
+   return _mm256_andnot_si256(b, a);
+}
+
+/* m ? a : b */
+static INLINE SOFTFILTER_AVX2_TARGET __m256i softfilter_avx2_sel(__m256i m, __m256i a, __m256i b)
+{
+   return _mm256_blendv_epi8(b, a, m);
+}
+
+static INLINE SOFTFILTER_AVX2_TARGET __m256i softfilter_avx2_u16_set1(uint32_t x)
+{
+   return _mm256_set1_epi16((short)x);
+}
+
+static INLINE SOFTFILTER_AVX2_TARGET __m256i softfilter_avx2_u16_eq(__m256i a, __m256i b)
+{
+   return _mm256_cmpeq_epi16(a, b);
+}
+
+static INLINE SOFTFILTER_AVX2_TARGET __m256i softfilter_avx2_u16_add(__m256i a, __m256i b)
+{
+   return _mm256_add_epi16(a, b);
+}
+
+static INLINE SOFTFILTER_AVX2_TARGET __m256i softfilter_avx2_u16_sub(__m256i a, __m256i b)
+{
+   return _mm256_sub_epi16(a, b);
+}
+
+static INLINE SOFTFILTER_AVX2_TARGET __m256i softfilter_avx2_u16_srl1(__m256i a)
+{
+   return _mm256_srli_epi16(a, 1);
+}
+
+static INLINE SOFTFILTER_AVX2_TARGET __m256i softfilter_avx2_u16_srl2(__m256i a)
+{
+   return _mm256_srli_epi16(a, 2);
+}
+
+static INLINE SOFTFILTER_AVX2_TARGET __m256i softfilter_avx2_u16_gtz(__m256i a)
+{
+   return _mm256_cmpgt_epi16(a, _mm256_setzero_si256());
+}
+
+static INLINE SOFTFILTER_AVX2_TARGET __m256i softfilter_avx2_u16_ltz(__m256i a)
+{
+   return _mm256_cmpgt_epi16(_mm256_setzero_si256(), a);
+}
+
+static INLINE SOFTFILTER_AVX2_TARGET __m256i softfilter_avx2_u32_set1(uint32_t x)
+{
+   return _mm256_set1_epi32((int)x);
+}
+
+static INLINE SOFTFILTER_AVX2_TARGET __m256i softfilter_avx2_u32_eq(__m256i a, __m256i b)
+{
+   return _mm256_cmpeq_epi32(a, b);
+}
+
+static INLINE SOFTFILTER_AVX2_TARGET __m256i softfilter_avx2_u32_add(__m256i a, __m256i b)
+{
+   return _mm256_add_epi32(a, b);
+}
+
+static INLINE SOFTFILTER_AVX2_TARGET __m256i softfilter_avx2_u32_sub(__m256i a, __m256i b)
+{
+   return _mm256_sub_epi32(a, b);
+}
+
+static INLINE SOFTFILTER_AVX2_TARGET __m256i softfilter_avx2_u32_srl1(__m256i a)
+{
+   return _mm256_srli_epi32(a, 1);
+}
+
+static INLINE SOFTFILTER_AVX2_TARGET __m256i softfilter_avx2_u32_srl2(__m256i a)
+{
+   return _mm256_srli_epi32(a, 2);
+}
+
+static INLINE SOFTFILTER_AVX2_TARGET __m256i softfilter_avx2_u32_gtz(__m256i a)
+{
+   return _mm256_cmpgt_epi32(a, _mm256_setzero_si256());
+}
+
+static INLINE SOFTFILTER_AVX2_TARGET __m256i softfilter_avx2_u32_ltz(__m256i a)
+{
+   return _mm256_cmpgt_epi32(_mm256_setzero_si256(), a);
+}
+
+/* Stores a0 b0 a1 b1 ...; the unpacks work within 128-bit
+ * halves, so put those back in order. */
+static INLINE SOFTFILTER_AVX2_TARGET void softfilter_avx2_u16_store2x(void *p,
+      __m256i a, __m256i b)
+{
+   __m256i lo = _mm256_unpacklo_epi16(a, b);
+   __m256i hi = _mm256_unpackhi_epi16(a, b);
+   _mm256_storeu_si256((__m256i*)p,     _mm256_permute2x128_si256(lo, hi, 0x20));
+   _mm256_storeu_si256((__m256i*)p + 1, _mm256_permute2x128_si256(lo, hi, 0x31));
+}
+
+static INLINE SOFTFILTER_AVX2_TARGET void softfilter_avx2_u32_store2x(void *p,
+      __m256i a, __m256i b)
+{
+   __m256i lo = _mm256_unpacklo_epi32(a, b);
+   __m256i hi = _mm256_unpackhi_epi32(a, b);
+   _mm256_storeu_si256((__m256i*)p,     _mm256_permute2x128_si256(lo, hi, 0x20));
+   _mm256_storeu_si256((__m256i*)p + 1, _mm256_permute2x128_si256(lo, hi, 0x31));
+}
+
+#define softfilter_avx2_u16_load   softfilter_avx2_load
+#define softfilter_avx2_u16_and    softfilter_avx2_and
+#define softfilter_avx2_u16_or     softfilter_avx2_or
+#define softfilter_avx2_u16_xor    softfilter_avx2_xor
+#define softfilter_avx2_u16_andnot softfilter_avx2_andnot
+#define softfilter_avx2_u16_sel    softfilter_avx2_sel
+#define softfilter_avx2_u32_load   softfilter_avx2_load
+#define softfilter_avx2_u32_and    softfilter_avx2_and
+#define softfilter_avx2_u32_or     softfilter_avx2_or
+#define softfilter_avx2_u32_xor    softfilter_avx2_xor
+#define softfilter_avx2_u32_andnot softfilter_avx2_andnot
+#define softfilter_avx2_u32_sel    softfilter_avx2_sel
+
+#define softfilter_avx2_u64_lanes 4
+typedef __m256i softfilter_avx2_u64_t;
+#define softfilter_avx2_u64_load      softfilter_avx2_load
+#define softfilter_avx2_u64_and       softfilter_avx2_and
+#define softfilter_avx2_u64_or        softfilter_avx2_or
+#define softfilter_avx2_u64_set1(x)   _mm256_set1_epi64x((long long)(x))
+#define softfilter_avx2_u64_add       _mm256_add_epi64
+#define softfilter_avx2_u64_sub       _mm256_sub_epi64
+#define softfilter_avx2_u64_srl(a, n) _mm256_srli_epi64(a, n)
+#define softfilter_avx2_u64_lo16(a, i) ((uint16_t)_mm256_extract_epi16(a, (i) * 4))
+/* Lanes 0-1 from lo, 2-3 from hi */
+#define softfilter_avx2_u64_load2(lo, hi) \
+   _mm256_inserti128_si256(_mm256_castsi128_si256( \
+            _mm_loadu_si128((const __m128i*)(lo))), \
+         _mm_loadu_si128((const __m128i*)(hi)), 1)
+#endif
+
+#endif
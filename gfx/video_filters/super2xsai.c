@@ -19,6 +19,8 @@
 #include "softfilter.h"
 #include <stdlib.h>
 
+#include "softfilter_simd.h"
+
 #ifdef RARCH_INTERNAL
 #define softfilter_get_implementation supertwoxsai_get_implementation
 #define softfilter_thread_data supertwoxsai_softfilter_thread_data
@@ -45,6 +47,14 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   softfilter_simd_mask_t simd;
+   /* Scalar or vector renderers, see supertwoxsai_generic_packets() */
+   void (*rgb565)(unsigned width, unsigned height,
+         int first, int last, uint16_t *src,
+         unsigned src_stride, uint16_t *dst, unsigned dst_stride);
+   void (*xrgb8888)(unsigned width, unsigned height,
+         int first, int last, uint32_t *src,
+         unsigned src_stride, uint32_t *dst, unsigned dst_stride);
 };
 
 static unsigned supertwoxsai_generic_input_fmts(void)
@@ -72,13 +82,13 @@ static void *supertwoxsai_generic_create(const struct softfilter_config *config,
    if (!filt)
       return NULL;
 
-   (void)simd;
    (void)config;
    (void)userdata;
 
    filt->workers = (struct softfilter_thread_data*)calloc(threads, sizeof(struct softfilter_thread_data));
    filt->threads = 1;
    filt->in_fmt  = in_fmt;
+   filt->simd    = simd;
 
    if (!filt->workers)
    {
@@ -260,15 +270,162 @@ static void supertwoxsai_generic_rgb565(unsigned width, unsigned height,
    }
 }
 
+#define supertwoxsai_vector_result(V, A, B, C, D) \
+         V##_sub(V##_and(V##_eq(A, C), V##_eq(A, D)), \
+               V##_and(V##_eq(B, C), V##_eq(B, D)))
+
+/* supertwoxsai_function() for V##_lanes pixels at once: every
+ * case is worked out and the outcome selected per lane. */
+#define supertwoxsai_vector_function(V, hi, lo, hi2, lo2) \
+         { \
+         const V##_t colorB0 = V##_load(in - nextline - 1); \
+         const V##_t colorB1 = V##_load(in - nextline + 0); \
+         const V##_t colorB2 = V##_load(in - nextline + 1); \
+         const V##_t colorB3 = V##_load(in - nextline + 2); \
+         const V##_t color4  = V##_load(in - 1); \
+         const V##_t color5  = V##_load(in + 0); \
+         const V##_t color6  = V##_load(in + 1); \
+         const V##_t colorS2 = V##_load(in + 2); \
+         const V##_t color1  = V##_load(in + nextline - 1); \
+         const V##_t color2  = V##_load(in + nextline + 0); \
+         const V##_t color3  = V##_load(in + nextline + 1); \
+         const V##_t colorS1 = V##_load(in + nextline + 2); \
+         const V##_t colorA0 = V##_load(in + nextline + nextline - 1); \
+         const V##_t colorA1 = V##_load(in + nextline + nextline + 0); \
+         const V##_t colorA2 = V##_load(in + nextline + nextline + 1); \
+         const V##_t colorA3 = V##_load(in + nextline + nextline + 2); \
+         const V##_t eq26    = V##_eq(color2, color6); \
+         const V##_t eq53    = V##_eq(color5, color3); \
+         const V##_t eq52    = V##_eq(color5, color2); \
+         const V##_t eq63    = V##_eq(color6, color3); \
+         const V##_t i56     = softfilter_interpolate(V, color5, color6, hi, lo); \
+         const V##_t i25     = softfilter_interpolate(V, color2, color5, hi, lo); \
+         const V##_t i23     = softfilter_interpolate(V, color2, color3, hi, lo); \
+         const V##_t r       = V##_add( \
+               V##_add(supertwoxsai_vector_result(V, color6, color5, color1, colorA1), \
+                  supertwoxsai_vector_result(V, color6, color5, color4, colorB1)), \
+               V##_add(supertwoxsai_vector_result(V, color6, color5, colorA2, colorS1), \
+                  supertwoxsai_vector_result(V, color6, color5, colorB2, colorS2))); \
+         /* Both diagonals equal, settled by the neighbours */ \
+         const V##_t both    = V##_sel(V##_gtz(r), color6, \
+               V##_sel(V##_ltz(r), color5, i56)); \
+         /* Neither diagonal equal */ \
+         const V##_t sel2b   = V##_sel( \
+               V##_andnot(V##_andnot(V##_and(eq63, V##_eq(color3, colorA1)), \
+                     V##_eq(color2, colorA2)), V##_eq(color3, colorA0)), \
+               softfilter_interpolate2(V, color3, color3, color3, color2, hi2, lo2), \
+               V##_sel(V##_andnot(V##_andnot(V##_and(eq52, V##_eq(color2, colorA2)), \
+                        V##_eq(colorA1, color3)), V##_eq(color2, colorA3)), \
+                  softfilter_interpolate2(V, color2, color2, color2, color3, hi2, lo2), \
+                  i23)); \
+         const V##_t sel1b   = V##_sel( \
+               V##_andnot(V##_andnot(V##_and(eq63, V##_eq(color6, colorB1)), \
+                     V##_eq(color5, colorB2)), V##_eq(color6, colorB0)), \
+               softfilter_interpolate2(V, color6, color6, color6, color5, hi2, lo2), \
+               V##_sel(V##_andnot(V##_andnot(V##_and(eq52, V##_eq(color5, colorB2)), \
+                        V##_eq(colorB1, color6)), V##_eq(color5, colorB3)), \
+                  softfilter_interpolate2(V, color6, color5, color5, color5, hi2, lo2), \
+                  i56)); \
+         const V##_t only26  = V##_andnot(eq26, eq53); \
+         const V##_t only53  = V##_andnot(eq53, eq26); \
+         const V##_t both26  = V##_and(eq26, eq53); \
+         const V##_t blend2a = V##_or( \
+               V##_andnot(V##_and(only53, V##_eq(color4, color5)), \
+                  V##_eq(color5, colorA2)), \
+               V##_andnot(V##_andnot(V##_and(V##_eq(color5, color1), V##_eq(color6, color5)), \
+                     V##_eq(color4, color2)), V##_eq(color5, colorA0))); \
+         const V##_t blend1a = V##_or( \
+               V##_andnot(V##_and(only26, V##_eq(color1, color2)), \
+                  V##_eq(color2, colorB2)), \
+               V##_andnot(V##_andnot(V##_and(V##_eq(color4, color2), V##_eq(color3, color2)), \
+                     V##_eq(color1, color5)), V##_eq(color2, colorB0))); \
+         V##_store2x(out, \
+               V##_sel(blend1a, i25, color5), \
+               V##_sel(only26, color2, V##_sel(only53, color5, \
+                     V##_sel(both26, both, sel1b)))); \
+         V##_store2x(out + dst_stride, \
+               V##_sel(blend2a, i25, color2), \
+               V##_sel(only26, color2, V##_sel(only53, color5, \
+                     V##_sel(both26, both, sel2b)))); \
+         in  += V##_lanes; \
+         out += V##_lanes * 2; \
+         }
+
+/* Body of a vector renderer, with the scalar code for the
+ * pixels left over at the end of each line. */
+#define supertwoxsai_vector_generic(V, typename_t, interpolate_cb, interpolate2_cb, hi_, lo_, hi2_, lo2_) \
+   unsigned finish; \
+   unsigned nextline = (last) ? 0 : src_stride; \
+   const V##_t hi    = V##_set1(hi_); \
+   const V##_t lo    = V##_set1(lo_); \
+   const V##_t hi2   = V##_set1(hi2_); \
+   const V##_t lo2   = V##_set1(lo2_); \
+   for (; height; height--) \
+   { \
+      typename_t *in  = (typename_t*)src; \
+      typename_t *out = (typename_t*)dst; \
+      for (finish = width; finish >= V##_lanes; finish -= V##_lanes) \
+         supertwoxsai_vector_function(V, hi, lo, hi2, lo2); \
+      for (; finish; finish -= 1) \
+      { \
+         supertwoxsai_declare_variables(typename_t, in, nextline); \
+         supertwoxsai_function(supertwoxsai_result, interpolate_cb, interpolate2_cb); \
+      } \
+      src += src_stride; \
+      dst += 2 * dst_stride; \
+   }
+
+#define supertwoxsai_vector_generic_xrgb8888(V) \
+   supertwoxsai_vector_generic(V, uint32_t, supertwoxsai_interpolate_xrgb8888, \
+         supertwoxsai_interpolate2_xrgb8888, \
+         0xFEFEFEFE, 0x01010101, 0xFCFCFCFC, 0x03030303)
+
+#define supertwoxsai_vector_generic_rgb565(V) \
+   supertwoxsai_vector_generic(V, uint16_t, supertwoxsai_interpolate_rgb565, \
+         supertwoxsai_interpolate2_rgb565, 0xF7DE, 0x0821, 0xE79C, 0x1863)
+
+#if defined(SOFTFILTER_SSE2)
+static void supertwoxsai_sse2_xrgb8888(unsigned width, unsigned height,
+      int first, int last, uint32_t *src,
+      unsigned src_stride, uint32_t *dst, unsigned dst_stride)
+{
+   supertwoxsai_vector_generic_xrgb8888(softfilter_sse2_u32);
+}
+
+static void supertwoxsai_sse2_rgb565(unsigned width, unsigned height,
+      int first, int last, uint16_t *src,
+      unsigned src_stride, uint16_t *dst, unsigned dst_stride)
+{
+   supertwoxsai_vector_generic_rgb565(softfilter_sse2_u16);
+}
+#endif
+
+#if defined(SOFTFILTER_AVX2)
+static SOFTFILTER_AVX2_TARGET void supertwoxsai_avx2_xrgb8888(unsigned width,
+      unsigned height, int first, int last, uint32_t *src,
+      unsigned src_stride, uint32_t *dst, unsigned dst_stride)
+{
+   supertwoxsai_vector_generic_xrgb8888(softfilter_avx2_u32);
+}
+
+static SOFTFILTER_AVX2_TARGET void supertwoxsai_avx2_rgb565(unsigned width,
+      unsigned height, int first, int last, uint16_t *src,
+      unsigned src_stride, uint16_t *dst, unsigned dst_stride)
+{
+   supertwoxsai_vector_generic_rgb565(softfilter_avx2_u16);
+}
+#endif
+
 static void supertwoxsai_work_cb_rgb565(void *data, void *thread_data)
 {
+   struct filter_data *filt = (struct filter_data*)data;
    struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
    uint16_t *input = (uint16_t*)thr->in_data;
    uint16_t *output = (uint16_t*)thr->out_data;
    unsigned width = thr->width;
    unsigned height = thr->height;
 
-   supertwoxsai_generic_rgb565(width, height,
+   filt->rgb565(width, height,
          thr->first, thr->last, input,
         (unsigned)(thr->in_pitch / SOFTFILTER_BPP_RGB565),
         output,
@@ -277,13 +434,14 @@ static void supertwoxsai_work_cb_rgb565(void *data, void *thread_data)
 
 static void supertwoxsai_work_cb_xrgb8888(void *data, void *thread_data)
 {
+   struct filter_data *filt = (struct filter_data*)data;
    struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
    uint32_t *input = (uint32_t*)thr->in_data;
    uint32_t *output = (uint32_t*)thr->out_data;
    unsigned width = thr->width;
    unsigned height = thr->height;
 
-   supertwoxsai_generic_xrgb8888(width, height,
+   filt->xrgb8888(width, height,
          thr->first, thr->last, input,
             (unsigned)(thr->in_pitch / SOFTFILTER_BPP_XRGB8888),
             output,
@@ -298,6 +456,23 @@ static void supertwoxsai_generic_packets(void *data,
    unsigned i;
    struct filter_data *filt = (struct filter_data*)data;
 
+   filt->rgb565   = supertwoxsai_generic_rgb565;
+   filt->xrgb8888 = supertwoxsai_generic_xrgb8888;
+#if defined(SOFTFILTER_SSE2)
+   if (filt->simd & SOFTFILTER_SIMD_SSE2)
+   {
+      filt->rgb565   = supertwoxsai_sse2_rgb565;
+      filt->xrgb8888 = supertwoxsai_sse2_xrgb8888;
+   }
+#endif
+#if defined(SOFTFILTER_AVX2)
+   if (filt->simd & SOFTFILTER_SIMD_AVX2)
+   {
+      filt->rgb565   = supertwoxsai_avx2_rgb565;
+      filt->xrgb8888 = supertwoxsai_avx2_xrgb8888;
+   }
+#endif
+
    for (i = 0; i < filt->threads; i++)
    {
       struct softfilter_thread_data *thr = (struct softfilter_thread_data*)&filt->workers[i];
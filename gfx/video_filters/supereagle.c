@@ -19,6 +19,8 @@
 #include "softfilter.h"
 #include <stdlib.h>
 
+#include "softfilter_simd.h"
+
 #ifdef RARCH_INTERNAL
 #define softfilter_get_implementation supereagle_get_implementation
 #define softfilter_thread_data supereagle_softfilter_thread_data
@@ -45,6 +47,14 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   softfilter_simd_mask_t simd;
+   /* Scalar or vector renderers, see supereagle_generic_packets() */
+   void (*rgb565)(unsigned width, unsigned height,
+         int first, int last, uint16_t *src,
+         unsigned src_stride, uint16_t *dst, unsigned dst_stride);
+   void (*xrgb8888)(unsigned width, unsigned height,
+         int first, int last, uint32_t *src,
+         unsigned src_stride, uint32_t *dst, unsigned dst_stride);
 };
 
 static unsigned supereagle_generic_input_fmts(void)
@@ -69,7 +79,6 @@ static void *supereagle_generic_create(const struct softfilter_config *config,
       unsigned threads, softfilter_simd_mask_t simd, void *userdata)
 {
    struct filter_data *filt = (struct filter_data*)calloc(1, sizeof(*filt));
-   (void)simd;
    (void)config;
    (void)userdata;
    if (!filt)
@@ -77,6 +86,7 @@ static void *supereagle_generic_create(const struct softfilter_config *config,
    filt->workers = (struct softfilter_thread_data*)calloc(threads, sizeof(struct softfilter_thread_data));
    filt->threads = 1;
    filt->in_fmt  = in_fmt;
+   filt->simd    = simd;
    if (!filt->workers)
    {
       free(filt);
@@ -262,15 +272,146 @@ static void supereagle_generic_rgb565(unsigned width, unsigned height,
    }
 }
 
+#define supereagle_vector_result(V, A, B, C, D) \
+         V##_sub(V##_and(V##_eq(A, C), V##_eq(A, D)), \
+               V##_and(V##_eq(B, C), V##_eq(B, D)))
+
+/* supereagle_function() for V##_lanes pixels at once: every
+ * case is worked out and the outcome selected per lane. */
+#define supereagle_vector_function(V, hi, lo, hi2, lo2) \
+         { \
+         const V##_t colorB1 = V##_load(in - nextline + 0); \
+         const V##_t colorB2 = V##_load(in - nextline + 1); \
+         const V##_t color4  = V##_load(in - 1); \
+         const V##_t color5  = V##_load(in + 0); \
+         const V##_t color6  = V##_load(in + 1); \
+         const V##_t colorS2 = V##_load(in + 2); \
+         const V##_t color1  = V##_load(in + nextline - 1); \
+         const V##_t color2  = V##_load(in + nextline + 0); \
+         const V##_t color3  = V##_load(in + nextline + 1); \
+         const V##_t colorS1 = V##_load(in + nextline + 2); \
+         const V##_t colorA1 = V##_load(in + nextline + nextline + 0); \
+         const V##_t colorA2 = V##_load(in + nextline + nextline + 1); \
+         const V##_t eq26    = V##_eq(color2, color6); \
+         const V##_t eq53    = V##_eq(color5, color3); \
+         const V##_t only26  = V##_andnot(eq26, eq53); \
+         const V##_t only53  = V##_andnot(eq53, eq26); \
+         const V##_t both    = V##_and(eq26, eq53); \
+         const V##_t i56     = softfilter_interpolate(V, color5, color6, hi, lo); \
+         const V##_t i25     = softfilter_interpolate(V, color2, color5, hi, lo); \
+         const V##_t i23     = softfilter_interpolate(V, color2, color3, hi, lo); \
+         const V##_t i26     = softfilter_interpolate(V, color2, color6, hi, lo); \
+         const V##_t i53     = softfilter_interpolate(V, color5, color3, hi, lo); \
+         const V##_t r       = V##_add( \
+               V##_add(supereagle_vector_result(V, color6, color5, color1, colorA1), \
+                  supereagle_vector_result(V, color6, color5, color4, colorB1)), \
+               V##_add(supereagle_vector_result(V, color6, color5, colorA2, colorS1), \
+                  supereagle_vector_result(V, color6, color5, colorB2, colorS2))); \
+         const V##_t r_gt    = V##_gtz(r); \
+         const V##_t r_lt    = V##_ltz(r); \
+         const V##_t product1a = V##_sel(only26, \
+               V##_sel(V##_or(V##_eq(color1, color2), V##_eq(color6, colorB2)), \
+                  softfilter_interpolate(V, color2, i25, hi, lo), i56), \
+               V##_sel(only53, color5, V##_sel(both, V##_sel(r_gt, i56, color5), \
+                     softfilter_interpolate2(V, color5, color5, color5, i26, hi2, lo2)))); \
+         const V##_t product1b = V##_sel(only26, color2, \
+               V##_sel(only53, \
+                  V##_sel(V##_or(V##_eq(colorB1, color5), V##_eq(color3, colorS1)), \
+                     softfilter_interpolate(V, color5, i56, hi, lo), i56), \
+                  V##_sel(both, V##_sel(r_lt, i56, color2), \
+                     softfilter_interpolate2(V, color6, color6, color6, i53, hi2, lo2)))); \
+         const V##_t product2a = V##_sel(only26, color2, \
+               V##_sel(only53, \
+                  V##_sel(V##_or(V##_eq(color3, colorA2), V##_eq(color4, color5)), \
+                     softfilter_interpolate(V, color5, i25, hi, lo), i23), \
+                  V##_sel(both, V##_sel(r_lt, i56, color2), \
+                     softfilter_interpolate2(V, color2, color2, color2, i53, hi2, lo2)))); \
+         const V##_t product2b = V##_sel(only26, \
+               V##_sel(V##_or(V##_eq(color6, colorS2), V##_eq(color2, colorA1)), \
+                  softfilter_interpolate(V, color2, i23, hi, lo), i23), \
+               V##_sel(only53, color5, V##_sel(both, V##_sel(r_gt, i56, color5), \
+                     softfilter_interpolate2(V, color3, color3, color3, i26, hi2, lo2)))); \
+         V##_store2x(out, product1a, product1b); \
+         V##_store2x(out + dst_stride, product2a, product2b); \
+         in  += V##_lanes; \
+         out += V##_lanes * 2; \
+         }
+
+/* Body of a vector renderer, with the scalar code for the
+ * pixels left over at the end of each line. */
+#define supereagle_vector_generic(V, typename_t, interpolate_cb, interpolate2_cb, hi_, lo_, hi2_, lo2_) \
+   unsigned finish; \
+   unsigned nextline = (last) ? 0 : src_stride; \
+   const V##_t hi    = V##_set1(hi_); \
+   const V##_t lo    = V##_set1(lo_); \
+   const V##_t hi2   = V##_set1(hi2_); \
+   const V##_t lo2   = V##_set1(lo2_); \
+   for (; height; height--) \
+   { \
+      typename_t *in  = (typename_t*)src; \
+      typename_t *out = (typename_t*)dst; \
+      for (finish = width; finish >= V##_lanes; finish -= V##_lanes) \
+         supereagle_vector_function(V, hi, lo, hi2, lo2); \
+      for (; finish; finish -= 1) \
+      { \
+         supereagle_declare_variables(typename_t, in, nextline); \
+         supereagle_function(supereagle_result, interpolate_cb, interpolate2_cb); \
+      } \
+      src += src_stride; \
+      dst += 2 * dst_stride; \
+   }
+
+#define supereagle_vector_generic_xrgb8888(V) \
+   supereagle_vector_generic(V, uint32_t, supereagle_interpolate_xrgb8888, \
+         supereagle_interpolate2_xrgb8888, \
+         0xFEFEFEFE, 0x01010101, 0xFCFCFCFC, 0x03030303)
+
+#define supereagle_vector_generic_rgb565(V) \
+   supereagle_vector_generic(V, uint16_t, supereagle_interpolate_rgb565, \
+         supereagle_interpolate2_rgb565, 0xF7DE, 0x0821, 0xE79C, 0x1863)
+
+#if defined(SOFTFILTER_SSE2)
+static void supereagle_sse2_xrgb8888(unsigned width, unsigned height,
+      int first, int last, uint32_t *src,
+      unsigned src_stride, uint32_t *dst, unsigned dst_stride)
+{
+   supereagle_vector_generic_xrgb8888(softfilter_sse2_u32);
+}
+
+static void supereagle_sse2_rgb565(unsigned width, unsigned height,
+      int first, int last, uint16_t *src,
+      unsigned src_stride, uint16_t *dst, unsigned dst_stride)
+{
+   supereagle_vector_generic_rgb565(softfilter_sse2_u16);
+}
+#endif
+
+#if defined(SOFTFILTER_AVX2)
+static SOFTFILTER_AVX2_TARGET void supereagle_avx2_xrgb8888(unsigned width,
+      unsigned height, int first, int last, uint32_t *src,
+      unsigned src_stride, uint32_t *dst, unsigned dst_stride)
+{
+   supereagle_vector_generic_xrgb8888(softfilter_avx2_u32);
+}
+
+static SOFTFILTER_AVX2_TARGET void supereagle_avx2_rgb565(unsigned width,
+      unsigned height, int first, int last, uint16_t *src,
+      unsigned src_stride, uint16_t *dst, unsigned dst_stride)
+{
+   supereagle_vector_generic_rgb565(softfilter_avx2_u16);
+}
+#endif
+
 static void supereagle_work_cb_rgb565(void *data, void *thread_data)
 {
+   struct filter_data *filt = (struct filter_data*)data;
    struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
    uint16_t *input = (uint16_t*)thr->in_data;
    uint16_t *output = (uint16_t*)thr->out_data;
    unsigned width = thr->width;
    unsigned height = thr->height;
 
-   supereagle_generic_rgb565(width, height,
+   filt->rgb565(width, height,
          thr->first, thr->last, input,
             (unsigned)(thr->in_pitch / SOFTFILTER_BPP_RGB565),
             output,
@@ -279,13 +420,14 @@ static void supereagle_work_cb_rgb565(void *data, void *thread_data)
 
 static void supereagle_work_cb_xrgb8888(void *data, void *thread_data)
 {
+   struct filter_data *filt = (struct filter_data*)data;
    struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
    uint32_t *input = (uint32_t*)thr->in_data;
    uint32_t *output = (uint32_t*)thr->out_data;
    unsigned width = thr->width;
    unsigned height = thr->height;
 
-   supereagle_generic_xrgb8888(width, height,
+   filt->xrgb8888(width, height,
          thr->first, thr->last, input,
         (unsigned)(thr->in_pitch / SOFTFILTER_BPP_XRGB8888),
         output,
@@ -300,6 +442,23 @@ static void supereagle_generic_packets(void *data,
    unsigned i;
    struct filter_data *filt = (struct filter_data*)data;
 
+   filt->rgb565   = supereagle_generic_rgb565;
+   filt->xrgb8888 = supereagle_generic_xrgb8888;
+#if defined(SOFTFILTER_SSE2)
+   if (filt->simd & SOFTFILTER_SIMD_SSE2)
+   {
+      filt->rgb565   = supereagle_sse2_rgb565;
+      filt->xrgb8888 = supereagle_sse2_xrgb8888;
+   }
+#endif
+#if defined(SOFTFILTER_AVX2)
+   if (filt->simd & SOFTFILTER_SIMD_AVX2)
+   {
+      filt->rgb565   = supereagle_avx2_rgb565;
+      filt->xrgb8888 = supereagle_avx2_xrgb8888;
+   }
+#endif
+
    for (i = 0; i < filt->threads; i++)
    {
       struct softfilter_thread_data *thr = (struct softfilter_thread_data*)&filt->workers[i];
@@ -149,7 +149,8 @@ static bool video_thread_handle_packet(
          thr->driver_data = thr->driver->init(&thr->info,
                thr->input, thr->input_data);
          pkt.data.b = (thr->driver_data != NULL);
-         thr->driver->viewport_info(thr->driver_data, &thr->vp);
+         if (thr->driver->viewport_info)
+            thr->driver->viewport_info(thr->driver_data, &thr->vp);
          video_thread_reply(thr, &pkt);
          break;
 
@@ -180,7 +181,8 @@ static bool video_thread_handle_packet(
          vp.full_width            = 0;
          vp.full_height           = 0;
 
-         thr->driver->viewport_info(thr->driver_data, &vp);
+         if (thr->driver->viewport_info)
+            thr->driver->viewport_info(thr->driver_data, &vp);
 
          if (string_is_equal_fast(&vp, &thr->read_vp, sizeof(vp)))
          {
@@ -387,7 +389,15 @@ static void video_thread_loop(void *data)
       while (thr->send_cmd == CMD_VIDEO_NONE && !thr->frame.updated)
          scond_wait(thr->cond_thread, thr->lock);
       if (thr->frame.updated)
-         updated = true;
+      {
+         /* Take the new frame, and give back the one drawn last. */
+         unsigned read       = thr->frame.read;
+         thr->frame.read     = thr->frame.ready;
+         thr->frame.ready    = read;
+         thr->frame.updated  = false;
+         thr->frame.drawing  = true;
+         updated             = true;
+      }
 
       /* To avoid race condition where send_cmd is updated
        * right after the switch is checked. */
@@ -401,6 +411,7 @@ static void video_thread_loop(void *data)
       if (updated)
       {
          struct video_viewport vp;
+         const thread_frame_t *frame = &thr->frame.pool[thr->frame.read];
          bool                 ret = false;
          bool               alive = false;
          bool               focus = false;
@@ -425,9 +436,9 @@ static void video_thread_loop(void *data)
             video_driver_build_info(&video_info);
 
             ret = thr->driver->frame(thr->driver_data,
-                  thr->frame.buffer, thr->frame.width, thr->frame.height,
-                  thr->frame.count,
-                  thr->frame.pitch, *thr->frame.msg ? thr->frame.msg : NULL,
+                  frame->data, frame->width, frame->height,
+                  frame->count,
+                  frame->pitch, *frame->msg ? frame->msg : NULL,
                   &video_info);
          }
 
@@ -449,7 +460,7 @@ static void video_thread_loop(void *data)
          thr->alive         = alive;
          thr->focus         = focus;
          thr->has_windowed  = has_windowed;
-         thr->frame.updated = false;
+         thr->frame.drawing = false;
          thr->vp            = vp;
          scond_signal(thr->cond_cmd);
          slock_unlock(thr->lock);
@@ -519,8 +530,9 @@ static bool video_thread_frame(void *data, const void *frame_,
       unsigned pitch, const char *msg, video_frame_info_t *video_info)
 {
    unsigned copy_stride;
+   bool drop                           = false;
    const uint8_t *src                  = NULL;
-   uint8_t *dst                        = NULL;
+   thread_frame_t *frame               = NULL;
    thread_video_t *thr                 = (thread_video_t*)data;
 
    /* If called from within read_viewport, we're actually in the
@@ -538,8 +550,8 @@ static bool video_thread_frame(void *data, const void *frame_,
    copy_stride = width * (thr->info.rgb32
          ? sizeof(uint32_t) : sizeof(uint16_t));
 
-   src = (const uint8_t*)frame_;
-   dst = thr->frame.buffer;
+   src   = (const uint8_t*)frame_;
+   frame = &thr->frame.pool[thr->frame.write];
 
    slock_lock(thr->lock);
 
@@ -551,7 +563,7 @@ static bool video_thread_frame(void *data, const void *frame_,
       retro_time_t target = thr->last_time + target_frame_time;
 
       /* Ideally, use absolute time, but that is only a good idea on POSIX. */
-      while (thr->frame.updated)
+      while (thr->frame.updated || thr->frame.drawing)
       {
          retro_time_t current = cpu_features_get_time_usec();
          retro_time_t delta   = target - current;
@@ -564,41 +576,56 @@ static bool video_thread_frame(void *data, const void *frame_,
       }
    }
 
-   /* Drop frame if updated flag is still set, as thread is
-    * still working on last frame. */
-   if (!thr->frame.updated)
+   /* Drop frame if the thread hasn't even picked up
+    * the last one yet. */
+   drop = thr->frame.updated;
+
+   slock_unlock(thr->lock);
+
+   if (drop)
    {
-      if (src)
-      {
-         unsigned h;
-         for (h = 0; h < height; h++, src += pitch, dst += copy_stride)
-            memcpy(dst, src, copy_stride);
-      }
+      thr->miss_count++;
+      thr->last_time = cpu_features_get_time_usec();
+      return true;
+   }
 
-      thr->frame.updated = true;
-      thr->frame.width  = width;
-      thr->frame.height = height;
-      thr->frame.count  = frame_count;
-      thr->frame.pitch  = copy_stride;
+   /* pool[write] is ours alone, so fill it without holding
+    * the lock. There's nothing to copy if the core rendered
+    * straight into it, see thread_get_current_software_framebuffer(). */
+   if (src && src != frame->buffer)
+   {
+      unsigned h;
+      uint8_t *dst = frame->buffer;
+      for (h = 0; h < height; h++, src += pitch, dst += copy_stride)
+         memcpy(dst, src, copy_stride);
+   }
 
-      if (msg)
-         strlcpy(thr->frame.msg, msg, sizeof(thr->frame.msg));
-      else
-         *thr->frame.msg = '\0';
+   frame->data   = src ? frame->buffer : NULL;
+   frame->width  = width;
+   frame->height = height;
+   frame->count  = frame_count;
+   frame->pitch  = copy_stride;
 
-      scond_signal(thr->cond_thread);
+   if (msg)
+      strlcpy(frame->msg, msg, sizeof(frame->msg));
+   else
+      *frame->msg = '\0';
+
+   slock_lock(thr->lock);
+
+   thr->frame.write   = thr->frame.ready;
+   thr->frame.ready   = (unsigned)(frame - thr->frame.pool);
+   thr->frame.updated = true;
+   scond_signal(thr->cond_thread);
 
 #if defined(HAVE_MENU)
-      if (thr->texture.enable)
-      {
-         while (thr->frame.updated)
-            scond_wait(thr->cond_cmd, thr->lock);
-      }
-#endif
-      thr->hit_count++;
+   if (thr->texture.enable)
+   {
+      while (thr->frame.updated || thr->frame.drawing)
+         scond_wait(thr->cond_cmd, thr->lock);
    }
-   else
-      thr->miss_count++;
+#endif
+   thr->hit_count++;
 
    slock_unlock(thr->lock);
 
@@ -619,6 +646,7 @@ static bool video_thread_init(thread_video_t *thr,
       const video_info_t info,
       input_driver_t **input, void **input_data)
 {
+   unsigned i;
    size_t max_size;
    thread_packet_t pkt;
 
@@ -640,16 +668,26 @@ static bool video_thread_init(thread_video_t *thr,
    max_size                  = info.input_scale * RARCH_SCALE_BASE;
    max_size                 *= max_size;
    max_size                 *= info.rgb32 ? sizeof(uint32_t) : sizeof(uint16_t);
+   thr->frame.size           = max_size;
+
+   for (i = 0; i < THREAD_VIDEO_FRAMES; i++)
+   {
 #ifdef _3DS
-   thr->frame.buffer         = linearMemAlign(max_size, 0x80);
+      thr->frame.pool[i].buffer = (uint8_t*)linearMemAlign(max_size, 0x80);
 #else
-   thr->frame.buffer         = (uint8_t*)malloc(max_size);
+      thr->frame.pool[i].buffer = (uint8_t*)malloc(max_size);
 #endif
 
-   if (!thr->frame.buffer)
-      return false;
+      if (!thr->frame.pool[i].buffer)
+         return false;
+
+      memset(thr->frame.pool[i].buffer, 0x80, max_size);
+      thr->frame.pool[i].data   = thr->frame.pool[i].buffer;
+   }
 
-   memset(thr->frame.buffer, 0x80, max_size);
+   thr->frame.write          = 0;
+   thr->frame.ready          = 1;
+   thr->frame.read           = 2;
 
    thr->last_time            = cpu_features_get_time_usec();
    thr->thread               = sthread_create(video_thread_loop, thr);
@@ -750,6 +788,7 @@ static bool video_thread_read_viewport(void *data,
 
 static void video_thread_free(void *data)
 {
+   unsigned i;
    thread_packet_t pkt;
    thread_video_t *thr = (thread_video_t*)data;
 
@@ -764,10 +803,11 @@ static void video_thread_free(void *data)
 #if defined(HAVE_MENU)
    free(thr->texture.frame);
 #endif
+   for (i = 0; i < THREAD_VIDEO_FRAMES; i++)
 #ifdef _3DS
-   linearFree(thr->frame.buffer);
+      linearFree(thr->frame.pool[i].buffer);
 #else
-   free(thr->frame.buffer);
+      free(thr->frame.pool[i].buffer);
 #endif
    slock_free(thr->frame.lock);
    slock_free(thr->lock);
@@ -1101,6 +1141,44 @@ static struct video_shader *thread_get_current_shader(void *data)
    return thr->poke->get_current_shader(thr->driver_data);
 }
 
+/* Lets the core render straight into the frame that
+ * video_thread_frame() hands over next, so it needn't be
+ * copied. Only offered when the core's pixels reach us
+ * unconverted. */
+static bool thread_get_current_software_framebuffer(void *data,
+      struct retro_framebuffer *framebuffer)
+{
+   thread_video_t *thr        = (thread_video_t*)data;
+   enum retro_pixel_format fmt = video_driver_get_pixel_format();
+   unsigned bpp;
+
+   if (!thr || thr->frame.within_thread)
+      return false;
+
+   if (thr->info.rgb32)
+   {
+      if (fmt != RETRO_PIXEL_FORMAT_XRGB8888)
+         return false;
+      bpp = sizeof(uint32_t);
+   }
+   else
+   {
+      if (fmt != RETRO_PIXEL_FORMAT_RGB565)
+         return false;
+      bpp = sizeof(uint16_t);
+   }
+
+   if ((size_t)framebuffer->width * framebuffer->height * bpp
+         > thr->frame.size)
+      return false;
+
+   framebuffer->data         = thr->frame.pool[thr->frame.write].buffer;
+   framebuffer->pitch        = framebuffer->width * bpp;
+   framebuffer->format       = fmt;
+   framebuffer->memory_flags = RETRO_MEMORY_TYPE_CACHED;
+   return true;
+}
+
 static uint32_t thread_get_flags(void *data)
 {
    thread_video_t *thr = (thread_video_t*)data;
@@ -1131,7 +1209,7 @@ static const video_poke_interface_t thread_poke = {
    thread_grab_mouse_toggle,
 
    thread_get_current_shader,
-   NULL,                      /* get_current_software_framebuffer */
+   thread_get_current_software_framebuffer,
    NULL                       /* get_hw_render_interface */
 };
 
@@ -154,6 +154,21 @@ struct thread_packet
    enum thread_cmd type;
 };
 
+/* Frames in flight between the core and the video thread:
+ * one being written, one ready, one being drawn. */
+#define THREAD_VIDEO_FRAMES 3
+
+typedef struct thread_frame
+{
+   uint64_t count;
+   uint8_t *buffer;
+   const uint8_t *data; /* buffer, or NULL to redraw the last frame */
+   unsigned width;
+   unsigned height;
+   unsigned pitch;
+   char msg[255];
+} thread_frame_t;
+
 typedef struct thread_video
 {
    retro_time_t last_time;
@@ -210,14 +225,17 @@ typedef struct thread_video
 
    struct
    {
-      uint64_t count;
       slock_t *lock;
-      uint8_t *buffer;
-      unsigned width;
-      unsigned height;
-      unsigned pitch;
-      char msg[255];
-      bool updated;
+      /* pool[write] belongs to the user thread and pool[read]
+       * to the video thread; pool[ready] is handed over by
+       * swapping indices under thr->lock. */
+      thread_frame_t pool[THREAD_VIDEO_FRAMES];
+      size_t size;      /* of each buffer */
+      unsigned write;
+      unsigned ready;
+      unsigned read;
+      bool updated;     /* pool[ready] holds a frame not drawn yet */
+      bool drawing;     /* the video thread is drawing pool[read] */
       bool within_thread;
    } frame;
 
@@ -178,6 +178,7 @@ CONTENT METADATA RECORDS
 ============================================================ */
 #include "../runtime_file.c"
 #include "../disk_index_file.c"
+#include "../frame_timeline.c"
 
 /*============================================================
 ACHIEVEMENTS
@@ -844,6 +845,7 @@ AUDIO RESAMPLER
 ============================================================ */
 #include "../libretro-common/audio/resampler/audio_resampler.c"
 #include "../libretro-common/audio/resampler/drivers/sinc_resampler.c"
+#include "../libretro-common/audio/audio_timestretch.c"
 #ifdef HAVE_NEAREST_RESAMPLER
 #include "../libretro-common/audio/resampler/drivers/nearest_resampler.c"
 #endif
@@ -959,6 +961,10 @@ AUDIO
 #include "../audio/drivers/pulse.c"
 #endif
 
+#ifdef HAVE_PIPEWIRE
+#include "../audio/drivers/pipewire.c"
+#endif
+
 #ifdef HAVE_AL
 #include "../audio/drivers/openal.c"
 #endif
@@ -118,6 +118,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_AUDIO_FASTFORWARD_MUTE,
    "audio_fastforward_mute"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_AUDIO_TIMESTRETCH,
+   "audio_timestretch"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_AUDIO_OUTPUT_RATE,
    "audio_output_rate"
@@ -126,6 +130,14 @@ MSG_HASH(
    MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_DELTA,
    "audio_rate_control_delta"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_ADAPTIVE,
+   "audio_rate_control_adaptive"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_AUDIO_LATENCY_TARGET,
+   "audio_latency_target"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_AUDIO_RESAMPLER_DRIVER,
    "audio_resampler_driver"
@@ -150,6 +162,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_AUDIO_SYNC,
    "audio_sync"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_AUDIO_PROCESSING_THREAD,
+   "audio_processing_thread"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_AUDIO_VOLUME,
    "audio_volume"
@@ -2646,6 +2662,22 @@ MSG_HASH(
    MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP,
    "rewind_buffer_size_step"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_REWIND_THREADED,
+   "rewind_threaded"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_REWIND_KEYFRAME_INTERVAL,
+   "rewind_keyframe_interval"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_REWIND_MIN_HISTORY,
+   "rewind_min_history"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_REWIND_COMPRESSION,
+   "rewind_compression"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_REWIND_SETTINGS,
    "rewind_settings"
@@ -2852,6 +2884,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_INSTANCE,
    "run_ahead_secondary_instance"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_THREADED,
+   "run_ahead_secondary_threaded"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_RUN_AHEAD_HIDE_WARNINGS,
    "run_ahead_hide_warnings"
@@ -3258,6 +3294,14 @@ MSG_HASH(
    MENU_ENUM_LABEL_VIDEO_GPU_SCREENSHOT,
    "video_gpu_screenshot"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VIDEO_FRAME_DUPE_DETECT,
+   "video_frame_dupe_detect"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VIDEO_FRAME_PARTIAL_UPLOAD,
+   "video_frame_partial_upload"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VIDEO_HARD_SYNC,
    "video_hard_sync"
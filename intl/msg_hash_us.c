@@ -1224,6 +1224,10 @@ int msg_hash_get_help_us_enum(enum msg_hash_enums msg, char *s, size_t len)
             "JACK wants portnames (e.g. system:playback1\n"
             ",system:playback_2)."
 #endif
+#ifdef HAVE_PIPEWIRE
+            " \n"
+            "PipeWire wants a node name or serial."
+#endif
 #ifdef HAVE_RSOUND
             " \n"
             "RSound wants an IP address to an RSound \n"
@@ -712,6 +712,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_VALUE_SYSTEM_INFO_PULSEAUDIO_SUPPORT,
    "PulseAudio Support"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_SYSTEM_INFO_PIPEWIRE_SUPPORT,
+   "PipeWire Support"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_SYSTEM_INFO_COREAUDIO_SUPPORT,
    "CoreAudio Support"
@@ -1344,6 +1348,22 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_VIDEO_GPU_SCREENSHOT,
    "Screenshots capture GPU shaded material if available."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_VIDEO_FRAME_DUPE_DETECT,
+   "Detect Duplicate Frames"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_VIDEO_FRAME_DUPE_DETECT,
+   "Skip uploading and filtering frames identical to the previous one. Lowers CPU and GPU usage with mostly static content, at the cost of checking every frame."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_VIDEO_FRAME_PARTIAL_UPLOAD,
+   "Upload Changed Rows Only"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_VIDEO_FRAME_PARTIAL_UPLOAD,
+   "Only upload the rows of a software frame that changed since the previous one. Lowers bandwidth use when little of the screen changes. Needs a video driver that supports it, and no video filter or threaded video."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_VIDEO_SMOOTH,
    "Bilinear Filtering"
@@ -1831,6 +1851,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_AUDIO_FASTFORWARD_MUTE,
    "Automatically mute audio when using fast-forward."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_AUDIO_TIMESTRETCH,
+   "Time-Stretch Fast-Forward and Slow-Motion"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_AUDIO_TIMESTRETCH,
+   "Keep the original pitch of the audio during fast-forward and slow-motion, instead of speeding it up or slowing it down."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_AUDIO_VOLUME,
    "Volume Gain (dB)"
@@ -1944,6 +1972,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_AUDIO_SYNC,
    "Synchronize audio. Recommended."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_AUDIO_PROCESSING_THREAD,
+   "Threaded Audio Processing"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_AUDIO_PROCESSING_THREAD,
+   "Run DSP filters, resampling and the mixer on a separate thread instead of inside the core's audio callback. Adds up to one frame of audio latency."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_AUDIO_MAX_TIMING_SKEW,
    "Maximum Timing Skew"
@@ -1960,6 +1996,22 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_AUDIO_RATE_CONTROL_DELTA,
    "Helps smooth out imperfections in timing when synchronizing audio and video. Be aware that if disabled, proper synchronization is nearly impossible to obtain."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_AUDIO_RATE_CONTROL_ADAPTIVE,
+   "Adaptive Rate Control"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_AUDIO_RATE_CONTROL_ADAPTIVE,
+   "Settle the audio buffer at a steady fill level instead of letting it drift around half full. Copes better with audio drivers that report their buffer coarsely, allowing a lower audio latency."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_AUDIO_LATENCY_TARGET,
+   "Target Latency (ms)"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_AUDIO_LATENCY_TARGET,
+   "Amount of audio adaptive rate control keeps buffered. Raised automatically when the timing is too uneven for it. 0 keeps the buffer half full."
+   )
 
 /* Settings > Audio > MIDI */
 
@@ -2875,6 +2927,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_RUN_AHEAD_SECONDARY_INSTANCE,
    "Use a second instance of the RetroArch core to run-ahead. Prevents audio problems due to loading state."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_RUN_AHEAD_SECONDARY_THREADED,
+   "Run Second Instance on a Thread"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_RUN_AHEAD_SECONDARY_THREADED,
+   "While input is unchanged, run the second instance on a worker thread alongside the main core. Only used by software-rendered cores."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_RUN_AHEAD_HIDE_WARNINGS,
    "Hide Run-Ahead Warnings"
@@ -3314,6 +3374,38 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_REWIND_BUFFER_SIZE_STEP,
    "Each time the rewind buffer size value is increased or decreased, it will change by this amount."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_REWIND_THREADED,
+   "Threaded Rewind"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_REWIND_THREADED,
+   "Compress rewind states on a separate thread. Reduces the per-frame cost of rewind on cores with large save states."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_REWIND_KEYFRAME_INTERVAL,
+   "Rewind Keyframe Interval"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_REWIND_KEYFRAME_INTERVAL,
+   "Store a full state every N rewind steps so that jumping far back is fast. Each keyframe uses one save state worth of the rewind buffer. 0 disables keyframes."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_REWIND_MIN_HISTORY,
+   "Minimum Rewind History (Seconds)"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_REWIND_MIN_HISTORY,
+   "Capture rewind states less often when the buffer cannot hold this much history. 0 disables the adaptive mode."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_REWIND_COMPRESSION,
+   "Compress Rewind States"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_REWIND_COMPRESSION,
+   "Run rewind deltas through a fast compressor before storing them. Fits more history in the same buffer at some CPU cost."
+   )
 
 /* Settings > Frame Throttle > Frame Time Counter */
 
@@ -29,6 +29,8 @@
 
 #if defined(__SSE2__)
 #include <emmintrin.h>
+#elif defined(__ARM_NEON__) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
+#include <arm_neon.h>
 #elif defined(__ALTIVEC__)
 #include <altivec.h>
 #endif
@@ -79,6 +81,27 @@ void audio_mix_volume_SSE2(float *out, const float *in, float vol, size_t sample
 }
 #endif
 
+#if defined(__ARM_NEON__) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
+void audio_mix_volume_NEON(float *out, const float *in, float vol, size_t samples)
+{
+   size_t i, remaining_samples;
+
+   for (i = 0; i + 8 <= samples; i += 8, out += 8, in += 8)
+   {
+      float32x4_t out0 = vld1q_f32(out + 0);
+      float32x4_t out1 = vld1q_f32(out + 4);
+
+      vst1q_f32(out + 0, vmlaq_n_f32(out0, vld1q_f32(in + 0), vol));
+      vst1q_f32(out + 4, vmlaq_n_f32(out1, vld1q_f32(in + 4), vol));
+   }
+
+   remaining_samples = samples - i;
+
+   for (i = 0; i < remaining_samples; i++)
+      out[i] += in[i] * vol;
+}
+#endif
+
 void audio_mix_free_chunk(audio_chunk_t *chunk)
 {
    if (!chunk)
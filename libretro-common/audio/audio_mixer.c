@@ -25,18 +25,31 @@
 #endif
 
 #include <audio/audio_mixer.h>
+#include <audio/audio_mix.h>
 #include <audio/audio_resampler.h>
 
 #ifdef HAVE_RWAV
 #include <formats/rwav.h>
 #endif
 #include <memalign.h>
+#include <streams/file_stream.h>
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
+#include <arm_neon.h>
+#endif
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#include <retro_timers.h>
+#endif
+
 #ifdef HAVE_STB_VORBIS
 #define STB_VORBIS_NO_PUSHDATA_API
 #define STB_VORBIS_NO_STDIO
@@ -64,6 +77,49 @@
 #define AUDIO_MIXER_MAX_VOICES      8
 #define AUDIO_MIXER_TEMP_BUFFER 8192
 
+/* Decoded samples queued up per voice, must be a power of two.
+ * 8192 frames is about 170ms at 48kHz. */
+#define AUDIO_MIXER_RING_SAMPLES    16384
+
+/* How often the decoder tops up the rings while something plays. */
+#define AUDIO_MIXER_DECODE_INTERVAL_US 10000
+
+/* Bytes read from the file at a time by streamed sounds */
+#define AUDIO_MIXER_READ_AHEAD      65536
+
+/* Voices are decoded ahead of time into their ring by a
+ * background thread; audio_mixer_mix() only sums the rings
+ * and never locks nor allocates. The ring indices and the
+ * voice state are shared without a lock, which needs the
+ * GCC/Clang __atomic builtins. Elsewhere, voices are decoded
+ * inside audio_mixer_mix() as they always were. */
+#if defined(HAVE_THREADS) && (defined(__GNUC__) || defined(__clang__))
+#define AUDIO_MIXER_DECODE_THREAD
+#define AUDIO_MIXER_LOAD(ptr)        __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define AUDIO_MIXER_STORE(ptr, val)  __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#define AUDIO_MIXER_ADD(ptr, val)    __atomic_fetch_add((ptr), (val), __ATOMIC_ACQ_REL)
+#define AUDIO_MIXER_TAKE(ptr)        __atomic_exchange_n((ptr), 0, __ATOMIC_ACQ_REL)
+/* Voice state and s_mix_seq need a total order, see
+ * audio_mixer_wait_mix(). */
+#define AUDIO_MIXER_STATE_LOAD(ptr)       __atomic_load_n((ptr), __ATOMIC_SEQ_CST)
+#define AUDIO_MIXER_STATE_STORE(ptr, val) __atomic_store_n((ptr), (val), __ATOMIC_SEQ_CST)
+#else
+#define AUDIO_MIXER_LOAD(ptr)        (*(ptr))
+#define AUDIO_MIXER_STORE(ptr, val)  (*(ptr) = (val))
+#define AUDIO_MIXER_ADD(ptr, val)    (*(ptr) += (val))
+#define AUDIO_MIXER_TAKE(ptr)        audio_mixer_take(ptr)
+#define AUDIO_MIXER_STATE_LOAD(ptr)       (*(ptr))
+#define AUDIO_MIXER_STATE_STORE(ptr, val) (*(ptr) = (val))
+#endif
+
+enum audio_mixer_voice_state
+{
+   AUDIO_MIXER_VOICE_IDLE = 0,
+   AUDIO_MIXER_VOICE_PLAYING,
+   /* Played to the end, stop callback not delivered yet */
+   AUDIO_MIXER_VOICE_FINISHED
+};
+
 struct audio_mixer_sound
 {
    enum audio_mixer_type type;
@@ -92,6 +148,8 @@ struct audio_mixer_sound
           /* flac */
          const void* data;
          unsigned size;
+         /* Streamed from here instead if set */
+         char *path;
       } flac;
 #endif
 
@@ -101,6 +159,8 @@ struct audio_mixer_sound
           /* mp */
          const void* data;
          unsigned size;
+         /* Streamed from here instead if set */
+         char *path;
       } mp3;
 #endif
 
@@ -115,6 +175,21 @@ struct audio_mixer_sound
    } types;
 };
 
+#if defined(HAVE_DR_FLAC) || defined(HAVE_DR_MP3)
+/* A file read AUDIO_MIXER_READ_AHEAD bytes at a time */
+typedef struct audio_mixer_file
+{
+   RFILE   *file;
+   uint8_t *buffer;
+   /* File position of buffer[0] */
+   int64_t  offset;
+   size_t   size;
+   size_t   pos;
+} audio_mixer_file_t;
+#endif
+
+/* Decoder state, owned by whoever fills the ring: the
+ * decoder thread, or audio_mixer_mix() without one. */
 struct audio_mixer_voice
 {
    union
@@ -131,8 +206,6 @@ struct audio_mixer_voice
          void       *resampler_data;
          const retro_resampler_t *resampler;
          float      *buffer;
-         unsigned    position;
-         unsigned    samples;
          unsigned    buf_samples;
          float       ratio;
       } ogg;
@@ -145,8 +218,6 @@ struct audio_mixer_voice
          drflac      *stream;
          void        *resampler_data;
          const retro_resampler_t *resampler;
-         unsigned    position;
-         unsigned    samples;
          unsigned    buf_samples;
          float       ratio;
       } flac;
@@ -159,8 +230,6 @@ struct audio_mixer_voice
          void        *resampler_data;
          const retro_resampler_t *resampler;
          float*      buffer;
-         unsigned    position;
-         unsigned    samples;
          unsigned    buf_samples;
          float       ratio;
       } mp3;
@@ -170,19 +239,40 @@ struct audio_mixer_voice
       struct
       {
          int*              buffer;
+         float*            pcm_buffer;
          struct replay*    stream;
          struct module*    module;
-         unsigned          position;
-         unsigned          samples;
          unsigned          buf_samples;
       } mod;
 #endif
    } types;
    audio_mixer_sound_t *sound;
    audio_mixer_stop_cb_t stop_cb;
+#if defined(HAVE_DR_FLAC) || defined(HAVE_DR_MP3)
+   /* Source of a streamed sound */
+   audio_mixer_file_t *file;
+#endif
+   /* Decoded chunk not yet copied to the ring */
+   const float *pcm;
+   /* Decode scratch, AUDIO_MIXER_TEMP_BUFFER samples */
+   float    *temp;
+   /* AUDIO_MIXER_RING_SAMPLES samples; head is only
+    * written by the decoder, tail by the mixer. */
+   float    *ring;
+   unsigned pcm_samples;
+   unsigned head;
+   unsigned tail;
+   unsigned state;
+   /* Set with the last head once the stream ran out */
+   unsigned eos;
+   /* Loops since the last audio_mixer_update() */
+   unsigned repeats;
+   /* Which of 'types' is live */
    unsigned type;
    float    volume;
    bool     repeat;
+   /* Streamed sound the decoder thread has yet to open */
+   bool     pending;
 
 };
 
@@ -190,6 +280,38 @@ struct audio_mixer_voice
 static struct audio_mixer_voice s_voices[AUDIO_MIXER_MAX_VOICES] = {0};
 static unsigned s_rate = 0;
 
+#ifdef AUDIO_MIXER_DECODE_THREAD
+static sthread_t *s_decoder_thread = NULL;
+static slock_t   *s_decoder_lock   = NULL;
+static scond_t   *s_decoder_cond   = NULL;
+static bool       s_decoder_quit   = false;
+/* Odd while audio_mixer_mix() runs */
+static unsigned   s_mix_seq        = 0;
+#else
+static unsigned audio_mixer_take(unsigned *ptr)
+{
+   unsigned val = *ptr;
+   *ptr         = 0;
+   return val;
+}
+#endif
+
+/* Moves a voice from one state to another, unless someone
+ * else (audio_mixer_stop() in particular) got there first. */
+static bool audio_mixer_state_cas(unsigned *state,
+      unsigned from, unsigned to)
+{
+#ifdef AUDIO_MIXER_DECODE_THREAD
+   return __atomic_compare_exchange_n(state, &from, to, false,
+         __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#else
+   if (*state != from)
+      return false;
+   *state = to;
+   return true;
+#endif
+}
+
 #ifdef HAVE_RWAV
 static bool wav_to_float(const rwav_t* wav, float** pcm, size_t samples_out)
 {
@@ -305,22 +427,543 @@ static bool one_shot_resample(const float* in, size_t samples_in,
 }
 #endif
 
+static void audio_mixer_lock(void)
+{
+#ifdef AUDIO_MIXER_DECODE_THREAD
+   if (s_decoder_lock)
+      slock_lock(s_decoder_lock);
+#endif
+}
+
+static void audio_mixer_unlock(void)
+{
+#ifdef AUDIO_MIXER_DECODE_THREAD
+   if (s_decoder_lock)
+      slock_unlock(s_decoder_lock);
+#endif
+}
+
+/* Waits out an audio_mixer_mix() call in progress, after
+ * which a voice no longer marked as playing is not touched
+ * by the mixer anymore. */
+static void audio_mixer_wait_mix(void)
+{
+#ifdef AUDIO_MIXER_DECODE_THREAD
+   unsigned seq = AUDIO_MIXER_STATE_LOAD(&s_mix_seq);
+
+   if (seq & 1)
+      while (AUDIO_MIXER_LOAD(&s_mix_seq) == seq)
+         retro_sleep(0);
+#endif
+}
+
+#if defined(HAVE_DR_FLAC) || defined(HAVE_DR_MP3)
+static void audio_mixer_file_free(audio_mixer_file_t *f)
+{
+   if (!f)
+      return;
+
+   if (f->file)
+      filestream_close(f->file);
+   if (f->buffer)
+      free(f->buffer);
+   free(f);
+}
+
+static audio_mixer_file_t *audio_mixer_file_open(const char *path)
+{
+   audio_mixer_file_t *f = (audio_mixer_file_t*)calloc(1, sizeof(*f));
+
+   if (!f)
+      return NULL;
+
+   f->file   = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+   f->buffer = (uint8_t*)malloc(AUDIO_MIXER_READ_AHEAD);
+
+   if (!f->file || !f->buffer)
+   {
+      audio_mixer_file_free(f);
+      return NULL;
+   }
+
+   return f;
+}
+
+static size_t audio_mixer_file_read(void *data, void *out, size_t bytes)
+{
+   audio_mixer_file_t *f = (audio_mixer_file_t*)data;
+   uint8_t *dst          = (uint8_t*)out;
+   size_t total          = 0;
+
+   while (total < bytes)
+   {
+      size_t count = f->size - f->pos;
+
+      if (!count)
+      {
+         int64_t ret;
+
+         f->offset += f->size;
+         f->size    = 0;
+         f->pos     = 0;
+         ret        = filestream_read(f->file,
+               f->buffer, AUDIO_MIXER_READ_AHEAD);
+
+         if (ret <= 0)
+            break;
+
+         f->size    = (size_t)ret;
+         count      = f->size;
+      }
+
+      if (count > bytes - total)
+         count = bytes - total;
+
+      memcpy(dst + total, f->buffer + f->pos, count);
+      f->pos += count;
+      total  += count;
+   }
+
+   return total;
+}
+
+static bool audio_mixer_file_seek(audio_mixer_file_t *f,
+      int offset, bool from_start)
+{
+   int64_t target = from_start
+      ? offset : f->offset + (int64_t)f->pos + offset;
+
+   if (target < 0)
+      return false;
+
+   /* Short seeks stay within what was read already */
+   if (target >= f->offset && target <= f->offset + (int64_t)f->size)
+   {
+      f->pos = (size_t)(target - f->offset);
+      return true;
+   }
+
+   if (filestream_seek(f->file, target,
+            RETRO_VFS_SEEK_POSITION_START) < 0)
+      return false;
+
+   f->offset = target;
+   f->size   = 0;
+   f->pos    = 0;
+   return true;
+}
+#endif
+
+#ifdef HAVE_DR_FLAC
+static drflac_bool32 audio_mixer_flac_seek(void *data, int offset,
+      drflac_seek_origin origin)
+{
+   return audio_mixer_file_seek((audio_mixer_file_t*)data,
+         offset, origin == drflac_seek_origin_start);
+}
+#endif
+
+#ifdef HAVE_DR_MP3
+static drmp3_bool32 audio_mixer_mp3_seek(void *data, int offset,
+      drmp3_seek_origin origin)
+{
+   return audio_mixer_file_seek((audio_mixer_file_t*)data,
+         offset, origin == drmp3_seek_origin_start);
+}
+#endif
+
+static void audio_mixer_voice_free_codec(audio_mixer_voice_t *voice)
+{
+   switch (voice->type)
+   {
+      case AUDIO_MIXER_TYPE_OGG:
+#ifdef HAVE_STB_VORBIS
+         if (voice->types.ogg.stream)
+            stb_vorbis_close(voice->types.ogg.stream);
+         if (voice->types.ogg.resampler && voice->types.ogg.resampler_data)
+            voice->types.ogg.resampler->free(voice->types.ogg.resampler_data);
+         if (voice->types.ogg.buffer)
+            memalign_free(voice->types.ogg.buffer);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MOD:
+#ifdef HAVE_IBXM
+         if (voice->types.mod.stream)
+            dispose_replay(voice->types.mod.stream);
+         if (voice->types.mod.module)
+            dispose_module(voice->types.mod.module);
+         if (voice->types.mod.buffer)
+            memalign_free(voice->types.mod.buffer);
+         if (voice->types.mod.pcm_buffer)
+            memalign_free(voice->types.mod.pcm_buffer);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_FLAC:
+#ifdef HAVE_DR_FLAC
+         if (voice->types.flac.stream)
+            drflac_close(voice->types.flac.stream);
+         if (voice->types.flac.resampler && voice->types.flac.resampler_data)
+            voice->types.flac.resampler->free(voice->types.flac.resampler_data);
+         if (voice->types.flac.buffer)
+            memalign_free(voice->types.flac.buffer);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MP3:
+#ifdef HAVE_DR_MP3
+         drmp3_uninit(&voice->types.mp3.stream);
+         if (voice->types.mp3.resampler && voice->types.mp3.resampler_data)
+            voice->types.mp3.resampler->free(voice->types.mp3.resampler_data);
+         if (voice->types.mp3.buffer)
+            memalign_free(voice->types.mp3.buffer);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_WAV:
+      case AUDIO_MIXER_TYPE_NONE:
+         break;
+   }
+
+#if defined(HAVE_DR_FLAC) || defined(HAVE_DR_MP3)
+   audio_mixer_file_free(voice->file);
+   voice->file = NULL;
+#endif
+
+   memset(&voice->types, 0, sizeof(voice->types));
+   voice->type = AUDIO_MIXER_TYPE_NONE;
+}
+
+#if defined(HAVE_STB_VORBIS) || defined(HAVE_DR_FLAC) || defined(HAVE_DR_MP3)
+/* Resamples the chunk decoded into voice->temp, if needed. */
+static unsigned audio_mixer_resample(audio_mixer_voice_t *voice,
+      const retro_resampler_t *resampler, void *resampler_data,
+      float ratio, float *buffer, unsigned buf_samples,
+      unsigned samples)
+{
+   struct resampler_data info;
+
+   if (!resampler)
+   {
+      voice->pcm         = voice->temp;
+      return samples;
+   }
+
+   info.data_in          = voice->temp;
+   info.data_out         = buffer;
+   info.input_frames     = samples / 2;
+   info.output_frames    = 0;
+   info.ratio            = ratio;
+
+   resampler->process(resampler_data, &info);
+
+   voice->pcm            = buffer;
+   samples               = (unsigned)info.output_frames * 2;
+   return samples < buf_samples ? samples : buf_samples & ~1;
+}
+#endif
+
+/* Decodes the next chunk of the stream into voice->pcm and
+ * returns its size in samples, or 0 at the end. */
+static unsigned audio_mixer_decode(audio_mixer_voice_t *voice)
+{
+   unsigned samples = 0;
+
+   switch (voice->type)
+   {
+      case AUDIO_MIXER_TYPE_WAV:
+         {
+            const audio_mixer_sound_t *sound = voice->sound;
+
+            samples = sound->types.wav.frames * 2
+               - voice->types.wav.position;
+            if (samples > AUDIO_MIXER_TEMP_BUFFER)
+               samples = AUDIO_MIXER_TEMP_BUFFER;
+
+            voice->pcm                 = sound->types.wav.pcm
+               + voice->types.wav.position;
+            voice->types.wav.position += samples;
+         }
+         break;
+      case AUDIO_MIXER_TYPE_OGG:
+#ifdef HAVE_STB_VORBIS
+         samples = stb_vorbis_get_samples_float_interleaved(
+               voice->types.ogg.stream, 2, voice->temp,
+               AUDIO_MIXER_TEMP_BUFFER) * 2;
+
+         if (samples)
+            samples = audio_mixer_resample(voice,
+                  voice->types.ogg.resampler,
+                  voice->types.ogg.resampler_data,
+                  voice->types.ogg.ratio, voice->types.ogg.buffer,
+                  voice->types.ogg.buf_samples, samples);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MOD:
+#ifdef HAVE_IBXM
+         {
+            unsigned i;
+            const int *in = voice->types.mod.buffer;
+            float *out    = voice->types.mod.pcm_buffer;
+
+            samples = replay_get_audio(
+                  voice->types.mod.stream, voice->types.mod.buffer, 0) * 2;
+
+            for (i = 0; i < samples; i++)
+            {
+               float samplef = ((float)in[i] + 32768.0f) / 65535.0f;
+               out[i]        = samplef * 2.0f - 1.0f;
+            }
+
+            voice->pcm    = out;
+         }
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_FLAC:
+#ifdef HAVE_DR_FLAC
+         samples = (unsigned)drflac_read_f32(voice->types.flac.stream,
+               AUDIO_MIXER_TEMP_BUFFER, voice->temp);
+
+         if (samples)
+            samples = audio_mixer_resample(voice,
+                  voice->types.flac.resampler,
+                  voice->types.flac.resampler_data,
+                  voice->types.flac.ratio, voice->types.flac.buffer,
+                  voice->types.flac.buf_samples, samples);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MP3:
+#ifdef HAVE_DR_MP3
+         samples = (unsigned)drmp3_read_f32(&voice->types.mp3.stream,
+               AUDIO_MIXER_TEMP_BUFFER / 2, voice->temp) * 2;
+
+         if (samples)
+            samples = audio_mixer_resample(voice,
+                  voice->types.mp3.resampler,
+                  voice->types.mp3.resampler_data,
+                  voice->types.mp3.ratio, voice->types.mp3.buffer,
+                  voice->types.mp3.buf_samples, samples);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_NONE:
+         break;
+   }
+
+   return samples;
+}
+
+static void audio_mixer_rewind(audio_mixer_voice_t *voice)
+{
+   switch (voice->type)
+   {
+      case AUDIO_MIXER_TYPE_WAV:
+         voice->types.wav.position = 0;
+         break;
+      case AUDIO_MIXER_TYPE_OGG:
+#ifdef HAVE_STB_VORBIS
+         stb_vorbis_seek_start(voice->types.ogg.stream);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MOD:
+#ifdef HAVE_IBXM
+         replay_seek(voice->types.mod.stream, 0);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_FLAC:
+#ifdef HAVE_DR_FLAC
+         drflac_seek_to_sample(voice->types.flac.stream, 0);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MP3:
+#ifdef HAVE_DR_MP3
+         drmp3_seek_to_frame(&voice->types.mp3.stream, 0);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_NONE:
+         break;
+   }
+}
+
+/* Decodes into the voice's ring until it is full or the
+ * stream ends. */
+static void audio_mixer_fill(audio_mixer_voice_t *voice)
+{
+   bool rewound   = false;
+   bool eos       = false;
+   unsigned head  = voice->head;
+   unsigned space = AUDIO_MIXER_RING_SAMPLES
+      - (head - AUDIO_MIXER_LOAD(&voice->tail));
+
+   if (voice->eos)
+      return;
+
+   while (space)
+   {
+      unsigned count, first;
+      unsigned offset = head & (AUDIO_MIXER_RING_SAMPLES - 1);
+
+      if (!voice->pcm_samples)
+      {
+         voice->pcm_samples = audio_mixer_decode(voice);
+
+         if (voice->pcm_samples)
+            rewound = false;
+         /* Give up on a looped stream that yields nothing */
+         else if (voice->repeat && !rewound)
+         {
+            audio_mixer_rewind(voice);
+            AUDIO_MIXER_ADD(&voice->repeats, 1);
+            rewound = true;
+            continue;
+         }
+         else
+         {
+            eos = true;
+            break;
+         }
+      }
+
+      count = voice->pcm_samples < space ? voice->pcm_samples : space;
+      first = AUDIO_MIXER_RING_SAMPLES - offset;
+      if (first > count)
+         first = count;
+
+      memcpy(voice->ring + offset, voice->pcm, first * sizeof(float));
+      memcpy(voice->ring, voice->pcm + first,
+            (count - first) * sizeof(float));
+
+      voice->pcm         += count;
+      voice->pcm_samples -= count;
+      head               += count;
+      space              -= count;
+   }
+
+   AUDIO_MIXER_STORE(&voice->head, head);
+   if (eos)
+      AUDIO_MIXER_STORE(&voice->eos, 1);
+}
+
+#ifdef AUDIO_MIXER_DECODE_THREAD
+static void audio_mixer_open_pending(audio_mixer_voice_t *voice);
+
+static void audio_mixer_decoder_loop(void *data)
+{
+   slock_lock(s_decoder_lock);
+
+   while (!s_decoder_quit)
+   {
+      unsigned i;
+      bool playing = false;
+
+      for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
+      {
+         if (AUDIO_MIXER_STATE_LOAD(&s_voices[i].state)
+               != AUDIO_MIXER_VOICE_PLAYING)
+            continue;
+
+         if (s_voices[i].pending)
+            audio_mixer_open_pending(&s_voices[i]);
+
+         audio_mixer_fill(&s_voices[i]);
+         playing = true;
+
+         /* One voice per lock hold, so audio_mixer_play()
+          * and audio_mixer_stop() never wait on more than
+          * a single ring's worth of decoding. */
+         slock_unlock(s_decoder_lock);
+         slock_lock(s_decoder_lock);
+      }
+
+      if (playing)
+         scond_wait_timeout(s_decoder_cond, s_decoder_lock,
+               AUDIO_MIXER_DECODE_INTERVAL_US);
+      else
+         scond_wait(s_decoder_cond, s_decoder_lock);
+   }
+
+   slock_unlock(s_decoder_lock);
+}
+#endif
+
 void audio_mixer_init(unsigned rate)
 {
    unsigned i;
 
+   audio_mixer_done();
+
    s_rate = rate;
 
    for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
-      s_voices[i].type = AUDIO_MIXER_TYPE_NONE;
+   {
+      audio_mixer_voice_t *voice = &s_voices[i];
+
+      voice->ring = (float*)memalign_alloc(16,
+            AUDIO_MIXER_RING_SAMPLES * sizeof(float));
+      voice->temp = (float*)memalign_alloc(16,
+            AUDIO_MIXER_TEMP_BUFFER * sizeof(float));
+
+      if (!voice->ring || !voice->temp)
+      {
+         if (voice->ring)
+            memalign_free(voice->ring);
+         if (voice->temp)
+            memalign_free(voice->temp);
+         voice->ring = NULL;
+         voice->temp = NULL;
+      }
+   }
+
+#ifdef AUDIO_MIXER_DECODE_THREAD
+   /* Without the thread, audio_mixer_mix() decodes. */
+   s_decoder_quit = false;
+   s_decoder_lock = slock_new();
+   s_decoder_cond = scond_new();
+
+   if (s_decoder_lock && s_decoder_cond)
+      s_decoder_thread = sthread_create(audio_mixer_decoder_loop, NULL);
+#endif
 }
 
 void audio_mixer_done(void)
 {
    unsigned i;
 
+#ifdef AUDIO_MIXER_DECODE_THREAD
+   if (s_decoder_thread)
+   {
+      slock_lock(s_decoder_lock);
+      s_decoder_quit = true;
+      scond_signal(s_decoder_cond);
+      slock_unlock(s_decoder_lock);
+      sthread_join(s_decoder_thread);
+   }
+
+   if (s_decoder_cond)
+      scond_free(s_decoder_cond);
+   if (s_decoder_lock)
+      slock_free(s_decoder_lock);
+
+   s_decoder_thread = NULL;
+   s_decoder_cond   = NULL;
+   s_decoder_lock   = NULL;
+#endif
+
    for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
-      s_voices[i].type = AUDIO_MIXER_TYPE_NONE;
+   {
+      audio_mixer_voice_t *voice = &s_voices[i];
+
+      AUDIO_MIXER_STATE_STORE(&voice->state, AUDIO_MIXER_VOICE_IDLE);
+      audio_mixer_wait_mix();
+      audio_mixer_voice_free_codec(voice);
+
+      if (voice->ring)
+         memalign_free(voice->ring);
+      if (voice->temp)
+         memalign_free(voice->temp);
+
+      voice->ring    = NULL;
+      voice->temp    = NULL;
+      voice->stop_cb = NULL;
+      voice->sound   = NULL;
+   }
 }
 
 audio_mixer_sound_t* audio_mixer_load_wav(void *buffer, int32_t size)
@@ -429,9 +1072,59 @@ audio_mixer_sound_t* audio_mixer_load_mp3(void *buffer, int32_t size)
 #endif
 }
 
-audio_mixer_sound_t* audio_mixer_load_mod(void *buffer, int32_t size)
+audio_mixer_sound_t* audio_mixer_load_flac_file(const char *path)
 {
-#ifdef HAVE_IBXM
+#ifdef HAVE_DR_FLAC
+   audio_mixer_sound_t* sound = NULL;
+
+   sound = (audio_mixer_sound_t*)calloc(1, sizeof(*sound));
+
+   if (!sound)
+      return NULL;
+
+   sound->type            = AUDIO_MIXER_TYPE_FLAC;
+   sound->types.flac.path = strdup(path);
+
+   if (!sound->types.flac.path)
+   {
+      free(sound);
+      return NULL;
+   }
+
+   return sound;
+#else
+   return NULL;
+#endif
+}
+
+audio_mixer_sound_t* audio_mixer_load_mp3_file(const char *path)
+{
+#ifdef HAVE_DR_MP3
+   audio_mixer_sound_t* sound = NULL;
+
+   sound = (audio_mixer_sound_t*)calloc(1, sizeof(*sound));
+
+   if (!sound)
+      return NULL;
+
+   sound->type           = AUDIO_MIXER_TYPE_MP3;
+   sound->types.mp3.path = strdup(path);
+
+   if (!sound->types.mp3.path)
+   {
+      free(sound);
+      return NULL;
+   }
+
+   return sound;
+#else
+   return NULL;
+#endif
+}
+
+audio_mixer_sound_t* audio_mixer_load_mod(void *buffer, int32_t size)
+{
+#ifdef HAVE_IBXM
    audio_mixer_sound_t* sound = (audio_mixer_sound_t*)calloc(1, sizeof(*sound));
 
    if (!sound)
@@ -479,6 +1172,8 @@ void audio_mixer_destroy(audio_mixer_sound_t* sound)
          handle = (void*)sound->types.flac.data;
          if (handle)
             free(handle);
+         if (sound->types.flac.path)
+            free(sound->types.flac.path);
 #endif
          break;
       case AUDIO_MIXER_TYPE_MP3:
@@ -486,6 +1181,8 @@ void audio_mixer_destroy(audio_mixer_sound_t* sound)
          handle = (void*)sound->types.mp3.data;
          if (handle)
             free(handle);
+         if (sound->types.mp3.path)
+            free(sound->types.mp3.path);
 #endif
          break;
       case AUDIO_MIXER_TYPE_NONE:
@@ -495,20 +1192,10 @@ void audio_mixer_destroy(audio_mixer_sound_t* sound)
    free(sound);
 }
 
-static bool audio_mixer_play_wav(audio_mixer_sound_t* sound,
-      audio_mixer_voice_t* voice, bool repeat, float volume,
-      audio_mixer_stop_cb_t stop_cb)
-{
-   voice->types.wav.position = 0;
-   return true;
-}
-
 #ifdef HAVE_STB_VORBIS
 static bool audio_mixer_play_ogg(
       audio_mixer_sound_t* sound,
-      audio_mixer_voice_t* voice,
-      bool repeat, float volume,
-      audio_mixer_stop_cb_t stop_cb)
+      audio_mixer_voice_t* voice)
 {
    stb_vorbis_info info;
    int res                         = 0;
@@ -534,35 +1221,25 @@ static bool audio_mixer_play_ogg(
                &resamp, NULL, RESAMPLER_QUALITY_DONTCARE,
                ratio))
          goto error;
-   }
 
-   samples                         = (unsigned)(AUDIO_MIXER_TEMP_BUFFER * ratio);
-   ogg_buffer                      = (float*)memalign_alloc(16,
-         ((samples + 15) & ~15) * sizeof(float));
+      /* A few spare samples, resamplers can round up */
+      samples                      = (unsigned)(AUDIO_MIXER_TEMP_BUFFER * ratio) + 4;
+      ogg_buffer                   = (float*)memalign_alloc(16,
+            ((samples + 15) & ~15) * sizeof(float));
 
-   if (!ogg_buffer)
-   {
-      if (resamp && resampler_data)
+      if (!ogg_buffer)
+      {
          resamp->free(resampler_data);
-      goto error;
+         goto error;
+      }
    }
 
-   /* "system" menu sounds may reuse the same voice without freeing anything first, so do that here if needed */
-   if (voice->types.ogg.stream)
-      stb_vorbis_close(voice->types.ogg.stream);
-   if (voice->types.ogg.resampler && voice->types.ogg.resampler_data)
-      voice->types.ogg.resampler->free(voice->types.ogg.resampler_data);
-   if (voice->types.ogg.buffer)
-      memalign_free(voice->types.ogg.buffer);
-
    voice->types.ogg.resampler      = resamp;
    voice->types.ogg.resampler_data = resampler_data;
    voice->types.ogg.buffer         = (float*)ogg_buffer;
    voice->types.ogg.buf_samples    = samples;
    voice->types.ogg.ratio          = ratio;
    voice->types.ogg.stream         = stb_vorbis;
-   voice->types.ogg.position       = 0;
-   voice->types.ogg.samples        = 0;
 
    return true;
 
@@ -575,15 +1252,14 @@ error:
 #ifdef HAVE_IBXM
 static bool audio_mixer_play_mod(
       audio_mixer_sound_t* sound,
-      audio_mixer_voice_t* voice,
-      bool repeat, float volume,
-      audio_mixer_stop_cb_t stop_cb)
+      audio_mixer_voice_t* voice)
 {
    struct data data;
    char message[64];
    int buf_samples               = 0;
    int samples                   = 0;
    void *mod_buffer              = NULL;
+   void *pcm_buffer              = NULL;
    struct module* module         = NULL;
    struct replay* replay         = NULL;
 
@@ -597,11 +1273,6 @@ static bool audio_mixer_play_mod(
       goto error;
    }
 
-   if (voice->types.mod.module)
-      dispose_module(voice->types.mod.module);
-
-   voice->types.mod.module = module;
-
    replay = new_replay(module, s_rate, 1);
 
    if (!replay)
@@ -612,8 +1283,9 @@ static bool audio_mixer_play_mod(
 
    buf_samples = calculate_mix_buf_len(s_rate);
    mod_buffer  = memalign_alloc(16, ((buf_samples + 15) & ~15) * sizeof(int));
+   pcm_buffer  = memalign_alloc(16, ((buf_samples + 15) & ~15) * sizeof(float));
 
-   if (!mod_buffer)
+   if (!mod_buffer || !pcm_buffer)
    {
       printf("audio_mixer_play_mod cannot allocate mod_buffer !\n");
       goto error;
@@ -627,23 +1299,21 @@ static bool audio_mixer_play_mod(
       goto error;
    }
 
-   /* FIXME: stopping and then starting a mod stream will crash here in dispose_replay (ASAN says struct replay is misaligned?) */
-   if (voice->types.mod.stream)
-      dispose_replay(voice->types.mod.stream);
-   if (voice->types.mod.buffer)
-      memalign_free(voice->types.mod.buffer);
-
    voice->types.mod.buffer         = (int*)mod_buffer;
+   voice->types.mod.pcm_buffer     = (float*)pcm_buffer;
    voice->types.mod.buf_samples    = buf_samples;
    voice->types.mod.stream         = replay;
-   voice->types.mod.position       = 0;
-   voice->types.mod.samples        = 0; /* samples; */
+   voice->types.mod.module         = module;
 
    return true;
 
 error:
    if (mod_buffer)
       memalign_free(mod_buffer);
+   if (pcm_buffer)
+      memalign_free(pcm_buffer);
+   if (replay)
+      dispose_replay(replay);
    if (module)
       dispose_module(module);
    return false;
@@ -654,19 +1324,28 @@ error:
 #ifdef HAVE_DR_FLAC
 static bool audio_mixer_play_flac(
       audio_mixer_sound_t* sound,
-      audio_mixer_voice_t* voice,
-      bool repeat, float volume,
-      audio_mixer_stop_cb_t stop_cb)
+      audio_mixer_voice_t* voice)
 {
    float ratio                     = 1.0f;
    unsigned samples                = 0;
    void *flac_buffer                = NULL;
    void *resampler_data            = NULL;
    const retro_resampler_t* resamp = NULL;
-   drflac *dr_flac          = drflac_open_memory((const unsigned char*)sound->types.flac.data,sound->types.flac.size);
+   drflac *dr_flac                 = NULL;
+
+   if (sound->types.flac.path)
+   {
+      if (!(voice->file = audio_mixer_file_open(sound->types.flac.path)))
+         return false;
+
+      dr_flac = drflac_open(audio_mixer_file_read,
+            audio_mixer_flac_seek, voice->file);
+   }
+   else
+      dr_flac = drflac_open_memory((const unsigned char*)sound->types.flac.data,sound->types.flac.size);
 
    if (!dr_flac)
-      return false;
+      goto error_file;
    if (dr_flac->sampleRate != s_rate)
    {
       ratio = (double)s_rate / (double)(dr_flac->sampleRate);
@@ -675,39 +1354,32 @@ static bool audio_mixer_play_flac(
                &resamp, NULL, RESAMPLER_QUALITY_DONTCARE,
                ratio))
          goto error;
-   }
 
-   samples                         = (unsigned)(AUDIO_MIXER_TEMP_BUFFER * ratio);
-   flac_buffer                      = (float*)memalign_alloc(16,
-         ((samples + 15) & ~15) * sizeof(float));
+      samples                      = (unsigned)(AUDIO_MIXER_TEMP_BUFFER * ratio) + 4;
+      flac_buffer                  = (float*)memalign_alloc(16,
+            ((samples + 15) & ~15) * sizeof(float));
 
-   if (!flac_buffer)
-   {
-      if (resamp && resamp->free)
+      if (!flac_buffer)
+      {
          resamp->free(resampler_data);
-      goto error;
+         goto error;
+      }
    }
 
-   if (voice->types.flac.stream)
-      drflac_close(voice->types.flac.stream);
-   if (voice->types.flac.resampler && voice->types.flac.resampler_data)
-      voice->types.flac.resampler->free(voice->types.flac.resampler_data);
-   if (voice->types.flac.buffer)
-      memalign_free(voice->types.flac.buffer);
-
    voice->types.flac.resampler      = resamp;
    voice->types.flac.resampler_data = resampler_data;
    voice->types.flac.buffer         = (float*)flac_buffer;
    voice->types.flac.buf_samples    = samples;
    voice->types.flac.ratio          = ratio;
    voice->types.flac.stream         = dr_flac;
-   voice->types.flac.position       = 0;
-   voice->types.flac.samples        = 0;
 
    return true;
 
 error:
    drflac_close(dr_flac);
+error_file:
+   audio_mixer_file_free(voice->file);
+   voice->file = NULL;
    return false;
 }
 #endif
@@ -715,9 +1387,7 @@ error:
 #ifdef HAVE_DR_MP3
 static bool audio_mixer_play_mp3(
       audio_mixer_sound_t* sound,
-      audio_mixer_voice_t* voice,
-      bool repeat, float volume,
-      audio_mixer_stop_cb_t stop_cb)
+      audio_mixer_voice_t* voice)
 {
    float ratio                     = 1.0f;
    unsigned samples                = 0;
@@ -726,16 +1396,19 @@ static bool audio_mixer_play_mp3(
    const retro_resampler_t* resamp = NULL;
    bool res;
 
-   if (voice->types.mp3.stream.pData)
+   if (sound->types.mp3.path)
    {
-      drmp3_uninit(&voice->types.mp3.stream);
-      memset(&voice->types.mp3.stream, 0, sizeof(voice->types.mp3.stream));
-   }
+      if (!(voice->file = audio_mixer_file_open(sound->types.mp3.path)))
+         return false;
 
-   res = drmp3_init_memory(&voice->types.mp3.stream, (const unsigned char*)sound->types.mp3.data, sound->types.mp3.size, NULL);
+      res = drmp3_init(&voice->types.mp3.stream, audio_mixer_file_read,
+            audio_mixer_mp3_seek, voice->file, NULL);
+   }
+   else
+      res = drmp3_init_memory(&voice->types.mp3.stream, (const unsigned char*)sound->types.mp3.data, sound->types.mp3.size, NULL);
 
    if (!res)
-      return false;
+      goto error_file;
 
    if (voice->types.mp3.stream.sampleRate != s_rate)
    {
@@ -745,99 +1418,175 @@ static bool audio_mixer_play_mp3(
                &resamp, NULL, RESAMPLER_QUALITY_DONTCARE,
                ratio))
          goto error;
-   }
 
-   samples                         = (unsigned)(AUDIO_MIXER_TEMP_BUFFER * ratio);
-   mp3_buffer                      = (float*)memalign_alloc(16,
-         ((samples + 15) & ~15) * sizeof(float));
+      samples                      = (unsigned)(AUDIO_MIXER_TEMP_BUFFER * ratio) + 4;
+      mp3_buffer                   = (float*)memalign_alloc(16,
+            ((samples + 15) & ~15) * sizeof(float));
 
-   if (!mp3_buffer)
-   {
-      if (resamp && resampler_data)
+      if (!mp3_buffer)
+      {
          resamp->free(resampler_data);
-      goto error;
+         goto error;
+      }
    }
 
-   /* "system" menu sounds may reuse the same voice without freeing anything first, so do that here if needed */
-   if (voice->types.mp3.resampler && voice->types.mp3.resampler_data)
-      voice->types.mp3.resampler->free(voice->types.mp3.resampler_data);
-   if (voice->types.mp3.buffer)
-      memalign_free(voice->types.mp3.buffer);
-
    voice->types.mp3.resampler      = resamp;
    voice->types.mp3.resampler_data = resampler_data;
    voice->types.mp3.buffer         = (float*)mp3_buffer;
    voice->types.mp3.buf_samples    = samples;
    voice->types.mp3.ratio          = ratio;
-   voice->types.mp3.position       = 0;
-   voice->types.mp3.samples        = 0;
 
    return true;
 
 error:
    drmp3_uninit(&voice->types.mp3.stream);
+   memset(&voice->types.mp3.stream, 0, sizeof(voice->types.mp3.stream));
+error_file:
+   audio_mixer_file_free(voice->file);
+   voice->file = NULL;
    return false;
 }
 #endif
 
+static bool audio_mixer_voice_open(audio_mixer_sound_t* sound,
+      audio_mixer_voice_t* voice)
+{
+   switch (sound->type)
+   {
+      case AUDIO_MIXER_TYPE_WAV:
+         return true;
+      case AUDIO_MIXER_TYPE_OGG:
+#ifdef HAVE_STB_VORBIS
+         return audio_mixer_play_ogg(sound, voice);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MOD:
+#ifdef HAVE_IBXM
+         return audio_mixer_play_mod(sound, voice);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_FLAC:
+#ifdef HAVE_DR_FLAC
+         return audio_mixer_play_flac(sound, voice);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MP3:
+#ifdef HAVE_DR_MP3
+         return audio_mixer_play_mp3(sound, voice);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_NONE:
+         break;
+   }
+
+   return false;
+}
+
+#ifdef AUDIO_MIXER_DECODE_THREAD
+static bool audio_mixer_sound_is_streamed(const audio_mixer_sound_t *sound)
+{
+   switch (sound->type)
+   {
+      case AUDIO_MIXER_TYPE_FLAC:
+#ifdef HAVE_DR_FLAC
+         return sound->types.flac.path != NULL;
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MP3:
+#ifdef HAVE_DR_MP3
+         return sound->types.mp3.path != NULL;
+#endif
+         break;
+      default:
+         break;
+   }
+
+   return false;
+}
+
+/* Opens a streamed sound audio_mixer_play() left to the
+ * decoder thread. If that fails, the voice ends without
+ * playing anything and is reported finished. */
+static void audio_mixer_open_pending(audio_mixer_voice_t *voice)
+{
+   voice->pending = false;
+
+   if (audio_mixer_voice_open(voice->sound, voice))
+      voice->type = voice->sound->type;
+   else
+      AUDIO_MIXER_STORE(&voice->eos, 1);
+}
+#endif
+
 audio_mixer_voice_t* audio_mixer_play(audio_mixer_sound_t* sound, bool repeat,
       float volume, audio_mixer_stop_cb_t stop_cb)
 {
    unsigned i;
    bool res                   = false;
+   bool pending               = false;
    audio_mixer_voice_t* voice = s_voices;
 
    if (!sound)
       return NULL;
 
+   /* Keeps the decoder thread off the voice */
+   audio_mixer_lock();
+
    for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++, voice++)
    {
-      if (voice->type != AUDIO_MIXER_TYPE_NONE)
+      if (     !voice->ring
+            || AUDIO_MIXER_STATE_LOAD(&voice->state) != AUDIO_MIXER_VOICE_IDLE)
          continue;
 
-      switch (sound->type)
+      /* Left over from the last sound played on this voice */
+      audio_mixer_voice_free_codec(voice);
+
+#ifdef AUDIO_MIXER_DECODE_THREAD
+      /* Opening a streamed sound reads the file, so that and
+       * the first fill are left to the decoder thread. The
+       * voice stays silent until then. */
+      if (s_decoder_thread && audio_mixer_sound_is_streamed(sound))
       {
-         case AUDIO_MIXER_TYPE_WAV:
-            res = audio_mixer_play_wav(sound, voice, repeat, volume, stop_cb);
-            break;
-         case AUDIO_MIXER_TYPE_OGG:
-#ifdef HAVE_STB_VORBIS
-            res = audio_mixer_play_ogg(sound, voice, repeat, volume, stop_cb);
-#endif
-            break;
-         case AUDIO_MIXER_TYPE_MOD:
-#ifdef HAVE_IBXM
-            res = audio_mixer_play_mod(sound, voice, repeat, volume, stop_cb);
-#endif
-            break;
-         case AUDIO_MIXER_TYPE_FLAC:
-#ifdef HAVE_DR_FLAC
-            res = audio_mixer_play_flac(sound, voice, repeat, volume, stop_cb);
-#endif
-            break;
-         case AUDIO_MIXER_TYPE_MP3:
-#ifdef HAVE_DR_MP3
-            res = audio_mixer_play_mp3(sound, voice, repeat, volume, stop_cb);
-#endif
-            break;
-         case AUDIO_MIXER_TYPE_NONE:
-            break;
+         res     = true;
+         pending = true;
+         break;
       }
+#endif
 
+      res = audio_mixer_voice_open(sound, voice);
       break;
    }
 
    if (res)
    {
-      voice->type     = sound->type;
-      voice->repeat   = repeat;
-      voice->volume   = volume;
-      voice->sound    = sound;
-      voice->stop_cb  = stop_cb;
+      voice->type        = pending ? AUDIO_MIXER_TYPE_NONE : sound->type;
+      voice->repeat      = repeat;
+      voice->volume      = volume;
+      voice->sound       = sound;
+      voice->stop_cb     = stop_cb;
+      voice->pcm         = NULL;
+      voice->pcm_samples = 0;
+      voice->head        = 0;
+      voice->tail        = 0;
+      voice->eos         = 0;
+      voice->repeats     = 0;
+      voice->pending     = pending;
+
+      /* Have something to mix right away */
+      if (!pending)
+         audio_mixer_fill(voice);
+
+      AUDIO_MIXER_STATE_STORE(&voice->state, AUDIO_MIXER_VOICE_PLAYING);
+#ifdef AUDIO_MIXER_DECODE_THREAD
+      if (s_decoder_cond)
+         scond_signal(s_decoder_cond);
+#endif
    }
    else
       voice = NULL;
 
+   audio_mixer_unlock();
+
    return voice;
 }
 
@@ -848,395 +1597,182 @@ void audio_mixer_stop(audio_mixer_voice_t* voice)
 
    if (voice)
    {
+      audio_mixer_lock();
+
       stop_cb     = voice->stop_cb;
       sound       = voice->sound;
 
-      voice->type = AUDIO_MIXER_TYPE_NONE;
+      AUDIO_MIXER_STATE_STORE(&voice->state, AUDIO_MIXER_VOICE_IDLE);
+      audio_mixer_wait_mix();
+
+      audio_mixer_unlock();
 
       if (stop_cb)
          stop_cb(sound, AUDIO_MIXER_SOUND_STOPPED);
    }
 }
 
-static void audio_mixer_mix_wav(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
+static void audio_mixer_mix_voice(float* buffer, unsigned samples,
+      audio_mixer_voice_t* voice, float volume)
 {
-   int i;
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   const audio_mixer_sound_t* sound = voice->sound;
-   unsigned pcm_available           = sound->types.wav.frames
-      * 2 - voice->types.wav.position;
-   const float* pcm                 = sound->types.wav.pcm +
-      voice->types.wav.position;
-
-again:
-   if (pcm_available < buf_free)
-   {
-      for (i = pcm_available; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
-
-      if (voice->repeat)
-      {
-         if (voice->stop_cb)
-            voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-         buf_free                  -= pcm_available;
-         pcm_available              = sound->types.wav.frames * 2;
-         pcm                        = sound->types.wav.pcm;
-         voice->types.wav.position  = 0;
-         goto again;
-      }
-
-      if (voice->stop_cb)
-         voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-      voice->type = AUDIO_MIXER_TYPE_NONE;
-   }
-   else
-   {
-      for (i = buf_free; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
-
-      voice->types.wav.position += buf_free;
-   }
+   /* eos first: once set, head is final */
+   unsigned eos    = AUDIO_MIXER_LOAD(&voice->eos);
+   unsigned tail   = voice->tail;
+   unsigned avail  = AUDIO_MIXER_LOAD(&voice->head) - tail;
+   unsigned count  = avail < samples ? avail : samples;
+   unsigned offset = tail & (AUDIO_MIXER_RING_SAMPLES - 1);
+   unsigned first  = AUDIO_MIXER_RING_SAMPLES - offset;
+
+   if (first > count)
+      first = count;
+
+   /* Short of samples, the decoder fell behind: the voice
+    * just drops out for the rest of this call. */
+   audio_mix_volume(buffer, voice->ring + offset, volume, first);
+   if (count > first)
+      audio_mix_volume(buffer + first, voice->ring, volume, count - first);
+
+   AUDIO_MIXER_STORE(&voice->tail, tail + count);
+
+   /* Not over a concurrent audio_mixer_stop(), which has
+    * already delivered AUDIO_MIXER_SOUND_STOPPED. */
+   if (eos && count == avail)
+      audio_mixer_state_cas(&voice->state,
+            AUDIO_MIXER_VOICE_PLAYING, AUDIO_MIXER_VOICE_FINISHED);
 }
 
-#ifdef HAVE_STB_VORBIS
-static void audio_mixer_mix_ogg(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
+static void audio_mixer_clamp(float *buffer, size_t samples)
 {
-   int i;
-   float* temp_buffer = NULL;
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   unsigned temp_samples            = 0;
-   float* pcm                       = NULL;
-
-   if (voice->types.ogg.position == voice->types.ogg.samples)
-   {
-again:
-      if (temp_buffer == NULL)
-         temp_buffer = (float*)malloc(AUDIO_MIXER_TEMP_BUFFER * sizeof(float));
-
-      temp_samples = stb_vorbis_get_samples_float_interleaved(
-            voice->types.ogg.stream, 2, temp_buffer,
-            AUDIO_MIXER_TEMP_BUFFER) * 2;
-
-      if (temp_samples == 0)
-      {
-         if (voice->repeat)
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-            stb_vorbis_seek_start(voice->types.ogg.stream);
-            goto again;
-         }
-
-         if (voice->stop_cb)
-            voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-         voice->type = AUDIO_MIXER_TYPE_NONE;
-         goto cleanup;
-      }
-
-      if (voice->types.ogg.resampler)
-      {
-         struct resampler_data info;
-         info.data_in = temp_buffer;
-         info.data_out = voice->types.ogg.buffer;
-         info.input_frames = temp_samples / 2;
-         info.output_frames = 0;
-         info.ratio = voice->types.ogg.ratio;
-
-         voice->types.ogg.resampler->process(
-               voice->types.ogg.resampler_data, &info);
-      }
-      else
-         memcpy(voice->types.ogg.buffer, temp_buffer,
-               temp_samples * sizeof(float));
-
-      voice->types.ogg.position = 0;
-      voice->types.ogg.samples  = voice->types.ogg.buf_samples;
-   }
-
-   pcm = voice->types.ogg.buffer + voice->types.ogg.position;
+   size_t i = 0;
+#if defined(__SSE2__)
+   __m128 lo = _mm_set1_ps(-1.0f);
+   __m128 hi = _mm_set1_ps( 1.0f);
+
+   for (; i + 4 <= samples; i += 4)
+      _mm_storeu_ps(buffer + i,
+            _mm_min_ps(_mm_max_ps(_mm_loadu_ps(buffer + i), lo), hi));
+#elif defined(__ARM_NEON__) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
+   float32x4_t lo = vdupq_n_f32(-1.0f);
+   float32x4_t hi = vdupq_n_f32( 1.0f);
+
+   for (; i + 4 <= samples; i += 4)
+      vst1q_f32(buffer + i,
+            vminq_f32(vmaxq_f32(vld1q_f32(buffer + i), lo), hi));
+#endif
 
-   if (voice->types.ogg.samples < buf_free)
+   for (; i < samples; i++)
    {
-      for (i = voice->types.ogg.samples; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
-
-      buf_free -= voice->types.ogg.samples;
-      goto again;
+      if (buffer[i] < -1.0f)
+         buffer[i] = -1.0f;
+      else if (buffer[i] > 1.0f)
+         buffer[i] = 1.0f;
    }
-
-   for (i = buf_free; i != 0; --i )
-      *buffer++ += *pcm++ * volume;
-
-   voice->types.ogg.position += buf_free;
-   voice->types.ogg.samples  -= buf_free;
-
-cleanup:
-   if (temp_buffer != NULL)
-      free(temp_buffer);
 }
-#endif
 
-#ifdef HAVE_IBXM
-static void audio_mixer_mix_mod(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
+void audio_mixer_mix(float* buffer, size_t num_frames,
+      float volume_override, bool override)
 {
-   int i;
-   float samplef                    = 0.0f;
-   unsigned temp_samples            = 0;
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   int* pcm                         = NULL;
-
-   if (voice->types.mod.samples == 0)
-   {
-again:
-      temp_samples = replay_get_audio(
-            voice->types.mod.stream, voice->types.mod.buffer, 0 ) * 2;
-
-      if (temp_samples == 0)
-      {
-         if (voice->repeat)
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-            replay_seek( voice->types.mod.stream, 0);
-            goto again;
-         }
+   unsigned i;
+   bool decode                = true;
+   audio_mixer_voice_t* voice = s_voices;
 
-         if (voice->stop_cb)
-            voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
+#ifdef AUDIO_MIXER_DECODE_THREAD
+   decode                     = !s_decoder_thread;
+   __atomic_fetch_add(&s_mix_seq, 1, __ATOMIC_SEQ_CST);
+#endif
 
-         voice->type = AUDIO_MIXER_TYPE_NONE;
-         return;
-      }
+   for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++, voice++)
+   {
+      float volume   = (override) ? volume_override : voice->volume;
+      float *out     = buffer;
+      size_t samples = num_frames * 2;
 
-      voice->types.mod.position = 0;
-      voice->types.mod.samples  = temp_samples;
-   }
-   pcm = voice->types.mod.buffer + voice->types.mod.position;
+      if (AUDIO_MIXER_STATE_LOAD(&voice->state) != AUDIO_MIXER_VOICE_PLAYING)
+         continue;
 
-   if (voice->types.mod.samples < buf_free)
-   {
-      for (i = voice->types.mod.samples; i != 0; i--)
+      if (!decode)
       {
-         samplef     = ((float)(*pcm++) + 32768.0f) / 65535.0f;
-         samplef     = samplef * 2.0f - 1.0f;
-         *buffer++  += samplef * volume;
+         audio_mixer_mix_voice(out, (unsigned)samples, voice, volume);
+         continue;
       }
 
-      buf_free -= voice->types.mod.samples;
-      goto again;
-   }
-
-   for (i = buf_free; i != 0; --i )
-   {
-      samplef     = ((float)(*pcm++) + 32768.0f) / 65535.0f;
-      samplef     = samplef * 2.0f - 1.0f;
-      *buffer++  += samplef * volume;
-   }
-
-   voice->types.mod.position += buf_free;
-   voice->types.mod.samples  -= buf_free;
-}
-#endif
-
-#ifdef HAVE_DR_FLAC
-static void audio_mixer_mix_flac(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
-{
-   int i;
-   struct resampler_data info;
-   float temp_buffer[AUDIO_MIXER_TEMP_BUFFER] = { 0 };
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   unsigned temp_samples            = 0;
-   float *pcm                       = NULL;
-
-   if (voice->types.flac.position == voice->types.flac.samples)
-   {
-again:
-      temp_samples = (unsigned)drflac_read_f32( voice->types.flac.stream, AUDIO_MIXER_TEMP_BUFFER, temp_buffer);
-      if (temp_samples == 0)
+      /* Decoding here, a ring's worth at a time */
+      while (samples
+            && AUDIO_MIXER_STATE_LOAD(&voice->state) == AUDIO_MIXER_VOICE_PLAYING)
       {
-         if (voice->repeat)
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-            drflac_seek_to_sample(voice->types.flac.stream,0);
-            goto again;
-         }
+         unsigned count = samples < AUDIO_MIXER_RING_SAMPLES
+            ? (unsigned)samples : AUDIO_MIXER_RING_SAMPLES;
 
-         if (voice->stop_cb)
-            voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
+         audio_mixer_fill(voice);
+         audio_mixer_mix_voice(out, count, voice, volume);
 
-         voice->type = AUDIO_MIXER_TYPE_NONE;
-         return;
+         out     += count;
+         samples -= count;
       }
-
-      info.data_in              = temp_buffer;
-      info.data_out             = voice->types.flac.buffer;
-      info.input_frames         = temp_samples / 2;
-      info.output_frames        = 0;
-      info.ratio                = voice->types.flac.ratio;
-
-      if (voice->types.flac.resampler)
-         voice->types.flac.resampler->process(
-               voice->types.flac.resampler_data, &info);
-      else
-         memcpy(voice->types.flac.buffer, temp_buffer, temp_samples * sizeof(float));
-      voice->types.flac.position = 0;
-      voice->types.flac.samples  = voice->types.flac.buf_samples;
    }
 
-   pcm = voice->types.flac.buffer + voice->types.flac.position;
+   audio_mixer_clamp(buffer, num_frames * 2);
 
-   if (voice->types.flac.samples < buf_free)
-   {
-      for (i = voice->types.flac.samples; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
+#ifdef AUDIO_MIXER_DECODE_THREAD
+   __atomic_fetch_add(&s_mix_seq, 1, __ATOMIC_RELEASE);
+#endif
+}
 
-      buf_free -= voice->types.flac.samples;
-      goto again;
-   }
+bool audio_mixer_is_playing(void)
+{
+   unsigned i;
 
-   for (i = buf_free; i != 0; --i )
-      *buffer++ += *pcm++ * volume;
+   for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
+      if (AUDIO_MIXER_STATE_LOAD(&s_voices[i].state)
+            == AUDIO_MIXER_VOICE_PLAYING)
+         return true;
 
-   voice->types.flac.position += buf_free;
-   voice->types.flac.samples  -= buf_free;
+   return false;
 }
-#endif
 
-#ifdef HAVE_DR_MP3
-static void audio_mixer_mix_mp3(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
+void audio_mixer_update(void)
 {
-   int i;
-   struct resampler_data info;
-   float temp_buffer[AUDIO_MIXER_TEMP_BUFFER] = { 0 };
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   unsigned temp_samples            = 0;
-   float* pcm                       = NULL;
-
-   if (voice->types.mp3.position == voice->types.mp3.samples)
+   unsigned i;
+   audio_mixer_stop_cb_t stop_cb[AUDIO_MIXER_MAX_VOICES];
+   audio_mixer_sound_t *sound[AUDIO_MIXER_MAX_VOICES];
+   unsigned repeats[AUDIO_MIXER_MAX_VOICES];
+   bool finished[AUDIO_MIXER_MAX_VOICES];
+
+   /* Lock-free: called every frame, it mustn't wait on the
+    * decoder thread. A voice leaves FINISHED only through
+    * here or audio_mixer_stop(), and only one of the two
+    * gets to deliver its callback. */
+   for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
    {
-again:
-      temp_samples = (unsigned)drmp3_read_f32(
-            &voice->types.mp3.stream,
-            AUDIO_MIXER_TEMP_BUFFER / 2, temp_buffer) * 2;
+      audio_mixer_voice_t *voice = &s_voices[i];
+      unsigned state             = AUDIO_MIXER_STATE_LOAD(&voice->state);
 
-      if (temp_samples == 0)
-      {
-         if (voice->repeat)
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-            drmp3_seek_to_frame(&voice->types.mp3.stream,0);
-            goto again;
-         }
-
-         if (voice->stop_cb)
-            voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
+      stop_cb[i]  = voice->stop_cb;
+      sound[i]    = voice->sound;
+      repeats[i]  = 0;
+      finished[i] = false;
 
-         voice->type = AUDIO_MIXER_TYPE_NONE;
-         return;
-      }
-
-      info.data_in              = temp_buffer;
-      info.data_out             = voice->types.mp3.buffer;
-      info.input_frames         = temp_samples / 2;
-      info.output_frames        = 0;
-      info.ratio                = voice->types.mp3.ratio;
-
-      if (voice->types.mp3.resampler)
-         voice->types.mp3.resampler->process(
-               voice->types.mp3.resampler_data, &info);
-      else
-         memcpy(voice->types.mp3.buffer, temp_buffer,
-               temp_samples * sizeof(float));
-      voice->types.mp3.position = 0;
-      voice->types.mp3.samples  = voice->types.mp3.buf_samples;
-   }
+      if (state == AUDIO_MIXER_VOICE_IDLE)
+         continue;
 
-   pcm = voice->types.mp3.buffer + voice->types.mp3.position;
+      repeats[i]  = AUDIO_MIXER_TAKE(&voice->repeats);
 
-   if (voice->types.mp3.samples < buf_free)
-   {
-      for (i = voice->types.mp3.samples; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
-
-      buf_free -= voice->types.mp3.samples;
-      goto again;
+      if (state == AUDIO_MIXER_VOICE_FINISHED)
+         finished[i] = audio_mixer_state_cas(&voice->state,
+               AUDIO_MIXER_VOICE_FINISHED, AUDIO_MIXER_VOICE_IDLE);
    }
 
-   for (i = buf_free; i != 0; --i )
-      *buffer++ += *pcm++ * volume;
-
-   voice->types.mp3.position += buf_free;
-   voice->types.mp3.samples  -= buf_free;
-}
-#endif
-
-void audio_mixer_mix(float* buffer, size_t num_frames,
-      float volume_override, bool override)
-{
-   unsigned i;
-   size_t j                   = 0;
-   float* sample              = NULL;
-   audio_mixer_voice_t* voice = s_voices;
-
-   for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++, voice++)
+   /* The callbacks may play and stop sounds */
+   for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
    {
-      float volume = (override) ? volume_override : voice->volume;
+      if (!stop_cb[i])
+         continue;
 
-      switch (voice->type)
-      {
-         case AUDIO_MIXER_TYPE_WAV:
-            audio_mixer_mix_wav(buffer, num_frames, voice, volume);
-            break;
-         case AUDIO_MIXER_TYPE_OGG:
-#ifdef HAVE_STB_VORBIS
-            audio_mixer_mix_ogg(buffer, num_frames, voice, volume);
-#endif
-            break;
-         case AUDIO_MIXER_TYPE_MOD:
-#ifdef HAVE_IBXM
-            audio_mixer_mix_mod(buffer, num_frames, voice, volume);
-#endif
-            break;
-         case AUDIO_MIXER_TYPE_FLAC:
-#ifdef HAVE_DR_FLAC
-            audio_mixer_mix_flac(buffer, num_frames, voice, volume);
-#endif
-            break;
-            case AUDIO_MIXER_TYPE_MP3:
-#ifdef HAVE_DR_MP3
-            audio_mixer_mix_mp3(buffer, num_frames, voice, volume);
-#endif
-            break;
-         case AUDIO_MIXER_TYPE_NONE:
-            break;
-      }
-   }
+      while (repeats[i]--)
+         stop_cb[i](sound[i], AUDIO_MIXER_SOUND_REPEATED);
 
-   for (j = 0, sample = buffer; j < num_frames * 2; j++, sample++)
-   {
-      if (*sample < -1.0f)
-         *sample = -1.0f;
-      else if (*sample > 1.0f)
-         *sample = 1.0f;
+      if (finished[i])
+         stop_cb[i](sound[i], AUDIO_MIXER_SOUND_FINISHED);
    }
 }
 
@@ -0,0 +1,476 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (audio_timestretch.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Waveform-similarity overlap-add (WSOLA) time-stretching.
+ *
+ * Output is built from segments of 'seq' frames taken from the
+ * input, advancing through the input 'speed' times faster than
+ * through the output. Each segment starts at the offset within a
+ * 'seek' window that best matches the tail of the previous one,
+ * and the two are cross-faded over 'overlap' frames. Since only
+ * whole segments are copied, pitch is left untouched.
+ *
+ * Finished segments are queued and handed out at in_frames / speed
+ * per call, so the output is as evenly paced as the input. */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <boolean.h>
+
+#include <retro_environment.h>
+#include <retro_inline.h>
+#include <retro_miscellaneous.h>
+#include <memalign.h>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#include <audio/audio_timestretch.h>
+
+/* Segment and seek lengths scale with the speed, like SoundTouch
+ * does: long segments keep slow motion smooth, short ones keep
+ * fast-forward responsive. Both are in milliseconds. */
+#define TIMESTRETCH_OVERLAP_MS  8.0f
+#define TIMESTRETCH_SEQ_MAX_MS  ((float)RETRO_TIMESTRETCH_MAX_SEGMENT_MS)
+#define TIMESTRETCH_SEQ_MIN_MS  50.0f
+#define TIMESTRETCH_SEEK_MAX_MS 25.0f
+#define TIMESTRETCH_SEEK_MIN_MS 15.0f
+
+/* Coarse step of the offset search, refined around the best match. */
+#define TIMESTRETCH_SEEK_STEP   4
+
+struct retro_timestretch
+{
+   float *fifo;         /* Input not yet cut into segments. */
+   float *mid;          /* Tail of the last segment. */
+   float *queue;        /* Segments not yet handed out. */
+   size_t capacity;
+   size_t start;
+   size_t frames;
+   size_t queue_capacity;
+   size_t queue_start;
+   size_t queue_frames;
+   size_t skip_pending; /* Input to skip that hasn't arrived yet. */
+   double skip_fract;
+   double emit_fract;
+   unsigned overlap;
+   float sample_rate;
+   bool primed;
+   bool flowing;        /* Output has started. */
+};
+
+retro_timestretch_t *retro_timestretch_new(float sample_rate)
+{
+   size_t seq_max;
+   retro_timestretch_t *ts = NULL;
+
+   if (sample_rate <= 0.0f)
+      return NULL;
+
+   ts = (retro_timestretch_t*)calloc(1, sizeof(*ts));
+   if (!ts)
+      return NULL;
+
+   ts->sample_rate = sample_rate;
+   /* Even, so the overlap is a whole number of SIMD vectors. */
+   ts->overlap     = ((unsigned)(TIMESTRETCH_OVERLAP_MS
+            * sample_rate / 1000.0f) + 1) & ~1u;
+
+   /* The longest segment plus its seek window, with room for
+    * a batch of input on top. Skips past the end of the input
+    * are deferred rather than buffered, so the top speed
+    * doesn't matter here. */
+   seq_max            = (size_t)(TIMESTRETCH_SEQ_MAX_MS
+         * sample_rate / 1000.0f) + 1;
+   ts->capacity       = seq_max + (size_t)(TIMESTRETCH_SEEK_MAX_MS
+         * sample_rate / 1000.0f) + 4096;
+   ts->queue_capacity = seq_max * 2;
+
+   ts->fifo           = (float*)memalign_alloc(16,
+         ts->capacity * 2 * sizeof(float));
+   ts->queue          = (float*)memalign_alloc(16,
+         ts->queue_capacity * 2 * sizeof(float));
+   ts->mid            = (float*)memalign_alloc(16,
+         ts->overlap * 2 * sizeof(float));
+
+   if (!ts->fifo || !ts->queue || !ts->mid)
+   {
+      retro_timestretch_free(ts);
+      return NULL;
+   }
+
+   retro_timestretch_reset(ts);
+   return ts;
+}
+
+void retro_timestretch_free(retro_timestretch_t *ts)
+{
+   if (!ts)
+      return;
+
+   memalign_free(ts->fifo);
+   memalign_free(ts->queue);
+   memalign_free(ts->mid);
+   free(ts);
+}
+
+void retro_timestretch_reset(retro_timestretch_t *ts)
+{
+   if (!ts)
+      return;
+
+   ts->start        = 0;
+   ts->frames       = 0;
+   ts->queue_start  = 0;
+   ts->queue_frames = 0;
+   ts->skip_pending = 0;
+   ts->skip_fract   = 0.0;
+   ts->emit_fract   = 0.0;
+   ts->primed       = false;
+   ts->flowing      = false;
+   memset(ts->mid, 0, ts->overlap * 2 * sizeof(float));
+}
+
+/* Dot product of @ref and @x, plus the energy of @x,
+ * over @n floats (a multiple of 4). */
+static float timestretch_correlate(const float *ref,
+      const float *x, size_t n, float *energy)
+{
+   size_t i;
+#if defined(__SSE__)
+   float tmp[4];
+   __m128 sum = _mm_setzero_ps();
+   __m128 nrg = _mm_setzero_ps();
+
+   for (i = 0; i < n; i += 4)
+   {
+      __m128 r = _mm_load_ps(ref + i);
+      __m128 v = _mm_loadu_ps(x + i);
+      sum      = _mm_add_ps(sum, _mm_mul_ps(r, v));
+      nrg      = _mm_add_ps(nrg, _mm_mul_ps(v, v));
+   }
+
+   _mm_storeu_ps(tmp, nrg);
+   *energy  = tmp[0] + tmp[1] + tmp[2] + tmp[3];
+   _mm_storeu_ps(tmp, sum);
+   return tmp[0] + tmp[1] + tmp[2] + tmp[3];
+#else
+   float sum = 0.0f;
+   float nrg = 0.0f;
+
+   for (i = 0; i < n; i++)
+   {
+      sum += ref[i] * x[i];
+      nrg += x[i] * x[i];
+   }
+
+   *energy  = nrg;
+   return sum;
+#endif
+}
+
+static float timestretch_score(retro_timestretch_t *ts,
+      const float *src, unsigned offset)
+{
+   float energy;
+   float corr = timestretch_correlate(ts->mid, src + offset * 2,
+         ts->overlap * 2, &energy);
+   return corr / (float)sqrt(energy + 1e-9f);
+}
+
+/* Offset in [0, seek) where the input best continues the
+ * previous segment. */
+static unsigned timestretch_seek(retro_timestretch_t *ts,
+      const float *src, unsigned seek)
+{
+   unsigned i, lo, hi;
+   unsigned best    = 0;
+   float best_score = timestretch_score(ts, src, 0);
+
+   for (i = TIMESTRETCH_SEEK_STEP; i < seek; i += TIMESTRETCH_SEEK_STEP)
+   {
+      float score = timestretch_score(ts, src, i);
+      if (score > best_score)
+      {
+         best       = i;
+         best_score = score;
+      }
+   }
+
+   lo = best > TIMESTRETCH_SEEK_STEP ? best - TIMESTRETCH_SEEK_STEP + 1 : 0;
+   hi = best + TIMESTRETCH_SEEK_STEP;
+   if (hi > seek)
+      hi = seek;
+
+   for (i = lo; i < hi; i++)
+   {
+      float score;
+      if (i == best)
+         continue;
+      score = timestretch_score(ts, src, i);
+      if (score > best_score)
+      {
+         best       = i;
+         best_score = score;
+      }
+   }
+
+   return best;
+}
+
+/* Linear cross-fade from @a to @b over @frames stereo frames.
+ * @out may alias @b. */
+static void timestretch_crossfade(float *out, const float *a,
+      const float *b, unsigned frames)
+{
+   unsigned i = 0;
+   float step = 1.0f / frames;
+#if defined(__SSE__)
+   /* Two frames per vector, so the weights go w, w, w+step, w+step. */
+   __m128 w   = _mm_set_ps(step, step, 0.0f, 0.0f);
+   __m128 inc = _mm_set1_ps(2.0f * step);
+
+   for (; i + 2 <= frames; i += 2)
+   {
+      __m128 va = _mm_loadu_ps(a + i * 2);
+      __m128 vb = _mm_loadu_ps(b + i * 2);
+      _mm_storeu_ps(out + i * 2,
+            _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), w)));
+      w         = _mm_add_ps(w, inc);
+   }
+#endif
+   for (; i < frames; i++)
+   {
+      float w        = i * step;
+      out[2 * i + 0] = a[2 * i + 0] + (b[2 * i + 0] - a[2 * i + 0]) * w;
+      out[2 * i + 1] = a[2 * i + 1] + (b[2 * i + 1] - a[2 * i + 1]) * w;
+   }
+}
+
+/* Skips @frames of input, deferring whatever hasn't arrived yet. */
+static void timestretch_drop(retro_timestretch_t *ts, size_t frames)
+{
+   size_t now        = MIN(frames, ts->frames);
+
+   ts->start        += now;
+   ts->frames       -= now;
+   ts->skip_pending += frames - now;
+   if (!ts->frames)
+      ts->start      = 0;
+}
+
+static void timestretch_append(retro_timestretch_t *ts,
+      const float *in, size_t frames)
+{
+   if (ts->start + ts->frames + frames > ts->capacity)
+   {
+      memmove(ts->fifo, ts->fifo + ts->start * 2,
+            ts->frames * 2 * sizeof(float));
+      ts->start = 0;
+   }
+
+   memcpy(ts->fifo + (ts->start + ts->frames) * 2, in,
+         frames * 2 * sizeof(float));
+   ts->frames += frames;
+}
+
+/* Cuts the next segment out of the input and queues it. */
+static void timestretch_segment(retro_timestretch_t *ts,
+      unsigned seq, unsigned seek, double skip)
+{
+   unsigned offset;
+   size_t drop;
+   float *dst;
+   unsigned overlap = ts->overlap;
+   const float *src = ts->fifo + ts->start * 2;
+
+   if (ts->queue_start + ts->queue_frames + seq > ts->queue_capacity)
+   {
+      memmove(ts->queue, ts->queue + ts->queue_start * 2,
+            ts->queue_frames * 2 * sizeof(float));
+      ts->queue_start = 0;
+   }
+
+   dst               = ts->queue + (ts->queue_start + ts->queue_frames) * 2;
+   offset            = timestretch_seek(ts, src, seek);
+   src              += offset * 2;
+
+   timestretch_crossfade(dst, ts->mid, src, overlap);
+   memcpy(dst + overlap * 2, src + overlap * 2,
+         (seq - 2 * overlap) * 2 * sizeof(float));
+   memcpy(ts->mid, src + (seq - overlap) * 2,
+         overlap * 2 * sizeof(float));
+   ts->queue_frames += seq - overlap;
+
+   ts->skip_fract   += skip;
+   drop              = (size_t)ts->skip_fract;
+   ts->skip_fract   -= drop;
+   timestretch_drop(ts, drop);
+}
+
+/* Hands out queued output the caller is owed. */
+static size_t timestretch_emit(retro_timestretch_t *ts,
+      float *out, size_t out_frames)
+{
+   size_t frames;
+
+   if (ts->emit_fract < 1.0)
+      return 0;
+
+   frames            = MIN(MIN((size_t)ts->emit_fract,
+            ts->queue_frames), out_frames);
+
+   memcpy(out, ts->queue + ts->queue_start * 2,
+         frames * 2 * sizeof(float));
+   ts->queue_start  += frames;
+   ts->queue_frames -= frames;
+   ts->emit_fract   -= frames;
+   if (!ts->queue_frames)
+      ts->queue_start = 0;
+
+   return frames;
+}
+
+void retro_timestretch_drain(retro_timestretch_t *ts,
+      float *data, size_t frames)
+{
+   if (!ts)
+      return;
+
+   /* Continue from whatever would have been played next. */
+   if (ts->queue_frames >= ts->overlap)
+      timestretch_crossfade(data, ts->queue + ts->queue_start * 2, data,
+            (unsigned)MIN(frames, ts->overlap));
+   else if (ts->primed && frames)
+      timestretch_crossfade(data, ts->mid, data,
+            (unsigned)MIN(frames, ts->overlap));
+
+   retro_timestretch_reset(ts);
+}
+
+size_t retro_timestretch_process(retro_timestretch_t *ts,
+      const float *in, size_t in_frames, float speed,
+      float *out, size_t out_frames)
+{
+   unsigned seq, seek, overlap;
+   double skip, owed;
+   float t;
+   size_t written = 0;
+
+   if (speed < RETRO_TIMESTRETCH_MIN_SPEED)
+      speed = RETRO_TIMESTRETCH_MIN_SPEED;
+   else if (speed > RETRO_TIMESTRETCH_MAX_SPEED)
+      speed = RETRO_TIMESTRETCH_MAX_SPEED;
+
+   /* 0 at half speed and below, 1 at double speed and above. */
+   t        = (speed - 0.5f) / 1.5f;
+   if (t < 0.0f)
+      t     = 0.0f;
+   else if (t > 1.0f)
+      t     = 1.0f;
+
+   overlap  = ts->overlap;
+   seq      = (unsigned)((TIMESTRETCH_SEQ_MAX_MS
+            + (TIMESTRETCH_SEQ_MIN_MS - TIMESTRETCH_SEQ_MAX_MS) * t)
+         * ts->sample_rate / 1000.0f);
+   seek     = (unsigned)((TIMESTRETCH_SEEK_MAX_MS
+            + (TIMESTRETCH_SEEK_MIN_MS - TIMESTRETCH_SEEK_MAX_MS) * t)
+         * ts->sample_rate / 1000.0f);
+   if (seq < 2 * overlap)
+      seq   = 2 * overlap;
+   if (seek < 1)
+      seek  = 1;
+   skip     = speed * (double)(seq - overlap);
+
+   /* What the caller is owed for this input, counted from the
+    * first queued segment so that one segment of latency absorbs
+    * the gaps between segments. A shortfall is made up later, up
+    * to a segment's worth. */
+   owed            = in_frames / speed;
+   if (ts->flowing)
+   {
+      ts->emit_fract += owed;
+      if (ts->emit_fract > owed + seq)
+         ts->emit_fract = owed + seq;
+   }
+
+   for (;;)
+   {
+      size_t room;
+
+      while (ts->frames >= seek + seq)
+      {
+         if (ts->queue_capacity - ts->queue_frames < seq)
+         {
+            written += timestretch_emit(ts, out + written * 2,
+                  out_frames - written);
+            if (ts->queue_capacity - ts->queue_frames < seq)
+               break;
+         }
+         timestretch_segment(ts, seq, seek, skip);
+      }
+
+      if (!in_frames)
+         break;
+
+      /* Start from the incoming audio itself, so the first
+       * segment continues whatever was played before. */
+      if (!ts->primed)
+      {
+         memcpy(ts->mid, in, MIN(in_frames, overlap) * 2 * sizeof(float));
+         ts->primed = true;
+      }
+
+      if (ts->skip_pending)
+      {
+         size_t skipped    = MIN(ts->skip_pending, in_frames);
+         in               += skipped * 2;
+         in_frames        -= skipped;
+         ts->skip_pending -= skipped;
+         continue;
+      }
+
+      /* Only happens when the caller stops taking output;
+       * keep the most recent audio. */
+      if (ts->frames == ts->capacity)
+         timestretch_drop(ts, MIN(in_frames, ts->frames));
+
+      room = MIN(ts->capacity - ts->frames, in_frames);
+      timestretch_append(ts, in, room);
+      in        += room * 2;
+      in_frames -= room;
+   }
+
+   if (!ts->flowing && ts->queue_frames)
+   {
+      /* Hold back a little extra for the calls that land
+       * between segments. */
+      ts->emit_fract = -2.0 * overlap;
+      ts->flowing    = true;
+   }
+
+   return written + timestretch_emit(ts, out + written * 2,
+         out_frames - written);
+}
@@ -22,7 +22,9 @@
 
 #include <stdlib.h>
 
+#include <boolean.h>
 #include <retro_miscellaneous.h>
+#include <memalign.h>
 
 #include <compat/posix_string.h>
 #include <dynamic/dylib.h>
@@ -36,6 +38,10 @@
 
 #include <audio/dsp_filter.h>
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
 struct retro_dsp_plug
 {
 #ifdef HAVE_DYLIB
@@ -48,12 +54,18 @@ struct retro_dsp_instance
 {
    const struct dspfilter_implementation *impl;
    void *impl_data;
+   /* Runs process_block() rather than process(). */
+   bool block;
 };
 
 struct retro_dsp_filter
 {
    config_file_t *conf;
 
+   /* Planar scratch for block filters, one
+    * DSPFILTER_BLOCK_FRAMES channel after the other. */
+   float *planar;
+
    struct retro_dsp_plug *plugs;
    unsigned num_plugs;
 
@@ -88,6 +100,8 @@ static bool create_filter_graph(retro_dsp_filter_t *dsp, float sample_rate)
    unsigned i;
    struct retro_dsp_instance *instances = NULL;
    unsigned filters                     = 0;
+   dspfilter_simd_mask_t mask           =
+      (dspfilter_simd_mask_t)cpu_features_get();
 
    if (!config_get_uint(dsp->conf, "filters", &filters))
       return false;
@@ -128,6 +142,20 @@ static bool create_filter_graph(retro_dsp_filter_t *dsp, float sample_rate)
             &dspfilter_config, &userdata);
       if (!dsp->instances[i].impl_data)
          return false;
+
+      dsp->instances[i].block =
+            dsp->instances[i].impl->api_version >= DSPFILTER_API_VERSION_BLOCK
+         && dsp->instances[i].impl->process_block
+         && (dsp->instances[i].impl->simd & mask)
+            == dsp->instances[i].impl->simd;
+
+      if (dsp->instances[i].block && !dsp->planar)
+      {
+         dsp->planar = (float*)memalign_alloc(DSPFILTER_BLOCK_ALIGN,
+               2 * DSPFILTER_BLOCK_FRAMES * sizeof(float));
+         if (!dsp->planar)
+            return false;
+      }
    }
 
    return true;
@@ -206,7 +234,8 @@ static bool append_plugs(retro_dsp_filter_t *dsp, struct string_list *list)
          continue;
       }
 
-      if (impl->api_version != DSPFILTER_API_VERSION)
+      if (     impl->api_version != DSPFILTER_API_VERSION
+            && impl->api_version != DSPFILTER_API_VERSION_BLOCK)
       {
          dylib_close(lib);
          continue;
@@ -298,9 +327,80 @@ void retro_dsp_filter_free(retro_dsp_filter_t *dsp)
    if (dsp->conf)
       config_file_free(dsp->conf);
 
+   memalign_free(dsp->planar);
    free(dsp);
 }
 
+static void dsp_filter_deinterleave(float *left, float *right,
+      const float *in, unsigned frames)
+{
+   unsigned i = 0;
+#if defined(__SSE__)
+   for (; i + 4 <= frames; i += 4)
+   {
+      __m128 a = _mm_loadu_ps(in + 2 * i + 0);
+      __m128 b = _mm_loadu_ps(in + 2 * i + 4);
+      _mm_store_ps(left  + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+      _mm_store_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+   }
+#endif
+   for (; i < frames; i++)
+   {
+      left[i]  = in[2 * i + 0];
+      right[i] = in[2 * i + 1];
+   }
+}
+
+static void dsp_filter_interleave(float *out,
+      const float *left, const float *right, unsigned frames)
+{
+   unsigned i = 0;
+#if defined(__SSE__)
+   for (; i + 4 <= frames; i += 4)
+   {
+      __m128 l = _mm_load_ps(left  + i);
+      __m128 r = _mm_load_ps(right + i);
+      _mm_storeu_ps(out + 2 * i + 0, _mm_unpacklo_ps(l, r));
+      _mm_storeu_ps(out + 2 * i + 4, _mm_unpackhi_ps(l, r));
+   }
+#endif
+   for (; i < frames; i++)
+   {
+      out[2 * i + 0] = left[i];
+      out[2 * i + 1] = right[i];
+   }
+}
+
+/* Runs the block filters in [first, last) over @samples in place,
+ * converting to planar once for the whole run. */
+static void dsp_filter_process_blocks(retro_dsp_filter_t *dsp,
+      unsigned first, unsigned last, float *samples, unsigned frames)
+{
+   struct dspfilter_block block;
+
+   block.channels[0] = dsp->planar;
+   block.channels[1] = dsp->planar + DSPFILTER_BLOCK_FRAMES;
+
+   while (frames)
+   {
+      unsigned i;
+
+      block.frames = MIN(frames, DSPFILTER_BLOCK_FRAMES);
+      dsp_filter_deinterleave(block.channels[0], block.channels[1],
+            samples, block.frames);
+
+      for (i = first; i < last; i++)
+         dsp->instances[i].impl->process_block(
+               dsp->instances[i].impl_data, &block);
+
+      dsp_filter_interleave(samples,
+            block.channels[0], block.channels[1], block.frames);
+
+      samples += block.frames * 2;
+      frames  -= block.frames;
+   }
+}
+
 void retro_dsp_filter_process(retro_dsp_filter_t *dsp,
       struct retro_dsp_data *data)
 {
@@ -311,12 +411,27 @@ void retro_dsp_filter_process(retro_dsp_filter_t *dsp,
    output.samples = data->input;
    output.frames  = data->input_frames;
 
-   for (i = 0; i < dsp->num_instances; i++)
+   for (i = 0; i < dsp->num_instances; )
    {
+      /* Chain consecutive block filters, so the audio
+       * is only made planar once per run. */
+      if (dsp->instances[i].block)
+      {
+         unsigned last = i + 1;
+         while (last < dsp->num_instances && dsp->instances[last].block)
+            last++;
+
+         dsp_filter_process_blocks(dsp, i, last,
+               output.samples, output.frames);
+         i = last;
+         continue;
+      }
+
       input.samples = output.samples;
       input.frames  = output.frames;
       dsp->instances[i].impl->process(
             dsp->instances[i].impl_data, &output, &input);
+      i++;
    }
 
    data->output        = output.samples;
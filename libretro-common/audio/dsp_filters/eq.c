@@ -29,6 +29,13 @@
 #include <filters.h>
 #include <libretro_dspfilter.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define EQ_BLOCK_SIMD DSPFILTER_SIMD_SSE2
+#else
+#define EQ_BLOCK_SIMD 0
+#endif
+
 #include "fft/fft.c"
 
 struct eq_data
@@ -40,6 +47,8 @@ struct eq_data
    float *block;
    fft_complex_t *filter;
    fft_complex_t *fftblock;
+   /* Block kernel output, delayed by one block. */
+   fft_complex_t *block_out;
    unsigned block_size;
    unsigned block_ptr;
 };
@@ -60,6 +69,7 @@ static void eq_free(void *data)
    free(eq->save);
    free(eq->block);
    free(eq->fftblock);
+   free(eq->block_out);
    free(eq->filter);
    free(eq);
 }
@@ -119,6 +129,101 @@ static void eq_process(void *data, struct dspfilter_output *output,
    }
 }
 
+static void eq_complex_mul(fft_complex_t *a, const fft_complex_t *b,
+      unsigned samples)
+{
+   unsigned i = 0;
+#if defined(__SSE2__)
+   __m128 sign = _mm_set_ps(1.0f, -1.0f, 1.0f, -1.0f);
+
+   for (; i + 2 <= samples; i += 2)
+   {
+      __m128 va   = _mm_loadu_ps(&a[i].real);
+      __m128 vb   = _mm_loadu_ps(&b[i].real);
+      __m128 re   = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(2, 2, 0, 0));
+      __m128 im   = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(3, 3, 1, 1));
+      __m128 swap = _mm_shuffle_ps(va, va, _MM_SHUFFLE(2, 3, 0, 1));
+      _mm_storeu_ps(&a[i].real, _mm_add_ps(_mm_mul_ps(va, re),
+               _mm_mul_ps(_mm_mul_ps(swap, im), sign)));
+   }
+#endif
+   for (; i < samples; i++)
+      a[i] = fft_complex_mul(a[i], b[i]);
+}
+
+/* The filter is real, so both channels go through a single
+ * complex FFT, left as the real part and right as the imaginary
+ * part, and come out of the inverse FFT the same way. */
+static void eq_convolve_block(struct eq_data *eq)
+{
+   unsigned i;
+   float *out  = &eq->block_out[0].real;
+   float *save = eq->save;
+
+   fft_process_forward_complex(eq->fft, eq->fftblock,
+         (const fft_complex_t*)eq->block, 1);
+   eq_complex_mul(eq->fftblock, eq->filter, 2 * eq->block_size);
+   fft_process_inverse_complex(eq->fft, eq->block_out, eq->fftblock, 1);
+
+   /* Overlap add method, so add in saved block now. */
+   for (i = 0; i < 2 * eq->block_size; i++)
+      out[i] += save[i];
+
+   /* Save block for later. */
+   memcpy(save, out + 2 * eq->block_size,
+         2 * eq->block_size * sizeof(float));
+}
+
+static void eq_process_block(void *data, struct dspfilter_block *block)
+{
+   struct eq_data *eq = (struct eq_data*)data;
+   float *left        = block->channels[0];
+   float *right       = block->channels[1];
+   unsigned frames    = block->frames;
+
+   while (frames)
+   {
+      unsigned i         = 0;
+      unsigned n         = MIN(frames, eq->block_size - eq->block_ptr);
+      float *in          = eq->block + eq->block_ptr * 2;
+      const float *out   = &eq->block_out[eq->block_ptr].real;
+
+      /* Queue the input, and hand out the last block's output
+       * in its place. */
+#if defined(__SSE2__)
+      for (; i + 4 <= n; i += 4)
+      {
+         __m128 l = _mm_loadu_ps(left  + i);
+         __m128 r = _mm_loadu_ps(right + i);
+         __m128 a = _mm_loadu_ps(out + 2 * i + 0);
+         __m128 b = _mm_loadu_ps(out + 2 * i + 4);
+         _mm_storeu_ps(in + 2 * i + 0, _mm_unpacklo_ps(l, r));
+         _mm_storeu_ps(in + 2 * i + 4, _mm_unpackhi_ps(l, r));
+         _mm_storeu_ps(left  + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+         _mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+      }
+#endif
+      for (; i < n; i++)
+      {
+         in[2 * i + 0] = left[i];
+         in[2 * i + 1] = right[i];
+         left[i]       = out[2 * i + 0];
+         right[i]      = out[2 * i + 1];
+      }
+
+      left          += n;
+      right         += n;
+      frames        -= n;
+      eq->block_ptr += n;
+
+      if (eq->block_ptr == eq->block_size)
+      {
+         eq_convolve_block(eq);
+         eq->block_ptr = 0;
+      }
+   }
+}
+
 static int gains_cmp(const void *a_, const void *b_)
 {
    const struct eq_gain *a = (const struct eq_gain*)a_;
@@ -303,17 +408,19 @@ static void *eq_init(const struct dspfilter_info *info,
 
    eq->block_size = size;
 
-   eq->save     = (float*)calloc(    size, 2 * sizeof(*eq->save));
-   eq->block    = (float*)calloc(2 * size, 2 * sizeof(*eq->block));
-   eq->fftblock = (fft_complex_t*)calloc(2 * size, sizeof(*eq->fftblock));
-   eq->filter   = (fft_complex_t*)calloc(2 * size, sizeof(*eq->filter));
+   eq->save      = (float*)calloc(    size, 2 * sizeof(*eq->save));
+   eq->block     = (float*)calloc(2 * size, 2 * sizeof(*eq->block));
+   eq->fftblock  = (fft_complex_t*)calloc(2 * size, sizeof(*eq->fftblock));
+   eq->filter    = (fft_complex_t*)calloc(2 * size, sizeof(*eq->filter));
+   eq->block_out = (fft_complex_t*)calloc(2 * size, sizeof(*eq->block_out));
 
    /* Use an FFT which is twice the block size with zero-padding
     * to make circular convolution => proper convolution.
     */
    eq->fft = fft_new(size_log2 + 1);
 
-   if (!eq->fft || !eq->fftblock || !eq->save || !eq->block || !eq->filter)
+   if (     !eq->fft || !eq->fftblock || !eq->save || !eq->block
+         || !eq->filter || !eq->block_out)
       goto error;
 
    create_filter(eq, size_log2, gains, num_gain, beta, filter_path);
@@ -334,9 +441,12 @@ static const struct dspfilter_implementation eq_plug = {
    eq_process,
    eq_free,
 
-   DSPFILTER_API_VERSION,
+   DSPFILTER_API_VERSION_BLOCK,
    "Linear-Phase FFT Equalizer",
    "eq",
+
+   eq_process_block,
+   EQ_BLOCK_SIMD,
 };
 
 #ifdef HAVE_FILTERS_BUILTIN
@@ -28,6 +28,13 @@
 #include <libretro_dspfilter.h>
 #include <string/stdstring.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define IIR_BLOCK_SIMD DSPFILTER_SIMD_SSE2
+#else
+#define IIR_BLOCK_SIMD 0
+#endif
+
 #define sqr(a) ((a) * (a))
 
 /* filter types */
@@ -47,16 +54,27 @@ enum IIRFilter
    RIAA_CD     /* CD de-emphasis */
 };
 
+struct iir_state
+{
+   float xn1, xn2;
+   float yn1, yn2;
+};
+
 struct iir_data
 {
    float b0, b1, b2;
    float a0, a1, a2;
 
-   struct
-   {
-      float xn1, xn2;
-      float yn1, yn2;
-   } l, r;
+   /* Block kernel coefficients, normalized by a0.
+    * Over four outputs the feedback unrolls into the
+    * impulse response 'h' applied to the feed-forward
+    * terms, plus the response 'c1', 'c2' to the last
+    * two outputs of the previous four. */
+   float nb0, nb1, nb2;
+   float na1, na2;
+   float h[4], c1[4], c2[4];
+
+   struct iir_state l, r;
 };
 
 static void iir_free(void *data)
@@ -124,6 +142,91 @@ static void iir_process(void *data, struct dspfilter_output *output,
    iir->r.yn2 = yn2_r;
 }
 
+static void iir_process_channel(const struct iir_data *iir,
+      struct iir_state *state, float *samples, unsigned frames)
+{
+   unsigned i   = 0;
+   float b0     = iir->nb0;
+   float b1     = iir->nb1;
+   float b2     = iir->nb2;
+   float a1     = iir->na1;
+   float a2     = iir->na2;
+   float xn1    = state->xn1;
+   float xn2    = state->xn2;
+   float yn1    = state->yn1;
+   float yn2    = state->yn2;
+#if defined(__SSE2__)
+   __m128 vb0   = _mm_set1_ps(b0);
+   __m128 vb1   = _mm_set1_ps(b1);
+   __m128 vb2   = _mm_set1_ps(b2);
+   __m128 h1    = _mm_set1_ps(iir->h[1]);
+   __m128 h2    = _mm_set1_ps(iir->h[2]);
+   __m128 h3    = _mm_set1_ps(iir->h[3]);
+   __m128 c1    = _mm_loadu_ps(iir->c1);
+   __m128 c2    = _mm_loadu_ps(iir->c2);
+   __m128 xprev = _mm_set_ps(xn1, xn2, 0.0f, 0.0f);
+   __m128 y1    = _mm_set1_ps(yn1);
+   __m128 y2    = _mm_set1_ps(yn2);
+
+   for (; i + 4 <= frames; i += 4)
+   {
+      __m128 x   = _mm_load_ps(samples + i);
+      /* x[n - 1] and x[n - 2] for the four lanes. */
+      __m128 xm1 = _mm_shuffle_ps(
+            _mm_shuffle_ps(xprev, x, _MM_SHUFFLE(0, 0, 3, 3)),
+            x, _MM_SHUFFLE(2, 1, 2, 0));
+      __m128 xm2 = _mm_shuffle_ps(xprev, x, _MM_SHUFFLE(1, 0, 3, 2));
+      __m128 f   = _mm_add_ps(_mm_mul_ps(vb0, x),
+            _mm_add_ps(_mm_mul_ps(vb1, xm1), _mm_mul_ps(vb2, xm2)));
+      __m128i fi = _mm_castps_si128(f);
+      __m128 y   = _mm_add_ps(
+            _mm_add_ps(f,
+               _mm_mul_ps(h1, _mm_castsi128_ps(_mm_slli_si128(fi, 4)))),
+            _mm_add_ps(
+               _mm_mul_ps(h2, _mm_castsi128_ps(_mm_slli_si128(fi, 8))),
+               _mm_mul_ps(h3, _mm_castsi128_ps(_mm_slli_si128(fi, 12)))));
+
+      y          = _mm_add_ps(y,
+            _mm_add_ps(_mm_mul_ps(c1, y1), _mm_mul_ps(c2, y2)));
+      _mm_store_ps(samples + i, y);
+
+      y1         = _mm_shuffle_ps(y, y, _MM_SHUFFLE(3, 3, 3, 3));
+      y2         = _mm_shuffle_ps(y, y, _MM_SHUFFLE(2, 2, 2, 2));
+      xprev      = x;
+   }
+
+   xn1 = _mm_cvtss_f32(_mm_shuffle_ps(xprev, xprev, _MM_SHUFFLE(3, 3, 3, 3)));
+   xn2 = _mm_cvtss_f32(_mm_shuffle_ps(xprev, xprev, _MM_SHUFFLE(2, 2, 2, 2)));
+   yn1 = _mm_cvtss_f32(y1);
+   yn2 = _mm_cvtss_f32(y2);
+#endif
+
+   for (; i < frames; i++)
+   {
+      float x    = samples[i];
+      float y    = b0 * x + b1 * xn1 + b2 * xn2 - a1 * yn1 - a2 * yn2;
+
+      xn2        = xn1;
+      xn1        = x;
+      yn2        = yn1;
+      yn1        = y;
+      samples[i] = y;
+   }
+
+   state->xn1 = xn1;
+   state->xn2 = xn2;
+   state->yn1 = yn1;
+   state->yn2 = yn2;
+}
+
+static void iir_process_block(void *data, struct dspfilter_block *block)
+{
+   struct iir_data *iir = (struct iir_data*)data;
+
+   iir_process_channel(iir, &iir->l, block->channels[0], block->frames);
+   iir_process_channel(iir, &iir->r, block->channels[1], block->frames);
+}
+
 #define CHECK(x) if (string_is_equal(str, #x)) return x
 static enum IIRFilter str_to_type(const char *str)
 {
@@ -157,6 +260,45 @@ static void make_poly_from_roots(
          poly[j] -= poly[j - 1] * roots[i];
 }
 
+static void iir_block_init(struct iir_data *iir)
+{
+   unsigned k;
+   double a1 = iir->a1 / iir->a0;
+   double a2 = iir->a2 / iir->a0;
+   /* Responses at n - 2, n - 1 and n: the impulse, and the
+    * initial conditions y[-1] = 1 and y[-2] = 1. */
+   double h[3]  = { 0.0, 0.0, 1.0 };
+   double c1[3] = { 0.0, 1.0, 0.0 };
+   double c2[3] = { 1.0, 0.0, 0.0 };
+
+   iir->nb0 = iir->b0 / iir->a0;
+   iir->nb1 = iir->b1 / iir->a0;
+   iir->nb2 = iir->b2 / iir->a0;
+   iir->na1 = (float)a1;
+   iir->na2 = (float)a2;
+
+   iir->h[0] = 1.0f;
+   for (k = 1; k < 4; k++)
+   {
+      h[0]      = h[1];
+      h[1]      = h[2];
+      h[2]      = -a1 * h[1] - a2 * h[0];
+      iir->h[k] = (float)h[2];
+   }
+
+   for (k = 0; k < 4; k++)
+   {
+      c1[2]      = -a1 * c1[1] - a2 * c1[0];
+      c2[2]      = -a1 * c2[1] - a2 * c2[0];
+      iir->c1[k] = (float)c1[2];
+      iir->c2[k] = (float)c2[2];
+      c1[0]      = c1[1];
+      c1[1]      = c1[2];
+      c2[0]      = c2[1];
+      c2[1]      = c2[2];
+   }
+}
+
 static void iir_filter_init(struct iir_data *iir,
       float sample_rate, float freq, float qual, float gain, enum IIRFilter filter_type)
 {
@@ -323,6 +465,8 @@ static void iir_filter_init(struct iir_data *iir,
    iir->a0 = a0;
    iir->a1 = a1;
    iir->a2 = a2;
+
+   iir_block_init(iir);
 }
 
 static void *iir_init(const struct dspfilter_info *info,
@@ -353,9 +497,12 @@ static const struct dspfilter_implementation iir_plug = {
    iir_process,
    iir_free,
 
-   DSPFILTER_API_VERSION,
+   DSPFILTER_API_VERSION_BLOCK,
    "IIR",
    "iir",
+
+   iir_process_block,
+   IIR_BLOCK_SIMD,
 };
 
 #ifdef HAVE_FILTERS_BUILTIN
@@ -25,8 +25,16 @@
 #include <string.h>
 
 #include <retro_inline.h>
+#include <retro_miscellaneous.h>
 #include <libretro_dspfilter.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define REVERB_BLOCK_SIMD DSPFILTER_SIMD_SSE2
+#else
+#define REVERB_BLOCK_SIMD 0
+#endif
+
 struct comb
 {
    float *buffer;
@@ -73,6 +81,106 @@ static INLINE float allpass_process(struct allpass *a, float input)
    return output;
 }
 
+/* Block versions of the above. A comb or allpass only reads
+ * back what it wrote 'bufsize' samples ago, so any run that
+ * doesn't wrap around its buffer can be processed at once. */
+static void comb_process_block(struct comb *c, const float *input,
+      float *accum, unsigned frames)
+{
+   while (frames)
+   {
+      unsigned i       = 0;
+      unsigned n       = MIN(frames, c->bufsize - c->bufidx);
+      float *buf       = c->buffer + c->bufidx;
+      float store      = c->filterstore;
+#if defined(__SSE2__)
+      /* The damping low-pass unrolled over four samples. */
+      float d1         = c->damp1;
+      __m128 damp1     = _mm_set1_ps(d1);
+      __m128 damp1_2   = _mm_set1_ps(d1 * d1);
+      __m128 damp1_3   = _mm_set1_ps(d1 * d1 * d1);
+      __m128 decay     = _mm_set_ps(d1 * d1 * d1 * d1,
+            d1 * d1 * d1, d1 * d1, d1);
+      __m128 damp2     = _mm_set1_ps(c->damp2);
+      __m128 feedback  = _mm_set1_ps(c->feedback);
+      __m128 vstore    = _mm_set1_ps(store);
+
+      for (; i + 4 <= n; i += 4)
+      {
+         __m128 output = _mm_loadu_ps(buf + i);
+         __m128i t     = _mm_castps_si128(_mm_mul_ps(output, damp2));
+         __m128 filter = _mm_add_ps(
+               _mm_add_ps(_mm_castsi128_ps(t),
+                  _mm_mul_ps(damp1, _mm_castsi128_ps(_mm_slli_si128(t, 4)))),
+               _mm_add_ps(
+                  _mm_mul_ps(damp1_2, _mm_castsi128_ps(_mm_slli_si128(t, 8))),
+                  _mm_mul_ps(damp1_3, _mm_castsi128_ps(_mm_slli_si128(t, 12)))));
+
+         filter        = _mm_add_ps(filter, _mm_mul_ps(decay, vstore));
+         _mm_storeu_ps(buf + i, _mm_add_ps(_mm_loadu_ps(input + i),
+                  _mm_mul_ps(filter, feedback)));
+         _mm_storeu_ps(accum + i, _mm_add_ps(_mm_loadu_ps(accum + i), output));
+         vstore        = _mm_shuffle_ps(filter, filter, _MM_SHUFFLE(3, 3, 3, 3));
+      }
+
+      store            = _mm_cvtss_f32(vstore);
+#endif
+      for (; i < n; i++)
+      {
+         float output  = buf[i];
+         store         = (output * c->damp2) + (store * c->damp1);
+         buf[i]        = input[i] + (store * c->feedback);
+         accum[i]     += output;
+      }
+
+      c->filterstore   = store;
+      c->bufidx       += n;
+      if (c->bufidx >= c->bufsize)
+         c->bufidx     = 0;
+
+      input           += n;
+      accum           += n;
+      frames          -= n;
+   }
+}
+
+static void allpass_process_block(struct allpass *a, float *samples,
+      unsigned frames)
+{
+   while (frames)
+   {
+      unsigned i       = 0;
+      unsigned n       = MIN(frames, a->bufsize - a->bufidx);
+      float *buf       = a->buffer + a->bufidx;
+#if defined(__SSE2__)
+      __m128 feedback  = _mm_set1_ps(a->feedback);
+
+      for (; i + 4 <= n; i += 4)
+      {
+         __m128 input  = _mm_loadu_ps(samples + i);
+         __m128 bufout = _mm_loadu_ps(buf + i);
+         _mm_storeu_ps(buf + i,
+               _mm_add_ps(input, _mm_mul_ps(bufout, feedback)));
+         _mm_storeu_ps(samples + i, _mm_sub_ps(bufout, input));
+      }
+#endif
+      for (; i < n; i++)
+      {
+         float input   = samples[i];
+         float bufout  = buf[i];
+         buf[i]        = input + bufout * a->feedback;
+         samples[i]    = -input + bufout;
+      }
+
+      a->bufidx       += n;
+      if (a->bufidx >= a->bufsize)
+         a->bufidx     = 0;
+
+      samples         += n;
+      frames          -= n;
+   }
+}
+
 #define numcombs 8
 #define numallpasses 4
 static const float muted = 0;
@@ -123,6 +231,28 @@ static float revmodel_process(struct revmodel *rev, float in)
    return mono_in * rev->dry + mono_out * rev->wet1;
 }
 
+/* @input and @accum are scratch space of at least @frames. */
+static void revmodel_process_block(struct revmodel *rev, float *samples,
+      unsigned frames, float *input, float *accum)
+{
+   unsigned i;
+
+   for (i = 0; i < frames; i++)
+   {
+      input[i] = samples[i] * rev->gain;
+      accum[i] = 0.0f;
+   }
+
+   for (i = 0; i < numcombs; i++)
+      comb_process_block(&rev->combL[i], input, accum, frames);
+
+   for (i = 0; i < numallpasses; i++)
+      allpass_process_block(&rev->allpassL[i], accum, frames);
+
+   for (i = 0; i < frames; i++)
+      samples[i] = samples[i] * rev->dry + accum[i] * rev->wet1;
+}
+
 static void revmodel_update(struct revmodel *rev)
 {
    int i;
@@ -221,6 +351,9 @@ static void revmodel_init(struct revmodel *rev,int srate)
 struct reverb_data
 {
    struct revmodel left, right;
+
+   float input[DSPFILTER_BLOCK_FRAMES];
+   float accum[DSPFILTER_BLOCK_FRAMES];
 };
 
 static void reverb_free(void *data)
@@ -260,6 +393,16 @@ static void reverb_process(void *data, struct dspfilter_output *output,
    }
 }
 
+static void reverb_process_block(void *data, struct dspfilter_block *block)
+{
+   struct reverb_data *rev = (struct reverb_data*)data;
+
+   revmodel_process_block(&rev->left, block->channels[0], block->frames,
+         rev->input, rev->accum);
+   revmodel_process_block(&rev->right, block->channels[1], block->frames,
+         rev->input, rev->accum);
+}
+
 static void *reverb_init(const struct dspfilter_info *info,
       const struct dspfilter_config *config, void *userdata)
 {
@@ -298,9 +441,12 @@ static const struct dspfilter_implementation reverb_plug = {
    reverb_process,
    reverb_free,
 
-   DSPFILTER_API_VERSION,
+   DSPFILTER_API_VERSION_BLOCK,
    "Reverb",
    "reverb",
+
+   reverb_process_block,
+   REVERB_BLOCK_SIMD,
 };
 
 #ifdef HAVE_FILTERS_BUILTIN
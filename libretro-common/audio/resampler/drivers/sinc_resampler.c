@@ -45,10 +45,31 @@
 #endif
 #endif
 
-#if defined(__AVX__)
+/* The AVX and AVX2/FMA kernels are compiled in regardless of the
+ * target flags and picked in resampler_sinc_new() from the SIMD mask,
+ * so generic x86 builds still get them on capable CPUs. */
+#if (defined(__x86_64__) || defined(__i386__) || defined(_M_IX86) || defined(_M_X64)) && (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5) || (defined(_MSC_VER) && _MSC_VER >= 1910))
+#define SINC_SIMD_DISPATCH
+#endif
+
+#if defined(SINC_SIMD_DISPATCH) || defined(__AVX__)
+#define SINC_HAVE_AVX
+#endif
+
+#if defined(SINC_SIMD_DISPATCH) || (defined(__AVX2__) && defined(__FMA__))
+#define SINC_HAVE_FMA
+#endif
+
+#if defined(SINC_HAVE_AVX)
 #include <immintrin.h>
 #endif
 
+#if defined(__GNUC__) || defined(__clang__)
+#define SINC_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SINC_TARGET(isa)
+#endif
+
 /* Rough SNR values for upsampling:
  * LOWEST: 40 dB
  * LOWER: 55 dB
@@ -158,7 +179,8 @@ static void resampler_sinc_process_neon(void *re_, struct resampler_data *data)
 }
 #endif
 
-#if defined(__AVX__)
+#if defined(SINC_HAVE_AVX)
+SINC_TARGET("avx")
 static void resampler_sinc_process_avx_kaiser(void *re_, struct resampler_data *data)
 {
    rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
@@ -196,6 +218,7 @@ static void resampler_sinc_process_avx_kaiser(void *re_, struct resampler_data *
          while (resamp->time < phases)
          {
             unsigned i;
+            __m256 res_l, res_r;
             unsigned phase           = resamp->time >> resamp->subphase_bits;
 
             float *phase_table       = resamp->phase_table + phase * taps * 2;
@@ -220,8 +243,8 @@ static void resampler_sinc_process_avx_kaiser(void *re_, struct resampler_data *
 
             /* hadd on AVX is weird, and acts on low-lanes
              * and high-lanes separately. */
-            __m256 res_l = _mm256_hadd_ps(sum_l, sum_l);
-            __m256 res_r = _mm256_hadd_ps(sum_r, sum_r);
+            res_l        = _mm256_hadd_ps(sum_l, sum_l);
+            res_r        = _mm256_hadd_ps(sum_r, sum_r);
             res_l        = _mm256_hadd_ps(res_l, res_l);
             res_r        = _mm256_hadd_ps(res_r, res_r);
             res_l        = _mm256_add_ps(_mm256_permute2f128_ps(res_l, res_l, 1), res_l);
@@ -242,6 +265,7 @@ static void resampler_sinc_process_avx_kaiser(void *re_, struct resampler_data *
    data->output_frames = out_frames;
 }
 
+SINC_TARGET("avx")
 static void resampler_sinc_process_avx(void *re_, struct resampler_data *data)
 {
    rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
@@ -279,7 +303,7 @@ static void resampler_sinc_process_avx(void *re_, struct resampler_data *data)
          while (resamp->time < phases)
          {
             unsigned i;
-            __m256 delta;
+            __m256 res_l, res_r;
             unsigned phase           = resamp->time >> resamp->subphase_bits;
             float *phase_table       = resamp->phase_table + phase * taps;
 
@@ -298,8 +322,8 @@ static void resampler_sinc_process_avx(void *re_, struct resampler_data *data)
 
             /* hadd on AVX is weird, and acts on low-lanes
              * and high-lanes separately. */
-            __m256 res_l = _mm256_hadd_ps(sum_l, sum_l);
-            __m256 res_r = _mm256_hadd_ps(sum_r, sum_r);
+            res_l        = _mm256_hadd_ps(sum_l, sum_l);
+            res_r        = _mm256_hadd_ps(sum_r, sum_r);
             res_l        = _mm256_hadd_ps(res_l, res_l);
             res_r        = _mm256_hadd_ps(res_r, res_r);
             res_l        = _mm256_add_ps(_mm256_permute2f128_ps(res_l, res_l, 1), res_l);
@@ -321,6 +345,112 @@ static void resampler_sinc_process_avx(void *re_, struct resampler_data *data)
 }
 #endif
 
+#if defined(SINC_HAVE_FMA)
+/* Same as the AVX Kaiser kernel, but the delta interpolation and the
+ * multiply-accumulate are fused, halving the arithmetic per tap. */
+SINC_TARGET("avx2,fma")
+static void resampler_sinc_process_fma_kaiser(void *re_, struct resampler_data *data)
+{
+   rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
+   unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
+
+   uint32_t ratio                 = phases / data->ratio;
+   const float *input             = data->data_in;
+   float *output                  = data->data_out;
+   size_t frames                  = data->input_frames;
+   size_t out_frames              = 0;
+
+   while (frames)
+   {
+      while (frames && resamp->time >= phases)
+      {
+         /* Push in reverse to make filter more obvious. */
+         if (!resamp->ptr)
+            resamp->ptr = resamp->taps;
+         resamp->ptr--;
+
+         resamp->buffer_l[resamp->ptr + resamp->taps] =
+            resamp->buffer_l[resamp->ptr]                = *input++;
+
+         resamp->buffer_r[resamp->ptr + resamp->taps] =
+            resamp->buffer_r[resamp->ptr]                = *input++;
+
+         resamp->time                                -= phases;
+         frames--;
+      }
+
+      {
+         const float *buffer_l    = resamp->buffer_l + resamp->ptr;
+         const float *buffer_r    = resamp->buffer_r + resamp->ptr;
+         unsigned taps            = resamp->taps;
+         while (resamp->time < phases)
+         {
+            unsigned i;
+            __m128 res_l, res_r;
+            unsigned phase           = resamp->time >> resamp->subphase_bits;
+
+            float *phase_table       = resamp->phase_table + phase * taps * 2;
+            float *delta_table       = phase_table + taps;
+            __m256 delta             = _mm256_set1_ps((float)
+                  (resamp->time & resamp->subphase_mask) * resamp->subphase_mod);
+
+            __m256 sum_l             = _mm256_setzero_ps();
+            __m256 sum_r             = _mm256_setzero_ps();
+            __m256 sum2_l            = _mm256_setzero_ps();
+            __m256 sum2_r            = _mm256_setzero_ps();
+
+            /* Two accumulator pairs to hide the FMA latency. */
+            for (i = 0; i + 16 <= taps; i += 16)
+            {
+               __m256 sinc   = _mm256_fmadd_ps(
+                     _mm256_load_ps(delta_table + i), delta,
+                     _mm256_load_ps((const float*)phase_table + i));
+               __m256 sinc2  = _mm256_fmadd_ps(
+                     _mm256_load_ps(delta_table + i + 8), delta,
+                     _mm256_load_ps((const float*)phase_table + i + 8));
+
+               sum_l         = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_l + i), sinc, sum_l);
+               sum_r         = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_r + i), sinc, sum_r);
+               sum2_l        = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_l + i + 8), sinc2, sum2_l);
+               sum2_r        = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_r + i + 8), sinc2, sum2_r);
+            }
+
+            if (i < taps)
+            {
+               __m256 sinc   = _mm256_fmadd_ps(
+                     _mm256_load_ps(delta_table + i), delta,
+                     _mm256_load_ps((const float*)phase_table + i));
+
+               sum_l         = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_l + i), sinc, sum_l);
+               sum_r         = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_r + i), sinc, sum_r);
+            }
+
+            sum_l        = _mm256_add_ps(sum_l, sum2_l);
+            sum_r        = _mm256_add_ps(sum_r, sum2_r);
+
+            /* Fold the high lane onto the low one first,
+             * then finish the reduction with 128-bit ops. */
+            res_l        = _mm_add_ps(_mm256_castps256_ps128(sum_l),
+                  _mm256_extractf128_ps(sum_l, 1));
+            res_r        = _mm_add_ps(_mm256_castps256_ps128(sum_r),
+                  _mm256_extractf128_ps(sum_r, 1));
+            res_l        = _mm_hadd_ps(res_l, res_r);
+            res_l        = _mm_hadd_ps(res_l, res_l);
+
+            /* Lanes 0 and 1 now hold the left and right sums. */
+            _mm_storel_pi((__m64*)output, res_l);
+
+            output += 2;
+            out_frames++;
+            resamp->time += ratio;
+         }
+      }
+   }
+
+   data->output_frames = out_frames;
+}
+#endif
+
 #if defined(__SSE__)
 static void resampler_sinc_process_sse_kaiser(void *re_, struct resampler_data *data)
 {
@@ -784,8 +914,8 @@ static void *resampler_sinc_new(const struct resampler_config *config,
    }
 
    /* Be SIMD-friendly. */
-#if defined(__AVX__)
-   if (enable_avx)
+#if defined(SINC_HAVE_AVX)
+   if (enable_avx && (mask & RESAMPLER_SIMD_AVX))
       re->taps  = (re->taps + 7) & ~7;
    else
 #endif
@@ -832,10 +962,16 @@ static void *resampler_sinc_new(const struct resampler_config *config,
 
    if (mask & RESAMPLER_SIMD_AVX && enable_avx)
    {
-#if defined(__AVX__)
+#if defined(SINC_HAVE_AVX)
       sinc_resampler.process    = resampler_sinc_process_avx;
       if (window_type == SINC_WINDOW_KAISER)
          sinc_resampler.process = resampler_sinc_process_avx_kaiser;
+#endif
+#if defined(SINC_HAVE_FMA)
+      if (     (mask & (RESAMPLER_SIMD_AVX2 | RESAMPLER_SIMD_FMA))
+            == (RESAMPLER_SIMD_AVX2 | RESAMPLER_SIMD_FMA)
+            && window_type == SINC_WINDOW_KAISER)
+         sinc_resampler.process = resampler_sinc_process_fma_kaiser;
 #endif
    }
    else if (mask & RESAMPLER_SIMD_SSE)
@@ -870,3 +1006,4 @@ retro_resampler_t sinc_resampler = {
 };
 
 #undef WANT_NEON
+#undef SINC_TARGET
@@ -597,8 +597,9 @@ uint64_t cpu_features_get(void)
 {
    uint64_t cpu        = 0;
 #if defined(CPU_X86) && !defined(__MACH__)
-   int vendor_is_intel = 0;
-   const int avx_flags = (1 << 27) | (1 << 28);
+   int vendor_is_intel   = 0;
+   int avx512_os_support = 0;
+   const int avx_flags   = (1 << 27) | (1 << 28);
 #endif
 #if defined(__MACH__)
    size_t len          = sizeof(size_t);
@@ -652,6 +653,15 @@ uint64_t cpu_features_get(void)
    if (sysctlbyname("hw.optional.avx2_0", NULL, &len, NULL, 0) == 0)
       cpu |= RETRO_SIMD_AVX2;
 
+   len            = sizeof(size_t);
+   if (sysctlbyname("hw.optional.fma", NULL, &len, NULL, 0) == 0)
+      cpu |= RETRO_SIMD_FMA;
+
+   len            = sizeof(size_t);
+   if (     sysctlbyname("hw.optional.avx512f",  NULL, &len, NULL, 0) == 0
+         && sysctlbyname("hw.optional.avx512bw", NULL, &len, NULL, 0) == 0)
+      cpu |= RETRO_SIMD_AVX512;
+
    len            = sizeof(size_t);
    if (sysctlbyname("hw.optional.altivec", NULL, &len, NULL, 0) == 0)
       cpu |= RETRO_SIMD_VMX;
@@ -741,13 +751,29 @@ uint64_t cpu_features_get(void)
     * AVX CPU support (guaranteed to have at least i686). */
    if (((flags[2] & avx_flags) == avx_flags)
          && ((xgetbv_x86(0) & 0x6) == 0x6))
+   {
       cpu |= RETRO_SIMD_AVX;
 
+      /* FMA3 operates on the YMM state too. */
+      if (flags[2] & (1 << 12))
+         cpu |= RETRO_SIMD_FMA;
+
+      /* AVX-512 additionally needs the OS to save
+       * the opmask and ZMM register state. */
+      if ((xgetbv_x86(0) & 0xe6) == 0xe6)
+         avx512_os_support = 1;
+   }
+
    if (max_flag >= 7)
    {
       x86_cpuid(7, flags);
       if (flags[1] & (1 << 5))
          cpu |= RETRO_SIMD_AVX2;
+      /* AVX512F + AVX512BW */
+      if (avx512_os_support
+            && (flags[1] & (1 << 16))
+            && (flags[1] & (1 << 30)))
+         cpu |= RETRO_SIMD_AVX512;
    }
 
    x86_cpuid(0x80000000, flags);
@@ -60,6 +60,11 @@ typedef struct
 
 void audio_mix_volume_SSE2(float *out,
       const float *in, float vol, size_t samples);
+#elif defined(__ARM_NEON__) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
+#define audio_mix_volume           audio_mix_volume_NEON
+
+void audio_mix_volume_NEON(float *out,
+      const float *in, float vol, size_t samples);
 #else
 #define audio_mix_volume           audio_mix_volume_C
 #endif
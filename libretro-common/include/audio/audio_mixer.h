@@ -66,6 +66,15 @@ audio_mixer_sound_t* audio_mixer_load_mod(void *buffer, int32_t size);
 audio_mixer_sound_t* audio_mixer_load_flac(void *buffer, int32_t size);
 audio_mixer_sound_t* audio_mixer_load_mp3(void *buffer, int32_t size);
 
+/* Streamed from the file while playing, a chunk at a time,
+ * rather than loaded whole. Each voice playing the sound
+ * opens the file on its own, on the decoder thread where
+ * there is one. The file isn't touched until then, so a
+ * missing one only shows as a voice that finishes at once
+ * (or, without the thread, audio_mixer_play() failing). */
+audio_mixer_sound_t* audio_mixer_load_flac_file(const char *path);
+audio_mixer_sound_t* audio_mixer_load_mp3_file(const char *path);
+
 void audio_mixer_destroy(audio_mixer_sound_t* sound);
 
 audio_mixer_voice_t* audio_mixer_play(audio_mixer_sound_t* sound,
@@ -77,8 +86,21 @@ float audio_mixer_voice_get_volume(audio_mixer_voice_t *voice);
 
 void audio_mixer_voice_set_volume(audio_mixer_voice_t *voice, float val);
 
+/* Adds the playing voices to buffer. Never locks nor
+ * allocates, and may run on a different thread than the
+ * functions above. Stop callbacks are not called from
+ * here but from audio_mixer_update(). */
 void audio_mixer_mix(float* buffer, size_t num_frames, float volume_override, bool override);
 
+/* Whether any voice is playing, i.e. whether
+ * audio_mixer_mix() would add anything. */
+bool audio_mixer_is_playing(void);
+
+/* Calls the stop callbacks of the voices that finished or
+ * looped since the last call. Call regularly from the thread
+ * that plays and stops sounds. */
+void audio_mixer_update(void);
+
 RETRO_END_DECLS
 
 #endif
@@ -0,0 +1,79 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (audio_timestretch.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LIBRETRO_SDK_AUDIO_TIMESTRETCH_H
+#define __LIBRETRO_SDK_AUDIO_TIMESTRETCH_H
+
+#include <stddef.h>
+
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* Pitch-preserving tempo change (WSOLA) for interleaved
+ * stereo float audio. */
+
+#define RETRO_TIMESTRETCH_MIN_SPEED 0.0625f
+#define RETRO_TIMESTRETCH_MAX_SPEED 256.0f
+
+/* Longest stretch of output a single segment produces. */
+#define RETRO_TIMESTRETCH_MAX_SEGMENT_MS 125
+
+typedef struct retro_timestretch retro_timestretch_t;
+
+retro_timestretch_t *retro_timestretch_new(float sample_rate);
+
+void retro_timestretch_free(retro_timestretch_t *ts);
+
+/* Drops buffered audio. The next call to
+ * retro_timestretch_process() starts afresh. */
+void retro_timestretch_reset(retro_timestretch_t *ts);
+
+/* Cross-fades the tail of the stretched audio into the
+ * start of @data, then resets. Pass the first unstretched
+ * audio so that switching back is seamless. */
+void retro_timestretch_drain(retro_timestretch_t *ts,
+      float *data, size_t frames);
+
+/**
+ * retro_timestretch_process:
+ * @ts                   : time-stretch handle.
+ * @in                   : interleaved stereo input.
+ * @in_frames            : number of frames in @in.
+ * @speed                : tempo factor; 2.0 plays twice as fast.
+ * @out                  : interleaved stereo output.
+ * @out_frames           : capacity of @out, in frames.
+ *
+ * Consumes all of @in and writes the stretched audio to @out.
+ * Output is paced to about @in_frames / @speed frames per call,
+ * lagging the input by up to one segment; whatever isn't handed
+ * out stays buffered for the next call.
+ *
+ * Returns: number of frames written to @out.
+ **/
+size_t retro_timestretch_process(retro_timestretch_t *ts,
+      const float *in, size_t in_frames, float speed,
+      float *out, size_t out_frames);
+
+RETRO_END_DECLS
+
+#endif
@@ -60,6 +60,18 @@ const struct dspfilter_implementation *dspfilter_get_implementation(
 
 #define DSPFILTER_API_VERSION 1
 
+/* Version 2 adds the planar block interface below. A version 2
+ * plugin must still provide the interleaved process() callback,
+ * which hosts fall back to when they can't run the block kernel. */
+#define DSPFILTER_API_VERSION_BLOCK 2
+
+/* Each channel of a dspfilter_block starts at this alignment
+ * (in bytes) and is padded to a multiple of this many bytes. */
+#define DSPFILTER_BLOCK_ALIGN 32
+
+/* A dspfilter_block never holds more frames than this. */
+#define DSPFILTER_BLOCK_FRAMES 512
+
 struct dspfilter_info
 {
    /* Input sample rate that the DSP plugin receives. */
@@ -114,6 +126,20 @@ struct dspfilter_input
    unsigned frames;
 };
 
+struct dspfilter_block
+{
+   /* Planar samples, left channel first. Each channel is aligned
+    * and padded to DSPFILTER_BLOCK_ALIGN, so kernels can use aligned
+    * vector loads and stores, and may process the padding.
+    *
+    * The range of the samples are [-1.0, 1.0]. */
+   float *channels[2];
+
+   /* Number of valid frames per channel,
+    * at most DSPFILTER_BLOCK_FRAMES. */
+   unsigned frames;
+};
+
 /* Returns true if config key was found. Otherwise,
  * returns false, and sets value to default value.
  */
@@ -165,13 +191,20 @@ typedef void (*dspfilter_free_t)(void *data);
 typedef void (*dspfilter_process_t)(void *data,
       struct dspfilter_output *output, const struct dspfilter_input *input);
 
+/* Processes a planar block in place.
+ * Block kernels output exactly one frame per input frame;
+ * filters with latency must delay their output instead. */
+typedef void (*dspfilter_process_block_t)(void *data,
+      struct dspfilter_block *block);
+
 struct dspfilter_implementation
 {
    dspfilter_init_t     init;
    dspfilter_process_t  process;
    dspfilter_free_t     free;
 
-   /* Must be DSPFILTER_API_VERSION */
+   /* Must be DSPFILTER_API_VERSION or
+    * DSPFILTER_API_VERSION_BLOCK. */
    unsigned api_version;
 
    /* Human readable identifier of implementation. */
@@ -180,6 +213,17 @@ struct dspfilter_implementation
    /* Computer-friendly short version of ident.
     * Lower case, no spaces and special characters, etc. */
    const char *short_ident;
+
+   /* The fields below are only read if api_version is
+    * DSPFILTER_API_VERSION_BLOCK or newer. */
+
+   /* Optional. The host uses it over process() when it
+    * supports every instruction set in 'simd'. */
+   dspfilter_process_block_t process_block;
+
+   /* DSPFILTER_SIMD_* instruction sets process_block
+    * was built for. */
+   dspfilter_simd_mask_t simd;
 };
 
 RETRO_END_DECLS
@@ -327,11 +327,14 @@ DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_video_shared_context,          MENU_
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_driver_switch_enable,          MENU_ENUM_SUBLABEL_DRIVER_SWITCH_ENABLE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_audio_latency,                 MENU_ENUM_SUBLABEL_AUDIO_LATENCY)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_audio_rate_control_delta,      MENU_ENUM_SUBLABEL_AUDIO_RATE_CONTROL_DELTA)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_audio_rate_control_adaptive,   MENU_ENUM_SUBLABEL_AUDIO_RATE_CONTROL_ADAPTIVE)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_audio_latency_target,          MENU_ENUM_SUBLABEL_AUDIO_LATENCY_TARGET)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_audio_mute,                    MENU_ENUM_SUBLABEL_AUDIO_MUTE)
 #ifdef HAVE_AUDIOMIXER
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_audio_mixer_mute,              MENU_ENUM_SUBLABEL_AUDIO_MIXER_MUTE)
 #endif
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_audio_fastforward_mute,        MENU_ENUM_SUBLABEL_AUDIO_FASTFORWARD_MUTE)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_audio_timestretch,              MENU_ENUM_SUBLABEL_AUDIO_TIMESTRETCH)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_camera_allow,                  MENU_ENUM_SUBLABEL_CAMERA_ALLOW)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_location_allow,                MENU_ENUM_SUBLABEL_LOCATION_ALLOW)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_input_max_users,               MENU_ENUM_SUBLABEL_INPUT_MAX_USERS)
@@ -344,6 +347,9 @@ DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_audio_volume,                  MENU_
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_audio_mixer_volume,            MENU_ENUM_SUBLABEL_AUDIO_MIXER_VOLUME)
 #endif
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_audio_sync,                    MENU_ENUM_SUBLABEL_AUDIO_SYNC)
+#ifdef HAVE_THREADS
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_audio_processing_thread,        MENU_ENUM_SUBLABEL_AUDIO_PROCESSING_THREAD)
+#endif
 #if defined(GEKKO)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_input_mouse_scale, MENU_ENUM_SUBLABEL_INPUT_MOUSE_SCALE)
 #endif
@@ -454,6 +460,8 @@ DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_content_collection_list,       MENU_
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_video_scale_integer,           MENU_ENUM_SUBLABEL_VIDEO_SCALE_INTEGER)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_video_scale_integer_overscale, MENU_ENUM_SUBLABEL_VIDEO_SCALE_INTEGER_OVERSCALE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_video_gpu_screenshot,          MENU_ENUM_SUBLABEL_VIDEO_GPU_SCREENSHOT)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_video_frame_dupe_detect,       MENU_ENUM_SUBLABEL_VIDEO_FRAME_DUPE_DETECT)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_video_frame_partial_upload,    MENU_ENUM_SUBLABEL_VIDEO_FRAME_PARTIAL_UPLOAD)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_video_rotation,                MENU_ENUM_SUBLABEL_VIDEO_ROTATION)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_screen_orientation,            MENU_ENUM_SUBLABEL_SCREEN_ORIENTATION)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_video_force_srgb_enable,       MENU_ENUM_SUBLABEL_VIDEO_FORCE_SRGB_DISABLE)
@@ -467,6 +475,9 @@ DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_vrr_runloop_enable,            MENU_
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_slowmotion_ratio,              MENU_ENUM_SUBLABEL_SLOWMOTION_RATIO)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_run_ahead_enabled,             MENU_ENUM_SUBLABEL_RUN_AHEAD_ENABLED)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_run_ahead_secondary_instance,  MENU_ENUM_SUBLABEL_RUN_AHEAD_SECONDARY_INSTANCE)
+#ifdef HAVE_THREADS
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_run_ahead_secondary_threaded,   MENU_ENUM_SUBLABEL_RUN_AHEAD_SECONDARY_THREADED)
+#endif
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_run_ahead_hide_warnings,       MENU_ENUM_SUBLABEL_RUN_AHEAD_HIDE_WARNINGS)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_run_ahead_frames,              MENU_ENUM_SUBLABEL_RUN_AHEAD_FRAMES)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_input_block_timeout,           MENU_ENUM_SUBLABEL_INPUT_BLOCK_TIMEOUT)
@@ -512,6 +523,14 @@ DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_cheat_file_save_as,            MENU_
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_rewind_granularity,            MENU_ENUM_SUBLABEL_REWIND_GRANULARITY)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_rewind_buffer_size,            MENU_ENUM_SUBLABEL_REWIND_BUFFER_SIZE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_rewind_buffer_size_step,       MENU_ENUM_SUBLABEL_REWIND_BUFFER_SIZE_STEP)
+#ifdef HAVE_THREADS
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_rewind_threaded,                MENU_ENUM_SUBLABEL_REWIND_THREADED)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_rewind_keyframe_interval,       MENU_ENUM_SUBLABEL_REWIND_KEYFRAME_INTERVAL)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_rewind_min_history,             MENU_ENUM_SUBLABEL_REWIND_MIN_HISTORY)
+#ifdef HAVE_ZLIB
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_rewind_compression,             MENU_ENUM_SUBLABEL_REWIND_COMPRESSION)
+#endif
+#endif
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_libretro_log_level,            MENU_ENUM_SUBLABEL_LIBRETRO_LOG_LEVEL)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_frontend_log_level,            MENU_ENUM_SUBLABEL_FRONTEND_LOG_LEVEL)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_perfcnt_enable,                MENU_ENUM_SUBLABEL_PERFCNT_ENABLE)
@@ -3106,6 +3125,22 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_rewind_buffer_size_step);
             break;
+         case MENU_ENUM_LABEL_REWIND_THREADED:
+#ifdef HAVE_THREADS
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_rewind_threaded);
+#endif
+            break;
+         case MENU_ENUM_LABEL_REWIND_KEYFRAME_INTERVAL:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_rewind_keyframe_interval);
+            break;
+         case MENU_ENUM_LABEL_REWIND_MIN_HISTORY:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_rewind_min_history);
+            break;
+         case MENU_ENUM_LABEL_REWIND_COMPRESSION:
+#ifdef HAVE_ZLIB
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_rewind_compression);
+#endif
+            break;
          case MENU_ENUM_LABEL_CHEAT_IDX:
 #ifdef HAVE_CHEATS
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_cheat_idx);
@@ -3235,6 +3270,11 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_INSTANCE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_run_ahead_secondary_instance);
             break;
+         case MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_THREADED:
+#ifdef HAVE_THREADS
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_run_ahead_secondary_threaded);
+#endif
+            break;
          case MENU_ENUM_LABEL_RUN_AHEAD_HIDE_WARNINGS:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_run_ahead_hide_warnings);
             break;
@@ -3277,6 +3317,12 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_VIDEO_GPU_SCREENSHOT:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_gpu_screenshot);
             break;
+         case MENU_ENUM_LABEL_VIDEO_FRAME_DUPE_DETECT:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_frame_dupe_detect);
+            break;
+         case MENU_ENUM_LABEL_VIDEO_FRAME_PARTIAL_UPLOAD:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_frame_partial_upload);
+            break;
          case MENU_ENUM_LABEL_VIDEO_SCALE_INTEGER:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_scale_integer);
             break;
@@ -3535,6 +3581,11 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_AUDIO_SYNC:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_sync);
             break;
+         case MENU_ENUM_LABEL_AUDIO_PROCESSING_THREAD:
+#ifdef HAVE_THREADS
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_processing_thread);
+#endif
+            break;
          case MENU_ENUM_LABEL_AUDIO_VOLUME:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_volume);
             break;
@@ -3561,6 +3612,12 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_DELTA:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_rate_control_delta);
             break;
+         case MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_ADAPTIVE:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_rate_control_adaptive);
+            break;
+         case MENU_ENUM_LABEL_AUDIO_LATENCY_TARGET:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_latency_target);
+            break;
          case MENU_ENUM_LABEL_AUDIO_MUTE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_mute);
             break;
@@ -3572,6 +3629,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_AUDIO_FASTFORWARD_MUTE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_fastforward_mute);
             break;
+         case MENU_ENUM_LABEL_AUDIO_TIMESTRETCH:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_timestretch);
+            break;
          case MENU_ENUM_LABEL_AUDIO_LATENCY:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_latency);
             break;
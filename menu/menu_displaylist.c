@@ -1645,6 +1645,7 @@ static unsigned menu_displaylist_parse_system_info(file_list_t *list)
          {SUPPORTS_ROAR        ,    MENU_ENUM_LABEL_VALUE_SYSTEM_INFO_ROARAUDIO_SUPPORT},
          {SUPPORTS_JACK        ,    MENU_ENUM_LABEL_VALUE_SYSTEM_INFO_JACK_SUPPORT},
          {SUPPORTS_PULSE       ,    MENU_ENUM_LABEL_VALUE_SYSTEM_INFO_PULSEAUDIO_SUPPORT},
+         {SUPPORTS_PIPEWIRE    ,    MENU_ENUM_LABEL_VALUE_SYSTEM_INFO_PIPEWIRE_SUPPORT},
          {SUPPORTS_COREAUDIO   ,    MENU_ENUM_LABEL_VALUE_SYSTEM_INFO_COREAUDIO_SUPPORT},
          {SUPPORTS_COREAUDIO3  ,    MENU_ENUM_LABEL_VALUE_SYSTEM_INFO_COREAUDIO3_SUPPORT},
          {SUPPORTS_DSOUND      ,    MENU_ENUM_LABEL_VALUE_SYSTEM_INFO_DSOUND_SUPPORT},
@@ -5881,6 +5882,12 @@ unsigned menu_displaylist_build_list(
                   MENU_ENUM_LABEL_AUDIO_SYNC,
                   PARSE_ONLY_BOOL, false) == 0)
             count++;
+#ifdef HAVE_THREADS
+         if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
+                  MENU_ENUM_LABEL_AUDIO_PROCESSING_THREAD,
+                  PARSE_ONLY_BOOL, false) == 0)
+            count++;
+#endif
          if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
                   MENU_ENUM_LABEL_AUDIO_MAX_TIMING_SKEW,
                   PARSE_ONLY_FLOAT, false) == 0)
@@ -5889,6 +5896,14 @@ unsigned menu_displaylist_build_list(
                   MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_DELTA,
                   PARSE_ONLY_FLOAT, false) == 0)
             count++;
+         if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
+                  MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_ADAPTIVE,
+                  PARSE_ONLY_BOOL, false) == 0)
+            count++;
+         if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
+                  MENU_ENUM_LABEL_AUDIO_LATENCY_TARGET,
+                  PARSE_ONLY_UINT, false) == 0)
+            count++;
          break;
       case DISPLAYLIST_AUDIO_SETTINGS_LIST:
          if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
@@ -5929,6 +5944,10 @@ unsigned menu_displaylist_build_list(
                   MENU_ENUM_LABEL_AUDIO_FASTFORWARD_MUTE,
                   PARSE_ONLY_BOOL, false) == 0)
             count++;
+         if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
+                  MENU_ENUM_LABEL_AUDIO_TIMESTRETCH,
+                  PARSE_ONLY_BOOL, false) == 0)
+            count++;
          if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
                   MENU_ENUM_LABEL_AUDIO_VOLUME,
                   PARSE_ONLY_FLOAT, false) == 0)
@@ -6047,6 +6066,14 @@ unsigned menu_displaylist_build_list(
                      MENU_SETTING_ACTION_VIDEO_FILTER_REMOVE, 0, 0))
                   count++;
 #endif
+            if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
+                     MENU_ENUM_LABEL_VIDEO_FRAME_DUPE_DETECT,
+                     PARSE_ONLY_BOOL, false) == 0)
+               count++;
+            if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
+                     MENU_ENUM_LABEL_VIDEO_FRAME_PARTIAL_UPLOAD,
+                     PARSE_ONLY_BOOL, false) == 0)
+               count++;
             if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
                      MENU_ENUM_LABEL_VIDEO_NOTCH_WRITE_OVER,
                      PARSE_ONLY_BOOL, false) == 0)
@@ -8134,6 +8161,9 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_RUN_AHEAD_ENABLED,                     PARSE_ONLY_BOOL, true },
                {MENU_ENUM_LABEL_RUN_AHEAD_FRAMES,                      PARSE_ONLY_UINT, false },
                {MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_INSTANCE,          PARSE_ONLY_BOOL, false },
+#ifdef HAVE_THREADS
+               {MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_THREADED,          PARSE_ONLY_BOOL, false },
+#endif
                {MENU_ENUM_LABEL_RUN_AHEAD_HIDE_WARNINGS,               PARSE_ONLY_BOOL, false },
 #endif
             };
@@ -8170,6 +8200,9 @@ unsigned menu_displaylist_build_list(
                      {
                         case MENU_ENUM_LABEL_RUN_AHEAD_FRAMES:
                         case MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_INSTANCE:
+#ifdef HAVE_THREADS
+                        case MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_THREADED:
+#endif
                         case MENU_ENUM_LABEL_RUN_AHEAD_HIDE_WARNINGS:
                            build_list[i].checked = true;
                            break;
@@ -9011,6 +9044,14 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_REWIND_GRANULARITY,      PARSE_ONLY_UINT, false},
                {MENU_ENUM_LABEL_REWIND_BUFFER_SIZE,      PARSE_ONLY_SIZE, false},
                {MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP, PARSE_ONLY_UINT, false},
+#ifdef HAVE_THREADS
+               {MENU_ENUM_LABEL_REWIND_THREADED,         PARSE_ONLY_BOOL, false},
+#endif
+               {MENU_ENUM_LABEL_REWIND_KEYFRAME_INTERVAL, PARSE_ONLY_UINT, false},
+               {MENU_ENUM_LABEL_REWIND_MIN_HISTORY,      PARSE_ONLY_UINT, false},
+#ifdef HAVE_ZLIB
+               {MENU_ENUM_LABEL_REWIND_COMPRESSION,      PARSE_ONLY_BOOL, false},
+#endif
             };
 
             for (i = 0; i < ARRAY_SIZE(build_list); i++)
@@ -9020,6 +9061,14 @@ unsigned menu_displaylist_build_list(
                   case MENU_ENUM_LABEL_REWIND_GRANULARITY:
                   case MENU_ENUM_LABEL_REWIND_BUFFER_SIZE:
                   case MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP:
+#ifdef HAVE_THREADS
+                  case MENU_ENUM_LABEL_REWIND_THREADED:
+#endif
+                  case MENU_ENUM_LABEL_REWIND_KEYFRAME_INTERVAL:
+                  case MENU_ENUM_LABEL_REWIND_MIN_HISTORY:
+#ifdef HAVE_ZLIB
+                  case MENU_ENUM_LABEL_REWIND_COMPRESSION:
+#endif
                      if (rewind_enable)
                         build_list[i].checked = true;
                      break;
@@ -7684,6 +7684,10 @@ static void general_write_handler(rarch_setting_t *setting)
       case MENU_ENUM_LABEL_AUDIO_WASAPI_EXCLUSIVE_MODE:
       case MENU_ENUM_LABEL_AUDIO_WASAPI_FLOAT_FORMAT:
       case MENU_ENUM_LABEL_AUDIO_WASAPI_SH_BUFFER_LENGTH:
+      case MENU_ENUM_LABEL_AUDIO_PROCESSING_THREAD:
+      case MENU_ENUM_LABEL_AUDIO_TIMESTRETCH:
+      case MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_ADAPTIVE:
+      case MENU_ENUM_LABEL_AUDIO_LATENCY_TARGET:
          rarch_cmd = CMD_EVENT_AUDIO_REINIT;
          break;
       case MENU_ENUM_LABEL_PAL60_ENABLE:
@@ -10251,6 +10255,68 @@ static bool setting_append_list(
             (*list)[list_info->index - 1].offset_by     = 1;
             menu_settings_list_current_add_range(list, list_info, 1, 100, 1, true, true);
 
+#ifdef HAVE_THREADS
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.rewind_threaded,
+                  MENU_ENUM_LABEL_REWIND_THREADED,
+                  MENU_ENUM_LABEL_VALUE_REWIND_THREADED,
+                  DEFAULT_REWIND_THREADED,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+#endif
+
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.rewind_keyframe_interval,
+                  MENU_ENUM_LABEL_REWIND_KEYFRAME_INTERVAL,
+                  MENU_ENUM_LABEL_VALUE_REWIND_KEYFRAME_INTERVAL,
+                  DEFAULT_REWIND_KEYFRAME_INTERVAL,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].action_ok     = &setting_action_ok_uint;
+            menu_settings_list_current_add_range(list, list_info, 0, 3600, 30, true, true);
+
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.rewind_min_history,
+                  MENU_ENUM_LABEL_REWIND_MIN_HISTORY,
+                  MENU_ENUM_LABEL_VALUE_REWIND_MIN_HISTORY,
+                  DEFAULT_REWIND_MIN_HISTORY,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].action_ok     = &setting_action_ok_uint;
+            menu_settings_list_current_add_range(list, list_info, 0, 600, 5, true, true);
+
+#ifdef HAVE_ZLIB
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.rewind_compression,
+                  MENU_ENUM_LABEL_REWIND_COMPRESSION,
+                  MENU_ENUM_LABEL_VALUE_REWIND_COMPRESSION,
+                  DEFAULT_REWIND_COMPRESSION,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+#endif
+
          END_SUB_GROUP(list, list_info, parent_group);
          END_GROUP(list, list_info, parent_group);
          break;
@@ -11847,6 +11913,38 @@ static bool setting_append_list(
             MENU_SETTINGS_LIST_CURRENT_ADD_CMD(list, list_info, CMD_EVENT_REINIT);
             SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_LAKKA_ADVANCED);
 
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.video_frame_dupe_detect,
+                  MENU_ENUM_LABEL_VIDEO_FRAME_DUPE_DETECT,
+                  MENU_ENUM_LABEL_VALUE_VIDEO_FRAME_DUPE_DETECT,
+                  DEFAULT_VIDEO_FRAME_DUPE_DETECT,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_ADVANCED
+                  );
+
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.video_frame_partial_upload,
+                  MENU_ENUM_LABEL_VIDEO_FRAME_PARTIAL_UPLOAD,
+                  MENU_ENUM_LABEL_VALUE_VIDEO_FRAME_PARTIAL_UPLOAD,
+                  DEFAULT_VIDEO_FRAME_PARTIAL_UPLOAD,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_ADVANCED
+                  );
+
             END_SUB_GROUP(list, list_info, parent_group);
             END_GROUP(list, list_info, parent_group);
          }
@@ -12129,6 +12227,22 @@ static bool setting_append_list(
                SD_FLAG_NONE
                );
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.audio_timestretch,
+               MENU_ENUM_LABEL_AUDIO_TIMESTRETCH,
+               MENU_ENUM_LABEL_VALUE_AUDIO_TIMESTRETCH,
+               DEFAULT_AUDIO_TIMESTRETCH,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_NONE
+               );
+
          CONFIG_FLOAT(
                list, list_info,
                &settings->floats.audio_volume,
@@ -12191,6 +12305,24 @@ static bool setting_append_list(
                );
          SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_LAKKA_ADVANCED);
 
+#ifdef HAVE_THREADS
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.audio_processing_thread,
+               MENU_ENUM_LABEL_AUDIO_PROCESSING_THREAD,
+               MENU_ENUM_LABEL_VALUE_AUDIO_PROCESSING_THREAD,
+               DEFAULT_AUDIO_PROCESSING_THREAD,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_ADVANCED
+               );
+#endif
+
          CONFIG_UINT(
                list, list_info,
                &settings->uints.audio_latency,
@@ -12246,6 +12378,37 @@ static bool setting_append_list(
                false);
          SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.audio_rate_control_adaptive,
+               MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_ADAPTIVE,
+               MENU_ENUM_LABEL_VALUE_AUDIO_RATE_CONTROL_ADAPTIVE,
+               DEFAULT_RATE_CONTROL_ADAPTIVE,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_ADVANCED
+               );
+
+         CONFIG_UINT(
+               list, list_info,
+               &settings->uints.audio_latency_target,
+               MENU_ENUM_LABEL_AUDIO_LATENCY_TARGET,
+               MENU_ENUM_LABEL_VALUE_AUDIO_LATENCY_TARGET,
+               DEFAULT_AUDIO_LATENCY_TARGET,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler);
+         (*list)[list_info->index - 1].action_ok     = &setting_action_ok_uint;
+         menu_settings_list_current_add_range(list, list_info, 0, 512, 1.0, true, true);
+         SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
+
          CONFIG_FLOAT(
                list, list_info,
                &settings->floats.audio_max_timing_skew,
@@ -13399,6 +13562,24 @@ static bool setting_append_list(
                general_read_handler,
                SD_FLAG_NONE
                );
+
+#ifdef HAVE_THREADS
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.run_ahead_secondary_threaded,
+               MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_THREADED,
+               MENU_ENUM_LABEL_VALUE_RUN_AHEAD_SECONDARY_THREADED,
+               DEFAULT_RUN_AHEAD_SECONDARY_THREADED,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_ADVANCED
+               );
+#endif
 #endif
 
          CONFIG_BOOL(
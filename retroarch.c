@@ -40,6 +40,10 @@
 #include <signal.h>
 #endif
 
+#if defined(HAVE_RUNAHEAD) && defined(__linux__) && !defined(ANDROID)
+#include <sys/mman.h>
+#endif
+
 #if defined(_WIN32_WINNT) && _WIN32_WINNT < 0x0500 || defined(_XBOX)
 #ifndef LEGACY_WIN32
 #define LEGACY_WIN32
@@ -145,6 +149,7 @@
 #endif
 
 #include <audio/audio_resampler.h>
+#include <audio/audio_timestretch.h>
 
 #include "gfx/gfx_animation.h"
 #include "gfx/gfx_display.h"
@@ -252,6 +257,7 @@
 #include "tasks/task_powerstate.h"
 #include "tasks/tasks_internal.h"
 #include "performance_counters.h"
+#include "frame_timeline.h"
 
 #include "version.h"
 #include "version_git.h"
@@ -10750,6 +10756,94 @@ bool command_write_memory(command_t *cmd, const char *arg)
    cmd->replier(cmd, reply, strlen(reply));
    return true;
 }
+
+bool command_timeline_start(command_t *cmd, const char *arg)
+{
+   const char *reply = frame_timeline_start()
+      ? "TIMELINE_START OK\n" : "TIMELINE_START -1\n";
+   cmd->replier(cmd, reply, strlen(reply));
+   return true;
+}
+
+bool command_timeline_stop(command_t *cmd, const char *arg)
+{
+   const char *reply = "TIMELINE_STOP OK\n";
+   frame_timeline_stop();
+   cmd->replier(cmd, reply, strlen(reply));
+   return true;
+}
+
+bool command_timeline_dump(command_t *cmd, const char *arg)
+{
+   char reply[PATH_MAX_LENGTH + 32];
+   int events = string_is_empty(arg) ? -1 : frame_timeline_write(arg);
+
+   snprintf(reply, sizeof(reply), "TIMELINE_DUMP %s %d\n",
+         arg ? arg : "", events);
+   cmd->replier(cmd, reply, strlen(reply));
+   return events >= 0;
+}
+
+bool command_get_audio_stats(command_t *cmd, const char *arg)
+{
+   char reply[512];
+   audio_telemetry_t tm;
+   struct rarch_state *p_rarch  = &rarch_st;
+
+   if (!p_rarch->audio_driver_active || !p_rarch->current_audio)
+   {
+      strcpy_literal(reply, "GET_AUDIO_STATS -1\n");
+      cmd->replier(cmd, reply, strlen(reply));
+      return true;
+   }
+
+   audio_driver_get_telemetry(p_rarch, &tm, true);
+
+   snprintf(reply, sizeof(reply), "GET_AUDIO_STATS driver=%s"
+         " rate=%u buffer=%u buffer_ms=%.2f fill=%u fill_min=%u"
+         " fill_max=%u latency_ms=%.2f target_ms=%.2f jitter_ms=%.2f"
+         " underruns=%u overruns=%u ratio=%.6f dsp_us=%.1f"
+         " stretch_us=%.1f resample_us=%.1f mix_us=%.1f\n",
+         p_rarch->current_audio->ident,
+         tm.output_rate, tm.buffer_size, tm.buffer_ms, tm.fill,
+         tm.fill_min, tm.fill_max, tm.latency_ms, tm.target_ms,
+         tm.jitter_ms, tm.underruns, tm.overruns, tm.ratio,
+         tm.dsp_usec, tm.stretch_usec, tm.resample_usec, tm.mix_usec);
+   cmd->replier(cmd, reply, strlen(reply));
+   return true;
+}
+
+bool command_reset_audio_stats(command_t *cmd, const char *arg)
+{
+   const char *reply            = "RESET_AUDIO_STATS OK\n";
+   struct rarch_state *p_rarch  = &rarch_st;
+
+   audio_driver_lock(p_rarch);
+   audio_driver_telemetry_reset(p_rarch);
+   audio_driver_unlock(p_rarch);
+   cmd->replier(cmd, reply, strlen(reply));
+   return true;
+}
+
+#ifdef HAVE_REWIND
+bool command_rewind_seek(command_t *cmd, const char *arg)
+{
+   char reply[64];
+   struct rarch_state *p_rarch  = &rarch_st;
+   unsigned frames              = (unsigned)strtoul(arg, NULL, 10);
+   bool ok                      = false;
+
+#ifdef HAVE_CHEEVOS
+   if (!rcheevos_hardcore_active())
+#endif
+      ok = state_manager_seek(&p_rarch->rewind_st, frames);
+
+   snprintf(reply, sizeof(reply), "REWIND_SEEK %u %s\n",
+         frames, ok ? "OK" : "-1");
+   cmd->replier(cmd, reply, strlen(reply));
+   return true;
+}
+#endif
 #endif
 
 static bool retroarch_apply_shader(
@@ -11335,6 +11429,7 @@ static void handle_translation_cb(
       params.state                = AUDIO_STREAM_STATE_PLAYING;
       params.buf                  = raw_sound_data;
       params.bufsize              = new_sound_size;
+      params.path                 = NULL;
       params.cb                   = NULL;
       params.basename             = NULL;
 
@@ -12654,7 +12749,8 @@ static INLINE void retroarch_set_frame_limit(
 {
    const struct retro_system_av_info* av_info = &p_rarch->video_driver_av_info;
 
-   p_rarch->frame_limit_minimum_time = (fastforward_ratio < 1.0f) ? 0.0f :
+   p_rarch->frame_limit_minimum_time = (fastforward_ratio < 1.0f
+         || runloop_state.benchmark) ? 0.0f :
          (retro_time_t)roundf(1000000.0f / (av_info->timing.fps * fastforward_ratio));
 }
 
@@ -14035,6 +14131,8 @@ bool command_event(enum event_command cmd, void *data)
 #ifdef HAVE_REWIND
          {
             bool rewind_enable        = settings->bools.rewind_enable;
+            bool rewind_threaded      = settings->bools.rewind_threaded;
+            bool rewind_compression   = settings->bools.rewind_compression;
             size_t rewind_buf_size    = settings->sizes.rewind_buffer_size;
 #ifdef HAVE_CHEEVOS
             if (rcheevos_hardcore_active())
@@ -14049,8 +14147,17 @@ bool command_event(enum event_command cmd, void *data)
                         RARCH_NETPLAY_CTL_IS_ENABLED, NULL))
 #endif
                {
+                  struct retro_system_av_info *av_info =
+                     &p_rarch->video_driver_av_info;
+                  unsigned min_history_frames          = (unsigned)
+                     (settings->uints.rewind_min_history
+                      * av_info->timing.fps);
+
                   state_manager_event_init(&p_rarch->rewind_st,
-                        (unsigned)rewind_buf_size);
+                        (unsigned)rewind_buf_size, rewind_threaded,
+                        rewind_compression,
+                        settings->uints.rewind_keyframe_interval,
+                        min_history_frames);
                }
             }
          }
@@ -14155,14 +14262,15 @@ bool command_event(enum event_command cmd, void *data)
 #ifdef HAVE_DSP_FILTER
          {
             const char *path_audio_dsp_plugin = settings->paths.path_audio_dsp_plugin;
+            audio_driver_lock(p_rarch);
             audio_driver_dsp_filter_free();
-            if (string_is_empty(path_audio_dsp_plugin))
-               break;
-            if (!audio_driver_dsp_filter_init(path_audio_dsp_plugin))
+            if (     !string_is_empty(path_audio_dsp_plugin)
+                  && !audio_driver_dsp_filter_init(path_audio_dsp_plugin))
             {
                RARCH_ERR("[DSP]: Failed to initialize DSP filter \"%s\".\n",
                      path_audio_dsp_plugin);
             }
+            audio_driver_unlock(p_rarch);
          }
 #endif
          break;
@@ -19238,6 +19346,10 @@ static void secondary_core_destroy(struct rarch_state *p_rarch)
    if (!p_rarch || !p_rarch->secondary_lib_handle)
       return;
 
+#ifdef HAVE_RUNAHEAD_SECONDARY_THREAD
+   runahead_secondary_worker_free(p_rarch);
+#endif
+
    /* unload game from core */
    if (p_rarch->secondary_core.retro_unload_game)
       p_rarch->secondary_core.retro_unload_game();
@@ -19486,11 +19598,215 @@ end:
    return NULL;
 }
 
+#ifdef HAVE_RUNAHEAD_SECONDARY_THREAD
+/* Takes what the secondary core may ask for while it runs on
+ * the worker, so it never reads frontend state the main core
+ * is changing at the same time. Main thread, before the
+ * worker starts. */
+static void runahead_secondary_worker_snapshot(
+      struct rarch_state *p_rarch,
+      runahead_secondary_worker_t *worker)
+{
+   size_t i;
+   core_option_manager_t *opts   = runloop_state.core_options;
+
+   worker->variable_update       = p_rarch->has_variable_update
+      || (opts && opts->updated);
+   worker->variable_update_taken = false;
+   worker->fastforwarding        = runloop_state.fastmotion;
+   worker->variables_count       = 0;
+
+   if (!opts)
+      return;
+
+   if (opts->size > worker->variables_capacity)
+   {
+      struct runahead_secondary_variable *variables =
+         (struct runahead_secondary_variable*)realloc(
+               worker->variables, opts->size * sizeof(*variables));
+
+      if (!variables)
+         return;
+
+      memset(variables + worker->variables_capacity, 0,
+            (opts->size - worker->variables_capacity)
+            * sizeof(*variables));
+      worker->variables          = variables;
+      worker->variables_capacity = opts->size;
+   }
+
+   /* Values rarely change, so only those that did are copied. */
+   for (i = 0; i < opts->size; i++)
+   {
+      struct runahead_secondary_variable *var = &worker->variables[i];
+      const char *key                         = opts->opts[i].key;
+      const char *value                       = NULL;
+
+      if (!string_is_empty(key) && opts->opts[i].vals)
+         value = opts->opts[i].vals->elems[opts->opts[i].index].data;
+
+      if (!string_is_equal(var->key, key))
+      {
+         free(var->key);
+         var->key   = key ? strdup(key) : NULL;
+      }
+      if (!string_is_equal(var->value, value))
+      {
+         free(var->value);
+         var->value = value ? strdup(value) : NULL;
+      }
+   }
+
+   worker->variables_count = opts->size;
+}
+
+/* Environment calls of the secondary core while it runs on
+ * the worker. Queries are answered from the snapshot, or
+ * passed on if they only read what is set up at load time.
+ * Calls that change frontend state are queued for the main
+ * thread; anything else is refused. */
+static bool runahead_secondary_worker_environment(
+      runahead_secondary_worker_t *worker, unsigned cmd, void *data)
+{
+   struct runahead_secondary_env_call *call = NULL;
+
+   switch (cmd)
+   {
+      case RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE:
+         /* Video only, with audio hard disabled. */
+         if (data)
+            *(int*)data = 1 | 8;
+         return true;
+      case RETRO_ENVIRONMENT_GET_VARIABLE:
+         {
+            size_t i;
+            struct retro_variable *var = (struct retro_variable*)data;
+
+            worker->variable_update       = false;
+            worker->variable_update_taken = true;
+
+            if (!var)
+               return true;
+
+            var->value = NULL;
+            for (i = 0; i < worker->variables_count; i++)
+            {
+               if (string_is_equal(worker->variables[i].key, var->key))
+               {
+                  var->value = worker->variables[i].value;
+                  break;
+               }
+            }
+         }
+         return true;
+      case RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE:
+         *(bool*)data                  = worker->variable_update;
+         worker->variable_update       = false;
+         worker->variable_update_taken = true;
+         return true;
+      case RETRO_ENVIRONMENT_GET_FASTFORWARDING:
+         *(bool*)data = worker->fastforwarding;
+         return true;
+      case RETRO_ENVIRONMENT_GET_CAN_DUPE:
+      case RETRO_ENVIRONMENT_GET_OVERSCAN:
+      case RETRO_ENVIRONMENT_GET_SAVE_DIRECTORY:
+      case RETRO_ENVIRONMENT_GET_CORE_ASSETS_DIRECTORY:
+      case RETRO_ENVIRONMENT_GET_LIBRETRO_PATH:
+      case RETRO_ENVIRONMENT_GET_USERNAME:
+      case RETRO_ENVIRONMENT_GET_LANGUAGE:
+      case RETRO_ENVIRONMENT_GET_LOG_INTERFACE:
+      case RETRO_ENVIRONMENT_GET_PERF_INTERFACE:
+      case RETRO_ENVIRONMENT_GET_INPUT_BITMASKS:
+      case RETRO_ENVIRONMENT_GET_INPUT_MAX_USERS:
+      case RETRO_ENVIRONMENT_GET_CORE_OPTIONS_VERSION:
+      case RETRO_ENVIRONMENT_GET_MESSAGE_INTERFACE_VERSION:
+         return rarch_environment_cb(cmd, data);
+      case RETRO_ENVIRONMENT_SET_ROTATION:
+      case RETRO_ENVIRONMENT_SET_GEOMETRY:
+      case RETRO_ENVIRONMENT_SET_SYSTEM_AV_INFO:
+      case RETRO_ENVIRONMENT_SET_MESSAGE:
+      case RETRO_ENVIRONMENT_SET_MESSAGE_EXT:
+         if (!data || worker->env_calls_count
+               >= RUNAHEAD_SECONDARY_MAX_ENV_CALLS)
+            return false;
+         call      = &worker->env_calls[worker->env_calls_count];
+         call->cmd = cmd;
+         call->msg = NULL;
+         break;
+      default:
+         return false;
+   }
+
+   switch (cmd)
+   {
+      case RETRO_ENVIRONMENT_SET_ROTATION:
+         call->data.rotation    = *(const unsigned*)data;
+         break;
+      case RETRO_ENVIRONMENT_SET_GEOMETRY:
+         call->data.geometry    = *(const struct retro_game_geometry*)data;
+         break;
+      case RETRO_ENVIRONMENT_SET_SYSTEM_AV_INFO:
+         call->data.av_info     = *(const struct retro_system_av_info*)data;
+         break;
+      case RETRO_ENVIRONMENT_SET_MESSAGE:
+         call->data.message     = *(const struct retro_message*)data;
+         if (!(call->msg = strdup(call->data.message.msg
+                     ? call->data.message.msg : "")))
+            return false;
+         call->data.message.msg = call->msg;
+         break;
+      case RETRO_ENVIRONMENT_SET_MESSAGE_EXT:
+         call->data.message_ext = *(const struct retro_message_ext*)data;
+         if (!(call->msg = strdup(call->data.message_ext.msg
+                     ? call->data.message_ext.msg : "")))
+            return false;
+         call->data.message_ext.msg = call->msg;
+         break;
+   }
+
+   worker->env_calls_count++;
+   return true;
+}
+
+/* Main thread, after the join. The queued calls only
+ * happen if the worker's frame is kept. */
+static void runahead_secondary_worker_finish_env(
+      struct rarch_state *p_rarch,
+      runahead_secondary_worker_t *worker, bool keep)
+{
+   unsigned i;
+
+   for (i = 0; i < worker->env_calls_count; i++)
+   {
+      struct runahead_secondary_env_call *call = &worker->env_calls[i];
+
+      if (keep)
+         rarch_environment_cb(call->cmd, &call->data);
+      free(call->msg);
+      call->msg = NULL;
+   }
+   worker->env_calls_count = 0;
+
+   if (worker->variable_update_taken)
+      p_rarch->has_variable_update = false;
+}
+#endif
+
 static bool rarch_environment_secondary_core_hook(
       unsigned cmd, void *data)
 {
    struct rarch_state *p_rarch = &rarch_st;
-   bool                 result = rarch_environment_cb(cmd, data);
+   bool                 result = false;
+
+#ifdef HAVE_RUNAHEAD_SECONDARY_THREAD
+   /* The main thread is running the main core meanwhile. */
+   if (     p_rarch->runahead_secondary_worker
+         && p_rarch->runahead_secondary_worker->busy)
+      return runahead_secondary_worker_environment(
+            p_rarch->runahead_secondary_worker, cmd, data);
+#endif
+
+   result = rarch_environment_cb(cmd, data);
 
    if (p_rarch->has_variable_update)
    {
@@ -22584,6 +22900,8 @@ static void input_driver_poll(void)
          && p_rarch->sec_joypad->poll)
       p_rarch->sec_joypad->poll();
 #endif
+   frame_timeline_begin(FRAME_TIMELINE_INPUT_POLL);
+
    if (     p_rarch->current_input
          && p_rarch->current_input->poll)
       p_rarch->current_input->poll(p_rarch->current_input_data);
@@ -22594,6 +22912,7 @@ static void input_driver_poll(void)
    {
       for (i = 0; i < max_users; i++)
          p_rarch->input_driver_turbo_btns.frame_enable[i] = 0;
+      frame_timeline_end(FRAME_TIMELINE_INPUT_POLL);
       return;
    }
 
@@ -22983,7 +23302,10 @@ static void input_driver_poll(void)
             struct remote_message msg;
 
             if (p_rarch->input_driver_remote->net_fd[user] < 0)
+            {
+               frame_timeline_end(FRAME_TIMELINE_INPUT_POLL);
                return;
+            }
 
             FD_ZERO(&fds);
             FD_SET(p_rarch->input_driver_remote->net_fd[user], &fds);
@@ -23008,6 +23330,8 @@ static void input_driver_poll(void)
       }
    }
 #endif
+
+   frame_timeline_end(FRAME_TIMELINE_INPUT_POLL);
 }
 
 static int16_t input_state_device(
@@ -25589,6 +25913,8 @@ static void input_driver_deinit_command(struct rarch_state *p_rarch)
 
       p_rarch->input_driver_command[i] = NULL;
     }
+
+   frame_timeline_free();
 }
 #endif
 
@@ -28452,6 +28778,14 @@ static bool audio_driver_deinit_internal(struct rarch_state *p_rarch,
       memalign_free(p_rarch->audio_driver_output_samples_buf);
    p_rarch->audio_driver_output_samples_buf = NULL;
 
+   retro_timestretch_free(p_rarch->audio_driver_timestretch);
+   p_rarch->audio_driver_timestretch        = NULL;
+
+   if (p_rarch->audio_driver_timestretch_buf)
+      memalign_free(p_rarch->audio_driver_timestretch_buf);
+   p_rarch->audio_driver_timestretch_buf    = NULL;
+   p_rarch->audio_driver_timestretch_frames = 0;
+
 #ifdef HAVE_DSP_FILTER
    audio_driver_dsp_filter_free();
 #endif
@@ -28477,6 +28811,9 @@ static bool audio_driver_free_devices_list(struct rarch_state *p_rarch)
 static bool audio_driver_deinit(struct rarch_state *p_rarch,
       settings_t *settings)
 {
+#ifdef HAVE_AUDIO_PROCESSING_THREAD
+   audio_processing_thread_free(p_rarch);
+#endif
 #ifdef HAVE_AUDIOMIXER
    audio_driver_mixer_deinit(p_rarch);
 #endif
@@ -28595,7 +28932,8 @@ static bool audio_driver_init_internal(
    }
 
 #ifdef HAVE_THREADS
-   if (audio_cb_inited)
+   if (     audio_cb_inited
+         && !p_rarch->current_audio->pulls_callback)
    {
       RARCH_LOG("[Audio]: Starting threaded audio driver ...\n");
       if (!audio_init_thread(
@@ -28664,11 +29002,14 @@ static bool audio_driver_init_internal(
       p_rarch->audio_source_ratio_current =
       (double)settings->uints.audio_output_sample_rate / p_rarch->audio_driver_input;
 
+   p_rarch->audio_driver_resampler_quality =
+      audio_driver_get_resampler_quality(settings);
+
    if (!retro_resampler_realloc(
             &p_rarch->audio_driver_resampler_data,
             &p_rarch->audio_driver_resampler,
             settings->arrays.audio_resampler,
-            audio_driver_get_resampler_quality(settings),
+            p_rarch->audio_driver_resampler_quality,
             p_rarch->audio_source_ratio_original))
    {
       RARCH_ERR("Failed to initialize resampler \"%s\".\n",
@@ -28676,6 +29017,13 @@ static bool audio_driver_init_internal(
       p_rarch->audio_driver_active = false;
    }
 
+   p_rarch->audio_driver_resampler_nearest =
+         p_rarch->audio_driver_resampler
+      && string_is_equal(p_rarch->audio_driver_resampler->ident,
+            "nearest");
+   p_rarch->audio_driver_s16_phase         = 0;
+   p_rarch->audio_driver_s16_passthrough   = false;
+
    p_rarch->audio_driver_data_ptr   = 0;
 
    retro_assert(settings->uints.audio_output_sample_rate <
@@ -28691,6 +29039,39 @@ static bool audio_driver_init_internal(
    p_rarch->audio_driver_output_samples_buf = (float*)samples_buf;
    p_rarch->audio_driver_control            = false;
 
+   if (     settings->bools.audio_timestretch
+         && p_rarch->audio_driver_active)
+   {
+      /* Room for a chunk at the slowest speed, plus the
+       * segment's worth the stretcher may catch up by. */
+      size_t frames = (size_t)(AUDIO_CHUNK_SIZE_NONBLOCKING
+            * (slowmotion_ratio > 1.0f ? slowmotion_ratio : 1.0f))
+         + (size_t)(p_rarch->audio_driver_input
+            * RETRO_TIMESTRETCH_MAX_SEGMENT_MS / 1000.0f) + 1;
+
+      p_rarch->audio_driver_timestretch     =
+         retro_timestretch_new(p_rarch->audio_driver_input);
+      p_rarch->audio_driver_timestretch_buf = (float*)
+         memalign_alloc(64, frames * 2 * sizeof(float));
+
+      if (     p_rarch->audio_driver_timestretch
+            && p_rarch->audio_driver_timestretch_buf)
+         p_rarch->audio_driver_timestretch_frames = frames;
+      else
+      {
+         RARCH_WARN("[Audio]: Failed to initialize time-stretching.\n");
+         retro_timestretch_free(p_rarch->audio_driver_timestretch);
+         p_rarch->audio_driver_timestretch  = NULL;
+      }
+   }
+
+   /* Best guess until fast-forward has been measured. */
+   p_rarch->audio_driver_fastforward_speed  =
+      settings->floats.fastforward_ratio > 1.0f
+      ? settings->floats.fastforward_ratio : 2.0f;
+   p_rarch->audio_driver_fastforward_time   = 0;
+   p_rarch->audio_driver_timestretch_active = false;
+
    if (
          !audio_cb_inited
          && p_rarch->audio_driver_active
@@ -28710,6 +29091,44 @@ static bool audio_driver_init_internal(
          RARCH_WARN("[Audio]: Rate control was desired, but driver does not support needed features.\n");
    }
 
+   {
+      audio_telemetry_t *tm = &p_rarch->audio_driver_telemetry;
+      unsigned frame_size   = p_rarch->audio_driver_use_float
+         ? 2 * sizeof(float) : 2 * sizeof(int16_t);
+
+      memset(tm, 0, sizeof(*tm));
+      audio_driver_telemetry_reset(p_rarch);
+      tm->output_rate                = settings->uints.audio_output_sample_rate;
+      p_rarch->audio_driver_nonblock = !audio_sync
+         && p_rarch->audio_driver_active;
+
+      if (     p_rarch->audio_driver_active
+            && p_rarch->current_audio->write_avail
+            && p_rarch->current_audio->buffer_size)
+      {
+         tm->buffer_size             = (unsigned)
+            p_rarch->current_audio->buffer_size(
+                  p_rarch->audio_driver_context_audio_data);
+         tm->buffer_ms               = tm->buffer_size * 1000.0f
+            / (frame_size * tm->output_rate);
+      }
+
+      p_rarch->audio_driver_rate_control_adaptive =
+            p_rarch->audio_driver_control
+         && settings->bools.audio_rate_control_adaptive;
+      p_rarch->audio_driver_latency_target        = (unsigned)(
+            (uint64_t)settings->uints.audio_latency_target
+            * tm->output_rate / 1000 * frame_size);
+      p_rarch->audio_driver_rate_fill             = -1.0f;
+      p_rarch->audio_driver_rate_jitter           = 0.0f;
+      p_rarch->audio_driver_rate_margin           = 0.0f;
+      p_rarch->audio_driver_rate_integral         = 0.0f;
+      if (p_rarch->audio_driver_control)
+         tm->target_ms                            = tm->buffer_ms / 2;
+
+      p_rarch->audio_driver_telemetry_snapshot    = *tm;
+   }
+
    command_event(CMD_EVENT_DSP_FILTER_INIT, NULL);
 
    p_rarch->audio_driver_free_samples_count = 0;
@@ -28726,74 +29145,269 @@ static bool audio_driver_init_internal(
       audio_driver_start(p_rarch,
             false);
 
+#ifdef HAVE_AUDIO_PROCESSING_THREAD
+   /* Callback-driven cores already feed a threaded driver. */
+   if (     settings->bools.audio_processing_thread
+         && p_rarch->audio_driver_active
+         && !audio_cb_inited)
+   {
+      if (audio_processing_thread_init(p_rarch, !audio_sync))
+         RARCH_LOG("[Audio]: Processing audio on a separate thread.\n");
+      else
+         RARCH_ERR("[Audio]: Failed to start the audio processing thread.\n");
+   }
+#endif
+
    return true;
 
 error:
    return audio_driver_deinit(p_rarch, settings);
 }
 
-/**
- * audio_driver_flush:
- * @data                 : pointer to audio buffer.
- * @right                : amount of samples to write.
- *
- * Writes audio samples to audio driver. Will first
- * perform DSP processing (if enabled) and resampling.
- **/
-static void audio_driver_flush(
-      struct rarch_state *p_rarch,
-      float slowmotion_ratio,
-      bool audio_fastforward_mute,
-      const int16_t *data, size_t samples,
-      bool is_slowmotion, bool is_fastmotion)
+#ifdef HAVE_AUDIO_PROCESSING_THREAD
+#define AUDIO_RING_LOAD(ptr)       __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define AUDIO_RING_STORE(ptr, val) __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#define AUDIO_PROCESSING_SEGMENT(t, i) \
+   ((t)->segments[(i) & (AUDIO_PROCESSING_SEGMENTS - 1)])
+
+static size_t audio_processing_thread_pending(
+      audio_processing_thread_t *t)
 {
-   struct resampler_data src_data;
-   float audio_volume_gain           = (p_rarch->audio_driver_mute_enable ||
-         (audio_fastforward_mute && is_fastmotion)) ?
-               0.0f : p_rarch->audio_driver_volume_gain;
+   return AUDIO_RING_LOAD(&t->head) - AUDIO_RING_LOAD(&t->tail);
+}
+#endif
 
-   src_data.data_out                 = NULL;
-   src_data.output_frames            = 0;
+/* Bytes of driver output the audio processing thread
+ * has yet to write, estimated from its pending input. */
+static size_t audio_driver_pending_bytes(struct rarch_state *p_rarch)
+{
+#ifdef HAVE_AUDIO_PROCESSING_THREAD
+   audio_processing_thread_t *t = p_rarch->audio_processing_thread;
 
-   convert_s16_to_float(p_rarch->audio_driver_input_data, data, samples,
-         audio_volume_gain);
+   if (t)
+      return (size_t)(audio_processing_thread_pending(t)
+            * p_rarch->audio_source_ratio_current
+            * (p_rarch->audio_driver_use_float
+               ? sizeof(float) : sizeof(int16_t)));
+#endif
+   return 0;
+}
 
-   src_data.data_in                  = p_rarch->audio_driver_input_data;
-   src_data.input_frames             = samples >> 1;
+/* Free space in the driver's buffer, in bytes, for rate
+ * control, given the driver's own figure @driver_avail. */
+static int audio_driver_write_avail(struct rarch_state *p_rarch,
+      size_t driver_avail)
+{
+   /* Samples still waiting in the ring will land in the
+    * driver's buffer too; count them as already there. */
+   int avail = (int)driver_avail
+      - (int)audio_driver_pending_bytes(p_rarch);
+   return avail < 0 ? 0 : avail;
+}
 
-#ifdef HAVE_DSP_FILTER
-   if (p_rarch->audio_driver_dsp)
-   {
-      struct retro_dsp_data dsp_data;
+/* Weight of the newest sample in the telemetry's
+ * cost averages. */
+#define AUDIO_TELEMETRY_SMOOTHING 0.0625f
 
-      dsp_data.input                 = NULL;
-      dsp_data.input_frames          = 0;
-      dsp_data.output                = NULL;
-      dsp_data.output_frames         = 0;
+/* Folds the time since @start into the moving average
+ * @avg. Returns the current time. */
+static retro_time_t audio_driver_telemetry_cost(float *avg,
+      retro_time_t start)
+{
+   retro_time_t now = cpu_features_get_time_usec();
+   *avg            += ((float)(now - start) - *avg)
+      * AUDIO_TELEMETRY_SMOOTHING;
+   return now;
+}
 
-      dsp_data.input                 = p_rarch->audio_driver_input_data;
-      dsp_data.input_frames          = (unsigned)(samples >> 1);
+/**
+ * audio_driver_telemetry_fill:
+ * @driver_avail         : free space in the driver's buffer, in bytes.
+ * @size                 : bytes about to be written.
+ *
+ * Records the state of the driver's buffer ahead of a write.
+ **/
+static void audio_driver_telemetry_fill(struct rarch_state *p_rarch,
+      size_t driver_avail, size_t size)
+{
+   audio_telemetry_t *tm = &p_rarch->audio_driver_telemetry;
+   unsigned frame_size   = p_rarch->audio_driver_use_float
+      ? 2 * sizeof(float) : 2 * sizeof(int16_t);
+   unsigned fill         = driver_avail < tm->buffer_size
+      ? tm->buffer_size - (unsigned)driver_avail : 0;
+
+   /* Every write leaves data behind, so finding the buffer
+    * empty means it ran dry since the last one. */
+   if (!fill && p_rarch->audio_driver_telemetry_primed)
+      tm->underruns++;
+   /* Blocking writes wait for room; non-blocking ones
+    * drop whatever doesn't fit. */
+   if (driver_avail < size && p_rarch->audio_driver_nonblock)
+      tm->overruns++;
+
+   tm->fill       = fill;
+   tm->latency_ms = (fill + audio_driver_pending_bytes(p_rarch))
+      * 1000.0f / (frame_size * tm->output_rate);
+
+   if (!p_rarch->audio_driver_fill_window_bytes)
+   {
+      p_rarch->audio_driver_fill_window_min = fill;
+      p_rarch->audio_driver_fill_window_max = fill;
+   }
+   else if (fill < p_rarch->audio_driver_fill_window_min)
+      p_rarch->audio_driver_fill_window_min = fill;
+   else if (fill > p_rarch->audio_driver_fill_window_max)
+      p_rarch->audio_driver_fill_window_max = fill;
+
+   p_rarch->audio_driver_fill_window_bytes += (unsigned)size;
+   if (p_rarch->audio_driver_fill_window_bytes
+         >= frame_size * tm->output_rate)
+   {
+      tm->fill_min = p_rarch->audio_driver_fill_window_min;
+      tm->fill_max = p_rarch->audio_driver_fill_window_max;
+      p_rarch->audio_driver_fill_window_bytes = 0;
+   }
+}
+
+/* Clears the counters and the fill range, keeping what
+ * describes the driver and the averages. */
+static void audio_driver_telemetry_reset(struct rarch_state *p_rarch)
+{
+   audio_telemetry_t *tm                   = &p_rarch->audio_driver_telemetry;
+
+   tm->fill_min                            = 0;
+   tm->fill_max                            = 0;
+   tm->underruns                           = 0;
+   tm->overruns                            = 0;
+   p_rarch->audio_driver_fill_window_bytes = 0;
+   p_rarch->audio_driver_telemetry_primed  = false;
+}
+
+/* Adaptive rate control: time constant of the fill and
+ * jitter filters in seconds, proportional gain relative
+ * to the buffer size, the multiple of the jitter kept
+ * clear of underruns, and the margin an underrun adds to
+ * that, as a fraction of the buffer, which decays with the
+ * given time constant. */
+#define AUDIO_RATE_CONTROL_FILTER_TIME  0.1
+#define AUDIO_RATE_CONTROL_KP           2.0
+#define AUDIO_RATE_CONTROL_JITTER_SPAN  4.0
+#define AUDIO_RATE_CONTROL_MARGIN_STEP  0.125
+#define AUDIO_RATE_CONTROL_MARGIN_TIME  30.0
 
-      retro_dsp_filter_process(p_rarch->audio_driver_dsp, &dsp_data);
+/**
+ * audio_driver_rate_control_adjust:
+ * @avail                : free space in the driver's buffer for
+ *                         rate control, in bytes.
+ * @frames               : output frames the write will produce.
+ *
+ * PI controller steering the driver's buffer fill to
+ * the latency target. It acts on the low-passed fill, so
+ * drivers that report it in coarse steps don't make the
+ * rate wobble. The target is kept above the write size
+ * plus the fill's jitter, and a margin each underrun
+ * grows. The integral term takes up the steady clock
+ * offset, so the fill settles on the target rather than
+ * next to it.
+ *
+ * Returns: factor for the resampling ratio.
+ **/
+static double audio_driver_rate_control_adjust(
+      struct rarch_state *p_rarch, int avail, double frames)
+{
+   audio_telemetry_t *tm   = &p_rarch->audio_driver_telemetry;
+   double delta            = p_rarch->audio_driver_rate_control_delta;
+   double buffer           = p_rarch->audio_driver_buffer_size;
+   double frame_size       = p_rarch->audio_driver_use_float
+      ? 2 * sizeof(float) : 2 * sizeof(int16_t);
+   double bytes_per_sec    = frame_size * tm->output_rate;
+   double block            = frames * frame_size;
+   double dt               = frames / tm->output_rate;
+   double alpha            = dt / (AUDIO_RATE_CONTROL_FILTER_TIME + dt);
+   double fill             = buffer - avail;
+   double target           = p_rarch->audio_driver_latency_target
+      ? p_rarch->audio_driver_latency_target : buffer / 2;
+   double low, error, output;
+
+   if (p_rarch->audio_driver_rate_fill < 0.0f)
+      p_rarch->audio_driver_rate_fill = (float)fill;
+
+   if (fill <= 0.0 && p_rarch->audio_driver_telemetry_primed)
+      p_rarch->audio_driver_rate_margin  += (float)(buffer
+            * AUDIO_RATE_CONTROL_MARGIN_STEP);
+   p_rarch->audio_driver_rate_margin     *= (float)exp(
+         -dt / AUDIO_RATE_CONTROL_MARGIN_TIME);
+
+   p_rarch->audio_driver_rate_fill       += (float)(alpha
+         * (fill - p_rarch->audio_driver_rate_fill));
+   p_rarch->audio_driver_rate_jitter     += (float)(alpha
+         * (fabs(fill - p_rarch->audio_driver_rate_fill)
+            - p_rarch->audio_driver_rate_jitter));
+
+   low                     = block + p_rarch->audio_driver_rate_margin
+      + AUDIO_RATE_CONTROL_JITTER_SPAN * p_rarch->audio_driver_rate_jitter;
+   if (target < low)
+      target               = low;
+   if (target > buffer - block)
+      target               = buffer - block;
+
+   error                   = (target - p_rarch->audio_driver_rate_fill)
+      / buffer;
+   output                  = AUDIO_RATE_CONTROL_KP * error
+      + p_rarch->audio_driver_rate_integral;
+
+   /* Integral gain for a damping of 1/sqrt(2): the loop's
+    * proportional rate is delta * Kp per buffer length. */
+   if (output > -1.0 && output < 1.0)
+      p_rarch->audio_driver_rate_integral += (float)(error * dt
+            * delta * AUDIO_RATE_CONTROL_KP * AUDIO_RATE_CONTROL_KP
+            / (2.0 * buffer / bytes_per_sec));
+
+   output                  = AUDIO_RATE_CONTROL_KP * error
+      + p_rarch->audio_driver_rate_integral;
+   if (output > 1.0)
+      output               = 1.0;
+   else if (output < -1.0)
+      output               = -1.0;
+
+   tm->target_ms           = (float)(target * 1000.0 / bytes_per_sec);
+   tm->jitter_ms           = (float)(p_rarch->audio_driver_rate_jitter
+         * 1000.0 / bytes_per_sec);
+
+   return 1.0 + delta * output;
+}
+
+/* Frames asked of write_begin() beyond the resampled
+ * length, which the resamplers can exceed by one. */
+#define AUDIO_WRITE_BEGIN_SLACK 16
 
-      if (dsp_data.output)
-      {
-         src_data.data_in            = dsp_data.output;
-         src_data.input_frames       = dsp_data.output_frames;
-      }
-   }
-#endif
+/**
+ * audio_driver_control_rate:
+ * @frames               : output frames the write will produce.
+ *
+ * Readjusts the audio input rate to the driver's buffer
+ * fill, when rate control is enabled.
+ *
+ * Returns: free space in the driver's buffer, in bytes,
+ * or 0 if the driver doesn't report it.
+ **/
+static size_t audio_driver_control_rate(
+      struct rarch_state *p_rarch, double frames)
+{
+   size_t driver_avail               = 0;
 
-   src_data.data_out                 = p_rarch->audio_driver_output_samples_buf;
+   /* Set when the driver can report its buffer fill. */
+   if (p_rarch->audio_driver_telemetry.buffer_size)
+      driver_avail                   = p_rarch->current_audio->write_avail(
+            p_rarch->audio_driver_context_audio_data);
 
    if (p_rarch->audio_driver_control)
    {
       /* Readjust the audio input rate. */
       int      half_size           =
          (int)(p_rarch->audio_driver_buffer_size / 2);
-      int      avail               =
-         (int)p_rarch->current_audio->write_avail(
-               p_rarch->audio_driver_context_audio_data);
+      int      avail               = audio_driver_write_avail(p_rarch,
+            driver_avail);
       int      delta_mid           = avail - half_size;
       double   direction           = (double)delta_mid / half_size;
       double   adjust              = 1.0 +
@@ -28802,6 +29416,10 @@ static void audio_driver_flush(
          p_rarch->audio_driver_free_samples_count++ &
          (AUDIO_BUFFER_FREE_SAMPLES_COUNT - 1);
 
+      if (p_rarch->audio_driver_rate_control_adaptive)
+         adjust                    = audio_driver_rate_control_adjust(
+               p_rarch, avail, frames);
+
       p_rarch->audio_driver_free_samples_buf
          [write_idx]                        = avail;
       p_rarch->audio_source_ratio_current   =
@@ -28820,30 +29438,109 @@ static void audio_driver_flush(
 #endif
    }
 
-   src_data.ratio           = p_rarch->audio_source_ratio_current;
+   return driver_avail;
+}
+
+/**
+ * audio_driver_write_begin:
+ * @size                 : upper bound for the bytes to write.
+ *
+ * Returns: memory inside the driver's buffer to render
+ * the samples into, or NULL to render them into our own
+ * and hand them to write().
+ **/
+static void *audio_driver_write_begin(
+      struct rarch_state *p_rarch, size_t size)
+{
+   if (!p_rarch->current_audio->write_begin)
+      return NULL;
+   return p_rarch->current_audio->write_begin(
+         p_rarch->audio_driver_context_audio_data, size);
+}
+
+/**
+ * audio_driver_write_output:
+ * @begun                : @data came from audio_driver_write_begin().
+ * @data                 : samples in the driver's format.
+ * @size                 : size of @data in bytes.
+ * @driver_avail         : as returned by audio_driver_control_rate().
+ *
+ * Hands the samples to the audio driver.
+ **/
+static void audio_driver_write_output(
+      struct rarch_state *p_rarch, bool begun,
+      const void *data, size_t size, size_t driver_avail)
+{
+   ssize_t ret;
+
+   if (p_rarch->audio_driver_telemetry.buffer_size)
+      audio_driver_telemetry_fill(p_rarch, driver_avail, size);
+
+   if (begun)
+      ret = p_rarch->current_audio->write_end(
+            p_rarch->audio_driver_context_audio_data, size);
+   else
+      ret = p_rarch->current_audio->write(
+            p_rarch->audio_driver_context_audio_data, data, size);
+
+   if (ret < 0)
+      p_rarch->audio_driver_active = false;
+   else if (size)
+      p_rarch->audio_driver_telemetry_primed = true;
+}
+
+/**
+ * audio_driver_write_frames:
+ * @data                 : stereo float frames.
+ * @frames               : number of frames in @data.
+ * @ratio_scale          : extra factor for the resampling ratio
+ *                         (slow motion).
+ *
+ * Resamples and mixes @data, then writes the result
+ * to the audio driver. Float output is rendered straight
+ * into the driver's buffer when it supports that, s16
+ * output is converted into it.
+ **/
+static void audio_driver_write_frames(
+      struct rarch_state *p_rarch,
+      const float *data, size_t frames, float ratio_scale)
+{
+   struct resampler_data src_data;
+   retro_time_t start;
+   audio_telemetry_t *tm             = &p_rarch->audio_driver_telemetry;
+   void *out                         = NULL;
+   size_t driver_avail               = audio_driver_control_rate(p_rarch,
+         frames * p_rarch->audio_source_ratio_original * ratio_scale);
+
+   src_data.data_in                  = data;
+   src_data.input_frames             = frames;
+   src_data.data_out                 = p_rarch->audio_driver_output_samples_buf;
+   src_data.output_frames            = 0;
+   src_data.ratio                    =
+      p_rarch->audio_source_ratio_current * ratio_scale;
+   tm->ratio                         = src_data.ratio;
 
-   if (is_slowmotion)
-      src_data.ratio       *= slowmotion_ratio;
+   /* Fast-forward is not compensated for here: the
+    * achievable speed is only known after the fact, and
+    * per-flush measurements are far too noisy to steer the
+    * ratio with. With 'audio_timestretch' enabled, the audio
+    * is instead tempo-corrected before it gets here, see
+    * audio_driver_process(). */
 
-   /* Note: Ideally we would divide by the user-configured
-    * 'fastforward_ratio' when fast forward is enabled,
-    * but in practice this doesn't work:
-    * - 'fastforward_ratio' is only a limit. If the host
-    *   cannot push frames fast enough, the actual ratio
-    *   will be lower - and crackling will ensue
-    * - Most of the time 'fastforward_ratio' will be
-    *   zero (unlimited)
-    * So what we would need to do is measure the time since
-    * the last audio flush operation, and calculate a 'real'
-    * fast-forward ratio - but this doesn't work either.
-    * The measurement is inaccurate and the frame-by-frame
-    * fluctuations are too large, so crackling is unavoidable.
-    * Since it's going to crackle anyway, there's no point
-    * trying to do anything. Just leave the ratio as-is,
-    * and hope for the best... */
+   if (p_rarch->audio_driver_use_float)
+   {
+      out                            = audio_driver_write_begin(p_rarch,
+            ((size_t)(frames * src_data.ratio) + AUDIO_WRITE_BEGIN_SLACK)
+            * 2 * sizeof(float));
+      if (out)
+         src_data.data_out           = (float*)out;
+   }
 
+   start                    = cpu_features_get_time_usec();
    p_rarch->audio_driver_resampler->process(
          p_rarch->audio_driver_resampler_data, &src_data);
+   start                    = audio_driver_telemetry_cost(
+         &tm->resample_usec, start);
 
 #ifdef HAVE_AUDIOMIXER
    if (p_rarch->audio_mixer_active)
@@ -28861,33 +29558,719 @@ static void audio_driver_flush(
             p_rarch->audio_driver_mixer_volume_gain;
       }
       audio_mixer_mix(
-            p_rarch->audio_driver_output_samples_buf,
+            src_data.data_out,
             src_data.output_frames, mixer_gain, override);
+      audio_driver_telemetry_cost(&tm->mix_usec, start);
    }
 #endif
 
+   if (p_rarch->audio_driver_use_float)
+      audio_driver_write_output(p_rarch, out != NULL, src_data.data_out,
+            src_data.output_frames * 2 * sizeof(float), driver_avail);
+   else
    {
-      const void *output_data = p_rarch->audio_driver_output_samples_buf;
-      unsigned output_frames  = (unsigned)src_data.output_frames;
+      size_t size  = src_data.output_frames * 2 * sizeof(int16_t);
+      int16_t *buf = p_rarch->audio_driver_output_samples_conv_buf;
 
-      if (p_rarch->audio_driver_use_float)
-         output_frames       *= sizeof(float);
-      else
+      out          = audio_driver_write_begin(p_rarch, size);
+      if (out)
+         buf       = (int16_t*)out;
+
+      convert_float_to_s16(buf, src_data.data_out,
+            src_data.output_frames * 2);
+
+      audio_driver_write_output(p_rarch, out != NULL, buf, size,
+            driver_avail);
+   }
+}
+
+/**
+ * audio_driver_resample_s16:
+ * @out                  : where to write the output frames.
+ * @data                 : stereo s16 frames.
+ * @frames               : number of frames in @data.
+ * @ratio                : resampling ratio.
+ * @gain                 : volume gain to apply.
+ *
+ * Integer-only counterpart of the nearest resampler for
+ * the s16 passthrough; the phase carries over between
+ * batches.
+ *
+ * Returns: number of frames written to @out, at most
+ * (@frames * @ratio) + 1.
+ **/
+static size_t audio_driver_resample_s16(
+      struct rarch_state *p_rarch, int16_t *out,
+      const int16_t *data, size_t frames, double ratio, float gain)
+{
+   int16_t *outp       = out;
+   uint64_t pos        = p_rarch->audio_driver_s16_phase;
+   uint64_t end        = (uint64_t)frames << 32;
+   uint64_t step       = (uint64_t)(4294967296.0 / ratio);
+   int32_t scale       = (int32_t)(gain * 0x10000 + 0.5f);
+
+   if (scale == 0x10000)
+   {
+      for (; pos < end; pos += step, outp += 2)
+      {
+         const int16_t *in = data + (pos >> 32) * 2;
+         outp[0]           = in[0];
+         outp[1]           = in[1];
+      }
+   }
+   else
+   {
+      for (; pos < end; pos += step, outp += 2)
+      {
+         const int16_t *in = data + (pos >> 32) * 2;
+         int32_t l         = (int32_t)(((int64_t)in[0] * scale) >> 16);
+         int32_t r         = (int32_t)(((int64_t)in[1] * scale) >> 16);
+         outp[0]           = (int16_t)(l > 0x7FFF ? 0x7FFF
+               : l < -0x8000 ? -0x8000 : l);
+         outp[1]           = (int16_t)(r > 0x7FFF ? 0x7FFF
+               : r < -0x8000 ? -0x8000 : r);
+      }
+   }
+
+   p_rarch->audio_driver_s16_phase = pos - end;
+   return (outp - out) / 2;
+}
+
+/**
+ * audio_driver_write_s16:
+ * @data                 : stereo s16 frames from the core.
+ * @frames               : number of frames in @data.
+ * @gain                 : volume gain to apply.
+ * @ratio_scale          : extra factor for the resampling ratio
+ *                         (slow motion).
+ *
+ * Passthrough for s16 drivers when there's nothing to do
+ * in float. At a resampling ratio of exactly 1 and unity
+ * gain @data goes to the driver untouched; otherwise it
+ * is resampled into the driver's buffer if it supports
+ * that.
+ **/
+static void audio_driver_write_s16(
+      struct rarch_state *p_rarch,
+      const int16_t *data, size_t frames, float gain, float ratio_scale)
+{
+   retro_time_t start;
+   int16_t *buf;
+   void *out;
+   size_t out_frames;
+   audio_telemetry_t *tm             = &p_rarch->audio_driver_telemetry;
+   size_t driver_avail               = audio_driver_control_rate(p_rarch,
+         frames * p_rarch->audio_source_ratio_original * ratio_scale);
+   double ratio                      =
+      p_rarch->audio_source_ratio_current * ratio_scale;
+
+   tm->ratio                         = ratio;
+
+   if (ratio == 1.0 && gain == 1.0f)
+   {
+      audio_driver_write_output(p_rarch, false, data,
+            frames * 2 * sizeof(int16_t), driver_avail);
+      return;
+   }
+
+   out                      = audio_driver_write_begin(p_rarch,
+         ((size_t)(frames * ratio) + AUDIO_WRITE_BEGIN_SLACK)
+         * 2 * sizeof(int16_t));
+   /* Idle on this path, and unlike the conversion buffer
+    * never what @data points to. */
+   buf                      = out ? (int16_t*)out
+      : (int16_t*)p_rarch->audio_driver_output_samples_buf;
+
+   start                    = cpu_features_get_time_usec();
+   out_frames               = audio_driver_resample_s16(p_rarch, buf,
+         data, frames, ratio, gain);
+   audio_driver_telemetry_cost(&tm->resample_usec, start);
+
+   audio_driver_write_output(p_rarch, out != NULL, buf,
+         out_frames * 2 * sizeof(int16_t), driver_avail);
+}
+
+/**
+ * audio_driver_reset_resampler:
+ *
+ * Gives the float resampler a fresh history. What it
+ * still holds from before a stretch of s16 passthrough
+ * would otherwise be played back in front of the new
+ * audio, clicking at the seam.
+ **/
+static void audio_driver_reset_resampler(struct rarch_state *p_rarch)
+{
+   void *data                        = NULL;
+   const retro_resampler_t *backend  = NULL;
+
+   if (!p_rarch->audio_driver_resampler)
+      return;
+
+   /* Keep the old one if this fails */
+   if (!retro_resampler_realloc(&data, &backend,
+            p_rarch->audio_driver_resampler->ident,
+            p_rarch->audio_driver_resampler_quality,
+            p_rarch->audio_source_ratio_original))
+      return;
+
+   if (p_rarch->audio_driver_resampler_data)
+      p_rarch->audio_driver_resampler->free(
+            p_rarch->audio_driver_resampler_data);
+
+   p_rarch->audio_driver_resampler      = backend;
+   p_rarch->audio_driver_resampler_data = data;
+}
+
+/**
+ * audio_driver_process:
+ * @data                 : pointer to audio buffer.
+ * @samples              : amount of samples to write.
+ * @audio_volume_gain    : gain applied to @data.
+ * @ratio_scale          : extra factor for the resampling ratio
+ *                         (slow motion).
+ * @stretch              : tempo to time-stretch to, 1.0 for none.
+ *
+ * Performs DSP processing (if enabled), time-stretching,
+ * resampling and mixing, then writes the result to the
+ * audio driver. Runs on the audio processing thread when
+ * there is one.
+ **/
+static void audio_driver_process(
+      struct rarch_state *p_rarch,
+      const int16_t *data, size_t samples,
+      float audio_volume_gain, float ratio_scale, float stretch)
+{
+   float *data_in                    = p_rarch->audio_driver_input_data;
+   size_t input_frames               = samples >> 1;
+
+   /* Nothing to do in float: hand the core's samples
+    * to the driver as they are, or through the integer
+    * resampler when that's what the float one would do. */
+   if (     !p_rarch->audio_driver_use_float
+#ifdef HAVE_DSP_FILTER
+         && !p_rarch->audio_driver_dsp
+#endif
+#ifdef HAVE_AUDIOMIXER
+         && !(p_rarch->audio_mixer_active && audio_mixer_is_playing())
+#endif
+         && !(p_rarch->audio_driver_timestretch && stretch != 1.0f)
+         && !p_rarch->audio_driver_timestretch_active
+         && (p_rarch->audio_driver_resampler_nearest
+            || (!p_rarch->audio_driver_control
+               && p_rarch->audio_source_ratio_original * ratio_scale
+               == 1.0)))
+   {
+      /* Start on the first frame of this batch, not
+       * wherever the last stretch of passthrough left off. */
+      if (!p_rarch->audio_driver_s16_passthrough)
+         p_rarch->audio_driver_s16_phase   = 0;
+      p_rarch->audio_driver_s16_passthrough = true;
+
+      audio_driver_write_s16(p_rarch, data, input_frames,
+            audio_volume_gain, ratio_scale);
+      return;
+   }
+
+   /* E.g. a mixer voice just started */
+   if (p_rarch->audio_driver_s16_passthrough)
+   {
+      audio_driver_reset_resampler(p_rarch);
+      p_rarch->audio_driver_s16_passthrough = false;
+   }
+
+   convert_s16_to_float(p_rarch->audio_driver_input_data, data, samples,
+         audio_volume_gain);
+
+#ifdef HAVE_DSP_FILTER
+   if (p_rarch->audio_driver_dsp)
+   {
+      struct retro_dsp_data dsp_data;
+      retro_time_t start             = cpu_features_get_time_usec();
+
+      dsp_data.input                 = NULL;
+      dsp_data.input_frames          = 0;
+      dsp_data.output                = NULL;
+      dsp_data.output_frames         = 0;
+
+      dsp_data.input                 = p_rarch->audio_driver_input_data;
+      dsp_data.input_frames          = (unsigned)(samples >> 1);
+
+      retro_dsp_filter_process(p_rarch->audio_driver_dsp, &dsp_data);
+      audio_driver_telemetry_cost(
+            &p_rarch->audio_driver_telemetry.dsp_usec, start);
+
+      if (dsp_data.output)
+      {
+         data_in                     = dsp_data.output;
+         input_frames                = dsp_data.output_frames;
+      }
+   }
+#endif
+
+   if (p_rarch->audio_driver_timestretch && stretch != 1.0f)
+   {
+      size_t i, frames;
+      const float *stretched         = p_rarch->audio_driver_timestretch_buf;
+      retro_time_t start;
+
+      /* The measured fast-forward speed lags behind; nudge the
+       * tempo by the driver's buffer fill so the stretched audio
+       * neither overruns nor starves it meanwhile. */
+      if (p_rarch->audio_driver_control && stretch > 1.0f)
       {
-         convert_float_to_s16(p_rarch->audio_driver_output_samples_conv_buf,
-               (const float*)output_data, output_frames * 2);
+         int half_size               =
+            (int)(p_rarch->audio_driver_buffer_size / 2);
+         int avail                   = audio_driver_write_avail(p_rarch,
+               p_rarch->current_audio->write_avail(
+                  p_rarch->audio_driver_context_audio_data));
+         float direction             = (float)(avail - half_size) / half_size;
+         /* Input frames that would fill half the free space; going
+          * faster than the estimate when needed keeps a sudden jump
+          * in speed from overrunning the driver. */
+         double room                 = (double)avail / (2 *
+               (p_rarch->audio_driver_use_float
+                ? sizeof(float) : sizeof(int16_t)))
+            / p_rarch->audio_source_ratio_original / 2.0;
+
+         stretch                    *= 1.0f
+            - AUDIO_TIMESTRETCH_BUFFER_STEER * direction;
+         if (room < 1.0)
+            room                     = 1.0;
+         if (stretch < input_frames / room)
+            stretch                  = (float)(input_frames / room);
+      }
+
+      start                          = cpu_features_get_time_usec();
+      frames                         = retro_timestretch_process(
+            p_rarch->audio_driver_timestretch,
+            data_in, input_frames, stretch,
+            p_rarch->audio_driver_timestretch_buf,
+            p_rarch->audio_driver_timestretch_frames);
+      audio_driver_telemetry_cost(
+            &p_rarch->audio_driver_telemetry.stretch_usec, start);
 
-         output_data          = p_rarch->audio_driver_output_samples_conv_buf;
-         output_frames       *= sizeof(int16_t);
+      p_rarch->audio_driver_timestretch_active = true;
+
+      /* Slow motion yields more than a chunk; feed it in
+       * pieces the output buffers are sized for. */
+      for (i = 0;
+            i < frames && p_rarch->audio_driver_active;
+            i += AUDIO_CHUNK_SIZE_NONBLOCKING)
+         audio_driver_write_frames(p_rarch, stretched + i * 2,
+               MIN(frames - i, AUDIO_CHUNK_SIZE_NONBLOCKING), 1.0f);
+      return;
+   }
+
+   /* Whatever is still buffered belongs to the old tempo;
+    * fade its tail into the audio that follows. */
+   if (p_rarch->audio_driver_timestretch_active)
+   {
+      retro_timestretch_drain(p_rarch->audio_driver_timestretch,
+            data_in, input_frames);
+      p_rarch->audio_driver_timestretch_active = false;
+   }
+
+   audio_driver_write_frames(p_rarch, data_in, input_frames, ratio_scale);
+}
+
+#ifdef HAVE_AUDIO_PROCESSING_THREAD
+static void audio_processing_thread_wake(audio_processing_thread_t *t)
+{
+   slock_lock(t->wake_lock);
+   scond_broadcast(t->wake_cond);
+   slock_unlock(t->wake_lock);
+}
+
+static void audio_processing_thread_loop(void *data)
+{
+   struct rarch_state          *p_rarch = &rarch_st;
+   audio_processing_thread_t         *t = (audio_processing_thread_t*)data;
+
+   for (;;)
+   {
+      size_t i, samples, segment_head;
+      audio_processing_segment_t segment;
+      size_t tail    = t->tail;
+      size_t current = t->segment_tail;
+
+      slock_lock(t->wake_lock);
+      while (!t->quit && (t->stopped || !audio_processing_thread_pending(t)))
+         scond_wait(t->wake_cond, t->wake_lock);
+      slock_unlock(t->wake_lock);
+
+      if (t->quit)
+         break;
+
+      /* Largest input audio_driver_process() is sized for. */
+      samples      = audio_processing_thread_pending(t);
+      if (samples > AUDIO_CHUNK_SIZE_NONBLOCKING * 2)
+         samples   = AUDIO_CHUNK_SIZE_NONBLOCKING * 2;
+
+      /* The producer publishes a segment before its samples,
+       * so everything up to the head has one. Segments are
+       * never empty; one starting here ends the current one. */
+      segment_head = AUDIO_RING_LOAD(&t->segment_head);
+      if (     current + 1 != segment_head
+            && AUDIO_PROCESSING_SEGMENT(t, current + 1).start == tail)
+         current++;
+
+      /* Stop at the next segment; its samples go out
+       * with its own settings. */
+      segment = AUDIO_PROCESSING_SEGMENT(t, current);
+      if (current + 1 != segment_head)
+      {
+         size_t end = AUDIO_PROCESSING_SEGMENT(t, current + 1).start;
+         if (samples > end - tail)
+            samples = end - tail;
       }
 
-      if (p_rarch->current_audio->write(
-               p_rarch->audio_driver_context_audio_data,
-               output_data, output_frames * 2) < 0)
-         p_rarch->audio_driver_active = false;
+      for (i = 0; i < samples; i++)
+         t->chunk[i] = t->ring[(tail + i) & (AUDIO_PROCESSING_RING_SIZE - 1)];
+
+      /* Hand back a finished segment with its samples, so a
+       * producer that sees an empty ring has a free entry. */
+      tail += samples;
+      if (     current + 1 != segment_head
+            && AUDIO_PROCESSING_SEGMENT(t, current + 1).start == tail)
+         current++;
+      AUDIO_RING_STORE(&t->segment_tail, current);
+      AUDIO_RING_STORE(&t->tail, tail);
+      audio_processing_thread_wake(t);
+
+      slock_lock(t->lock);
+      if (p_rarch->audio_driver_active)
+         audio_driver_process(p_rarch, t->chunk, samples,
+               segment.volume_gain, segment.ratio_scale, segment.stretch);
+      slock_unlock(t->lock);
    }
 }
 
+/* Producer side, on the thread that runs the core. Blocks
+ * while the ring is too full when the driver is blocking,
+ * drops what doesn't fit otherwise - as the driver would.
+ * The samples are processed with the settings given here. */
+static void audio_processing_thread_push(audio_processing_thread_t *t,
+      const int16_t *data, size_t samples,
+      float volume_gain, float ratio_scale, float stretch)
+{
+   size_t i, space;
+   size_t head         = t->head;
+   size_t segment_head = t->segment_head;
+   /* Only the producer writes segments, so the newest is ours
+    * to read; the thread may still be working through it. */
+   const audio_processing_segment_t *last =
+      &AUDIO_PROCESSING_SEGMENT(t, segment_head - 1);
+   bool new_segment    =
+            last->volume_gain != volume_gain
+         || last->ratio_scale != ratio_scale
+         || last->stretch     != stretch;
+
+   slock_lock(t->wake_lock);
+   while (!t->nonblock)
+   {
+      size_t pending = head - AUDIO_RING_LOAD(&t->tail);
+
+      if (     t->quit
+            || t->stopped
+            || pending == 0
+            || (     pending + samples <= t->block_limit
+                  && pending + samples <= AUDIO_PROCESSING_RING_SIZE
+                  && (!new_segment || segment_head
+                     - AUDIO_RING_LOAD(&t->segment_tail)
+                     < AUDIO_PROCESSING_SEGMENTS)))
+         break;
+
+      scond_wait(t->wake_cond, t->wake_lock);
+   }
+   slock_unlock(t->wake_lock);
+
+   space = AUDIO_PROCESSING_RING_SIZE - (head - AUDIO_RING_LOAD(&t->tail));
+   if (samples > space)
+      samples = space & ~(size_t)1;
+   if (     new_segment
+         && segment_head - AUDIO_RING_LOAD(&t->segment_tail)
+            >= AUDIO_PROCESSING_SEGMENTS)
+      samples = 0;
+
+   if (!samples)
+      return;
+
+   if (new_segment)
+   {
+      audio_processing_segment_t *segment =
+         &AUDIO_PROCESSING_SEGMENT(t, segment_head);
+      segment->start       = head;
+      segment->volume_gain = volume_gain;
+      segment->ratio_scale = ratio_scale;
+      segment->stretch     = stretch;
+      AUDIO_RING_STORE(&t->segment_head, segment_head + 1);
+   }
+
+   for (i = 0; i < samples; i++)
+      t->ring[(head + i) & (AUDIO_PROCESSING_RING_SIZE - 1)] = data[i];
+
+   AUDIO_RING_STORE(&t->head, head + samples);
+   audio_processing_thread_wake(t);
+}
+
+static void audio_processing_thread_free(struct rarch_state *p_rarch)
+{
+   audio_processing_thread_t *t = p_rarch->audio_processing_thread;
+
+   if (!t)
+      return;
+
+   if (t->thread)
+   {
+      slock_lock(t->wake_lock);
+      t->quit = true;
+      scond_broadcast(t->wake_cond);
+      slock_unlock(t->wake_lock);
+      sthread_join(t->thread);
+   }
+
+   if (t->wake_cond)
+      scond_free(t->wake_cond);
+   if (t->wake_lock)
+      slock_free(t->wake_lock);
+   if (t->lock)
+      slock_free(t->lock);
+   if (t->ring)
+      memalign_free(t->ring);
+   if (t->chunk)
+      memalign_free(t->chunk);
+   free(t);
+
+   p_rarch->audio_processing_thread = NULL;
+}
+
+static bool audio_processing_thread_init(struct rarch_state *p_rarch,
+      bool nonblock)
+{
+   const struct retro_system_timing *timing =
+      &p_rarch->video_driver_av_info.timing;
+   size_t block_limit           = AUDIO_CHUNK_SIZE_BLOCKING;
+   audio_processing_thread_t *t = (audio_processing_thread_t*)
+      calloc(1, sizeof(*t));
+
+   if (!t)
+      return false;
+
+   p_rarch->audio_processing_thread = t;
+
+   /* About a frame's worth of samples. */
+   if (timing->fps > 0.0)
+      block_limit = (size_t)(p_rarch->audio_driver_input / timing->fps) * 2;
+   if (block_limit < AUDIO_CHUNK_SIZE_BLOCKING)
+      block_limit = AUDIO_CHUNK_SIZE_BLOCKING;
+   if (block_limit > AUDIO_PROCESSING_RING_SIZE / 2)
+      block_limit = AUDIO_PROCESSING_RING_SIZE / 2;
+
+   t->block_limit = block_limit;
+   t->nonblock    = nonblock;
+   /* Every sample belongs to some segment; start with one. */
+   t->segments[0].volume_gain = p_rarch->audio_driver_volume_gain;
+   t->segments[0].ratio_scale = 1.0f;
+   t->segments[0].stretch     = 1.0f;
+   t->segment_head            = 1;
+   t->ring        = (int16_t*)memalign_alloc(64,
+         AUDIO_PROCESSING_RING_SIZE * sizeof(int16_t));
+   t->chunk       = (int16_t*)memalign_alloc(64,
+         AUDIO_CHUNK_SIZE_NONBLOCKING * 2 * sizeof(int16_t));
+   t->lock        = slock_new();
+   t->wake_lock   = slock_new();
+   t->wake_cond   = scond_new();
+
+   if (     !t->ring  || !t->chunk
+         || !t->lock  || !t->wake_lock || !t->wake_cond
+         || !(t->thread = sthread_create(audio_processing_thread_loop, t)))
+   {
+      audio_processing_thread_free(p_rarch);
+      return false;
+   }
+
+   return true;
+}
+#endif
+
+/* Serializes the main thread's access to the audio driver
+ * and the DSP filter with the audio processing thread.
+ * Nests; a no-op without the thread, or on it. */
+static void audio_driver_lock(struct rarch_state *p_rarch)
+{
+#ifdef HAVE_AUDIO_PROCESSING_THREAD
+   audio_processing_thread_t *t = p_rarch->audio_processing_thread;
+
+   if (t && !sthread_isself(t->thread) && t->lock_depth++ == 0)
+      slock_lock(t->lock);
+#endif
+}
+
+static void audio_driver_unlock(struct rarch_state *p_rarch)
+{
+#ifdef HAVE_AUDIO_PROCESSING_THREAD
+   audio_processing_thread_t *t = p_rarch->audio_processing_thread;
+
+   if (t && !sthread_isself(t->thread) && --t->lock_depth == 0)
+      slock_unlock(t->lock);
+#endif
+}
+
+/**
+ * audio_driver_get_telemetry:
+ * @telemetry            : filled in with the latest measurements.
+ * @wait                 : whether to wait for the audio processing
+ *                         thread if it's busy, rather than return
+ *                         the previous snapshot.
+ *
+ * Reads the audio telemetry from the main thread.
+ **/
+static void audio_driver_get_telemetry(struct rarch_state *p_rarch,
+      audio_telemetry_t *telemetry, bool wait)
+{
+#ifdef HAVE_AUDIO_PROCESSING_THREAD
+   audio_processing_thread_t *t = p_rarch->audio_processing_thread;
+
+   /* Don't hold up a frame on a thread blocked in a write. */
+   if (t && !wait && !t->lock_depth)
+   {
+      if (slock_try_lock(t->lock))
+      {
+         p_rarch->audio_driver_telemetry_snapshot =
+            p_rarch->audio_driver_telemetry;
+         slock_unlock(t->lock);
+      }
+      *telemetry = p_rarch->audio_driver_telemetry_snapshot;
+      return;
+   }
+#endif
+
+   audio_driver_lock(p_rarch);
+   p_rarch->audio_driver_telemetry_snapshot =
+      p_rarch->audio_driver_telemetry;
+   audio_driver_unlock(p_rarch);
+   *telemetry = p_rarch->audio_driver_telemetry_snapshot;
+}
+
+static void audio_driver_set_nonblock_state(
+      struct rarch_state *p_rarch, bool nonblock)
+{
+   audio_driver_lock(p_rarch);
+   p_rarch->current_audio->set_nonblock_state(
+         p_rarch->audio_driver_context_audio_data, nonblock);
+   p_rarch->audio_driver_nonblock = nonblock;
+#ifdef HAVE_AUDIO_PROCESSING_THREAD
+   if (p_rarch->audio_processing_thread)
+   {
+      audio_processing_thread_t *t = p_rarch->audio_processing_thread;
+      /* Let a producer waiting for room re-check. */
+      slock_lock(t->wake_lock);
+      t->nonblock = nonblock;
+      scond_broadcast(t->wake_cond);
+      slock_unlock(t->wake_lock);
+   }
+#endif
+   audio_driver_unlock(p_rarch);
+}
+
+/* Speed actually achieved while fast-forwarding: audio
+ * pushed against wall-clock time, over windows long enough
+ * to even out the frame-to-frame jitter, then smoothed. */
+static float audio_driver_fastforward_speed(
+      struct rarch_state *p_rarch, size_t samples)
+{
+   retro_time_t now = cpu_features_get_time_usec();
+   retro_time_t elapsed;
+
+   if (!p_rarch->audio_driver_fastforward_time)
+   {
+      p_rarch->audio_driver_fastforward_time   = now;
+      p_rarch->audio_driver_fastforward_frames = 0;
+      return p_rarch->audio_driver_fastforward_speed;
+   }
+
+   p_rarch->audio_driver_fastforward_frames   += samples >> 1;
+   elapsed = now - p_rarch->audio_driver_fastforward_time;
+
+   if (elapsed >= AUDIO_FASTFORWARD_MEASURE_USEC)
+   {
+      float speed = (float)(p_rarch->audio_driver_fastforward_frames
+            * 1000000.0 / (p_rarch->audio_driver_input * elapsed));
+
+      if (speed < 1.0f)
+         speed    = 1.0f;
+
+      /* Smooth out jitter, but follow a real change at once;
+       * an unlimited fast-forward is far off any guess. */
+      if (     speed > p_rarch->audio_driver_fastforward_speed * 2.0f
+            || speed < p_rarch->audio_driver_fastforward_speed * 0.5f)
+         p_rarch->audio_driver_fastforward_speed  = speed;
+      else
+         p_rarch->audio_driver_fastforward_speed +=
+            (speed - p_rarch->audio_driver_fastforward_speed) * 0.5f;
+      p_rarch->audio_driver_fastforward_time   = now;
+      p_rarch->audio_driver_fastforward_frames = 0;
+   }
+
+   return p_rarch->audio_driver_fastforward_speed;
+}
+
+/**
+ * audio_driver_flush:
+ * @data                 : pointer to audio buffer.
+ * @samples              : amount of samples to write.
+ *
+ * Writes audio samples to audio driver. Will first
+ * perform DSP processing (if enabled) and resampling,
+ * here or on the audio processing thread.
+ **/
+static void audio_driver_flush(
+      struct rarch_state *p_rarch,
+      float slowmotion_ratio,
+      bool audio_fastforward_mute,
+      const int16_t *data, size_t samples,
+      bool is_slowmotion, bool is_fastmotion)
+{
+   float audio_volume_gain           = (p_rarch->audio_driver_mute_enable ||
+         (audio_fastforward_mute && is_fastmotion)) ?
+               0.0f : p_rarch->audio_driver_volume_gain;
+   float ratio_scale                 = is_slowmotion ? slowmotion_ratio : 1.0f;
+   float stretch                     = 1.0f;
+#ifdef HAVE_AUDIO_PROCESSING_THREAD
+   audio_processing_thread_t *t      = p_rarch->audio_processing_thread;
+#endif
+
+   frame_timeline_begin(FRAME_TIMELINE_AUDIO_FLUSH);
+
+   if (p_rarch->audio_driver_timestretch)
+   {
+      /* Keep the pitch: slow the tempo down rather
+       * than the resampling ratio. */
+      if (is_slowmotion)
+      {
+         stretch                     = 1.0f / slowmotion_ratio;
+         ratio_scale                 = 1.0f;
+      }
+      else if (is_fastmotion && audio_volume_gain != 0.0f)
+         stretch                     = audio_driver_fastforward_speed(
+               p_rarch, samples);
+   }
+
+   if (!is_fastmotion)
+      p_rarch->audio_driver_fastforward_time = 0;
+
+#ifdef HAVE_AUDIO_PROCESSING_THREAD
+   if (t)
+      audio_processing_thread_push(t, data, samples,
+            audio_volume_gain, ratio_scale, stretch);
+   else
+#endif
+      audio_driver_process(p_rarch, data, samples,
+            audio_volume_gain, ratio_scale, stretch);
+
+   frame_timeline_end(FRAME_TIMELINE_AUDIO_FLUSH);
+}
+
 /**
  * audio_driver_sample:
  * @left                 : value of the left audio channel.
@@ -29414,16 +30797,24 @@ bool audio_driver_mixer_add_stream(audio_mixer_stream_params_t *params)
    if (params->state == AUDIO_STREAM_STATE_NONE)
       return false;
 
-   buf = malloc(params->bufsize);
+   /* No buffer: streamed from params->path */
+   if (params->buf)
+   {
+      buf = malloc(params->bufsize);
 
-   if (!buf)
-      return false;
+      if (!buf)
+         return false;
 
-   memcpy(buf, params->buf, params->bufsize);
+      memcpy(buf, params->buf, params->bufsize);
+   }
+   else if (string_is_empty(params->path))
+      return false;
 
    switch (params->type)
    {
       case AUDIO_MIXER_TYPE_WAV:
+         if (!buf)
+            break;
          handle = audio_mixer_load_wav(buf, (int32_t)params->bufsize);
          /* WAV is a special case - input buffer is not
           * free()'d when sound playback is complete (it is
@@ -29433,19 +30824,27 @@ bool audio_driver_mixer_add_stream(audio_mixer_stream_params_t *params)
          buf = NULL;
          break;
       case AUDIO_MIXER_TYPE_OGG:
-         handle = audio_mixer_load_ogg(buf, (int32_t)params->bufsize);
+         if (buf)
+            handle = audio_mixer_load_ogg(buf, (int32_t)params->bufsize);
          break;
       case AUDIO_MIXER_TYPE_MOD:
-         handle = audio_mixer_load_mod(buf, (int32_t)params->bufsize);
+         if (buf)
+            handle = audio_mixer_load_mod(buf, (int32_t)params->bufsize);
          break;
       case AUDIO_MIXER_TYPE_FLAC:
 #ifdef HAVE_DR_FLAC
-         handle = audio_mixer_load_flac(buf, (int32_t)params->bufsize);
+         if (buf)
+            handle = audio_mixer_load_flac(buf, (int32_t)params->bufsize);
+         else
+            handle = audio_mixer_load_flac_file(params->path);
 #endif
          break;
       case AUDIO_MIXER_TYPE_MP3:
 #ifdef HAVE_DR_MP3
-         handle = audio_mixer_load_mp3(buf, (int32_t)params->bufsize);
+         if (buf)
+            handle = audio_mixer_load_mp3(buf, (int32_t)params->bufsize);
+         else
+            handle = audio_mixer_load_mp3_file(params->path);
 #endif
          break;
       case AUDIO_MIXER_TYPE_NONE:
@@ -29715,6 +31114,8 @@ void audio_driver_mixer_stop_stream(unsigned i)
    if (i >= AUDIO_MIXER_MAX_SYSTEM_STREAMS)
       return;
 
+   audio_driver_lock(p_rarch);
+
    switch (p_rarch->audio_mixer_streams[i].state)
    {
       case AUDIO_STREAM_STATE_PLAYING:
@@ -29736,6 +31137,8 @@ void audio_driver_mixer_stop_stream(unsigned i)
       p_rarch->audio_mixer_streams[i].state   = AUDIO_STREAM_STATE_STOPPED;
       p_rarch->audio_mixer_streams[i].volume  = 1.0f;
    }
+
+   audio_driver_unlock(p_rarch);
 }
 
 void audio_driver_mixer_remove_stream(unsigned i)
@@ -29746,6 +31149,10 @@ void audio_driver_mixer_remove_stream(unsigned i)
    if (i >= AUDIO_MIXER_MAX_SYSTEM_STREAMS)
       return;
 
+   /* Also keeps a stream that finishes playing on the
+    * audio processing thread from being freed twice. */
+   audio_driver_lock(p_rarch);
+
    switch (p_rarch->audio_mixer_streams[i].state)
    {
       case AUDIO_STREAM_STATE_PLAYING:
@@ -29777,6 +31184,8 @@ void audio_driver_mixer_remove_stream(unsigned i)
       p_rarch->audio_mixer_streams[i].voice   = NULL;
       p_rarch->audio_mixer_streams[i].name    = NULL;
    }
+
+   audio_driver_unlock(p_rarch);
 }
 #endif
 
@@ -29850,13 +31259,35 @@ static INLINE bool audio_driver_alive(struct rarch_state *p_rarch)
 static bool audio_driver_start(struct rarch_state *p_rarch,
       bool is_shutdown)
 {
+   bool ret;
+#ifdef HAVE_AUDIO_PROCESSING_THREAD
+   audio_processing_thread_t *t = p_rarch->audio_processing_thread;
+#endif
+
    if (!p_rarch->current_audio || !p_rarch->current_audio->start
          || !p_rarch->audio_driver_context_audio_data)
       goto error;
-   if (!p_rarch->current_audio->start(
-            p_rarch->audio_driver_context_audio_data, is_shutdown))
+
+   audio_driver_lock(p_rarch);
+   ret = p_rarch->current_audio->start(
+         p_rarch->audio_driver_context_audio_data, is_shutdown);
+   /* Whatever drained while stopped isn't an underrun. */
+   p_rarch->audio_driver_telemetry_primed = false;
+   audio_driver_unlock(p_rarch);
+
+   if (!ret)
       goto error;
 
+#ifdef HAVE_AUDIO_PROCESSING_THREAD
+   if (t)
+   {
+      slock_lock(t->wake_lock);
+      t->stopped = false;
+      scond_broadcast(t->wake_cond);
+      slock_unlock(t->wake_lock);
+   }
+#endif
+
    return true;
 
 error:
@@ -29868,14 +31299,36 @@ error:
 
 static bool audio_driver_stop(struct rarch_state *p_rarch)
 {
+   bool ret;
+#ifdef HAVE_AUDIO_PROCESSING_THREAD
+   audio_processing_thread_t *t = p_rarch->audio_processing_thread;
+#endif
+
    if (     !p_rarch->current_audio
          || !p_rarch->current_audio->stop
          || !p_rarch->audio_driver_context_audio_data
          || !audio_driver_alive(p_rarch)
       )
       return false;
-   return p_rarch->current_audio->stop(
+
+#ifdef HAVE_AUDIO_PROCESSING_THREAD
+   /* A write to a stopped driver may block for good;
+    * keep the thread off it until it's started again. */
+   if (t)
+   {
+      slock_lock(t->wake_lock);
+      t->stopped = true;
+      scond_broadcast(t->wake_cond);
+      slock_unlock(t->wake_lock);
+   }
+#endif
+
+   audio_driver_lock(p_rarch);
+   ret = p_rarch->current_audio->stop(
          p_rarch->audio_driver_context_audio_data);
+   audio_driver_unlock(p_rarch);
+
+   return ret;
 }
 
 #ifdef HAVE_REWIND
@@ -30539,6 +31992,9 @@ static void video_driver_free_internal(struct rarch_state *p_rarch)
    if (p_rarch->video_driver_scaler_ptr)
       video_driver_pixel_converter_free(p_rarch->video_driver_scaler_ptr);
    p_rarch->video_driver_scaler_ptr = NULL;
+   free(p_rarch->video_driver_frame_row_hashes);
+   p_rarch->video_driver_frame_row_hashes = NULL;
+   p_rarch->video_driver_frame_hash_valid = false;
 #ifdef HAVE_VIDEO_FILTER
    video_driver_filter_free();
 #endif
@@ -30820,6 +32276,8 @@ static bool video_driver_init_internal(
 
    /* Reset video frame count */
    p_rarch->video_driver_frame_count = 0;
+   /* The new driver has no frame to repeat yet */
+   p_rarch->video_driver_frame_hash_valid = false;
 
    tmp                               = p_rarch->current_input;
    /* Need to grab the "real" video driver interface on a reinit. */
@@ -31265,6 +32723,9 @@ void video_driver_cached_frame(void)
 
    /* Cannot allow recording when pushing duped frames. */
    p_rarch->recording_data      = NULL;
+   /* Callers push the cached frame to get it uploaded again,
+    * don't turn it into a dupe. */
+   p_rarch->video_driver_frame_hash_valid = false;
 
    if (p_rarch->current_core.inited)
       cbs->frame_cb(
@@ -31934,6 +33395,124 @@ struct video_viewport *video_viewport_get_custom(void)
  *
  * Video frame render callback function.
  **/
+#define VIDEO_FRAME_HASH_PRIME1 0x9E3779B185EBCA87ULL
+#define VIDEO_FRAME_HASH_PRIME2 0xC2B2AE3D27D4EB4FULL
+#define VIDEO_FRAME_HASH_ROUND(acc, v) \
+   acc = ((acc) + (v) * VIDEO_FRAME_HASH_PRIME2); \
+   acc = (((acc) << 31) | ((acc) >> 33)) * VIDEO_FRAME_HASH_PRIME1
+
+/**
+ * video_driver_frame_hash_row:
+ *
+ * 64-bit hash of one row of a software frame. Four
+ * independent lanes keep the multiplies pipelined, so
+ * this runs at close to memory speed.
+ **/
+static uint64_t video_driver_frame_hash_row(const uint8_t *row,
+      size_t row_size)
+{
+   size_t i  = 0;
+   uint64_t acc[4];
+
+   acc[0]    = VIDEO_FRAME_HASH_PRIME1;
+   acc[1]    = VIDEO_FRAME_HASH_PRIME2;
+   acc[2]    = VIDEO_FRAME_HASH_PRIME1 + row_size;
+   acc[3]    = VIDEO_FRAME_HASH_PRIME2 - row_size;
+
+   for (; i + 32 <= row_size; i += 32)
+   {
+      uint64_t v[4];
+      memcpy(v, row + i, sizeof(v));
+      VIDEO_FRAME_HASH_ROUND(acc[0], v[0]);
+      VIDEO_FRAME_HASH_ROUND(acc[1], v[1]);
+      VIDEO_FRAME_HASH_ROUND(acc[2], v[2]);
+      VIDEO_FRAME_HASH_ROUND(acc[3], v[3]);
+   }
+
+   for (; i < row_size; i += 2)
+   {
+      uint16_t tail;
+      memcpy(&tail, row + i, sizeof(tail));
+      VIDEO_FRAME_HASH_ROUND(acc[0], tail);
+   }
+
+   acc[0] ^= (acc[1] << 7  | acc[1] >> 57);
+   acc[0] ^= (acc[2] << 12 | acc[2] >> 52);
+   acc[0] ^= (acc[3] << 18 | acc[3] >> 46);
+   acc[0] ^= acc[0] >> 33;
+   acc[0] *= VIDEO_FRAME_HASH_PRIME2;
+   acc[0] ^= acc[0] >> 29;
+
+   return acc[0];
+}
+
+/**
+ * video_driver_frame_diff:
+ *
+ * Compares a software frame with the previous one the
+ * driver got, row by row, and remembers it for the next.
+ *
+ * Returns false if there is nothing to compare with.
+ * Otherwise, @dirty_y and @dirty_height are the range of
+ * rows that changed, 0 rows for a duplicate.
+ **/
+static bool video_driver_frame_diff(struct rarch_state *p_rarch,
+      const void *data, unsigned width, unsigned height, size_t pitch,
+      unsigned *dirty_y, unsigned *dirty_height)
+{
+   unsigned y;
+   unsigned first    = height;
+   unsigned last     = 0;
+   unsigned bpp      =
+      (p_rarch->video_driver_pix_fmt == RETRO_PIXEL_FORMAT_XRGB8888)
+      ? 4 : 2;
+   size_t row_size   = (size_t)width * bpp;
+   bool valid        =
+          p_rarch->video_driver_frame_hash_valid
+      &&  p_rarch->video_driver_frame_hash_width  == width
+      &&  p_rarch->video_driver_frame_hash_height == height
+      &&  p_rarch->video_driver_frame_hash_bpp    == bpp;
+
+   if (!valid)
+   {
+      uint64_t *hashes = (uint64_t*)realloc(
+            p_rarch->video_driver_frame_row_hashes,
+            height * sizeof(*hashes));
+
+      p_rarch->video_driver_frame_hash_valid     = false;
+      if (!hashes)
+         return false;
+
+      p_rarch->video_driver_frame_row_hashes     = hashes;
+      p_rarch->video_driver_frame_hash_width     = width;
+      p_rarch->video_driver_frame_hash_height    = height;
+      p_rarch->video_driver_frame_hash_bpp       = bpp;
+   }
+
+   for (y = 0; y < height; y++)
+   {
+      uint64_t hash = video_driver_frame_hash_row(
+            (const uint8_t*)data + y * pitch, row_size);
+
+      if (hash == p_rarch->video_driver_frame_row_hashes[y])
+         continue;
+
+      p_rarch->video_driver_frame_row_hashes[y] = hash;
+      if (first == height)
+         first = y;
+      last     = y;
+   }
+
+   p_rarch->video_driver_frame_hash_valid       = true;
+
+   if (!valid)
+      return false;
+
+   *dirty_y      = (first < height) ? first : 0;
+   *dirty_height = (first < height) ? last - first + 1 : 0;
+   return true;
+}
+
 static void video_driver_frame(const void *data, unsigned width,
       unsigned height, size_t pitch)
 {
@@ -31950,6 +33529,22 @@ static void video_driver_frame(const void *data, unsigned width,
       video_driver_pix_fmt      = p_rarch->video_driver_pix_fmt;
    bool runloop_idle            = runloop_state.idle;
    bool video_driver_active     = p_rarch->video_driver_active;
+   settings_t *settings         = p_rarch->configuration_settings;
+   bool frame_dupe_detect       = settings->bools.video_frame_dupe_detect;
+   /* Row ranges are in terms of the core's frame, a softfilter
+    * or the threaded wrapper's own frame info would lose them. */
+   bool frame_partial_upload    =
+          settings->bools.video_frame_partial_upload
+#ifdef HAVE_VIDEO_FILTER
+      && !p_rarch->video_driver_state_filter
+#endif
+#ifdef HAVE_THREADS
+      && !VIDEO_DRIVER_IS_THREADED_INTERNAL()
+#endif
+      && video_driver_test_all_flags(GFX_CTX_FLAGS_PARTIAL_UPLOAD);
+   bool dirty_known             = false;
+   unsigned dirty_y             = 0;
+   unsigned dirty_height        = 0;
 #if defined(HAVE_GFX_WIDGETS)
    bool widgets_active          = p_rarch->widgets_active;
 #endif
@@ -31960,6 +33555,8 @@ static void video_driver_frame(const void *data, unsigned width,
    if (!video_driver_active)
       return;
 
+   frame_timeline_begin(FRAME_TIMELINE_VIDEO_FRAME);
+
    new_time                     = cpu_features_get_time_usec();
 
    if (data)
@@ -31968,6 +33565,28 @@ static void video_driver_frame(const void *data, unsigned width,
    p_rarch->frame_cache_height  = height;
    p_rarch->frame_cache_pitch   = pitch;
 
+   /* Compare software frames with the previous one.
+    * An identical frame goes on as a dupe: the driver keeps
+    * the texture it already has and only renders, so
+    * conversion, filtering and upload are skipped. Drivers
+    * that support it are also told which rows changed, so
+    * they only upload those. */
+   if (     data
+         && data != RETRO_HW_FRAME_BUFFER_VALID
+         && (frame_dupe_detect || frame_partial_upload))
+   {
+      if (video_driver_frame_diff(p_rarch, data, width, height, pitch,
+               &dirty_y, &dirty_height))
+      {
+         if (!dirty_height)
+            data                = NULL;
+         else if (frame_partial_upload)
+            dirty_known         = true;
+      }
+   }
+   else if (data)
+      p_rarch->video_driver_frame_hash_valid = false;
+
    if (
             p_rarch->video_driver_scaler_ptr
          && data
@@ -31985,6 +33604,12 @@ static void video_driver_frame(const void *data, unsigned width,
 
    video_driver_build_info(&video_info);
 
+   if (dirty_known)
+   {
+      video_info.frame_dirty_y      = dirty_y;
+      video_info.frame_dirty_height = dirty_height;
+   }
+
    /* Get the amount of frames per seconds. */
    if (p_rarch->video_driver_frame_count)
    {
@@ -32282,6 +33907,62 @@ static void video_driver_frame(const void *data, unsigned width,
             av_info->timing.fps,
             av_info->timing.sample_rate);
 
+      {
+         audio_telemetry_t tm;
+         size_t _len = strlen(video_info.stat_text);
+
+         audio_driver_get_telemetry(p_rarch, &tm, false);
+
+         if (tm.buffer_size)
+            _len += snprintf(video_info.stat_text + _len,
+                  sizeof(video_info.stat_text) - _len,
+                  "Audio Latency:\n -Estimated latency: %.1f / %.1f ms\n"
+                  " -Rate control target: %.1f ms, jitter: %.1f ms\n"
+                  " -Buffer fill: %u (%u - %u) / %u bytes\n"
+                  " -Underruns: %u, overruns: %u\n",
+                  tm.latency_ms, tm.buffer_ms, tm.target_ms, tm.jitter_ms,
+                  tm.fill, tm.fill_min, tm.fill_max, tm.buffer_size,
+                  tm.underruns, tm.overruns);
+         else
+            _len += snprintf(video_info.stat_text + _len,
+                  sizeof(video_info.stat_text) - _len,
+                  "Audio Latency:\n -Not reported by the driver\n");
+
+         if (_len < sizeof(video_info.stat_text))
+            snprintf(video_info.stat_text + _len,
+                  sizeof(video_info.stat_text) - _len,
+                  " -Resampling ratio: %.6f\n"
+                  " -DSP / resampler / mixer: %.0f / %.0f / %.0f us\n",
+                  tm.ratio, tm.dsp_usec, tm.resample_usec, tm.mix_usec);
+      }
+
+#ifdef HAVE_REWIND
+      {
+         unsigned history_frames  = 0;
+         unsigned bytes_per_frame = 0;
+         unsigned granularity     = 0;
+
+         if (state_manager_get_statistics(&p_rarch->rewind_st,
+                  &history_frames, &bytes_per_frame, &granularity))
+         {
+            size_t _len               = strlen(video_info.stat_text);
+            unsigned user_granularity =
+               p_rarch->configuration_settings->uints.rewind_granularity;
+
+            if (granularity < user_granularity)
+               granularity = user_granularity;
+
+            snprintf(video_info.stat_text + _len,
+                  sizeof(video_info.stat_text) - _len,
+                  "Rewind:\n -History: %.1f s\n -Bytes per frame: %u\n -Frames per step: %u\n",
+                  av_info->timing.fps > 0.0
+                  ? history_frames / av_info->timing.fps : 0.0,
+                  bytes_per_frame,
+                  granularity);
+         }
+      }
+#endif
+
       /* TODO/FIXME - add OSD chat text here */
    }
 
@@ -32358,6 +34039,8 @@ static void video_driver_frame(const void *data, unsigned width,
    else if (!video_info.crt_switch_resolution)
 #endif
       p_rarch->video_driver_crt_switching_active = false;
+
+   frame_timeline_end(FRAME_TIMELINE_VIDEO_FRAME);
 }
 
 void crt_switch_driver_refresh(void)
@@ -32526,6 +34209,8 @@ void video_driver_build_info(video_frame_info_t *video_info)
 
    video_info->fps_update_interval         = settings->uints.fps_update_interval;
    video_info->memory_update_interval      = settings->uints.memory_update_interval;
+   video_info->frame_dirty_y               = 0;
+   video_info->frame_dirty_height          = 0;
 
 #ifdef HAVE_MENU
    video_info->menu_is_alive               = p_rarch->menu_driver_alive;
@@ -33539,8 +35224,7 @@ void driver_set_nonblock_state(void)
    }
 
    if (audio_driver_active && p_rarch->audio_driver_context_audio_data)
-      p_rarch->current_audio->set_nonblock_state(
-            p_rarch->audio_driver_context_audio_data,
+      audio_driver_set_nonblock_state(p_rarch,
             audio_sync ? enable : true);
 
    p_rarch->audio_driver_chunk_size = enable
@@ -34192,20 +35876,18 @@ static void input_state_set_last(
    }
 }
 
-static int16_t input_state_get_last(unsigned port,
-      unsigned device, unsigned index, unsigned id)
+static int16_t input_state_list_get(const my_list *list,
+      unsigned port, unsigned device, unsigned index, unsigned id)
 {
    unsigned i;
-   struct rarch_state      *p_rarch = &rarch_st;
 
-   if (!p_rarch->input_state_list)
+   if (!list)
       return 0;
 
    /* find list item */
-   for (i = 0; i < (unsigned)p_rarch->input_state_list->size; i++)
+   for (i = 0; i < (unsigned)list->size; i++)
    {
-      input_list_element *element =
-         (input_list_element*)p_rarch->input_state_list->data[i];
+      input_list_element *element = (input_list_element*)list->data[i];
 
       if (  (element->port   == port)   &&
             (element->device == device) &&
@@ -34219,6 +35901,14 @@ static int16_t input_state_get_last(unsigned port,
    return 0;
 }
 
+static int16_t input_state_get_last(unsigned port,
+      unsigned device, unsigned index, unsigned id)
+{
+   struct rarch_state      *p_rarch = &rarch_st;
+   return input_state_list_get(p_rarch->input_state_list,
+         port, device, index, id);
+}
+
 static int16_t input_state_with_logging(unsigned port,
       unsigned device, unsigned index, unsigned id)
 {
@@ -34313,48 +36003,91 @@ static void remove_input_state_hook(struct rarch_state *p_rarch)
    }
 }
 
-static void *runahead_save_state_alloc(void)
+#if defined(MADV_HUGEPAGE) && defined(MAP_ANONYMOUS)
+#define RUNAHEAD_ARENA_MMAP
+/* States at least this big are put on transparent huge pages. */
+#define RUNAHEAD_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#endif
+
+static void runahead_state_arena_free(runahead_state_arena_t *arena)
 {
-   struct rarch_state *p_rarch           = &rarch_st;
-   retro_ctx_serialize_info_t *savestate = (retro_ctx_serialize_info_t*)
-      malloc(sizeof(retro_ctx_serialize_info_t));
+   if (arena->base)
+   {
+#ifdef RUNAHEAD_ARENA_MMAP
+      if (arena->mapped)
+         munmap(arena->base, arena->size);
+      else
+#endif
+         memalign_free(arena->base);
+   }
 
-   if (!savestate)
-      return NULL;
+   memset(arena, 0, sizeof(*arena));
+}
+
+static bool runahead_state_arena_init(runahead_state_arena_t *arena,
+      size_t state_size)
+{
+   unsigned i;
+   /* Each slot starts on its own cache line. */
+   size_t slot_size = (state_size + 63) & ~(size_t)63;
+   size_t size      = slot_size * RUNAHEAD_STATE_SLOTS;
 
-   savestate->data          = NULL;
-   savestate->data_const    = NULL;
-   savestate->size          = 0;
+   runahead_state_arena_free(arena);
 
-   if (  (p_rarch->runahead_save_state_size > 0) &&
-         p_rarch->runahead_save_state_size_known)
+#ifdef RUNAHEAD_ARENA_MMAP
+   /* The whole state is rewritten every frame; on huge pages
+    * that costs a handful of TLB entries instead of hundreds. */
+   if (size >= RUNAHEAD_HUGE_PAGE_SIZE)
    {
-      savestate->data       = malloc(p_rarch->runahead_save_state_size);
-      savestate->data_const = savestate->data;
-      savestate->size       = p_rarch->runahead_save_state_size;
+      size_t map_size = (size + RUNAHEAD_HUGE_PAGE_SIZE - 1)
+         & ~(size_t)(RUNAHEAD_HUGE_PAGE_SIZE - 1);
+      void *base      = mmap(NULL, map_size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+      if (base != MAP_FAILED)
+      {
+         madvise(base, map_size, MADV_HUGEPAGE);
+         arena->base   = (uint8_t*)base;
+         arena->size   = map_size;
+         arena->mapped = true;
+      }
    }
+#endif
 
-   return savestate;
-}
+   if (!arena->base)
+   {
+      arena->base = (uint8_t*)memalign_alloc(64, size);
+      if (!arena->base)
+         return false;
+      arena->size = size;
+   }
 
-static void runahead_save_state_free(void *data)
-{
-   retro_ctx_serialize_info_t *savestate = (retro_ctx_serialize_info_t*)data;
-   if (!savestate)
-      return;
-   free(savestate->data);
-   free(savestate);
+   /* Fault the pages in now rather than during the first
+    * runahead frames. */
+   memset(arena->base, 0, size);
+
+   for (i = 0; i < RUNAHEAD_STATE_SLOTS; i++)
+   {
+      arena->slots[i].data       = arena->base + i * slot_size;
+      arena->slots[i].data_const = arena->slots[i].data;
+      arena->slots[i].size       = state_size;
+   }
+
+   return true;
 }
 
-static void runahead_save_state_list_init(
+static bool runahead_save_state_init(
       struct rarch_state *p_rarch,
       size_t save_state_size)
 {
    p_rarch->runahead_save_state_size       = save_state_size;
    p_rarch->runahead_save_state_size_known = true;
 
-   mylist_create(&p_rarch->runahead_save_state_list, 16,
-         runahead_save_state_alloc, runahead_save_state_free);
+   if (!save_state_size)
+      return false;
+
+   return runahead_state_arena_init(&p_rarch->runahead_states,
+         save_state_size);
 }
 
 /* Hooks - Hooks to cleanup, and add dirty input hooks */
@@ -34376,7 +36109,7 @@ static void runahead_remove_hooks(struct rarch_state *p_rarch)
 
 static void runahead_destroy(struct rarch_state *p_rarch)
 {
-   mylist_destroy(&p_rarch->runahead_save_state_list);
+   runahead_state_arena_free(&p_rarch->runahead_states);
    runahead_remove_hooks(p_rarch);
    runahead_clear_variables(p_rarch);
 }
@@ -34425,7 +36158,7 @@ static void runahead_add_hooks(struct rarch_state *p_rarch)
 static void runahead_error(struct rarch_state *p_rarch)
 {
    p_rarch->runahead_available             = false;
-   mylist_destroy(&p_rarch->runahead_save_state_list);
+   runahead_state_arena_free(&p_rarch->runahead_states);
    runahead_remove_hooks(p_rarch);
    p_rarch->runahead_save_state_size       = 0;
    p_rarch->runahead_save_state_size_known = true;
@@ -34440,12 +36173,10 @@ static bool runahead_create(struct rarch_state *p_rarch)
    core_serialize_size(&info);
    p_rarch->request_fast_savestate          = false;
 
-   runahead_save_state_list_init(p_rarch, info.size);
    p_rarch->runahead_video_driver_is_active =
       p_rarch->video_driver_active;
 
-   if (  (p_rarch->runahead_save_state_size == 0) ||
-         !p_rarch->runahead_save_state_size_known)
+   if (!runahead_save_state_init(p_rarch, info.size))
    {
       runahead_error(p_rarch);
       return false;
@@ -34453,8 +36184,6 @@ static bool runahead_create(struct rarch_state *p_rarch)
 
    runahead_add_hooks(p_rarch);
    p_rarch->runahead_force_input_dirty = true;
-   if (p_rarch->runahead_save_state_list)
-      mylist_resize(p_rarch->runahead_save_state_list, 1, true);
    return true;
 }
 
@@ -34463,15 +36192,16 @@ static bool runahead_save_state(struct rarch_state *p_rarch)
    retro_ctx_serialize_info_t *serialize_info;
    bool okay                       = false;
 
-   if (!p_rarch->runahead_save_state_list)
+   if (!p_rarch->runahead_states.base)
       return false;
 
-   serialize_info                  =
-      (retro_ctx_serialize_info_t*)p_rarch->runahead_save_state_list->data[0];
+   serialize_info                  = &p_rarch->runahead_states.slots[0];
 
+   frame_timeline_begin(FRAME_TIMELINE_RUNAHEAD_SAVE);
    p_rarch->request_fast_savestate = true;
    okay                            = core_serialize(serialize_info);
    p_rarch->request_fast_savestate = false;
+   frame_timeline_end(FRAME_TIMELINE_RUNAHEAD_SAVE);
 
    if (okay)
       return true;
@@ -34483,10 +36213,11 @@ static bool runahead_save_state(struct rarch_state *p_rarch)
 static bool runahead_load_state(struct rarch_state *p_rarch)
 {
    bool okay                                  = false;
-   retro_ctx_serialize_info_t *serialize_info = (retro_ctx_serialize_info_t*)
-      p_rarch->runahead_save_state_list->data[0];
+   retro_ctx_serialize_info_t *serialize_info =
+      &p_rarch->runahead_states.slots[0];
    bool last_dirty                            = p_rarch->input_is_dirty;
 
+   frame_timeline_begin(FRAME_TIMELINE_RUNAHEAD_LOAD);
    p_rarch->request_fast_savestate            = true;
    /* calling core_unserialize has side effects with
     * netplay (it triggers transmitting your save state)
@@ -34495,6 +36226,7 @@ static bool runahead_load_state(struct rarch_state *p_rarch)
          serialize_info->data_const, serialize_info->size);
 
    p_rarch->request_fast_savestate            = false;
+   frame_timeline_end(FRAME_TIMELINE_RUNAHEAD_LOAD);
    p_rarch->input_is_dirty                    = last_dirty;
 
    if (!okay)
@@ -34508,13 +36240,15 @@ static bool runahead_load_state_secondary(struct rarch_state *p_rarch)
 {
    bool okay                                  = false;
    retro_ctx_serialize_info_t *serialize_info =
-      (retro_ctx_serialize_info_t*)p_rarch->runahead_save_state_list->data[0];
+      &p_rarch->runahead_states.slots[0];
 
+   frame_timeline_begin(FRAME_TIMELINE_RUNAHEAD_LOAD);
    p_rarch->request_fast_savestate            = true;
    okay                                       = secondary_core_deserialize(
          p_rarch, p_rarch->configuration_settings,
          serialize_info->data_const, (int)serialize_info->size);
    p_rarch->request_fast_savestate            = false;
+   frame_timeline_end(FRAME_TIMELINE_RUNAHEAD_LOAD);
 
    if (!okay)
    {
@@ -34550,15 +36284,240 @@ static bool runahead_core_run_use_last_input(struct rarch_state *p_rarch)
    return true;
 }
 
+#ifdef HAVE_RUNAHEAD_SECONDARY_THREAD
+static void runahead_secondary_worker_loop(void *data)
+{
+   runahead_secondary_worker_t *worker = (runahead_secondary_worker_t*)data;
+   struct rarch_state         *p_rarch = &rarch_st;
+
+   slock_lock(worker->lock);
+   for (;;)
+   {
+      while (!worker->busy && !worker->quit)
+         scond_wait(worker->cond, worker->lock);
+      if (worker->quit)
+         break;
+      slock_unlock(worker->lock);
+
+      p_rarch->secondary_core.retro_run();
+
+      slock_lock(worker->lock);
+      worker->busy = false;
+      scond_signal(worker->cond);
+   }
+   slock_unlock(worker->lock);
+}
+
+static void runahead_secondary_worker_free(struct rarch_state *p_rarch)
+{
+   size_t i;
+   runahead_secondary_worker_t *worker = p_rarch->runahead_secondary_worker;
+
+   if (!worker)
+      return;
+
+   if (worker->thread)
+   {
+      slock_lock(worker->lock);
+      worker->quit = true;
+      scond_signal(worker->cond);
+      slock_unlock(worker->lock);
+      sthread_join(worker->thread);
+   }
+
+   if (worker->cond)
+      scond_free(worker->cond);
+   if (worker->lock)
+      slock_free(worker->lock);
+   runahead_secondary_worker_finish_env(p_rarch, worker, false);
+   for (i = 0; i < worker->variables_capacity; i++)
+   {
+      free(worker->variables[i].key);
+      free(worker->variables[i].value);
+   }
+   free(worker->variables);
+   mylist_destroy(&worker->input_state);
+   free(worker->frame);
+   free(worker);
+
+   p_rarch->runahead_secondary_worker = NULL;
+}
+
+static runahead_secondary_worker_t *runahead_secondary_worker_new(void)
+{
+   runahead_secondary_worker_t *worker = (runahead_secondary_worker_t*)
+      calloc(1, sizeof(*worker));
+
+   if (!worker)
+      return NULL;
+
+   worker->lock   = slock_new();
+   worker->cond   = scond_new();
+   if (worker->lock && worker->cond)
+      worker->thread = sthread_create(
+            runahead_secondary_worker_loop, worker);
+
+   if (!worker->thread)
+   {
+      if (worker->cond)
+         scond_free(worker->cond);
+      if (worker->lock)
+         slock_free(worker->lock);
+      free(worker);
+      return NULL;
+   }
+
+   return worker;
+}
+
+static void runahead_secondary_worker_frame(const void *data,
+      unsigned width, unsigned height, size_t pitch)
+{
+   runahead_secondary_worker_t *worker =
+      rarch_st.runahead_secondary_worker;
+   size_t size                         = pitch * height;
+
+   worker->frame_valid  = true;
+   worker->frame_dupe   = !data;
+   worker->frame_width  = width;
+   worker->frame_height = height;
+   worker->frame_pitch  = pitch;
+
+   if (!data)
+      return;
+
+   if (size > worker->frame_capacity)
+   {
+      uint8_t *frame = (uint8_t*)realloc(worker->frame, size);
+      if (!frame)
+      {
+         worker->frame_valid = false;
+         return;
+      }
+      worker->frame          = frame;
+      worker->frame_capacity = size;
+   }
+
+   memcpy(worker->frame, data, size);
+}
+
+static void runahead_secondary_worker_audio_sample(
+      int16_t left, int16_t right) { }
+
+static size_t runahead_secondary_worker_audio_sample_batch(
+      const int16_t *data, size_t frames)
+{
+   return frames;
+}
+
+static int16_t runahead_secondary_worker_input_state(unsigned port,
+      unsigned device, unsigned index, unsigned id)
+{
+   return input_state_list_get(
+         rarch_st.runahead_secondary_worker->input_state,
+         port, device, index, id);
+}
+
+static void runahead_secondary_worker_copy_input(
+      runahead_secondary_worker_t *worker, const my_list *src)
+{
+   int i;
+
+   if (!worker->input_state)
+      mylist_create(&worker->input_state, 16,
+            input_list_element_constructor,
+            input_list_element_destructor);
+
+   mylist_resize(worker->input_state, src ? src->size : 0, true);
+
+   for (i = 0; i < worker->input_state->size; i++)
+   {
+      const input_list_element *from =
+         (const input_list_element*)src->data[i];
+      input_list_element *to         =
+         (input_list_element*)worker->input_state->data[i];
+
+      to->port   = from->port;
+      to->device = from->device;
+      to->index  = from->index;
+      input_list_element_realloc(to, from->state_size);
+      memcpy(to->state, from->state,
+            from->state_size * sizeof(int16_t));
+   }
+}
+
+/* Starts the secondary core's next frame on the worker, with the
+ * last known input. Returns false if it has to run serially. */
+static bool runahead_secondary_worker_start(struct rarch_state *p_rarch)
+{
+   runahead_secondary_worker_t *worker = p_rarch->runahead_secondary_worker;
+
+   /* Hardware rendered cores need the video context,
+    * which only the main thread has. */
+   if (p_rarch->hw_render.context_type != RETRO_HW_CONTEXT_NONE)
+      return false;
+
+   if (!worker)
+   {
+      if (!(worker = runahead_secondary_worker_new()))
+         return false;
+      p_rarch->runahead_secondary_worker = worker;
+   }
+
+   runahead_secondary_worker_copy_input(worker, p_rarch->input_state_list);
+   runahead_secondary_worker_snapshot(p_rarch, worker);
+   worker->frame_valid = false;
+
+   p_rarch->secondary_core.retro_set_video_refresh(
+         runahead_secondary_worker_frame);
+   p_rarch->secondary_core.retro_set_audio_sample(
+         runahead_secondary_worker_audio_sample);
+   p_rarch->secondary_core.retro_set_audio_sample_batch(
+         runahead_secondary_worker_audio_sample_batch);
+   p_rarch->secondary_core.retro_set_input_poll(
+         secondary_core_input_poll_null);
+   p_rarch->secondary_core.retro_set_input_state(
+         runahead_secondary_worker_input_state);
+
+   slock_lock(worker->lock);
+   worker->busy = true;
+   scond_signal(worker->cond);
+   slock_unlock(worker->lock);
+
+   return true;
+}
+
+static void runahead_secondary_worker_wait(struct rarch_state *p_rarch)
+{
+   runahead_secondary_worker_t *worker = p_rarch->runahead_secondary_worker;
+   struct retro_callbacks *cbs         = &p_rarch->secondary_callbacks;
+
+   slock_lock(worker->lock);
+   while (worker->busy)
+      scond_wait(worker->cond, worker->lock);
+   slock_unlock(worker->lock);
+
+   p_rarch->secondary_core.retro_set_video_refresh(cbs->frame_cb);
+   p_rarch->secondary_core.retro_set_audio_sample(cbs->sample_cb);
+   p_rarch->secondary_core.retro_set_audio_sample_batch(cbs->sample_batch_cb);
+   p_rarch->secondary_core.retro_set_input_poll(cbs->poll_cb);
+   p_rarch->secondary_core.retro_set_input_state(cbs->state_cb);
+}
+#endif
+
 static void do_runahead(
       struct rarch_state *p_rarch,
       int runahead_count,
       bool runahead_hide_warnings,
-      bool use_secondary)
+      bool use_secondary,
+      bool use_secondary_thread)
 {
    int frame_number        = 0;
    bool last_frame         = false;
    bool suspended_frame    = false;
+#ifdef HAVE_RUNAHEAD_SECONDARY_THREAD
+   bool secondary_threaded = false;
+#endif
 #if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
    const bool have_dynamic = true;
 #else
@@ -34592,6 +36551,11 @@ static void do_runahead(
    {
       /* TODO: multiple savestates for higher performance
        * when not using secondary core */
+      /* NOTE: an incremental snapshot (only the memory map pages
+       * written since the last save) can't replace this save;
+       * retro_unserialize() takes the complete blob, and the maps
+       * don't cover CPU or peripheral state. Making it cheaper
+       * needs the core's help, see request_fast_savestate. */
       for (frame_number = 0; frame_number <= runahead_count; frame_number++)
       {
          last_frame      = frame_number == runahead_count;
@@ -34644,11 +36608,46 @@ static void do_runahead(
          goto force_input_dirty;
       }
 
+#ifdef HAVE_RUNAHEAD_SECONDARY_THREAD
+      /* Bet on the input staying the same, in which case the
+       * secondary core's frame doesn't depend on the main core's
+       * and both can run at once. */
+      if (     use_secondary_thread
+            && !p_rarch->runahead_force_input_dirty)
+         secondary_threaded = runahead_secondary_worker_start(p_rarch);
+#endif
+
       /* run main core with video suspended */
       p_rarch->video_driver_active     = false;
       core_run();
       RUNAHEAD_RESUME_VIDEO(p_rarch);
 
+#ifdef HAVE_RUNAHEAD_SECONDARY_THREAD
+      if (secondary_threaded)
+      {
+         runahead_secondary_worker_t *worker =
+            p_rarch->runahead_secondary_worker;
+
+         runahead_secondary_worker_wait(p_rarch);
+         runahead_secondary_worker_finish_env(p_rarch, worker,
+               !p_rarch->input_is_dirty);
+
+         if (!p_rarch->input_is_dirty)
+         {
+            if (worker->frame_valid)
+               video_driver_frame(
+                     worker->frame_dupe ? NULL : worker->frame,
+                     worker->frame_width, worker->frame_height,
+                     worker->frame_pitch);
+            p_rarch->runahead_force_input_dirty = false;
+            return;
+         }
+
+         /* Lost the bet; the state handoff below replaces
+          * whatever the worker ran. */
+      }
+#endif
+
       if (     p_rarch->input_is_dirty
             || p_rarch->runahead_force_input_dirty)
       {
@@ -34762,6 +36761,7 @@ static void retroarch_print_features(void)
    _PSUPP_BUF(buf, SUPPORTS_RSOUND,          "RSound",          "Audio driver");
    _PSUPP_BUF(buf, SUPPORTS_ROAR,            "RoarAudio",       "Audio driver");
    _PSUPP_BUF(buf, SUPPORTS_PULSE,           "PulseAudio",      "Audio driver");
+   _PSUPP_BUF(buf, SUPPORTS_PIPEWIRE,        "PipeWire",        "Audio driver");
    _PSUPP_BUF(buf, SUPPORTS_DSOUND,          "DirectSound",     "Audio driver");
    _PSUPP_BUF(buf, SUPPORTS_WASAPI,          "WASAPI",     "Audio driver");
    _PSUPP_BUF(buf, SUPPORTS_XAUDIO,          "XAudio2",         "Audio driver");
@@ -34973,6 +36973,10 @@ static void retroarch_print_help(const char *arg0)
 #endif
       strlcat(buf, "      --load-menu-on-error\n"
             "                        Open menu instead of quitting if specified core or content fails to load.\n", sizeof(buf));
+      strlcat(buf, "      --benchmark=NUMBER\n"
+            "                        Runs for the specified number of frames as fast as possible\n"
+            "                        on the null drivers, then prints frame timing statistics.\n"
+            "                        Use with --bsvplay for reproducible input.\n", sizeof(buf));
       puts(buf);
    }
 }
@@ -35054,6 +37058,7 @@ static bool retroarch_parse_input_and_config(
       { "log-file",           1, NULL, RA_OPT_LOG_FILE },
       { "accessibility",      0, NULL, RA_OPT_ACCESSIBILITY},
       { "load-menu-on-error", 0, NULL, RA_OPT_LOAD_MENU_ON_ERROR },
+      { "benchmark",          1, NULL, RA_OPT_BENCHMARK },
       { NULL, 0, NULL, 0 }
    };
 
@@ -35621,6 +37626,41 @@ static bool retroarch_parse_input_and_config(
             case RA_OPT_LOAD_MENU_ON_ERROR:
                global->cli_load_menu_on_error = true;
                break;
+
+            case RA_OPT_BENCHMARK:
+               {
+                  settings_t *settings     = p_rarch->configuration_settings;
+
+                  runloop_state.benchmark  = true;
+                  runloop_state.max_frames = (unsigned)strtoul(optarg, NULL, 10);
+
+                  /* Measure the core and the frontend only: no
+                   * output devices, no throttling of any kind.
+                   * None of this is written back to the config. */
+                  configuration_set_string(settings,
+                        settings->arrays.video_driver, "null");
+                  configuration_set_string(settings,
+                        settings->arrays.audio_driver, "null");
+                  configuration_set_string(settings,
+                        settings->arrays.input_driver, "null");
+                  configuration_set_bool(settings,
+                        settings->bools.video_vsync, false);
+                  configuration_set_bool(settings,
+                        settings->bools.audio_sync, false);
+                  configuration_set_bool(settings,
+                        settings->bools.vrr_runloop_enable, false);
+                  configuration_set_float(settings,
+                        settings->floats.fastforward_ratio, 0.0f);
+                  configuration_set_bool(settings,
+                        settings->bools.config_save_on_exit, false);
+
+#ifdef HAVE_BSV_MOVIE
+                  /* Input past the end of the movie isn't
+                   * reproducible, so stop there. */
+                  p_rarch->bsv_movie_state.eof_exit = true;
+#endif
+               }
+               break;
             default:
                RARCH_ERR("%s\n", msg_hash_to_str(MSG_ERROR_PARSING_ARGUMENTS));
                retroarch_fail(p_rarch, 1, "retroarch_parse_input()");
@@ -36118,6 +38158,9 @@ bool retroarch_main_init(int argc, char *argv[])
    audio_driver_load_system_sounds();
 #endif
 
+   if (runloop_state.benchmark)
+      frame_timeline_start();
+
    return true;
 
 error:
@@ -37294,6 +39337,10 @@ int retroarch_get_capabilities(enum rarch_capabilities type,
                strlcat(s, " AVX", len);
             if (cpu & RETRO_SIMD_AVX2)
                strlcat(s, " AVX2", len);
+            if (cpu & RETRO_SIMD_FMA)
+               strlcat(s, " FMA", len);
+            if (cpu & RETRO_SIMD_AVX512)
+               strlcat(s, " AVX512", len);
             if (cpu & RETRO_SIMD_NEON)
                strlcat(s, " NEON", len);
             if (cpu & RETRO_SIMD_VFPV3)
@@ -37697,6 +39744,47 @@ static bool menu_display_libretro(
 }
 #endif
 
+/* Prints the --benchmark results to stdout, in a
+ * format meant to be easy to diff and to parse. */
+static void runloop_benchmark_report(void)
+{
+   unsigned i;
+   frame_timeline_stats_t frame;
+
+   frame_timeline_stop();
+
+   if (!frame_timeline_get_stats(FRAME_TIMELINE_FRAME, &frame)
+         || !frame.count)
+   {
+      RARCH_ERR("[Benchmark]: No frames were recorded.\n");
+      return;
+   }
+
+   printf("Benchmark: %u frames in %.3f s, %.2f fps\n",
+         (unsigned)frame.count, frame.total / 1000000.0,
+         frame.count * 1000000.0 / (double)frame.total);
+   printf("%-14s %8s %10s %8s %8s %8s %8s (usec)\n",
+         "phase", "count", "mean", "p50", "p95", "p99", "max");
+
+   for (i = 0; i < FRAME_TIMELINE_LAST; i++)
+   {
+      frame_timeline_stats_t stats;
+
+      if (!frame_timeline_get_stats((enum frame_timeline_phase)i, &stats)
+            || !stats.count)
+         continue;
+
+      printf("%-14s %8u %10.1f %8u %8u %8u %8u\n",
+            frame_timeline_phase_name((enum frame_timeline_phase)i),
+            (unsigned)stats.count,
+            stats.total / (double)stats.count,
+            (unsigned)stats.p50, (unsigned)stats.p95,
+            (unsigned)stats.p99, (unsigned)stats.max);
+   }
+
+   fflush(stdout);
+}
+
 static enum runloop_state runloop_check_state(
       struct rarch_state *p_rarch,
       settings_t *settings,
@@ -38164,6 +40252,9 @@ static enum runloop_state runloop_check_state(
 
          if (quit_runloop)
          {
+            if (runloop_state.benchmark)
+               runloop_benchmark_report();
+
             old_quit_key                 = quit_key;
             retroarch_main_quit();
             return RUNLOOP_STATE_QUIT;
@@ -38730,12 +40821,14 @@ static enum runloop_state runloop_check_state(
 
          s[0]           = '\0';
 
+         frame_timeline_begin(FRAME_TIMELINE_REWIND);
          rewinding      = state_manager_check_rewind(
                &p_rarch->rewind_st,
                BIT256_GET(current_bits, RARCH_REWIND),
                settings->uints.rewind_granularity,
                runloop_state.paused,
                s, sizeof(s), &t);
+         frame_timeline_end(FRAME_TIMELINE_REWIND);
 
 #if defined(HAVE_GFX_WIDGETS)
          if (widgets_active)
@@ -38926,6 +41019,11 @@ int runloop_iterate(void)
 
 #ifdef HAVE_DISCORD
    discord_state_t *discord_st                  = &p_rarch->discord_st;
+#endif
+
+   frame_timeline_new_frame();
+
+#ifdef HAVE_DISCORD
 
    if (discord_is_inited)
    {
@@ -38980,8 +41078,12 @@ int runloop_iterate(void)
       {
          size_t audio_buf_avail;
 
-         if ((audio_buf_avail = p_rarch->current_audio->write_avail(
-               p_rarch->audio_driver_context_audio_data)) > p_rarch->audio_driver_buffer_size)
+         audio_driver_lock(p_rarch);
+         audio_buf_avail = p_rarch->current_audio->write_avail(
+               p_rarch->audio_driver_context_audio_data);
+         audio_driver_unlock(p_rarch);
+
+         if (audio_buf_avail > p_rarch->audio_driver_buffer_size)
             audio_buf_avail = p_rarch->audio_driver_buffer_size;
 
          audio_buf_occupancy = (unsigned)(100 - (audio_buf_avail * 100) /
@@ -39003,6 +41105,13 @@ int runloop_iterate(void)
                audio_buf_active, audio_buf_occupancy, audio_buf_underrun);
    }
 
+#ifdef HAVE_AUDIOMIXER
+   /* Mixer streams that finished playing are released
+    * here, on the main thread. */
+   if (p_rarch->audio_mixer_active)
+      audio_mixer_update();
+#endif
+
    switch ((enum runloop_state)runloop_check_state(p_rarch,
             settings, current_time))
    {
@@ -39016,10 +41125,12 @@ int runloop_iterate(void)
          /* FIXME: This is an ugly way to tell Netplay this... */
          netplay_driver_ctl(RARCH_NETPLAY_CTL_PAUSE, NULL);
 #endif
+         frame_timeline_begin(FRAME_TIMELINE_SLEEP);
 #if defined(HAVE_COCOATOUCH)
          if (!p_rarch->main_ui_companion_is_on_foreground)
 #endif
             retro_sleep(10);
+         frame_timeline_end(FRAME_TIMELINE_SLEEP);
          return 1;
       case RUNLOOP_STATE_END:
 #ifdef HAVE_NETWORKING
@@ -39135,7 +41246,13 @@ int runloop_iterate(void)
    }
 
    if ((video_frame_delay > 0) && !p_rarch->input_driver_nonblock_state)
+   {
+      frame_timeline_begin(FRAME_TIMELINE_SLEEP);
       retro_sleep(video_frame_delay);
+      frame_timeline_end(FRAME_TIMELINE_SLEEP);
+   }
+
+   frame_timeline_begin(FRAME_TIMELINE_CORE_RUN);
 
    {
 #ifdef HAVE_RUNAHEAD
@@ -39143,6 +41260,7 @@ int runloop_iterate(void)
       unsigned run_ahead_num_frames     = settings->uints.run_ahead_frames;
       bool run_ahead_hide_warnings      = settings->bools.run_ahead_hide_warnings;
       bool run_ahead_secondary_instance = settings->bools.run_ahead_secondary_instance;
+      bool run_ahead_secondary_threaded = settings->bools.run_ahead_secondary_threaded;
       /* Run Ahead Feature replaces the call to core_run in this loop */
       bool want_runahead                = run_ahead_enabled && run_ahead_num_frames > 0;
 #ifdef HAVE_NETWORKING
@@ -39154,12 +41272,15 @@ int runloop_iterate(void)
                p_rarch,
                run_ahead_num_frames,
                run_ahead_hide_warnings,
-               run_ahead_secondary_instance);
+               run_ahead_secondary_instance,
+               run_ahead_secondary_threaded);
       else
 #endif
          core_run();
    }
 
+   frame_timeline_end(FRAME_TIMELINE_CORE_RUN);
+
    /* Increment runtime tick counter after each call to
     * core_run() or run_ahead() */
    p_rarch->libretro_core_runtime_usec += rarch_core_runtime_tick(
@@ -39226,8 +41347,7 @@ end:
             /* Nonblocking audio */
             if (p_rarch->audio_driver_active &&
                   p_rarch->audio_driver_context_audio_data)
-               p_rarch->current_audio->set_nonblock_state(
-                     p_rarch->audio_driver_context_audio_data, true);
+               audio_driver_set_nonblock_state(p_rarch, true);
             p_rarch->audio_driver_chunk_size =
                p_rarch->audio_driver_chunk_nonblock_size;
          }
@@ -39239,8 +41359,7 @@ end:
             /* Blocking audio */
             if (p_rarch->audio_driver_active &&
                   p_rarch->audio_driver_context_audio_data)
-               p_rarch->current_audio->set_nonblock_state(
-                     p_rarch->audio_driver_context_audio_data,
+               audio_driver_set_nonblock_state(p_rarch,
                      audio_sync ? false : true);
 
             p_rarch->audio_driver_chunk_size  =
@@ -39274,10 +41393,12 @@ end:
 
          if (sleep_ms > 0)
          {
+            frame_timeline_begin(FRAME_TIMELINE_SLEEP);
 #if defined(HAVE_COCOATOUCH)
             if (!p_rarch->main_ui_companion_is_on_foreground)
 #endif
                retro_sleep(sleep_ms);
+            frame_timeline_end(FRAME_TIMELINE_SLEEP);
          }
 
          return 1;
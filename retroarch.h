@@ -450,8 +450,10 @@ typedef struct audio_mixer_stream
 
 typedef struct audio_mixer_stream_params
 {
+   /* NULL to stream FLAC/MP3 from path instead */
    void *buf;
    char *basename;
+   const char *path;
    audio_mixer_stop_cb_t cb;
    size_t bufsize;
    unsigned slot_selection_idx;
@@ -543,6 +545,27 @@ typedef struct audio_driver
    size_t (*write_avail)(void *data);
 
    size_t (*buffer_size)(void *data);
+
+   /* Optional. Zero-copy writes.
+    *
+    * Returns memory inside the driver's own buffer to render
+    * up to size bytes of samples into, in the same format
+    * write() takes. Like write(), it blocks until that much
+    * is free unless non-blocking. Returns NULL when that
+    * can't be done right now; write() is used instead.
+    */
+   void *(*write_begin)(void *data, size_t size);
+
+   /* Queues the first size bytes of the memory returned by
+    * write_begin(), which may be less than was asked for,
+    * including 0 to queue nothing.
+    * Returns the bytes queued, or -1 on error. */
+   ssize_t (*write_end)(void *data, size_t size);
+
+   /* Set if the driver runs audio_driver_callback() from a
+    * thread of its own when the core has an audio callback,
+    * which makes the threaded audio wrapper unnecessary. */
+   bool pulls_callback;
 } audio_driver_t;
 
 bool audio_driver_enable_callback(void);
@@ -626,6 +649,7 @@ extern audio_driver_t audio_jack;
 extern audio_driver_t audio_sdl;
 extern audio_driver_t audio_xa;
 extern audio_driver_t audio_pulse;
+extern audio_driver_t audio_pipewire;
 extern audio_driver_t audio_dsound;
 extern audio_driver_t audio_wasapi;
 extern audio_driver_t audio_coreaudio;
@@ -867,7 +891,8 @@ enum display_flags
    GFX_CTX_FLAGS_SHADERS_CG,
    GFX_CTX_FLAGS_SHADERS_HLSL,
    GFX_CTX_FLAGS_SHADERS_SLANG,
-   GFX_CTX_FLAGS_SCREENSHOTS_SUPPORTED
+   GFX_CTX_FLAGS_SCREENSHOTS_SUPPORTED,
+   GFX_CTX_FLAGS_PARTIAL_UPLOAD
 };
 
 enum shader_uniform_type
@@ -1179,6 +1204,12 @@ typedef struct video_frame_info
    unsigned black_frame_insertion;
    unsigned fps_update_interval;
    unsigned memory_update_interval;
+   /* Rows [y, y + height) of a software frame changed
+    * since the previous one. 0 rows means the whole frame
+    * has to be uploaded. Only filled in for drivers with
+    * GFX_CTX_FLAGS_PARTIAL_UPLOAD. */
+   unsigned frame_dirty_y;
+   unsigned frame_dirty_height;
 
    float menu_wallpaper_opacity;
    float menu_framebuffer_opacity;
@@ -1211,7 +1242,7 @@ typedef struct video_frame_info
       bool full_screen;
    } osd_stat_params;
 
-   char stat_text[512];
+   char stat_text[1024];
 
    bool widgets_active;
    bool menu_mouse_enable;
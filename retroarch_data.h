@@ -80,6 +80,14 @@
 
 #define AUDIO_BUFFER_FREE_SAMPLES_COUNT (8 * 1024)
 
+/* Window over which the fast-forward speed is measured
+ * for time-stretching. */
+#define AUDIO_FASTFORWARD_MEASURE_USEC 100000
+
+/* How much the driver's buffer fill may speed up or slow down
+ * time-stretched fast-forward audio, as a fraction. */
+#define AUDIO_TIMESTRETCH_BUFFER_STEER 0.2f
+
 #define MENU_SOUND_FORMATS "ogg|mod|xm|s3m|mp3|flac|wav"
 
 #define MIDI_DRIVER_BUF_SIZE 4096
@@ -475,6 +483,9 @@ static const audio_driver_t *audio_drivers[] = {
 #ifdef HAVE_PULSE
    &audio_pulse,
 #endif
+#ifdef HAVE_PIPEWIRE
+   &audio_pipewire,
+#endif
 #if defined(__PSL1GHT__) || defined(__PS3__)
    &audio_ps3,
 #endif
@@ -1266,7 +1277,8 @@ enum
    RA_OPT_MAX_FRAMES_SCREENSHOT_PATH,
    RA_OPT_SET_SHADER,
    RA_OPT_ACCESSIBILITY,
-   RA_OPT_LOAD_MENU_ON_ERROR
+   RA_OPT_LOAD_MENU_ON_ERROR,
+   RA_OPT_BENCHMARK
 };
 
 enum  runloop_state
@@ -1430,6 +1442,142 @@ typedef struct my_list_t
    int size;
 } my_list;
 
+/* Savestate buffers used by runahead. */
+#define RUNAHEAD_STATE_SLOTS 1
+
+/* One allocation holding every runahead savestate slot;
+ * set up once per core and reused by every frame. */
+typedef struct runahead_state_arena
+{
+   retro_ctx_serialize_info_t slots[RUNAHEAD_STATE_SLOTS];
+   uint8_t *base;
+   size_t size;
+   bool mapped;        /* base came from mmap(), not memalign_alloc() */
+} runahead_state_arena_t;
+
+#if defined(HAVE_RUNAHEAD) && defined(HAVE_DYNAMIC) && defined(HAVE_THREADS)
+#define HAVE_RUNAHEAD_SECONDARY_THREAD
+
+/* Environment calls the secondary core can make on the
+ * worker that change frontend state, per frame. */
+#define RUNAHEAD_SECONDARY_MAX_ENV_CALLS 8
+
+struct runahead_secondary_variable
+{
+   char *key;
+   char *value;
+};
+
+/* An environment call made on the worker, with a copy of
+ * its data; run on the main thread after the join. */
+struct runahead_secondary_env_call
+{
+   char *msg; /* owns the string the message points to */
+   union
+   {
+      struct retro_game_geometry geometry;
+      struct retro_system_av_info av_info;
+      struct retro_message message;
+      struct retro_message_ext message_ext;
+      unsigned rotation;
+   } data;
+   unsigned cmd;
+};
+
+/* Runs the secondary core's frame on a thread of its own,
+ * while the main core runs its frame on the main thread. */
+typedef struct runahead_secondary_worker
+{
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+   /* Copy of input_state_list, the main core updates the original
+    * while the worker runs. */
+   my_list *input_state;
+   /* Last frame the secondary core output; presented later
+    * on the main thread, which owns the video driver. */
+   uint8_t *frame;
+   size_t frame_capacity;
+   size_t frame_pitch;
+   unsigned frame_width;
+   unsigned frame_height;
+   /* Core option values as of when the worker started;
+    * GET_VARIABLE on the worker is answered from these. */
+   struct runahead_secondary_variable *variables;
+   size_t variables_count;
+   size_t variables_capacity;
+   struct runahead_secondary_env_call env_calls[
+      RUNAHEAD_SECONDARY_MAX_ENV_CALLS];
+   unsigned env_calls_count;
+   bool frame_valid;
+   bool frame_dupe;
+   /* Snapshots of has_variable_update and fast-forward. */
+   bool variable_update;
+   bool variable_update_taken; /* the secondary core saw it */
+   bool fastforwarding;
+   /* Set while the secondary core is running on the worker. */
+   bool busy;
+   bool quit;
+} runahead_secondary_worker_t;
+#endif
+
+/* The ring indices are shared without a lock, which
+ * needs the GCC/Clang __atomic builtins. */
+#if defined(HAVE_THREADS) && (defined(__GNUC__) || defined(__clang__))
+#define HAVE_AUDIO_PROCESSING_THREAD
+
+/* In samples; must be a power of two and hold at least
+ * one full rewind flush (AUDIO_CHUNK_SIZE_NONBLOCKING * 2). */
+#define AUDIO_PROCESSING_RING_SIZE (AUDIO_CHUNK_SIZE_NONBLOCKING * 4)
+
+/* Entries in the settings ring; a power of two. */
+#define AUDIO_PROCESSING_SEGMENTS 16
+
+/* The settings a run of samples in the ring was flushed with,
+ * from ring position @start up to the next segment's. */
+typedef struct audio_processing_segment
+{
+   size_t start;
+   float volume_gain;
+   float ratio_scale;
+   float stretch;
+} audio_processing_segment_t;
+
+/* Runs audio_driver_process() - DSP, resampler, mixer,
+ * conversion and the driver write - off the emulation thread.
+ * The core's samples reach it through a single-producer,
+ * single-consumer ring. */
+typedef struct audio_processing_thread
+{
+   sthread_t *thread;
+   /* Held by the thread while it processes a chunk, and by the
+    * main thread around anything else touching the driver,
+    * the DSP filter or the mixer. */
+   slock_t *lock;
+   unsigned lock_depth; /* main thread only */
+   /* Wakes the thread when samples arrive, and a blocked
+    * producer when space frees up. */
+   slock_t *wake_lock;
+   scond_t *wake_cond;
+   int16_t *ring;
+   int16_t *chunk;
+   size_t head;         /* written by the producer only */
+   size_t tail;         /* written by the thread only */
+   /* A blocking producer waits while this many samples
+    * are pending; bounds the latency the ring adds. */
+   size_t block_limit;
+   /* Second ring, in step with the first: a new segment
+    * starts wherever audio_driver_flush() was called with
+    * other settings than the samples before. */
+   audio_processing_segment_t segments[AUDIO_PROCESSING_SEGMENTS];
+   size_t segment_head; /* written by the producer only */
+   size_t segment_tail; /* written by the thread only */
+   bool nonblock;       /* under wake_lock */
+   bool stopped;
+   bool quit;
+} audio_processing_thread_t;
+#endif
+
 #ifdef HAVE_OVERLAY
 typedef struct input_overlay_state
 {
@@ -1701,6 +1849,7 @@ struct runloop
    bool core_shutdown_initiated;
    bool core_running;
    bool perfcnt_enable;
+   bool benchmark;
    bool game_options_active;
    bool folder_options_active;
    bool autosave;
@@ -1723,6 +1872,10 @@ struct rarch_state
    double audio_source_ratio_original;
    double audio_source_ratio_current;
    struct retro_system_av_info video_driver_av_info; /* double alignment */
+   /* Updated by whichever thread writes to the driver;
+    * the snapshot is what the main thread last read. */
+   audio_telemetry_t audio_driver_telemetry;          /* double alignment */
+   audio_telemetry_t audio_driver_telemetry_snapshot; /* double alignment */
 #ifdef HAVE_CRTSWITCHRES
    videocrt_switch_t crt_switch_st;                  /* double alignment */
 #endif
@@ -1730,6 +1883,8 @@ struct rarch_state
    retro_time_t frame_limit_last_time;
    retro_time_t libretro_core_runtime_last;
    retro_time_t libretro_core_runtime_usec;
+   /* Start of the current fast-forward speed measurement. */
+   retro_time_t audio_driver_fastforward_time;
    retro_time_t video_driver_frame_time_samples[
       MEASURE_FRAME_TIME_SAMPLES_COUNT];
    struct global              g_extern;         /* retro_time_t alignment */
@@ -1762,6 +1917,9 @@ struct rarch_state
 #endif
 
    uint64_t audio_driver_free_samples_count;
+   /* Position of the s16 passthrough resampler in the
+    * next batch, 32.32 fixed point. */
+   uint64_t audio_driver_s16_phase;
 
 #ifdef HAVE_RUNAHEAD
    uint64_t runahead_last_frame_count;
@@ -1784,8 +1942,10 @@ struct rarch_state
    uint8_t *video_driver_record_gpu_buffer;
    uint8_t *midi_drv_input_buffer;
    uint8_t *midi_drv_output_buffer;
+   uint64_t *video_driver_frame_row_hashes;   /* last software frame's */
    bool    *load_no_content_hook;
    float   *audio_driver_output_samples_buf;
+   float   *audio_driver_timestretch_buf;
    char    *osk_grid[45];
 #if defined(HAVE_RUNAHEAD)
 #if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
@@ -1862,8 +2022,12 @@ struct rarch_state
    const retro_resampler_t *audio_driver_resampler;
 
    void *audio_driver_resampler_data;
+   retro_timestretch_t *audio_driver_timestretch;
    const audio_driver_t *current_audio;
    void *audio_driver_context_audio_data;
+#ifdef HAVE_AUDIO_PROCESSING_THREAD
+   audio_processing_thread_t *audio_processing_thread;
+#endif
 #ifdef HAVE_OVERLAY
    input_overlay_t *overlay_ptr;
 #endif
@@ -1899,8 +2063,11 @@ struct rarch_state
 #endif
    frontend_ctx_driver_t *current_frontend_ctx;
 #ifdef HAVE_RUNAHEAD
-   my_list *runahead_save_state_list;
+   runahead_state_arena_t runahead_states;
    my_list *input_state_list;
+#ifdef HAVE_RUNAHEAD_SECONDARY_THREAD
+   runahead_secondary_worker_t *runahead_secondary_worker;
+#endif
 #endif
 
    struct retro_perf_counter *perf_counters_rarch[MAX_COUNTERS];
@@ -1988,6 +2155,9 @@ struct rarch_state
 #endif
    size_t audio_driver_buffer_size;
    size_t audio_driver_data_ptr;
+   size_t audio_driver_timestretch_frames;
+   /* Frames pushed since audio_driver_fastforward_time. */
+   size_t audio_driver_fastforward_frames;
 
 #ifdef HAVE_RUNAHEAD
    size_t runahead_save_state_size;
@@ -2047,6 +2217,9 @@ struct rarch_state
    unsigned frame_cache_height;
    unsigned video_driver_width;
    unsigned video_driver_height;
+   unsigned video_driver_frame_hash_width;
+   unsigned video_driver_frame_hash_height;
+   unsigned video_driver_frame_hash_bpp;
    unsigned osk_last_codepoint;
    unsigned osk_last_codepoint_len;
    unsigned input_driver_flushing_input;
@@ -2061,6 +2234,14 @@ struct rarch_state
 
    unsigned audio_driver_free_samples_buf[
       AUDIO_BUFFER_FREE_SAMPLES_COUNT];
+   /* Buffer fill range of the second in progress,
+    * and how many bytes of it have been written. */
+   unsigned audio_driver_fill_window_min;
+   unsigned audio_driver_fill_window_max;
+   unsigned audio_driver_fill_window_bytes;
+   /* Adaptive rate control target in bytes,
+    * 0 for half the buffer. */
+   unsigned audio_driver_latency_target;
    unsigned perf_ptr_rarch;
    unsigned perf_ptr_libretro;
 
@@ -2073,7 +2254,17 @@ struct rarch_state
 #endif
 
    float audio_driver_rate_control_delta;
+   /* Adaptive rate control state, in bytes of driver output:
+    * the low-passed buffer fill (negative before the first
+    * reading), its jitter, and the margin underruns add to
+    * the target. The integral is in units of the delta. */
+   float audio_driver_rate_fill;
+   float audio_driver_rate_jitter;
+   float audio_driver_rate_margin;
+   float audio_driver_rate_integral;
    float audio_driver_input;
+   /* Smoothed speed achieved while fast-forwarding. */
+   float audio_driver_fastforward_speed;
    float audio_driver_volume_gain;
 
    float input_driver_axis_threshold;
@@ -2092,6 +2283,9 @@ struct rarch_state
 #endif
    enum rarch_display_type video_driver_display_type;
    enum poll_type_override_t core_poll_type_override;
+   /* Kept for audio_driver_reset_resampler(), which
+    * can run on the audio processing thread. */
+   enum resampler_quality audio_driver_resampler_quality;
 #ifdef HAVE_OVERLAY
    enum overlay_visibility *overlay_visibility;
 #endif
@@ -2259,12 +2453,22 @@ struct rarch_state
 #endif
    bool video_driver_crt_switching_active;
    bool video_driver_threaded;
+   bool video_driver_frame_hash_valid;
 
    bool video_started_fullscreen;
 
    bool audio_driver_control;
    bool audio_driver_mute_enable;
    bool audio_driver_use_float;
+   bool audio_driver_timestretch_active;
+   bool audio_driver_nonblock;
+   bool audio_driver_rate_control_adaptive;
+   bool audio_driver_resampler_nearest;
+   /* The last batch went through the s16 passthrough */
+   bool audio_driver_s16_passthrough;
+   /* A write has left data in the driver's buffer since
+    * it was started. */
+   bool audio_driver_telemetry_primed;
 
    bool audio_suspended;
 
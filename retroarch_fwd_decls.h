@@ -59,6 +59,9 @@ static bool secondary_core_create(struct rarch_state *p_rarch,
 #endif
 static int16_t input_state_get_last(unsigned port,
       unsigned device, unsigned index, unsigned id);
+#ifdef HAVE_RUNAHEAD_SECONDARY_THREAD
+static void runahead_secondary_worker_free(struct rarch_state *p_rarch);
+#endif
 #endif
 static int16_t input_state_internal(unsigned port, unsigned device,
       unsigned idx, unsigned id);
@@ -89,6 +92,18 @@ static void ui_companion_driver_init_first(
 static bool audio_driver_stop(struct rarch_state *p_rarch);
 static bool audio_driver_start(struct rarch_state *p_rarch,
       bool is_shutdown);
+static void audio_driver_lock(struct rarch_state *p_rarch);
+static void audio_driver_unlock(struct rarch_state *p_rarch);
+static void audio_driver_set_nonblock_state(
+      struct rarch_state *p_rarch, bool nonblock);
+static void audio_driver_telemetry_reset(struct rarch_state *p_rarch);
+static void audio_driver_get_telemetry(struct rarch_state *p_rarch,
+      audio_telemetry_t *telemetry, bool wait);
+#ifdef HAVE_AUDIO_PROCESSING_THREAD
+static bool audio_processing_thread_init(struct rarch_state *p_rarch,
+      bool nonblock);
+static void audio_processing_thread_free(struct rarch_state *p_rarch);
+#endif
 
 static bool recording_init(settings_t *settings,
       struct rarch_state *p_rarch);
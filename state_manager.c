@@ -26,6 +26,13 @@
 #include <retro_inline.h>
 #include <compat/strl.h>
 #include <compat/intrinsics.h>
+#include <features/features_cpu.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
 
 #include "state_manager.h"
 #include "msg_hash.h"
@@ -42,6 +49,27 @@
 /* Keep it off unless you're chasing a core bug, it slows things down. */
 #define STRICT_BUF_SIZE 0
 
+/* Threaded capture hands whole blocks to the worker,
+ * which doesn't mix with the debug block. */
+#if defined(HAVE_THREADS) && !STRICT_BUF_SIZE
+#define HAVE_REWIND_THREAD
+#endif
+
+/* Upper bound for the automatically raised rewind granularity. */
+#define REWIND_MAX_ADAPTIVE_GRANULARITY 32
+
+/* Number of serialized states that may be in flight between the
+ * main thread and the compression thread. When they are all in use,
+ * the main thread waits for the worker (backpressure). */
+#define REWIND_THREAD_BLOCKS 4
+
+#ifdef HAVE_ZLIB
+/* Deltas smaller than this are stored as they are;
+ * deflating them costs more time than it saves space. */
+#define REWIND_DEFLATE_MIN_SIZE 256
+#define REWIND_DEFLATE_LEVEL 1
+#endif
+
 #ifndef UINT16_MAX
 #define UINT16_MAX 0xffff
 #endif
@@ -59,10 +87,33 @@
 #define NO_UNALIGNED_MEM
 #endif
 
-#if __SSE2__
+/* Wider scanners are compiled in regardless of the target flags and
+ * picked at runtime with cpu_features_get(), so generic x86 builds
+ * still get the AVX2/AVX-512 paths. */
+#if defined(CPU_X86) && (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5) || (defined(_MSC_VER) && _MSC_VER >= 1910))
+#define STATE_MANAGER_SIMD_DISPATCH
+#endif
+
+#if defined(STATE_MANAGER_SIMD_DISPATCH) || __SSE2__
+#define STATE_MANAGER_SSE2
+#endif
+
+#if defined(STATE_MANAGER_SIMD_DISPATCH)
+#include <immintrin.h>
+#elif defined(STATE_MANAGER_SSE2)
 #include <emmintrin.h>
 #endif
 
+#if defined(__GNUC__) || defined(__clang__)
+#define STATE_MANAGER_TARGET(isa) __attribute__((target(isa)))
+#else
+#define STATE_MANAGER_TARGET(isa)
+#endif
+
+/* Vector scanners may read this far past the end of a block
+ * before they hit the sentinel (see state_manager_raw_alloc). */
+#define STATE_MANAGER_BLOCK_PADDING 64
+
 /* Format per frame (pseudocode): */
 #if 0
 size nextstart;
@@ -85,33 +136,8 @@ size thisstart;
 
 /* There's no equivalent in libc, you'd think so ...
  * std::mismatch exists, but it's not optimized at all. */
-static size_t find_change(const uint16_t *a, const uint16_t *b)
+static size_t find_change_generic(const uint16_t *a, const uint16_t *b)
 {
-#if __SSE2__
-   const __m128i *a128 = (const __m128i*)a;
-   const __m128i *b128 = (const __m128i*)b;
-
-   for (;;)
-   {
-      __m128i v0    = _mm_loadu_si128(a128);
-      __m128i v1    = _mm_loadu_si128(b128);
-      __m128i c     = _mm_cmpeq_epi8(v0, v1);
-      uint32_t mask = _mm_movemask_epi8(c);
-
-      if (mask != 0xffff) /* Something has changed, figure out where. */
-      {
-         /* calculate the real offset to the differing byte */
-         size_t ret = (((uint8_t*)a128 - (uint8_t*)a) |
-               (compat_ctz(~mask)));
-
-         /* and convert that to the uint16_t offset */
-         return (ret >> 1);
-      }
-
-      a128++;
-      b128++;
-   }
-#else
    const uint16_t *a_org = a;
 #ifdef NO_UNALIGNED_MEM
    while (((uintptr_t)a & (sizeof(size_t) - 1)) && *a == *b)
@@ -140,10 +166,9 @@ static size_t find_change(const uint16_t *a, const uint16_t *b)
       }
    }
    return a - a_org;
-#endif
 }
 
-static size_t find_same(const uint16_t *a, const uint16_t *b)
+static size_t find_same_generic(const uint16_t *a, const uint16_t *b)
 {
    const uint16_t *a_org = a;
 #ifdef NO_UNALIGNED_MEM
@@ -183,6 +208,246 @@ static size_t find_same(const uint16_t *a, const uint16_t *b)
    return a - a_org;
 }
 
+static void copy16_generic(uint16_t *dst, const uint16_t *src, size_t num16s)
+{
+   size_t i;
+   /* memcpy has a constant-per-call overhead that shows up
+    * with the short runs we usually get here. */
+   for (i = 0; i < num16s; i++)
+      dst[i] = src[i];
+}
+
+/* The vector versions of find_same() compare whole uint32 pairs,
+ * just like the generic one, then step back a word if the previous
+ * one also matches. 'pairs' is the number of uint32 pairs skipped. */
+static INLINE size_t find_same_finish(const uint16_t *a,
+      const uint16_t *b, size_t pairs)
+{
+   size_t ret = pairs * 2;
+   if (ret && a[ret - 1] == b[ret - 1])
+      ret--;
+   return ret;
+}
+
+#ifdef STATE_MANAGER_SSE2
+STATE_MANAGER_TARGET("sse2")
+static size_t find_change_sse2(const uint16_t *a, const uint16_t *b)
+{
+   const __m128i *a128 = (const __m128i*)a;
+   const __m128i *b128 = (const __m128i*)b;
+
+   for (;;)
+   {
+      __m128i v0    = _mm_loadu_si128(a128);
+      __m128i v1    = _mm_loadu_si128(b128);
+      __m128i c     = _mm_cmpeq_epi8(v0, v1);
+      uint32_t mask = _mm_movemask_epi8(c);
+
+      if (mask != 0xffff) /* Something has changed, figure out where. */
+      {
+         /* calculate the real offset to the differing byte */
+         size_t ret = (((uint8_t*)a128 - (uint8_t*)a) |
+               (compat_ctz(~mask)));
+
+         /* and convert that to the uint16_t offset */
+         return (ret >> 1);
+      }
+
+      a128++;
+      b128++;
+   }
+}
+
+STATE_MANAGER_TARGET("sse2")
+static size_t find_same_sse2(const uint16_t *a, const uint16_t *b)
+{
+   size_t pairs = 0;
+
+   for (;;)
+   {
+      __m128i v0    = _mm_loadu_si128((const __m128i*)(a + pairs * 2));
+      __m128i v1    = _mm_loadu_si128((const __m128i*)(b + pairs * 2));
+      uint32_t mask = _mm_movemask_ps(
+            _mm_castsi128_ps(_mm_cmpeq_epi32(v0, v1)));
+
+      if (mask)
+         return find_same_finish(a, b, pairs + compat_ctz(mask));
+
+      pairs += 4;
+   }
+}
+#endif
+
+#ifdef STATE_MANAGER_SIMD_DISPATCH
+STATE_MANAGER_TARGET("avx2")
+static size_t find_change_avx2(const uint16_t *a, const uint16_t *b)
+{
+   const __m256i *a256 = (const __m256i*)a;
+   const __m256i *b256 = (const __m256i*)b;
+
+   for (;;)
+   {
+      __m256i v0    = _mm256_loadu_si256(a256);
+      __m256i v1    = _mm256_loadu_si256(b256);
+      uint32_t mask = (uint32_t)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(v0, v1));
+
+      if (mask != 0xffffffff)
+      {
+         size_t ret = ((const uint8_t*)a256 - (const uint8_t*)a)
+            + compat_ctz(~mask);
+         return (ret >> 1);
+      }
+
+      a256++;
+      b256++;
+   }
+}
+
+STATE_MANAGER_TARGET("avx2")
+static size_t find_same_avx2(const uint16_t *a, const uint16_t *b)
+{
+   size_t pairs = 0;
+
+   for (;;)
+   {
+      __m256i v0    = _mm256_loadu_si256((const __m256i*)(a + pairs * 2));
+      __m256i v1    = _mm256_loadu_si256((const __m256i*)(b + pairs * 2));
+      uint32_t mask = (uint32_t)_mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpeq_epi32(v0, v1)));
+
+      if (mask)
+         return find_same_finish(a, b, pairs + compat_ctz(mask));
+
+      pairs += 8;
+   }
+}
+
+STATE_MANAGER_TARGET("avx2")
+static void copy16_avx2(uint16_t *dst, const uint16_t *src, size_t num16s)
+{
+   while (num16s >= 16)
+   {
+      _mm256_storeu_si256((__m256i*)dst,
+            _mm256_loadu_si256((const __m256i*)src));
+      dst    += 16;
+      src    += 16;
+      num16s -= 16;
+   }
+
+   copy16_generic(dst, src, num16s);
+}
+
+STATE_MANAGER_TARGET("avx512f,avx512bw")
+static size_t find_change_avx512(const uint16_t *a, const uint16_t *b)
+{
+   const __m512i *a512 = (const __m512i*)a;
+   const __m512i *b512 = (const __m512i*)b;
+
+   for (;;)
+   {
+      __mmask64 mask = _mm512_cmpneq_epi8_mask(
+            _mm512_loadu_si512(a512), _mm512_loadu_si512(b512));
+
+      if (mask)
+      {
+         size_t ret     = (const uint8_t*)a512 - (const uint8_t*)a;
+         uint32_t lo    = (uint32_t)mask;
+         if (lo)
+            ret        += compat_ctz(lo);
+         else
+            ret        += 32 + compat_ctz((uint32_t)(mask >> 32));
+         return (ret >> 1);
+      }
+
+      a512++;
+      b512++;
+   }
+}
+
+STATE_MANAGER_TARGET("avx512f,avx512bw")
+static size_t find_same_avx512(const uint16_t *a, const uint16_t *b)
+{
+   size_t pairs = 0;
+
+   for (;;)
+   {
+      __mmask16 mask = _mm512_cmpeq_epi32_mask(
+            _mm512_loadu_si512(a + pairs * 2),
+            _mm512_loadu_si512(b + pairs * 2));
+
+      if (mask)
+         return find_same_finish(a, b, pairs + compat_ctz(mask));
+
+      pairs += 16;
+   }
+}
+
+STATE_MANAGER_TARGET("avx512f,avx512bw")
+static void copy16_avx512(uint16_t *dst, const uint16_t *src, size_t num16s)
+{
+   while (num16s >= 32)
+   {
+      _mm512_storeu_si512(dst, _mm512_loadu_si512(src));
+      dst    += 32;
+      src    += 32;
+      num16s -= 32;
+   }
+
+   if (num16s)
+   {
+      /* Masked tail, so we never write past the patch. */
+      __mmask32 tail = (__mmask32)((1u << num16s) - 1);
+      _mm512_mask_storeu_epi16(dst, tail,
+            _mm512_maskz_loadu_epi16(tail, src));
+   }
+}
+#endif
+
+static const char *state_manager_select_kernels(state_manager_t *state)
+{
+   const char *name   = "generic";
+#if defined(STATE_MANAGER_SSE2) || defined(STATE_MANAGER_SIMD_DISPATCH)
+   uint64_t cpu       = cpu_features_get();
+#endif
+
+   state->find_change = find_change_generic;
+   state->find_same   = find_same_generic;
+   state->copy16      = copy16_generic;
+
+#ifdef STATE_MANAGER_SSE2
+#ifndef __SSE2__
+   if (cpu & RETRO_SIMD_SSE2)
+#endif
+   {
+      state->find_change = find_change_sse2;
+      state->find_same   = find_same_sse2;
+      name               = "SSE2";
+   }
+#endif
+
+#ifdef STATE_MANAGER_SIMD_DISPATCH
+   if ((cpu & (RETRO_SIMD_AVX | RETRO_SIMD_AVX2))
+         == (RETRO_SIMD_AVX | RETRO_SIMD_AVX2))
+   {
+      state->find_change = find_change_avx2;
+      state->find_same   = find_same_avx2;
+      state->copy16      = copy16_avx2;
+      name               = "AVX2";
+   }
+
+   if (cpu & RETRO_SIMD_AVX512)
+   {
+      state->find_change = find_change_avx512;
+      state->find_same   = find_same_avx512;
+      state->copy16      = copy16_avx512;
+      name               = "AVX-512";
+   }
+#endif
+
+   return name;
+}
+
 /* Returns the maximum compressed size of a savestate.
  * It is very likely to compress to far less. */
 static size_t state_manager_raw_maxsize(size_t uncomp)
@@ -204,7 +469,8 @@ static size_t state_manager_raw_maxsize(size_t uncomp)
 static void *state_manager_raw_alloc(size_t len, uint16_t uniq)
 {
    size_t  len16 = (len + sizeof(uint16_t) - 1) & -sizeof(uint16_t);
-   uint16_t *ret = (uint16_t*)calloc(len16 + sizeof(uint16_t) * 4 + 16, 1);
+   uint16_t *ret = (uint16_t*)calloc(len16 + sizeof(uint16_t) * 4
+         + STATE_MANAGER_BLOCK_PADDING, 1);
 
    /* Force in a different byte at the end, so we don't need to check
     * bounds in the innermost loop (it's expensive).
@@ -215,8 +481,8 @@ static void *state_manager_raw_alloc(size_t len, uint16_t uniq)
     * There is also some padding at the end. This is so we don't
     * read outside the buffer end if we're reading in large blocks;
     *
-    * It doesn't make any difference to us, but sacrificing 16 bytes to get
-    * Valgrind happy is worth it. */
+    * It doesn't make any difference to us, but sacrificing a vector's
+    * worth of bytes to get Valgrind happy is worth it. */
    ret[len16/sizeof(uint16_t) + 3] = uniq;
 
    return ret;
@@ -230,8 +496,8 @@ static void *state_manager_raw_alloc(size_t len, uint16_t uniq)
  * 'patch' must be size 'state_manager_raw_maxsize(len)' or more.
  * Returns the number of bytes actually written to 'patch'.
  */
-static size_t state_manager_raw_compress(const void *src,
-      const void *dst, size_t len, void *patch)
+static size_t state_manager_raw_compress(const state_manager_t *state,
+      const void *src, const void *dst, size_t len, void *patch)
 {
    const uint16_t  *old16 = (const uint16_t*)src;
    const uint16_t  *new16 = (const uint16_t*)dst;
@@ -241,8 +507,8 @@ static size_t state_manager_raw_compress(const void *src,
 
    while (num16s)
    {
-      size_t i, changed;
-      size_t skip = find_change(old16, new16);
+      size_t changed;
+      size_t skip = state->find_change(old16, new16);
 
       if (skip >= num16s)
          break;
@@ -265,15 +531,14 @@ static size_t state_manager_raw_compress(const void *src,
          continue;
       }
 
-      changed         = find_same(old16, new16);
+      changed         = state->find_same(old16, new16);
       if (changed > UINT16_MAX)
          changed = UINT16_MAX;
 
       *compressed16++ = changed;
       *compressed16++ = skip;
 
-      for (i = 0; i < changed; i++)
-         compressed16[i] = old16[i];
+      state->copy16(compressed16, old16, changed);
 
       old16        += changed;
       new16        += changed;
@@ -335,7 +600,15 @@ static void state_manager_raw_decompress(const void *patch,
    }
 }
 
-/* The start offsets point to 'nextstart' of any given compressed frame.
+/* Each entry is laid out as:
+ *    size  nextstart;
+ *    size  frames;     (number of frames this entry goes back)
+ *    size  packedsize; (deflated patch size, 0 if stored as is)
+ *    patch (see state_manager_raw_compress);
+ *    [keyframe]        (full state, every keyframe_interval entries)
+ *    size  thisstart;
+ *
+ * The start offsets point to 'nextstart' of any given compressed frame.
  * Each uint16 is stored native endian; anything that claims any other
  * endianness refers to the endianness of this specific item.
  * The uint32 is stored little endian.
@@ -381,6 +654,24 @@ static void state_manager_free(state_manager_t *state)
       free(state->thisblock);
    if (state->nextblock)
       free(state->nextblock);
+   if (state->keyframes)
+      free(state->keyframes);
+#ifdef HAVE_ZLIB
+   if (state->deflate_stream)
+   {
+      deflateEnd(state->deflate_stream);
+      free(state->deflate_stream);
+   }
+   if (state->inflate_stream)
+   {
+      inflateEnd(state->inflate_stream);
+      free(state->inflate_stream);
+   }
+   state->deflate_stream = NULL;
+   state->inflate_stream = NULL;
+#endif
+   if (state->scratch)
+      free(state->scratch);
 #if STRICT_BUF_SIZE
    if (state->debugblock)
       free(state->debugblock);
@@ -389,10 +680,67 @@ static void state_manager_free(state_manager_t *state)
    state->data       = NULL;
    state->thisblock  = NULL;
    state->nextblock  = NULL;
+   state->keyframes  = NULL;
+   state->scratch    = NULL;
 }
 
+#ifdef HAVE_ZLIB
+/* Deflates or inflates 'in' in one go, then resets the stream
+ * for the next delta, which keeps its window and tables.
+ * Returns the number of bytes written to 'out', or 0 if the
+ * stream did not finish. */
+static size_t state_manager_zlib_trans(z_stream *z, bool deflating,
+      const uint8_t *in, size_t in_size, uint8_t *out, size_t out_size)
+{
+   int ret;
+
+   z->next_in   = (Bytef*)in;
+   z->avail_in  = (uInt)in_size;
+   z->next_out  = out;
+   z->avail_out = (uInt)out_size;
+
+   if (deflating)
+   {
+      ret = deflate(z, Z_FINISH);
+      deflateReset(z);
+   }
+   else
+   {
+      ret = inflate(z, Z_FINISH);
+      inflateReset(z);
+   }
+
+   if (ret != Z_STREAM_END)
+      return 0;
+   return out_size - z->avail_out;
+}
+
+static bool state_manager_zlib_init(state_manager_t *state)
+{
+   state->deflate_stream = (z_stream*)calloc(1, sizeof(z_stream));
+   state->inflate_stream = (z_stream*)calloc(1, sizeof(z_stream));
+
+   if (     state->deflate_stream
+         && deflateInit(state->deflate_stream,
+            REWIND_DEFLATE_LEVEL) == Z_OK)
+   {
+      if (     state->inflate_stream
+            && inflateInit(state->inflate_stream) == Z_OK)
+         return true;
+      deflateEnd(state->deflate_stream);
+   }
+
+   free(state->deflate_stream);
+   free(state->inflate_stream);
+   state->deflate_stream = NULL;
+   state->inflate_stream = NULL;
+   return false;
+}
+#endif
+
 static state_manager_t *state_manager_new(
-      size_t state_size, size_t buffer_size)
+      size_t state_size, size_t buffer_size, unsigned keyframe_interval,
+      bool compression)
 {
    size_t max_comp_size, block_size;
    uint8_t *next_block    = NULL;
@@ -405,7 +753,7 @@ static state_manager_t *state_manager_new(
 
    block_size         = (state_size + sizeof(uint16_t) - 1) & -sizeof(uint16_t);
    /* the compressed data is surrounded by pointers to the other side */
-   max_comp_size      = state_manager_raw_maxsize(state_size) + sizeof(size_t) * 2;
+   max_comp_size      = state_manager_raw_maxsize(state_size) + sizeof(size_t) * 4;
    state_data         = (uint8_t*)malloc(buffer_size);
 
    if (!state_data)
@@ -423,10 +771,43 @@ static state_manager_t *state_manager_new(
    state->thisblock   = this_block;
    state->nextblock   = next_block;
    state->capacity    = buffer_size;
+   state->maxentrysize = max_comp_size;
+
+   /* Keyframes are only worth it if a useful number of them fit. */
+   if (keyframe_interval
+         && buffer_size >= (max_comp_size + block_size) * 4)
+   {
+      state->keyframes_capacity = (unsigned)(buffer_size / block_size) + 1;
+      state->keyframes          = (struct state_manager_keyframe*)
+         malloc(state->keyframes_capacity * sizeof(*state->keyframes));
+      if (state->keyframes)
+      {
+         state->keyframe_interval  = keyframe_interval;
+         state->maxentrysize      += block_size;
+      }
+   }
+   else if (keyframe_interval)
+      RARCH_WARN("[Rewind]: Buffer too small for keyframes, disabling them.\n");
+
+#ifdef HAVE_ZLIB
+   /* zlib takes 32-bit sizes; scratch also has room for
+    * deflate output that came out larger than its input. */
+   if (compression && max_comp_size < UINT32_MAX / 2)
+   {
+      state->scratchsize = max_comp_size + max_comp_size / 8 + 64;
+      state->scratch     = (uint8_t*)malloc(state->scratchsize);
+      if (state->scratch && state_manager_zlib_init(state))
+         RARCH_LOG("[Rewind]: Deflating deltas of %u bytes or more.\n",
+               REWIND_DEFLATE_MIN_SIZE);
+   }
+#endif
 
    state->head        = state->data + sizeof(size_t);
    state->tail        = state->data + sizeof(size_t);
 
+   RARCH_LOG("[Rewind]: Using %s delta encoder.\n",
+         state_manager_select_kernels(state));
+
 #if STRICT_BUF_SIZE
    state->debugsize   = state_size;
    state->debugblock  = (uint8_t*)malloc(state_size);
@@ -443,9 +824,39 @@ error:
    return NULL;
 }
 
+static INLINE struct state_manager_keyframe *state_manager_keyframe_at(
+      state_manager_t *state, unsigned i)
+{
+   return &state->keyframes[(state->keyframes_first + i)
+      % state->keyframes_capacity];
+}
+
+/* Drops keyframes whose entries are no longer in the ring. */
+static void state_manager_keyframes_prune(state_manager_t *state)
+{
+   unsigned oldest = state->pushed
+      - (state->entries - (state->thisblock_valid ? 1 : 0));
+
+   while (state->keyframes_count &&
+         (int)(state_manager_keyframe_at(state, 0)->id - oldest) < 0)
+   {
+      state->keyframes_first = (state->keyframes_first + 1)
+         % state->keyframes_capacity;
+      state->keyframes_count--;
+   }
+
+   while (state->keyframes_count &&
+         (int)(state_manager_keyframe_at(state,
+               state->keyframes_count - 1)->id - state->pushed) >= 0)
+      state->keyframes_count--;
+}
+
 static bool state_manager_pop(state_manager_t *state, const void **data)
 {
    size_t start;
+#ifdef HAVE_ZLIB
+   size_t packed_size;
+#endif
    uint8_t *out                 = NULL;
    const uint8_t *compressed    = NULL;
 
@@ -464,14 +875,110 @@ static bool state_manager_pop(state_manager_t *state, const void **data)
       return false;
 
    start                        = read_size_t(state->head - sizeof(size_t));
-   state->head                  = state->data + start;
-   compressed                   = state->data + start + sizeof(size_t);
+   compressed                   = state->data + start + sizeof(size_t) * 3;
    out                          = state->thisblock;
 
+#ifdef HAVE_ZLIB
+   packed_size                  = read_size_t(
+         state->data + start + sizeof(size_t) * 2);
+   if (packed_size)
+   {
+      if (!state->inflate_stream || !state_manager_zlib_trans(
+               state->inflate_stream, false, compressed, packed_size,
+               state->scratch, state->scratchsize))
+      {
+         /* Every older state is patched from this one, so none
+          * of them can be reached any more. Keep the newer state
+          * and start the history over from it. */
+         RARCH_ERR("[Rewind]: Failed to inflate state, "
+               "dropping %u older entries.\n", state->entries);
+         state->tail            = state->head;
+         state->entries         = 0;
+         state->history_frames  = 0;
+         state->keyframes_count = 0;
+         return false;
+      }
+      compressed                = state->scratch;
+   }
+#endif
+
+   state->head                  = state->data + start;
+   state->history_frames       -= read_size_t(state->head + sizeof(size_t));
+
    state_manager_raw_decompress(compressed,
          state->maxcompsize, out, state->blocksize);
 
    state->entries--;
+   state->pushed--;
+   if (state->keyframes_count)
+      state_manager_keyframes_prune(state);
+   return true;
+}
+
+/* Same as calling state_manager_pop() 'count' times, but
+ * starts from the nearest keyframe when there is one. */
+static bool state_manager_pop_many(state_manager_t *state,
+      unsigned count, const void **data)
+{
+   unsigned i;
+
+   *data = state->thisblock;
+
+   if (!count)
+      return false;
+
+   if (state->thisblock_valid)
+   {
+      state_manager_pop(state, data);
+      if (!--count)
+         return true;
+   }
+
+   if (count > state->entries)
+      count = state->entries;
+
+   if (!count)
+      return false;
+
+   if (state->keyframes_count && count > 1)
+   {
+      /* The oldest keyframe at or after the target saves the most. */
+      unsigned target = state->pushed - count;
+
+      for (i = 0; i < state->keyframes_count; i++)
+      {
+         struct state_manager_keyframe *key =
+            state_manager_keyframe_at(state, i);
+
+         if ((int)(key->id - target) < 0)
+            continue;
+
+         memcpy(state->thisblock, state->data + key->offset,
+               state->blocksize);
+
+         /* Only the entry headers are read, nothing is decompressed. */
+         while (state->head != state->data + key->entry)
+         {
+            state->head            = state->data +
+               read_size_t(state->head - sizeof(size_t));
+            state->history_frames -= read_size_t(
+                  state->head + sizeof(size_t));
+         }
+
+         state->entries -= state->pushed - key->id;
+         state->pushed   = key->id;
+         state_manager_keyframes_prune(state);
+
+         count           = key->id - target;
+         break;
+      }
+   }
+
+   /* Stops early if the history had to be dropped. */
+   for (i = 0; i < count; i++)
+      if (!state_manager_pop(state, data))
+         break;
+
    return true;
 }
 
@@ -497,7 +1004,15 @@ static void state_manager_push_where(state_manager_t *state, void **data)
 #endif
 }
 
-static void state_manager_push_do(state_manager_t *state)
+static void state_manager_drop_oldest(state_manager_t *state)
+{
+   state->history_frames -= read_size_t(state->tail + sizeof(size_t));
+   state->tail            = state->data + read_size_t(state->tail);
+   state->entries--;
+}
+
+/* 'frames' is the number of frames since the previous push. */
+static void state_manager_push_do(state_manager_t *state, unsigned frames)
 {
    uint8_t *swap = NULL;
 
@@ -509,8 +1024,9 @@ static void state_manager_push_do(state_manager_t *state)
    {
       const uint8_t *oldb, *newb;
       uint8_t *compressed;
-      size_t headpos, tailpos, remaining;
-      if (state->capacity < sizeof(size_t) + state->maxcompsize)
+      size_t headpos, tailpos, remaining, entry_size, patch_size;
+      size_t packed_size = 0;
+      if (state->capacity < sizeof(size_t) + state->maxentrysize)
          return;
 
 recheckcapacity:;
@@ -519,30 +1035,88 @@ recheckcapacity:;
       remaining = (tailpos + state->capacity -
             sizeof(size_t) - headpos - 1) % state->capacity + 1;
 
-      if (remaining <= state->maxcompsize)
+      if (remaining <= state->maxentrysize)
       {
-         state->tail = state->data + read_size_t(state->tail);
-         state->entries--;
+         state_manager_drop_oldest(state);
          goto recheckcapacity;
       }
 
       oldb              = state->thisblock;
       newb              = state->nextblock;
-      compressed        = state->head + sizeof(size_t);
+      write_size_t(state->head + sizeof(size_t), frames);
+      compressed        = state->head + sizeof(size_t) * 3;
 
-      compressed       += state_manager_raw_compress(oldb, newb,
+      patch_size        = state_manager_raw_compress(state, oldb, newb,
             state->blocksize, compressed);
 
-      if (compressed - state->data + state->maxcompsize > state->capacity)
+#ifdef HAVE_ZLIB
+      if (state->deflate_stream && patch_size >= REWIND_DEFLATE_MIN_SIZE)
+      {
+         packed_size    = state_manager_zlib_trans(state->deflate_stream,
+               true, compressed, patch_size,
+               state->scratch, state->scratchsize);
+
+         /* Keep the plain delta unless deflate actually shrunk it,
+          * so maxcompsize still bounds the entry. */
+         if (packed_size && packed_size < patch_size)
+         {
+            memcpy(compressed, state->scratch, packed_size);
+            /* Keeps the following patches 16-bit aligned. */
+            patch_size  = (packed_size + sizeof(uint16_t) - 1)
+               & -sizeof(uint16_t);
+         }
+         else
+            packed_size = 0;
+      }
+#endif
+
+      write_size_t(state->head + sizeof(size_t) * 2, packed_size);
+      compressed       += patch_size;
+
+      /* Popping this entry yields 'oldb', so that's the keyframe. */
+      if (state->keyframe_interval
+            && state->pushed % state->keyframe_interval == 0)
+      {
+         struct state_manager_keyframe *key;
+
+         if (state->keyframes_count == state->keyframes_capacity)
+         {
+            state->keyframes_first = (state->keyframes_first + 1)
+               % state->keyframes_capacity;
+            state->keyframes_count--;
+         }
+
+         key         = state_manager_keyframe_at(state,
+               state->keyframes_count++);
+         key->entry  = headpos;
+         key->offset = compressed - state->data;
+         key->id     = state->pushed;
+
+         memcpy(compressed, oldb, state->blocksize);
+         compressed += state->blocksize;
+      }
+
+      if (compressed - state->data + state->maxentrysize > state->capacity)
       {
          compressed     = state->data;
          if (state->tail == state->data + sizeof(size_t))
-            state->tail = state->data + read_size_t(state->tail);
+            state_manager_drop_oldest(state);
       }
       write_size_t(compressed, state->head-state->data);
       compressed       += sizeof(size_t);
       write_size_t(state->head, compressed-state->data);
+
+      entry_size        = (compressed - state->head + state->capacity)
+         % state->capacity;
+      if (state->avg_entry_size)
+         state->avg_entry_size = (state->avg_entry_size * 15
+               + entry_size) / 16;
+      else
+         state->avg_entry_size = entry_size;
+
       state->head       = compressed;
+      state->history_frames += frames;
+      state->pushed++;
    }
    else
       state->thisblock_valid = true;
@@ -552,29 +1126,265 @@ recheckcapacity:;
    state->nextblock          = swap;
 
    state->entries++;
+
+   if (state->keyframes_count)
+      state_manager_keyframes_prune(state);
 }
 
-#if 0
-static void state_manager_capacity(state_manager_t *state,
-      unsigned *entries, size_t *bytes, bool *full)
+/* What the statistics and the adaptive granularity
+ * read from the ring. */
+struct state_manager_stats
 {
-   size_t headpos   = state->head - state->data;
-   size_t tailpos   = state->tail - state->data;
-   size_t remaining = (tailpos + state->capacity -
-         sizeof(size_t) - headpos - 1) % state->capacity + 1;
+   size_t used;
+   size_t history_frames;
+   size_t avg_entry_size;
+};
+
+static void state_manager_get_stats(const state_manager_t *state,
+      struct state_manager_stats *stats)
+{
+   size_t headpos        = state->head - state->data;
+   size_t tailpos        = state->tail - state->data;
+
+   stats->used           = state->capacity - ((tailpos + state->capacity -
+            sizeof(size_t) - headpos - 1) % state->capacity + 1);
+   stats->history_frames = state->history_frames;
+   stats->avg_entry_size = state->avg_entry_size;
+}
+
+#ifdef HAVE_REWIND_THREAD
+struct state_manager_thread
+{
+   state_manager_t *state;
+   sthread_t *thread;
+   slock_t *lock;
+   /* Signalled when a block is queued, or on shutdown. */
+   scond_t *work_cond;
+   /* Signalled when the worker hands a block back. */
+   scond_t *done_cond;
+
+   uint8_t *free_blocks[REWIND_THREAD_BLOCKS];
+   uint8_t *queue[REWIND_THREAD_BLOCKS];
+   unsigned queue_frames[REWIND_THREAD_BLOCKS];
+
+   unsigned num_free;
+   unsigned queue_pos;
+   unsigned queue_count;
+
+   /* Published by the worker after each push. */
+   struct state_manager_stats stats;
+
+   bool busy;
+   bool quit;
+};
+
+/* The sentinel word written by state_manager_raw_alloc(). The two
+ * blocks handed to state_manager_raw_compress() must differ here. */
+static INLINE uint16_t *state_manager_block_uniq(
+      const state_manager_t *state, uint8_t *block)
+{
+   return (uint16_t*)block + state->blocksize / sizeof(uint16_t) + 3;
+}
+
+/* Pushes an already serialized block. Takes ownership of 'block'
+ * and returns a block the caller can reuse. */
+static uint8_t *state_manager_push_block(state_manager_t *state,
+      uint8_t *block, unsigned frames)
+{
+   void *ignored;
+   uint8_t *released;
+
+   state_manager_push_where(state, &ignored);
+
+   released                               = state->nextblock;
+   state->nextblock                       = block;
+   *state_manager_block_uniq(state, block) =
+      !*state_manager_block_uniq(state, state->thisblock);
+
+   state_manager_push_do(state, frames);
 
-   if (entries)
-      *entries      = state->entries;
-   if (bytes)
-      *bytes        = state->capacity-remaining;
-   if (full)
-      *full         = remaining <= state->maxcompsize * 2;
+   return released;
 }
+
+static void state_manager_thread_loop(void *data)
+{
+   struct state_manager_thread *thr = (struct state_manager_thread*)data;
+
+   slock_lock(thr->lock);
+
+   for (;;)
+   {
+      struct state_manager_stats stats;
+      uint8_t *block  = NULL;
+      unsigned frames = 0;
+
+      while (!thr->queue_count && !thr->quit)
+         scond_wait(thr->work_cond, thr->lock);
+
+      if (thr->quit)
+         break;
+
+      block           = thr->queue[thr->queue_pos];
+      frames          = thr->queue_frames[thr->queue_pos];
+      thr->queue_pos  = (thr->queue_pos + 1) % REWIND_THREAD_BLOCKS;
+      thr->queue_count--;
+      thr->busy       = true;
+      slock_unlock(thr->lock);
+
+      block           = state_manager_push_block(thr->state, block, frames);
+      state_manager_get_stats(thr->state, &stats);
+
+      slock_lock(thr->lock);
+      thr->free_blocks[thr->num_free++] = block;
+      thr->stats      = stats;
+      thr->busy       = false;
+      scond_signal(thr->done_cond);
+   }
+
+   slock_unlock(thr->lock);
+}
+
+static void state_manager_thread_free(struct state_manager_thread *thr)
+{
+   unsigned i;
+
+   if (!thr)
+      return;
+
+   if (thr->thread)
+   {
+      slock_lock(thr->lock);
+      thr->quit = true;
+      scond_signal(thr->work_cond);
+      slock_unlock(thr->lock);
+      sthread_join(thr->thread);
+   }
+
+   /* Whatever was still queued is dropped. */
+   for (i = 0; i < thr->queue_count; i++)
+      free(thr->queue[(thr->queue_pos + i) % REWIND_THREAD_BLOCKS]);
+   for (i = 0; i < thr->num_free; i++)
+      free(thr->free_blocks[i]);
+
+   if (thr->work_cond)
+      scond_free(thr->work_cond);
+   if (thr->done_cond)
+      scond_free(thr->done_cond);
+   if (thr->lock)
+      slock_free(thr->lock);
+   free(thr);
+}
+
+static struct state_manager_thread *state_manager_thread_new(
+      state_manager_t *state, size_t state_size)
+{
+   unsigned i;
+   struct state_manager_thread *thr = (struct state_manager_thread*)
+      calloc(1, sizeof(*thr));
+
+   if (!thr)
+      return NULL;
+
+   thr->state     = state;
+   state_manager_get_stats(state, &thr->stats);
+   thr->lock      = slock_new();
+   thr->work_cond = scond_new();
+   thr->done_cond = scond_new();
+
+   if (!thr->lock || !thr->work_cond || !thr->done_cond)
+      goto error;
+
+   for (i = 0; i < REWIND_THREAD_BLOCKS; i++)
+   {
+      uint8_t *block = (uint8_t*)state_manager_raw_alloc(state_size, 0);
+      if (!block)
+         goto error;
+      thr->free_blocks[thr->num_free++] = block;
+   }
+
+   if (!(thr->thread = sthread_create(state_manager_thread_loop, thr)))
+      goto error;
+
+   return thr;
+
+error:
+   state_manager_thread_free(thr);
+   return NULL;
+}
+
+/* Returns a free block to serialize into, waiting for
+ * the worker if all of them are queued. */
+static uint8_t *state_manager_thread_acquire(
+      struct state_manager_thread *thr)
+{
+   uint8_t *block;
+
+   slock_lock(thr->lock);
+   while (!thr->num_free)
+      scond_wait(thr->done_cond, thr->lock);
+   block = thr->free_blocks[--thr->num_free];
+   slock_unlock(thr->lock);
+
+   return block;
+}
+
+static void state_manager_thread_submit(
+      struct state_manager_thread *thr, uint8_t *block, unsigned frames)
+{
+   unsigned pos;
+
+   slock_lock(thr->lock);
+   pos                    = (thr->queue_pos + thr->queue_count)
+      % REWIND_THREAD_BLOCKS;
+   thr->queue[pos]        = block;
+   thr->queue_frames[pos] = frames;
+   thr->queue_count++;
+   scond_signal(thr->work_cond);
+   slock_unlock(thr->lock);
+}
+
+/* Waits until every submitted block is in the ring, after which
+ * the main thread may touch the state manager directly. */
+static void state_manager_thread_flush(struct state_manager_thread *thr)
+{
+   slock_lock(thr->lock);
+   while (thr->queue_count || thr->busy)
+      scond_wait(thr->done_cond, thr->lock);
+   slock_unlock(thr->lock);
+}
+#endif
+
+/* Ring statistics that are safe to read while the worker runs:
+ * taken from the state manager when the worker is idle, which
+ * includes any pops since its last push, or else from what the
+ * worker published last. */
+static void state_manager_read_stats(
+      const struct state_manager_rewind_state *rewind_st,
+      struct state_manager_stats *stats)
+{
+#ifdef HAVE_REWIND_THREAD
+   struct state_manager_thread *thr = rewind_st->thread;
+
+   if (thr)
+   {
+      slock_lock(thr->lock);
+      /* Nothing is queued and only this thread submits,
+       * so the worker stays off the state until unlocked. */
+      if (!thr->queue_count && !thr->busy)
+         state_manager_get_stats(rewind_st->state, &thr->stats);
+      *stats = thr->stats;
+      slock_unlock(thr->lock);
+      return;
+   }
 #endif
 
+   state_manager_get_stats(rewind_st->state, stats);
+}
+
 void state_manager_event_init(
       struct state_manager_rewind_state *rewind_st,
-      unsigned rewind_buffer_size)
+      unsigned rewind_buffer_size, bool threaded, bool compression,
+      unsigned keyframe_interval, unsigned min_history_frames)
 {
    void *state          = NULL;
 
@@ -601,16 +1411,33 @@ void state_manager_event_init(
          (unsigned)(rewind_buffer_size / 1000000));
 
    rewind_st->state = state_manager_new(rewind_st->size,
-         rewind_buffer_size);
+         rewind_buffer_size, keyframe_interval, compression);
 
    if (!rewind_st->state)
+   {
       RARCH_WARN("%s.\n", msg_hash_to_str(MSG_REWIND_INIT_FAILED));
+      return;
+   }
+
+   rewind_st->min_history_frames = min_history_frames;
+   rewind_st->granularity        = 0;
+   rewind_st->frames             = 0;
 
    state_manager_push_where(rewind_st->state, &state);
 
    content_serialize_state(state, rewind_st->size);
 
-   state_manager_push_do(rewind_st->state);
+   state_manager_push_do(rewind_st->state, 0);
+
+#ifdef HAVE_REWIND_THREAD
+   if (threaded)
+   {
+      rewind_st->thread = state_manager_thread_new(
+            rewind_st->state, rewind_st->size);
+      if (rewind_st->thread)
+         RARCH_LOG("[Rewind]: Compressing states on a worker thread.\n");
+   }
+#endif
 }
 
 void state_manager_event_deinit(
@@ -619,13 +1446,140 @@ void state_manager_event_deinit(
    if (!rewind_st)
       return;
 
+#ifdef HAVE_REWIND_THREAD
+   state_manager_thread_free(rewind_st->thread);
+   rewind_st->thread = NULL;
+#endif
+
    if (rewind_st->state)
    {
       state_manager_free(rewind_st->state);
       free(rewind_st->state);
    }
-   rewind_st->state = NULL;
-   rewind_st->size  = 0;
+   rewind_st->state              = NULL;
+   rewind_st->size               = 0;
+   rewind_st->granularity        = 0;
+   rewind_st->min_history_frames = 0;
+   rewind_st->adapt_counter      = 0;
+}
+
+/* Raises the push interval when the measured entry size means the
+ * buffer can't hold min_history_frames, and lowers it again once
+ * there is plenty of room. The entry size is a running average, so
+ * this only moves one step every so many pushes. */
+static void state_manager_adapt_granularity(
+      struct state_manager_rewind_state *rewind_st,
+      unsigned granularity)
+{
+   size_t usable, history;
+   struct state_manager_stats stats;
+   state_manager_t *state = rewind_st->state;
+
+   if (++rewind_st->adapt_counter < 64)
+      return;
+   rewind_st->adapt_counter = 0;
+
+   /* capacity and maxentrysize are fixed at init. */
+   if (state->capacity <= state->maxentrysize * 2)
+      return;
+
+   state_manager_read_stats(rewind_st, &stats);
+   if (!stats.avg_entry_size)
+      return;
+
+   usable  = state->capacity - state->maxentrysize * 2;
+   history = usable / stats.avg_entry_size * granularity;
+
+   if (history < rewind_st->min_history_frames)
+   {
+      if (granularity < REWIND_MAX_ADAPTIVE_GRANULARITY)
+         rewind_st->granularity = granularity * 2;
+   }
+   /* Entries at half the interval are at most half the size,
+    * so this estimate is on the safe side. */
+   else if (rewind_st->granularity
+         && history / 2 > rewind_st->min_history_frames
+         + rewind_st->min_history_frames / 4)
+      rewind_st->granularity = granularity / 2;
+}
+
+bool state_manager_get_statistics(
+      const struct state_manager_rewind_state *rewind_st,
+      unsigned *history_frames, unsigned *bytes_per_frame,
+      unsigned *granularity)
+{
+   struct state_manager_stats stats;
+
+   if (!rewind_st || !rewind_st->state)
+      return false;
+
+   state_manager_read_stats(rewind_st, &stats);
+
+   *history_frames  = (unsigned)stats.history_frames;
+   *bytes_per_frame = stats.history_frames
+      ? (unsigned)(stats.used / stats.history_frames) : 0;
+   *granularity     = rewind_st->granularity;
+
+   return true;
+}
+
+/* Number of entries state_manager_pop_many() has to pop to
+ * go back at least 'frames' frames. Entries store how many
+ * frames they cover, which differs between entries once the
+ * granularity has been adapted. */
+static unsigned state_manager_entries_for_frames(
+      const state_manager_t *state, unsigned frames, unsigned pending)
+{
+   size_t covered      = 0;
+   const uint8_t *head = state->head;
+   unsigned count      = 0;
+
+   /* The last pushed state counts as the first entry;
+    * it is 'pending' frames old. */
+   if (state->thisblock_valid)
+   {
+      covered          = pending;
+      count            = 1;
+   }
+
+   while (covered < frames && head != state->tail)
+   {
+      head     = state->data + read_size_t(head - sizeof(size_t));
+      covered += read_size_t(head + sizeof(size_t));
+      count++;
+   }
+
+   return count;
+}
+
+bool state_manager_seek(struct state_manager_rewind_state *rewind_st,
+      unsigned frames)
+{
+   unsigned count;
+   const void *buf      = NULL;
+
+   if (!rewind_st || !rewind_st->state || !frames)
+      return false;
+
+   /* Movies are rewound one frame at a time along with the state. */
+   if (rarch_ctl(RARCH_CTL_BSV_MOVIE_IS_INITED, NULL))
+      return false;
+
+#ifdef HAVE_REWIND_THREAD
+   if (rewind_st->thread)
+      state_manager_thread_flush(rewind_st->thread);
+#endif
+
+   count = state_manager_entries_for_frames(rewind_st->state, frames,
+         rewind_st->frames);
+
+   if (!state_manager_pop_many(rewind_st->state, count, &buf))
+      return false;
+
+   content_deserialize_state(buf, rewind_st->size);
+   rewind_st->frames = 0;
+
+   return true;
 }
 
 /**
@@ -671,6 +1625,11 @@ bool state_manager_check_rewind(
    {
       const void *buf    = NULL;
 
+#ifdef HAVE_REWIND_THREAD
+      if (rewind_st->thread)
+         state_manager_thread_flush(rewind_st->thread);
+#endif
+
       if (state_manager_pop(rewind_st->state, &buf))
       {
 #ifdef HAVE_NETWORKING
@@ -722,18 +1681,43 @@ bool state_manager_check_rewind(
          netplay_driver_ctl(RARCH_NETPLAY_CTL_DESYNC_POP, NULL);
 #endif
 
-      cnt = (cnt + 1) % (rewind_granularity ?
-            rewind_granularity : 1); /* Avoid possible SIGFPE. */
+      if (!rewind_granularity)
+         rewind_granularity = 1; /* Avoid possible SIGFPE. */
+      if (rewind_st->granularity > rewind_granularity)
+         rewind_granularity = rewind_st->granularity;
+
+      cnt = (cnt + 1) % rewind_granularity;
+      rewind_st->frames++;
 
       if ((cnt == 0) || rarch_ctl(RARCH_CTL_BSV_MOVIE_IS_INITED, NULL))
       {
-         void *state = NULL;
+         unsigned frames   = rewind_st->frames;
+         rewind_st->frames = 0;
+
+         if (rewind_st->min_history_frames)
+            state_manager_adapt_granularity(rewind_st, rewind_granularity);
+
+#ifdef HAVE_REWIND_THREAD
+         /* Only serialize here; delta compression and
+          * ring insertion happen on the worker. */
+         if (rewind_st->thread)
+         {
+            uint8_t *block = state_manager_thread_acquire(
+                  rewind_st->thread);
+            content_serialize_state(block, rewind_st->size);
+            state_manager_thread_submit(rewind_st->thread, block, frames);
+         }
+         else
+#endif
+         {
+            void *state = NULL;
 
-         state_manager_push_where(rewind_st->state, &state);
+            state_manager_push_where(rewind_st->state, &state);
 
-         content_serialize_state(state, rewind_st->size);
+            content_serialize_state(state, rewind_st->size);
 
-         state_manager_push_do(rewind_st->state);
+            state_manager_push_do(rewind_st->state, frames);
+         }
       }
    }
 
@@ -26,6 +26,17 @@
 
 RETRO_BEGIN_DECLS
 
+struct z_stream_s;
+
+struct state_manager_keyframe
+{
+   /* Ring offset of the entry; the ring head after popping it. */
+   size_t entry;
+   /* Ring offset of the full state stored in the entry. */
+   size_t offset;
+   unsigned id;
+};
+
 struct state_manager
 {
    uint8_t *data;
@@ -48,6 +59,42 @@ struct state_manager
     * (blocksize + u16 + u16) + u16 + u32 + size_t
     * (yes, the math is a bit ugly). */
    size_t maxcompsize;
+   /* maxcompsize, plus room for a keyframe if they are enabled. */
+   size_t maxentrysize;
+
+   /* Every keyframe_interval entries, the full state is stored
+    * next to its delta, so seeking back doesn't need to decompress
+    * the whole chain. Index is a circular list, oldest first. */
+   struct state_manager_keyframe *keyframes;
+   unsigned keyframe_interval;
+   unsigned keyframes_first;
+   unsigned keyframes_count;
+   unsigned keyframes_capacity;
+
+   /* Deltas above a size threshold are deflated before they go
+    * into the ring; NULL when rewind_compression is off. The
+    * streams live as long as the state manager and are reset
+    * between deltas. */
+   struct z_stream_s *deflate_stream;
+   struct z_stream_s *inflate_stream;
+   /* Holds a delta while it goes through zlib. */
+   uint8_t *scratch;
+   size_t scratchsize;
+
+   /* Frames covered by the entries currently in the ring. */
+   size_t history_frames;
+   /* Running average of the size of a ring entry. */
+   size_t avg_entry_size;
+
+   /* Id of the next entry written to the ring. Entries currently
+    * in the ring have ids in [pushed - count, pushed). */
+   unsigned pushed;
+
+   /* Delta encoder kernels, picked for the host CPU
+    * at state_manager_new() time. */
+   size_t (*find_change)(const uint16_t *a, const uint16_t *b);
+   size_t (*find_same)(const uint16_t *a, const uint16_t *b);
+   void (*copy16)(uint16_t *dst, const uint16_t *src, size_t num16s);
 
    unsigned entries;
    bool thisblock_valid;
@@ -55,11 +102,22 @@ struct state_manager
 
 typedef struct state_manager state_manager_t;
 
+struct state_manager_thread;
+
 struct state_manager_rewind_state
 {
    /* Rewind support. */
    state_manager_t *state;
+   /* Compression worker, when rewind_threaded is set. */
+   struct state_manager_thread *thread;
    size_t size;
+   /* Push interval picked by the adaptive mode, 0 if not raised. */
+   unsigned granularity;
+   /* History the adaptive mode tries to keep, 0 when disabled. */
+   unsigned min_history_frames;
+   unsigned adapt_counter;
+   /* Frames since the last push. */
+   unsigned frames;
    bool frame_is_reversed;
 };
 
@@ -69,7 +127,35 @@ void state_manager_event_deinit(
       struct state_manager_rewind_state *rewind_st);
 
 void state_manager_event_init(struct state_manager_rewind_state *rewind_st,
-      unsigned rewind_buffer_size);
+      unsigned rewind_buffer_size, bool threaded, bool compression,
+      unsigned keyframe_interval, unsigned min_history_frames);
+
+/**
+ * state_manager_get_statistics:
+ * @history_frames       : frames of history currently in the buffer.
+ * @bytes_per_frame      : average buffer use per frame of history.
+ * @granularity          : push interval picked by the adaptive mode,
+ *                         0 if it is not raised.
+ *
+ * Returns: false if rewind is not initialized.
+ **/
+bool state_manager_get_statistics(
+      const struct state_manager_rewind_state *rewind_st,
+      unsigned *history_frames, unsigned *bytes_per_frame,
+      unsigned *granularity);
+
+/**
+ * state_manager_seek:
+ * @frames               : how many frames to go back.
+ *
+ * Jumps back in the rewind history and loads that state,
+ * discarding everything newer. Uses the nearest keyframe so the
+ * cost is bounded by the keyframe interval.
+ *
+ * Returns: true if a state was loaded.
+ **/
+bool state_manager_seek(struct state_manager_rewind_state *rewind_st,
+      unsigned frames);
 
 /**
  * check_rewind:
@@ -25,6 +25,7 @@
 #include <audio/audio_mixer.h>
 #include <compat/strl.h>
 #include <string/stdstring.h>
+#include <streams/file_stream.h>
 #include <retro_miscellaneous.h>
 #include <queues/task_queue.h>
 
@@ -50,6 +51,7 @@ struct audio_mixer_handle
    char path[4095];
    bool copy_data_over;
    bool is_finished;
+   bool stream;
 };
 
 static void task_audio_mixer_load_free(retro_task_t *task)
@@ -97,6 +99,38 @@ static int cb_nbio_audio_mixer_load(void *data, size_t len)
    return 0;
 }
 
+/* FLAC and MP3 are decoded straight from the file while
+ * playing, only the path is handed over. The mixer opens
+ * the file on its decoder thread; all that is left for the
+ * task is checking it is there. */
+static bool task_audio_mixer_stream_from_file(nbio_handle_t *nbio,
+      struct audio_mixer_handle *mixer)
+{
+   switch (mixer->type)
+   {
+#ifdef HAVE_DR_FLAC
+      case AUDIO_MIXER_TYPE_FLAC:
+#endif
+#ifdef HAVE_DR_MP3
+      case AUDIO_MIXER_TYPE_MP3:
+#endif
+         break;
+      default:
+         return true;
+   }
+
+   mixer->buffer           = (nbio_buf_t*)calloc(1, sizeof(*mixer->buffer));
+
+   if (!mixer->buffer)
+      return false;
+
+   mixer->copy_data_over   = true;
+   mixer->stream           = true;
+   nbio->status            = NBIO_STATUS_TRANSFER_FINISHED;
+
+   return true;
+}
+
 static void task_audio_mixer_handle_upload_ogg(retro_task_t *task,
       void *task_data,
       void *user_data, const char *err)
@@ -115,6 +149,7 @@ static void task_audio_mixer_handle_upload_ogg(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_STOPPED;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.path                 = img->path;
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
@@ -147,6 +182,7 @@ static void task_audio_mixer_handle_upload_ogg_and_play(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_PLAYING;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.path                 = img->path;
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
@@ -179,6 +215,7 @@ static void task_audio_mixer_handle_upload_flac(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_STOPPED;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.path                 = img->path;
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
@@ -211,6 +248,7 @@ static void task_audio_mixer_handle_upload_flac_and_play(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_PLAYING;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.path                 = img->path;
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
@@ -243,6 +281,7 @@ static void task_audio_mixer_handle_upload_mp3(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_STOPPED;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.path                 = img->path;
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
@@ -275,6 +314,7 @@ static void task_audio_mixer_handle_upload_mp3_and_play(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_PLAYING;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.path                 = img->path;
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
@@ -307,6 +347,7 @@ static void task_audio_mixer_handle_upload_mod(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_STOPPED;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.path                 = img->path;
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
@@ -339,6 +380,7 @@ static void task_audio_mixer_handle_upload_mod_and_play(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_PLAYING;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.path                 = img->path;
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
@@ -372,6 +414,7 @@ static void task_audio_mixer_handle_upload_wav(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_STOPPED;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.path                 = img->path;
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
@@ -404,6 +447,7 @@ static void task_audio_mixer_handle_upload_wav_and_play(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_PLAYING;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.path                 = img->path;
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
@@ -423,6 +467,13 @@ bool task_audio_mixer_load_handler(retro_task_t *task)
    nbio_handle_t             *nbio  = (nbio_handle_t*)task->state;
    struct audio_mixer_handle *mixer = (struct audio_mixer_handle*)nbio->data;
 
+   if (mixer && mixer->stream && !nbio->is_finished)
+   {
+      if (!filestream_exists(nbio->path))
+         task_set_cancelled(task, true);
+      nbio->is_finished = true;
+   }
+
    if (
          nbio->is_finished
          && (mixer && !mixer->is_finished)
@@ -550,6 +601,9 @@ bool task_push_audio_mixer_load_and_play(
    nbio->cb                  = &cb_nbio_audio_mixer_load;
    nbio->status              = NBIO_STATUS_INIT;
 
+   if (!task_audio_mixer_stream_from_file(nbio, mixer))
+      goto error;
+
    t->state           = nbio;
    t->handler         = task_file_load_handler;
    t->cleanup         = task_audio_mixer_load_free;
@@ -674,6 +728,9 @@ bool task_push_audio_mixer_load(
    nbio->cb           = &cb_nbio_audio_mixer_load;
    nbio->status       = NBIO_STATUS_INIT;
 
+   if (!task_audio_mixer_stream_from_file(nbio, mixer))
+      goto error;
+
    if (system)
       user->stream_type      = AUDIO_STREAM_TYPE_SYSTEM;
    else